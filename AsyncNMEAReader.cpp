@@ -0,0 +1,72 @@
+#include "AsyncNMEAReader.hpp"
+
+namespace {
+    // Large enough to drain a full TCP segment or several serial bursts per wake-up.
+    constexpr size_t kReadChunkBytes = 4096;
+}
+
+AsyncNMEAReader::AsyncNMEAReader(IComms &comms, EventLoop &loop, unsigned int idleTimeoutMs)
+    : _comms(comms),
+      _loop(loop),
+      _idleTimeoutMs(idleTimeoutMs),
+      _pollFd(comms.getPollDescriptor()),
+      _reader(comms, 0)
+{
+}
+
+AsyncNMEAReader::~AsyncNMEAReader()
+{
+    if (_pollFd >= 0)
+    {
+        _loop.cancel(_pollFd);
+    }
+}
+
+Task<std::optional<std::shared_ptr<NMEAMessage>>> AsyncNMEAReader::next()
+{
+    while (true)
+    {
+        // 1. Serve sentences already buffered from an earlier read
+        std::optional<std::shared_ptr<NMEAMessage>> message = _reader.parseBufferedSentence();
+        if (message.has_value())
+        {
+            co_return message;
+        }
+
+        if (!_comms.isOpen())
+        {
+            co_return std::nullopt;
+        }
+
+        // 2. Suspend until the medium has data, without holding a thread. Bytes the
+        //    comms layer already holds in user space never make the descriptor readable.
+        if (_comms.getBufferedBytes() == 0)
+        {
+            _pollFd = _comms.getPollDescriptor();
+            bool readable = co_await _loop.readable(_pollFd, _idleTimeoutMs);
+            if (!readable)
+            {
+                co_return std::nullopt; // Idle timeout or source removed from the loop
+            }
+        }
+
+        // 3. Drain whatever is available right now (zero timeout: never blocks)
+        if (_reader.readIntoBuffer(kReadChunkBytes, 0) == 0 && !_comms.isOpen())
+        {
+            co_return std::nullopt; // Peer closed the connection
+        }
+    }
+}
+
+AsyncGenerator<std::shared_ptr<NMEAMessage>> AsyncNMEAReader::messages()
+{
+    while (true)
+    {
+        std::optional<std::shared_ptr<NMEAMessage>> message = co_await next();
+        if (!message.has_value())
+        {
+            co_return;
+        }
+        co_yield std::move(message.value());
+    }
+}
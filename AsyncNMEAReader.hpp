@@ -0,0 +1,59 @@
+#ifndef ASYNC_NMEA_READER_HPP
+#define ASYNC_NMEA_READER_HPP
+
+#include "IComms.hpp"
+#include "NMEAReader.hpp"
+#include "EventLoop.hpp"
+#include "Coroutine.hpp"
+#include <memory>
+#include <optional>
+
+/**
+ * @brief Coroutine front end to NMEAReader.
+ *
+ * Instead of blocking inside IComms::readInto, the reader suspends on the
+ * EventLoop until the medium's poll descriptor is readable, then drains what is
+ * available without waiting. Framing and parsing are delegated to NMEAReader, so
+ * both readers accept exactly the same input.
+ *
+ * Requires an IComms whose getPollDescriptor() returns a valid descriptor.
+ */
+class AsyncNMEAReader {
+public:
+    /**
+     * @brief Constructs an AsyncNMEAReader.
+     * @param comms An initialized IComms object that supports getPollDescriptor().
+     * @param loop The EventLoop that resumes this reader's coroutines.
+     * @param idleTimeoutMs How long next() waits for data before giving up; 0 waits indefinitely.
+     */
+    AsyncNMEAReader(IComms& comms, EventLoop& loop, unsigned int idleTimeoutMs = 0);
+
+    /**
+     * @brief Removes the medium from the EventLoop.
+     * A coroutine still waiting in next() is never resumed, since its frame refers
+     * to this reader; it stays suspended until the Task that owns it is destroyed.
+     */
+    ~AsyncNMEAReader();
+
+    /**
+     * @brief Waits for the next valid NMEA sentence.
+     * @return The parsed message, or std::nullopt if the idle timeout expired or
+     *         the medium was closed.
+     */
+    Task<std::optional<std::shared_ptr<NMEAMessage>>> next();
+
+    /**
+     * @brief Produces parsed messages until the medium closes (or the idle timeout expires).
+     * @return A generator consumed with `co_await generator.next()`.
+     */
+    AsyncGenerator<std::shared_ptr<NMEAMessage>> messages();
+
+private:
+    IComms& _comms;
+    EventLoop& _loop;
+    unsigned int _idleTimeoutMs;
+    int _pollFd;
+    NMEAReader _reader; // Used for framing and parsing only; never performs reads itself
+};
+
+#endif // ASYNC_NMEA_READER_HPP
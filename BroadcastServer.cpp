@@ -0,0 +1,403 @@
+/**
+ * @file BroadcastServer.cpp
+ * @brief Implementation of the shared-chunk TCP fan-out server.
+ */
+
+#include "BroadcastServer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+    constexpr int kMaxEventsPerWait = 256;
+    // Chunks gathered per write; a client this far behind is flushed over several calls
+    constexpr int kMaxIovecs = 64;
+}
+
+/// @brief One block of published bytes, shared by every client still reading it.
+struct BroadcastServer::Chunk {
+    std::unique_ptr<std::byte[]> data;
+    size_t capacity;
+    size_t used;
+    uint64_t startPosition;      // Stream position of data[0]
+    std::shared_ptr<Chunk> next; // Keeps later chunks alive for clients still here
+    uint64_t *liveCounter;
+
+    Chunk(size_t size, uint64_t position, uint64_t *counter)
+        : data(new std::byte[size]), capacity(size), used(0), startPosition(position), liveCounter(counter)
+    {
+        ++*liveCounter;
+    }
+    ~Chunk() { --*liveCounter; }
+};
+
+BroadcastServer::BroadcastServer(const Options &options)
+    : _options(options),
+      _listenFd(-1),
+      _epollFd(-1),
+      _port(0),
+      _publishedBytes(0)
+{
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollFd == -1)
+    {
+        std::cerr << "epoll_create1 error: " << strerror(errno) << std::endl;
+    }
+    startNewChunk(_options.chunkSize);
+}
+
+BroadcastServer::~BroadcastServer()
+{
+    close();
+    if (_epollFd != -1)
+    {
+        ::close(_epollFd);
+    }
+}
+
+bool BroadcastServer::listen(const std::string &port, const std::string &bindAddress)
+{
+    if (_listenFd != -1)
+    {
+        std::cerr << "Error: Already listening." << std::endl;
+        return false;
+    }
+
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    int status = getaddrinfo(bindAddress.empty() ? NULL : bindAddress.c_str(), port.c_str(), &hints, &res);
+    if (status != 0)
+    {
+        std::cerr << "getaddrinfo error: " << gai_strerror(status) << std::endl;
+        return false;
+    }
+
+    for (struct addrinfo *p = res; p != NULL && _listenFd == -1; p = p->ai_next)
+    {
+        int fd = socket(p->ai_family, p->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, p->ai_protocol);
+        if (fd == -1)
+        {
+            std::cerr << "socket error: " << strerror(errno) << std::endl;
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+        if (bind(fd, p->ai_addr, p->ai_addrlen) == -1 || ::listen(fd, _options.backlog) == -1)
+        {
+            std::cerr << "bind/listen error: " << strerror(errno) << std::endl;
+            ::close(fd);
+            continue;
+        }
+        _listenFd = fd;
+    }
+    freeaddrinfo(res);
+
+    if (_listenFd == -1)
+    {
+        std::cerr << "Error: Failed to listen on port " << port << std::endl;
+        return false;
+    }
+
+    struct sockaddr_storage local;
+    socklen_t length = sizeof local;
+    getsockname(_listenFd, reinterpret_cast<sockaddr *>(&local), &length);
+    _port = ntohs(local.ss_family == AF_INET6 ? reinterpret_cast<sockaddr_in6 *>(&local)->sin6_port
+                                               : reinterpret_cast<sockaddr_in *>(&local)->sin_port);
+
+    epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.fd = _listenFd;
+    epoll_ctl(_epollFd, EPOLL_CTL_ADD, _listenFd, &ev);
+    return true;
+}
+
+void BroadcastServer::close()
+{
+    while (!_clients.empty())
+    {
+        disconnect(_clients.begin()->first);
+    }
+    if (_listenFd != -1)
+    {
+        ::close(_listenFd);
+        _listenFd = -1;
+        _port = 0;
+    }
+}
+
+void BroadcastServer::startNewChunk(size_t minimumCapacity)
+{
+    auto chunk = std::make_shared<Chunk>(std::max(minimumCapacity, _options.chunkSize), _publishedBytes, &_stats.liveChunks);
+    if (_tail)
+    {
+        _tail->next = chunk; // Clients still on the old tail reach the new one through next
+    }
+    _tail = std::move(chunk);
+}
+
+void BroadcastServer::publish(std::span<const std::byte> data)
+{
+    if (data.empty())
+    {
+        return;
+    }
+    // Never split one publish across chunks, so a chunk always starts on a sentence boundary
+    if (_tail->used + data.size() > _tail->capacity)
+    {
+        startNewChunk(data.size());
+    }
+    memcpy(_tail->data.get() + _tail->used, data.data(), data.size());
+    _tail->used += data.size();
+    _publishedBytes += data.size();
+}
+
+void BroadcastServer::publish(const std::string &data)
+{
+    publish(std::as_bytes(std::span<const char>(data.data(), data.size())));
+}
+
+void BroadcastServer::publishSentence(const std::string &sentence)
+{
+    std::string framed;
+    framed.reserve(sentence.size() + 2);
+    framed.append(sentence).append("\r\n");
+    publish(framed);
+}
+
+uint64_t BroadcastServer::backlog(const Client &client) const
+{
+    return _publishedBytes - (client.chunk->startPosition + client.offset);
+}
+
+void BroadcastServer::acceptClients()
+{
+    while (true)
+    {
+        int fd = accept4(_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                std::cerr << "accept error: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        // Sentences should leave as soon as they are published
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+
+        epoll_event ev {};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev) == -1)
+        {
+            std::cerr << "epoll_ctl error: " << strerror(errno) << std::endl;
+            ::close(fd);
+            continue;
+        }
+
+        // New clients join at the live edge; history is not replayed
+        _clients[fd] = Client{fd, _tail, _tail->used, false};
+        ++_stats.accepted;
+    }
+}
+
+void BroadcastServer::setWritableInterest(Client &client, bool enable)
+{
+    if (client.waitingForWritable == enable)
+    {
+        return;
+    }
+    epoll_event ev {};
+    ev.events = EPOLLIN | EPOLLRDHUP | (enable ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    ev.data.fd = client.fd;
+    epoll_ctl(_epollFd, EPOLL_CTL_MOD, client.fd, &ev);
+    client.waitingForWritable = enable;
+}
+
+bool BroadcastServer::flushClient(Client &client)
+{
+    while (true)
+    {
+        // Gather the unsent part of the chain straight from the shared chunks
+        struct iovec iov[kMaxIovecs];
+        int count = 0;
+        size_t requested = 0;
+        size_t offset = client.offset;
+        for (Chunk *chunk = client.chunk.get(); chunk != nullptr && count < kMaxIovecs; chunk = chunk->next.get())
+        {
+            if (chunk->used > offset)
+            {
+                iov[count].iov_base = chunk->data.get() + offset;
+                iov[count].iov_len = chunk->used - offset;
+                requested += iov[count].iov_len;
+                ++count;
+            }
+            offset = 0;
+        }
+        if (count == 0)
+        {
+            setWritableInterest(client, false);
+            return true; // Up to date
+        }
+
+        // sendmsg is writev for sockets, plus MSG_NOSIGNAL so a vanished peer cannot raise SIGPIPE
+        struct msghdr msg;
+        memset(&msg, 0, sizeof msg);
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        ++_stats.writevCalls;
+        ssize_t written = sendmsg(client.fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                setWritableInterest(client, true);
+                return true;
+            }
+            return false;
+        }
+        _stats.bytesSent += static_cast<uint64_t>(written);
+
+        // Advance the cursor; chunks behind it are released when no one else holds them
+        size_t remaining = static_cast<size_t>(written);
+        while (remaining > 0)
+        {
+            size_t available = client.chunk->used - client.offset;
+            size_t step = std::min(available, remaining);
+            client.offset += step;
+            remaining -= step;
+            if (client.offset == client.chunk->used && client.chunk->next)
+            {
+                client.chunk = client.chunk->next;
+                client.offset = 0;
+            }
+        }
+        if (client.offset == client.chunk->used && client.chunk->next)
+        {
+            client.chunk = client.chunk->next;
+            client.offset = 0;
+        }
+
+        if (static_cast<size_t>(written) < requested)
+        {
+            setWritableInterest(client, true); // Socket buffer full
+            return true;
+        }
+    }
+}
+
+void BroadcastServer::disconnect(int fd)
+{
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    _clients.erase(fd);
+    ++_stats.disconnected;
+}
+
+void BroadcastServer::poll(unsigned int timeoutMs)
+{
+    std::vector<int> dropped;
+
+    // 1. Apply the slow-client policy, then push new data to everyone not blocked on EPOLLOUT
+    for (auto &[fd, client] : _clients)
+    {
+        if (backlog(client) > _options.maxQueuedBytes)
+        {
+            if (_options.slowClientPolicy == SlowClientPolicy::Evict)
+            {
+                ++_stats.evicted;
+                dropped.push_back(fd);
+                continue;
+            }
+            // Resume at the start of the newest chunk if that fits the limit, else at the live edge.
+            // A sentence the client was part way through is cut; NMEA readers resync on '$'.
+            size_t resumeOffset = _tail->used <= _options.maxQueuedBytes ? 0 : _tail->used;
+            _stats.skippedBytes += backlog(client) - (_tail->used - resumeOffset);
+            ++_stats.skipAheads;
+            client.chunk = _tail;
+            client.offset = resumeOffset;
+        }
+        if (!client.waitingForWritable && backlog(client) > 0 && !flushClient(client))
+        {
+            dropped.push_back(fd);
+        }
+    }
+    for (int fd : dropped)
+    {
+        disconnect(fd);
+    }
+    dropped.clear();
+
+    // 2. Wait for new clients, writable sockets and hang-ups
+    epoll_event events[kMaxEventsPerWait];
+    int n = epoll_wait(_epollFd, events, kMaxEventsPerWait, static_cast<int>(timeoutMs));
+    if (n == -1)
+    {
+        if (errno != EINTR)
+        {
+            std::cerr << "epoll_wait error: " << strerror(errno) << std::endl;
+        }
+        return;
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        int fd = events[i].data.fd;
+        if (fd == _listenFd)
+        {
+            acceptClients();
+            continue;
+        }
+
+        auto it = _clients.find(fd);
+        if (it == _clients.end())
+        {
+            continue;
+        }
+        Client &client = it->second;
+
+        if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+        {
+            // Downstream clients have nothing to say; drain and detect the close
+            char scratch[512];
+            ssize_t r = recv(fd, scratch, sizeof scratch, MSG_DONTWAIT);
+            if (r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) ||
+                (events[i].events & (EPOLLHUP | EPOLLERR)))
+            {
+                dropped.push_back(fd);
+                continue;
+            }
+        }
+        if (events[i].events & EPOLLOUT)
+        {
+            // flushClient drops EPOLLOUT interest once the client is up to date
+            if (!flushClient(client))
+            {
+                dropped.push_back(fd);
+            }
+        }
+    }
+    for (int fd : dropped)
+    {
+        disconnect(fd);
+    }
+}
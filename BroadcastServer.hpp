@@ -0,0 +1,157 @@
+/**
+ * @file BroadcastServer.hpp
+ * @brief TCP fan-out of an NMEA feed to many downstream clients (Linux only).
+ * @details Published bytes are appended once to a chain of shared, reference-counted
+ * chunks. Every client holds a cursor (chunk + offset) into that chain and is written
+ * with non-blocking writev() straight from the shared chunks, so there is no per-client
+ * copy. A chunk is freed as soon as the slowest client has moved past it.
+ *
+ * ## Example Usage
+ *
+ * ```cpp
+ * NetworkComms upstream;
+ * upstream.connect("gps-mux", "10110");
+ * NMEAReader reader(upstream, 100);
+ *
+ * BroadcastServer server;
+ * server.listen("10111");
+ * while (upstream.isOpen()) {
+ *     if (auto message = reader.readAndParseSentence()) {
+ *         server.publishSentence((*message)->rawSentence);
+ *     }
+ *     server.poll(0);
+ * }
+ * ```
+ */
+
+#ifndef BROADCAST_SERVER_HPP
+#define BROADCAST_SERVER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+class BroadcastServer {
+public:
+    /// @brief What to do with a client whose unsent backlog exceeds maxQueuedBytes.
+    enum class SlowClientPolicy {
+        Evict,    ///< Disconnect the client
+        SkipAhead ///< Drop its backlog and continue from the newest chunk (a sentence boundary)
+    };
+
+    struct Options {
+        size_t chunkSize = 64 * 1024;        ///< Capacity of each shared chunk
+        size_t maxQueuedBytes = 1024 * 1024; ///< Backlog limit per client
+        SlowClientPolicy slowClientPolicy = SlowClientPolicy::SkipAhead;
+        int backlog = 128;                   ///< listen() backlog
+    };
+
+    struct Stats {
+        uint64_t accepted = 0;     ///< Clients accepted
+        uint64_t disconnected = 0; ///< Clients removed for any reason (including eviction)
+        uint64_t evicted = 0;      ///< Clients dropped by SlowClientPolicy::Evict
+        uint64_t skipAheads = 0;   ///< Backlogs dropped by SlowClientPolicy::SkipAhead
+        uint64_t skippedBytes = 0; ///< Bytes never delivered because of skip-ahead
+        uint64_t writevCalls = 0;  ///< Gathered writes issued (sendmsg with an iovec array)
+        uint64_t bytesSent = 0;    ///< Bytes delivered, summed over all clients
+        uint64_t liveChunks = 0;   ///< Chunks currently referenced by the server or a client
+    };
+
+    BroadcastServer() : BroadcastServer(Options()) {}
+    explicit BroadcastServer(const Options& options);
+
+    /**
+     * @brief Destructor. Disconnects all clients and closes the listening socket.
+     */
+    ~BroadcastServer();
+
+    BroadcastServer(const BroadcastServer&) = delete;
+    BroadcastServer& operator=(const BroadcastServer&) = delete;
+
+    /**
+     * @brief Starts accepting clients.
+     * @param port The TCP port to listen on ("0" picks an ephemeral port, see getPort()).
+     * @param bindAddress Local address to bind; empty binds all interfaces.
+     * @return True on success, false otherwise.
+     */
+    bool listen(const std::string& port, const std::string& bindAddress = "");
+
+    /// @brief The port actually bound, or 0 if not listening.
+    unsigned short getPort() const { return _port; }
+
+    /**
+     * @brief Queues bytes for every connected client. Nothing is sent until poll().
+     * Data from one call is never split across chunks, so a chunk boundary is always
+     * a publish boundary.
+     * @param data The bytes to broadcast.
+     */
+    void publish(std::span<const std::byte> data);
+
+    /// @brief Convenience overload for preformatted text.
+    void publish(const std::string& data);
+
+    /**
+     * @brief Queues one NMEA sentence, adding the CRLF terminator.
+     * @param sentence The sentence without line ending (e.g. NMEAMessage::rawSentence).
+     */
+    void publishSentence(const std::string& sentence);
+
+    /**
+     * @brief Writes queued data to clients and services the listening socket.
+     * Accepts pending clients, flushes every client that has a backlog, and waits up to
+     * timeoutMs for sockets to become writable or new clients to arrive.
+     * @param timeoutMs Maximum time to wait in milliseconds; 0 does not block.
+     */
+    void poll(unsigned int timeoutMs);
+
+    /**
+     * @brief Returns the epoll descriptor; readable whenever poll() has work to do
+     * other than flushing newly published data.
+     */
+    int getPollDescriptor() const { return _epollFd; }
+
+    /// @brief Number of connected clients.
+    size_t getClientCount() const { return _clients.size(); }
+
+    /// @brief Returns counters since construction.
+    const Stats& getStats() const { return _stats; }
+
+    /**
+     * @brief Disconnects all clients and stops listening.
+     */
+    void close();
+
+private:
+    struct Chunk;
+
+    // Read position of one client in the chunk chain
+    struct Client {
+        int fd;
+        std::shared_ptr<Chunk> chunk;
+        size_t offset;
+        bool waitingForWritable; // EPOLLOUT armed after a short write
+    };
+
+    Options _options;
+    Stats _stats;
+    int _listenFd;
+    int _epollFd;
+    unsigned short _port;
+    uint64_t _publishedBytes;
+    std::shared_ptr<Chunk> _tail; // Chunk being appended to; new clients start here
+    std::unordered_map<int, Client> _clients;
+
+    void acceptClients();
+    void startNewChunk(size_t minimumCapacity);
+    // Bytes published but not yet written to client
+    uint64_t backlog(const Client& client) const;
+    // Sends as much of the client's backlog as the socket takes; false if it was disconnected
+    bool flushClient(Client& client);
+    void setWritableInterest(Client& client, bool enable);
+    void disconnect(int fd);
+};
+
+#endif // BROADCAST_SERVER_HPP
@@ -1,6 +1,6 @@
 /**
  * @file Comms.cpp
- * @brief Implementation of the Comms class supporting various framing strategies.
+ * @brief Implementation of CommsSocket, and of Comms for the built-in framing strategies.
  */
 
 #include "Comms.hpp"
@@ -9,19 +9,28 @@
 
 #ifdef _WIN32
     static bool winsock_initialized = false;
+#else
+    #include <poll.h>
 #endif
 
-Comms::Comms(SocketBackend backend, FramingStrategy framing)
-    : backend(backend), framing(framing), sock(INVALID_SOCKET) {
+CommsSocket::CommsSocket(SocketBackend backend, size_t receiveBufferSize)
+    : backend(backend), sock(INVALID_SOCKET),
+      receiveBuffer(receiveBufferSize > 0 ? receiveBufferSize : kDefaultReceiveBufferSize),
+      receiveStart(0), receiveEnd(0),
+      coalesceMessages(0), coalesceDelay(0), queuedMessages(0) {
     initializeSocketAPI();
 }
 
-Comms::~Comms() {
+CommsSocket::~CommsSocket() {
+    try {
+        flush(); // Best effort: deliver coalesced messages still queued
+    } catch (const std::exception&) {
+    }
     closeSocket();
     cleanupSocketAPI();
 }
 
-void Comms::initializeSocketAPI() {
+void CommsSocket::initializeSocketAPI() {
 #ifdef _WIN32
     if (!winsock_initialized) {
         WSADATA wsaData;
@@ -33,13 +42,13 @@ void Comms::initializeSocketAPI() {
 #endif
 }
 
-void Comms::cleanupSocketAPI() {
+void CommsSocket::cleanupSocketAPI() {
 #ifdef _WIN32
     // Optional: WSACleanup() could be called, but avoid if other sockets are in use.
 #endif
 }
 
-void Comms::closeSocket() {
+void CommsSocket::closeSocket() {
     if (sock != INVALID_SOCKET) {
 #ifdef _WIN32
         closesocket(sock);
@@ -50,7 +59,14 @@ void Comms::closeSocket() {
     }
 }
 
-void Comms::connectToServer(const std::string& ip, int port) {
+void CommsSocket::openConnection(const std::string& ip, int port) {
+    // Reconnecting (RequestClient does) must not leak the previous descriptor
+    closeSocket();
+    // Bytes left over from a previous connection belong to a different stream
+    receiveStart = receiveEnd = 0;
+    queued.clear();
+    queuedMessages = 0;
+
     sock = socket(AF_INET, SOCK_STREAM, 0);
     if (sock == INVALID_SOCKET) {
         throw std::runtime_error("Failed to create socket");
@@ -70,112 +86,191 @@ void Comms::connectToServer(const std::string& ip, int port) {
     }
 }
 
-void Comms::sendMessage(const std::string& message) {
-    std::string framedMessage = message;
-
-    switch (framing) {
-        case FramingStrategy::CRLF:
-            framedMessage += "\r\n";
-            break;
-        case FramingStrategy::LengthPrefix: {
-            uint32_t len = htonl(static_cast<uint32_t>(message.size()));
-            framedMessage = std::string(reinterpret_cast<char*>(&len), sizeof(len)) + message;
-            break;
-        }
-        case FramingStrategy::Timeout:
-        case FramingStrategy::None:
-            break; // No framing
+void CommsSocket::addVector(const char* data, size_t length) {
+    if (length == 0) {
+        return;
     }
-
-    if (send(sock, framedMessage.c_str(), static_cast<int>(framedMessage.size()), 0) == SOCKET_ERROR) {
-        throw std::runtime_error("Failed to send message");
+#ifdef _WIN32
+    WSABUF buffer;
+    buffer.buf = const_cast<char*>(data);
+    buffer.len = static_cast<ULONG>(length);
+#else
+    iovec buffer;
+    buffer.iov_base = const_cast<char*>(data);
+    buffer.iov_len = length;
+#endif
+    sendVectors.push_back(buffer);
+    if (sendVectors.size() == kMaxSendVectors) {
+        sendVectorsFully();
     }
 }
 
-std::string Comms::receiveMessage() {
-    switch (framing) {
-        case FramingStrategy::CRLF:
-            return receiveUntilCRLF();
-        case FramingStrategy::LengthPrefix:
-            return receiveWithLengthPrefix();
-        case FramingStrategy::Timeout:
-            return receiveWithTimeout();
-        case FramingStrategy::None: {
-            char buffer[1024];
-            int received = recv(sock, buffer, sizeof(buffer), 0);
-            if (received <= 0) {
-                throw std::runtime_error("Connection closed or error receiving data");
+void CommsSocket::sendVectorsFully() {
+    size_t first = 0;
+    while (first < sendVectors.size()) {
+        ++stats.sendCalls;
+#ifdef _WIN32
+        DWORD sent = 0;
+        if (WSASend(sock, &sendVectors[first], static_cast<DWORD>(sendVectors.size() - first), &sent, 0, nullptr,
+                    nullptr) == SOCKET_ERROR) {
+            sendVectors.clear();
+            throw std::runtime_error("Failed to send message");
+        }
+        size_t remaining = sent;
+#else
+        msghdr msg {};
+        msg.msg_iov = &sendVectors[first];
+        msg.msg_iovlen = sendVectors.size() - first;
+    #ifdef MSG_NOSIGNAL
+        int flags = MSG_NOSIGNAL; // A vanished peer is an exception, not SIGPIPE
+    #else
+        int flags = 0;
+    #endif
+        ssize_t sent = sendmsg(sock, &msg, flags);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            sendVectors.clear();
+            throw std::runtime_error("Failed to send message");
+        }
+        size_t remaining = static_cast<size_t>(sent);
+#endif
+        // Skip the buffers that went out completely and trim a partially sent one
+        while (first < sendVectors.size()) {
+#ifdef _WIN32
+            size_t length = sendVectors[first].len;
+#else
+            size_t length = sendVectors[first].iov_len;
+#endif
+            if (remaining < length) {
+#ifdef _WIN32
+                sendVectors[first].buf += remaining;
+                sendVectors[first].len -= static_cast<ULONG>(remaining);
+#else
+                sendVectors[first].iov_base = static_cast<char*>(sendVectors[first].iov_base) + remaining;
+                sendVectors[first].iov_len -= remaining;
+#endif
+                break;
             }
-            return std::string(buffer, received);
+            remaining -= length;
+            ++first;
         }
     }
-    return {};
+    sendVectors.clear();
 }
 
-std::string Comms::receiveUntilCRLF() {
-    std::string buffer;
-    char ch;
-    while (true) {
-        int result = recv(sock, &ch, 1, 0);
-        if (result <= 0) break;
-        buffer += ch;
-        if (buffer.size() >= 2 && buffer.substr(buffer.size() - 2) == "\r\n") {
-            buffer.resize(buffer.size() - 2); // remove CRLF
-            break;
-        }
+size_t CommsSocket::gatherQueued() {
+    size_t count = queuedMessages;
+    queuedMessages = 0;
+    addVector(queued.data(), queued.size());
+    return count;
+}
+
+void CommsSocket::sendGathered(size_t messageCount) {
+    try {
+        sendVectorsFully();
+    } catch (const std::runtime_error&) {
+        queued.clear(); // Not retried after a failed send
+        throw;
     }
-    return buffer;
+    queued.clear();
+    stats.messagesSent += messageCount;
 }
 
-std::string Comms::receiveWithLengthPrefix() {
-    uint32_t len = 0;
-    int total = 0;
-    char* lenPtr = reinterpret_cast<char*>(&len);
-    while (total < 4) {
-        int received = recv(sock, lenPtr + total, 4 - total, 0);
-        if (received <= 0) {
-            throw std::runtime_error("Failed to receive message length");
-        }
-        total += received;
+void CommsSocket::queueMessage() {
+    auto now = std::chrono::steady_clock::now();
+    if (queuedMessages == 0) {
+        queuedSince = now;
+    }
+    ++queuedMessages;
+    if (queuedMessages >= coalesceMessages || now - queuedSince >= coalesceDelay) {
+        flush();
     }
-    len = ntohl(len);
+}
 
-    std::string buffer(len, 0);
-    total = 0;
-    while (total < static_cast<int>(len)) {
-        int received = recv(sock, &buffer[total], len - total, 0);
-        if (received <= 0) {
-            throw std::runtime_error("Failed to receive message body");
-        }
-        total += received;
+void CommsSocket::setCoalescing(size_t maxMessages, std::chrono::microseconds maxDelay) {
+    if (maxMessages <= 1) {
+        flush();
     }
+    coalesceMessages = maxMessages;
+    coalesceDelay = maxDelay;
+}
 
-    return buffer;
+void CommsSocket::flush() {
+    if (queuedMessages == 0) {
+        return;
+    }
+    size_t count = gatherQueued();
+    sendGathered(count);
 }
 
-std::string Comms::receiveWithTimeout() {
-    std::string buffer;
-    char temp[256];
-    auto last_received = std::chrono::steady_clock::now();
+void CommsSocket::flushIfDue() {
+    if (queuedMessages > 0 && std::chrono::steady_clock::now() - queuedSince >= coalesceDelay) {
+        flush();
+    }
+}
 
-    while (true) {
-        fd_set fds;
-        FD_ZERO(&fds);
-        FD_SET(sock, &fds);
+bool CommsSocket::fillReceiveBuffer() {
+    if (receiveStart == receiveEnd) {
+        receiveStart = receiveEnd = 0;
+    }
+    if (receiveEnd == receiveBuffer.size()) {
+        if (receiveStart > 0) {
+            // Move the partial frame to the front to make room behind it
+            std::memmove(receiveBuffer.data(), receiveBuffer.data() + receiveStart, receiveEnd - receiveStart);
+            receiveEnd -= receiveStart;
+            receiveStart = 0;
+        } else {
+            receiveBuffer.resize(receiveBuffer.size() * 2); // A frame larger than the buffer
+        }
+    }
 
-        timeval timeout {};
-        timeout.tv_sec = 0;
-        timeout.tv_usec = 30000; // 30ms
+    ++stats.recvCalls;
+    int received = recv(sock, receiveBuffer.data() + receiveEnd, static_cast<int>(receiveBuffer.size() - receiveEnd), 0);
+    if (received <= 0) {
+        return false;
+    }
+    receiveEnd += static_cast<size_t>(received);
+    return true;
+}
 
-        int ret = select(sock + 1, &fds, nullptr, nullptr, &timeout);
-        if (ret <= 0) break;
+MessagePool& CommsSocket::getMessagePool() {
+    if (!messagePool) {
+        messagePool = MessagePool::create();
+    }
+    return *messagePool;
+}
 
-        int received = recv(sock, temp, sizeof(temp), 0);
-        if (received <= 0) break;
+bool CommsSocket::waitReadable(int timeoutMs) {
+    // poll() rather than select(): FD_SET on a descriptor at or above FD_SETSIZE
+    // writes past the fd_set, which a busy process reaches easily
+#ifdef _WIN32
+    WSAPOLLFD pfd {};
+    pfd.fd = sock;
+    pfd.events = POLLRDNORM;
+    return WSAPoll(&pfd, 1, timeoutMs) > 0;
+#else
+    pollfd pfd {};
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    return poll(&pfd, 1, timeoutMs) > 0;
+#endif
+}
 
-        buffer.append(temp, received);
-        last_received = std::chrono::steady_clock::now();
+Comms::Comms(SocketBackend backend, FramingStrategy framing, size_t receiveBufferSize, size_t maxFrameSize) {
+    switch (framing) {
+        case FramingStrategy::CRLF:
+            impl = std::make_unique<Model<CrlfCodec>>(backend, CrlfCodec(), receiveBufferSize);
+            break;
+        case FramingStrategy::LengthPrefix:
+            impl = std::make_unique<Model<LengthPrefixCodec>>(backend, LengthPrefixCodec(maxFrameSize), receiveBufferSize);
+            break;
+        case FramingStrategy::Timeout:
+            impl = std::make_unique<Model<TimeoutCodec>>(backend, TimeoutCodec(), receiveBufferSize);
+            break;
+        case FramingStrategy::None:
+            impl = std::make_unique<Model<RawCodec>>(backend, RawCodec(), receiveBufferSize);
+            break;
     }
-
-    return buffer;
-}
\ No newline at end of file
+}
@@ -3,12 +3,25 @@
  * @brief Cross-platform communication class supporting WinSock and BSD sockets.
  * @details Provides basic TCP client functionality with multiple framing strategies:
  * CRLF, Length Prefix, Timeout, or None.
+ *
+ * BasicComms<Codec> is the client templated on a framing codec policy (see FramingCodecs.hpp),
+ * so framing compiles into the send and receive paths and new framings need no change here.
+ * Comms wraps any BasicComms behind one type for framing chosen at runtime, at the cost of
+ * one virtual call per message.
  */
 
 #ifndef COMMS_HPP
 #define COMMS_HPP
 
+#include "FramingCodecs.hpp"
+#include "MessagePool.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <stdexcept>
 #include <chrono>
@@ -22,6 +35,7 @@
 #else
     #include <sys/socket.h>
     #include <arpa/inet.h>
+    #include <sys/uio.h>
     #include <unistd.h>
     using SocketType = int;
     #define INVALID_SOCKET (-1)
@@ -42,28 +56,326 @@ enum class FramingStrategy {
     None          ///< Raw stream, caller is responsible for interpreting message boundaries
 };
 
-/// @brief Basic TCP client communications class
-class Comms {
+/// @brief Socket, buffers and send machinery shared by every BasicComms instantiation.
+/// @details Received bytes are read in bulk into a per-connection buffer and frames are
+/// decoded from it, so several messages that arrive in one segment cost one recv().
+/// Bytes past the end of a frame are kept for the next receive.
+///
+/// Sends gather the framing header/trailer and the payloads into one sendmsg() (WSASend
+/// on Windows) without copying payloads. With coalescing enabled, small messages are
+/// queued and flushed together once enough have accumulated or the oldest is old enough.
+class CommsSocket {
 public:
-    Comms(SocketBackend backend, FramingStrategy framing);
-    ~Comms();
+    /// @brief Syscall counters for profiling.
+    struct Stats {
+        uint64_t recvCalls = 0;    ///< recv() calls issued
+        uint64_t sendCalls = 0;    ///< sendmsg()/WSASend() calls issued
+        uint64_t messagesSent = 0; ///< Messages handed to the socket
+    };
+
+    static constexpr size_t kDefaultReceiveBufferSize = 64 * 1024;
+    /// @brief Most buffers gathered into a single send call (IOV_MAX on Linux).
+    static constexpr size_t kMaxSendVectors = 1024;
+
+    CommsSocket(const CommsSocket&) = delete;
+    CommsSocket& operator=(const CommsSocket&) = delete;
+
+    /// @brief Queues messages sent with sendMessage() instead of sending each at once.
+    /// The queue is flushed when it holds maxMessages messages, when a send finds the oldest
+    /// queued message at least maxDelay old, on flush()/flushIfDue(), and before receiveMessage()
+    /// waits for a reply. There is no timer thread: an idle sender should call flushIfDue().
+    /// @param maxMessages Flush threshold; 0 or 1 disables coalescing.
+    /// @param maxDelay Longest time a message may wait in the queue.
+    void setCoalescing(size_t maxMessages, std::chrono::microseconds maxDelay);
+
+    /// @brief Sends every queued message now.
+    void flush();
+
+    /// @brief Flushes if the oldest queued message has waited maxDelay.
+    void flushIfDue();
+
+    /// @brief Messages waiting in the coalescing queue.
+    size_t getQueuedMessages() const { return queuedMessages; }
+
+    /// @brief Received bytes not yet returned by receiveMessage().
+    size_t getBufferedBytes() const { return receiveEnd - receiveStart; }
+
+    const Stats& getStats() const { return stats; }
+
+    /// @brief Pool that receivePooled() takes buffers from; created on first use.
+    MessagePool& getMessagePool();
+
+    /// @brief Shares a pool between several clients on one thread.
+    void setMessagePool(std::shared_ptr<MessagePool> pool) { messagePool = std::move(pool); }
+
+protected:
+    /// @param receiveBufferSize Initial size of the receive buffer; it grows to fit larger frames.
+    CommsSocket(SocketBackend backend, size_t receiveBufferSize);
+    ~CommsSocket();
+
+    // Connects and drops any state of a previous connection
+    void openConnection(const std::string& ip, int port);
+    // For socket options beyond what CommsSocket sets
+    SocketType socketHandle() const { return sock; }
 
-    void connectToServer(const std::string& ip, int port);
-    void sendMessage(const std::string& message);
-    std::string receiveMessage();
+    // Appends one recv() worth of data to the buffer; false if the peer closed or on error
+    bool fillReceiveBuffer();
+    // Waits up to timeoutMs for data; false on timeout
+    bool waitReadable(int timeoutMs);
+    std::span<const char> buffered() const {
+        return std::span<const char>(receiveBuffer.data() + receiveStart, receiveEnd - receiveStart);
+    }
+    void consume(size_t count) { receiveStart += count; }
+
+    void addVector(const char* data, size_t length);
+    // Adds the coalescing queue to sendVectors; returns the number of messages it holds
+    size_t gatherQueued();
+    // Sends everything in sendVectors and counts messageCount messages as sent
+    void sendGathered(size_t messageCount);
+    // Coalescing: append a frame to queueBuffer(), then call queueMessage()
+    bool isCoalescing() const { return coalesceMessages > 1; }
+    std::string& queueBuffer() { return queued; }
+    void queueMessage();
+
+    // Scratch reused by derived classes between calls
+    std::string encodeScratch;
+    std::vector<char> frameScratch;
 
 private:
     SocketBackend backend;
-    FramingStrategy framing;
     SocketType sock;
 
+    // Received, not yet decoded bytes live in [receiveStart, receiveEnd)
+    std::vector<char> receiveBuffer;
+    size_t receiveStart;
+    size_t receiveEnd;
+    Stats stats;
+
+    // Coalescing queue: framed messages waiting to be sent together
+    size_t coalesceMessages;
+    std::chrono::microseconds coalesceDelay;
+    std::string queued;
+    size_t queuedMessages;
+    std::chrono::steady_clock::time_point queuedSince;
+    std::shared_ptr<MessagePool> messagePool;
+#ifdef _WIN32
+    std::vector<WSABUF> sendVectors;
+#else
+    std::vector<iovec> sendVectors;
+#endif
+
     void initializeSocketAPI();
     void cleanupSocketAPI();
     void closeSocket();
+    // Sends sendVectors, resuming after partial writes; throws on failure
+    void sendVectorsFully();
+};
+
+/// @brief TCP client whose message framing is the Codec policy.
+template <FramingCodec Codec>
+class BasicComms : public CommsSocket {
+public:
+    explicit BasicComms(SocketBackend backend = SocketBackend::BSD, Codec codec = Codec(),
+                        size_t receiveBufferSize = kDefaultReceiveBufferSize)
+        : CommsSocket(backend, receiveBufferSize), codec(std::move(codec)) {}
+
+    void connectToServer(const std::string& ip, int port) {
+        openConnection(ip, port);
+        codec.reset();
+    }
+
+    void sendMessage(std::string_view message) {
+        if (isCoalescing()) {
+            appendFrame(message, queueBuffer()); // Queued frames must outlive the caller's string
+            queueMessage();
+            return;
+        }
+        if constexpr (GatherCodec<Codec>) {
+            // The send vectors point into these until sendGathered() returns
+            std::array<char, Codec::kMaxHeader> header;
+            std::array<char, Codec::kMaxTrailer> trailer;
+            addVector(header.data(), codec.header(message, header.data()));
+            addVector(message.data(), message.size());
+            addVector(trailer.data(), codec.trailer(message, trailer.data()));
+            sendGathered(1);
+        } else {
+            encodeScratch.clear();
+            codec.encode(message, encodeScratch);
+            addVector(encodeScratch.data(), encodeScratch.size());
+            sendGathered(1);
+        }
+    }
+
+    /// @brief Frames and sends several messages with as few syscalls as possible
+    /// (one per kMaxSendVectors buffers). Queued coalesced messages go first.
+    /// A BatchingCodec packs the messages into as few frames as it can.
+    void sendMessages(std::span<const std::string> messages) {
+        size_t count = gatherQueued() + messages.size();
+        if constexpr (GatherCodec<Codec>) {
+            // Sized up front: the send vectors point into frameScratch
+            constexpr size_t perMessage = Codec::kMaxHeader + Codec::kMaxTrailer;
+            frameScratch.resize(messages.size() * perMessage);
+            for (size_t i = 0; i < messages.size(); ++i) {
+                char* header = frameScratch.data() + i * perMessage;
+                char* trailer = header + Codec::kMaxHeader;
+                addVector(header, codec.header(messages[i], header));
+                addVector(messages[i].data(), messages[i].size());
+                addVector(trailer, codec.trailer(messages[i], trailer));
+            }
+        } else {
+            encodeScratch.clear();
+            if constexpr (BatchingCodec<Codec>) {
+                codec.encodeBatch(messages, encodeScratch);
+            } else {
+                for (const std::string& message : messages) {
+                    codec.encode(message, encodeScratch);
+                }
+            }
+            addVector(encodeScratch.data(), encodeScratch.size());
+        }
+        sendGathered(count);
+    }
+
+    /// @brief Receives the next message, waiting as long as the codec requires.
+    /// Throws std::runtime_error where the codec reports a close mid-frame as an error, and
+    /// FrameTooLargeError for a frame over the codec's maximum (the connection is then unusable).
+    /// A frame a RejectingCodec rejects throws once and is skipped; the connection stays usable.
+    std::string receiveMessage() {
+        std::string message;
+        receiveInto(message);
+        return message;
+    }
+
+    /// @brief As receiveMessage(), decoding into a buffer from getMessagePool().
+    /// Once the pool's buffers have grown to the message size this allocates nothing.
+    PooledMessage receivePooled() {
+        PooledMessage message = getMessagePool().acquire();
+        receiveInto(message.str());
+        return message;
+    }
+
+    Codec& getCodec() { return codec; }
+
+private:
+    Codec codec;
+
+    void receiveInto(std::string& message) {
+        flush(); // The peer may be waiting for queued messages before it replies
+
+        if constexpr (BatchingCodec<Codec>) {
+            if (codec.takePending(message)) {
+                return; // Left over from a frame that carried several messages
+            }
+        }
+        while (true) {
+            if (size_t frameBytes = decodeBuffered(message)) {
+                consume(frameBytes);
+                return;
+            }
+            bool ended = (Codec::kIdleTimeoutMs >= 0 && !waitReadable(Codec::kIdleTimeoutMs)) || !fillReceiveBuffer();
+            if (ended) {
+                std::span<const char> rest = buffered();
+                consume(rest.size());
+                message = codec.finish(rest);
+                return;
+            }
+        }
+    }
+
+    size_t decodeBuffered(std::string& message) {
+        if constexpr (RejectingCodec<Codec>) {
+            try {
+                return codec.decode(buffered(), message);
+            } catch (const std::runtime_error&) {
+                consume(codec.takeRejectedFrame()); // Only that frame is lost, not the stream
+                throw;
+            }
+        } else {
+            return codec.decode(buffered(), message);
+        }
+    }
+
+    void appendFrame(std::string_view message, std::string& out) {
+        if constexpr (GatherCodec<Codec>) {
+            std::array<char, Codec::kMaxHeader> header;
+            std::array<char, Codec::kMaxTrailer> trailer;
+            out.append(header.data(), codec.header(message, header.data()));
+            out.append(message);
+            out.append(trailer.data(), codec.trailer(message, trailer.data()));
+        } else {
+            codec.encode(message, out);
+        }
+    }
+};
+
+/// @brief Basic TCP client communications class, with framing chosen at runtime.
+/// @details Type-erased wrapper around BasicComms: construct it from a FramingStrategy for the
+/// built-in framings, or from any codec object.
+class Comms {
+public:
+    using Stats = CommsSocket::Stats;
+    static constexpr size_t kDefaultReceiveBufferSize = CommsSocket::kDefaultReceiveBufferSize;
+    static constexpr size_t kMaxSendVectors = CommsSocket::kMaxSendVectors;
+
+    /// @param receiveBufferSize Initial size of the receive buffer; it grows to fit larger frames.
+    /// @param maxFrameSize Largest LengthPrefix frame accepted; see FrameTooLargeError.
+    Comms(SocketBackend backend, FramingStrategy framing, size_t receiveBufferSize = kDefaultReceiveBufferSize,
+          size_t maxFrameSize = LengthPrefixCodec::kDefaultMaxFrameSize);
+
+    /// @brief Wraps a client using the given codec.
+    template <FramingCodec Codec>
+    Comms(SocketBackend backend, Codec codec, size_t receiveBufferSize = kDefaultReceiveBufferSize)
+        : impl(std::make_unique<Model<Codec>>(backend, std::move(codec), receiveBufferSize)) {}
+
+    void connectToServer(const std::string& ip, int port) { impl->connectToServer(ip, port); }
+    void sendMessage(std::string_view message) { impl->sendMessage(message); }
+
+    /// @brief Frames and sends several messages with as few syscalls as possible
+    /// (one per kMaxSendVectors buffers). Queued coalesced messages go first.
+    void sendMessages(std::span<const std::string> messages) { impl->sendMessages(messages); }
+    std::string receiveMessage() { return impl->receiveMessage(); }
+
+    /// @copydoc BasicComms::receivePooled
+    PooledMessage receivePooled() { return impl->receivePooled(); }
+
+    /// @copydoc CommsSocket::setCoalescing
+    void setCoalescing(size_t maxMessages, std::chrono::microseconds maxDelay) {
+        impl->socket().setCoalescing(maxMessages, maxDelay);
+    }
+    void flush() { impl->socket().flush(); }
+    void flushIfDue() { impl->socket().flushIfDue(); }
+    size_t getQueuedMessages() const { return impl->socket().getQueuedMessages(); }
+    size_t getBufferedBytes() const { return impl->socket().getBufferedBytes(); }
+    const Stats& getStats() const { return impl->socket().getStats(); }
+    MessagePool& getMessagePool() { return impl->socket().getMessagePool(); }
+    void setMessagePool(std::shared_ptr<MessagePool> pool) { impl->socket().setMessagePool(std::move(pool)); }
+
+private:
+    struct Concept {
+        virtual ~Concept() = default;
+        virtual CommsSocket& socket() = 0;
+        virtual void connectToServer(const std::string& ip, int port) = 0;
+        virtual void sendMessage(std::string_view message) = 0;
+        virtual void sendMessages(std::span<const std::string> messages) = 0;
+        virtual std::string receiveMessage() = 0;
+        virtual PooledMessage receivePooled() = 0;
+    };
+
+    template <FramingCodec Codec>
+    struct Model final : Concept {
+        Model(SocketBackend backend, Codec codec, size_t receiveBufferSize)
+            : comms(backend, std::move(codec), receiveBufferSize) {}
+        CommsSocket& socket() override { return comms; }
+        void connectToServer(const std::string& ip, int port) override { comms.connectToServer(ip, port); }
+        void sendMessage(std::string_view message) override { comms.sendMessage(message); }
+        void sendMessages(std::span<const std::string> messages) override { comms.sendMessages(messages); }
+        std::string receiveMessage() override { return comms.receiveMessage(); }
+        PooledMessage receivePooled() override { return comms.receivePooled(); }
+
+        BasicComms<Codec> comms;
+    };
 
-    std::string receiveWithTimeout();
-    std::string receiveUntilCRLF();
-    std::string receiveWithLengthPrefix();
+    std::unique_ptr<Concept> impl;
 };
 
-#endif // COMMS_HPP
\ No newline at end of file
+#endif // COMMS_HPP
@@ -0,0 +1,691 @@
+/**
+ * @file CommsServer.cpp
+ * @brief Implementation of the epoll loop and socket I/O behind CommsServer and CommsClientPool.
+ */
+
+#include "CommsServer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    constexpr int kMaxEventsPerWait = 256;
+    // Accepts per poll(), so a connection storm cannot delay serving established connections
+    constexpr int kMaxAcceptsPerPoll = 256;
+    // Token of the listening socket; connection tokens are never all ones (generation wraps first)
+    constexpr uint64_t kListenToken = ~uint64_t(0);
+    // Buffers above this size are released when they empty, so idle connections stay small
+    constexpr size_t kRetainedCapacity = 16 * 1024;
+
+    void setNoDelay(int fd)
+    {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    }
+}
+
+CommsReactor::CommsReactor(const Options &options, int idleTimeoutMs)
+    : _options(options),
+      _idleTimeoutMs(idleTimeoutMs),
+      _epollFd(-1),
+      _listenFd(-1),
+      _port(0),
+      _openCount(0),
+      _scratch(std::max<size_t>(options.readBudgetBytes, 1)),
+      _defaultHandlers(std::make_shared<Handlers>())
+{
+    _options.maxFramesPerTurn = std::max<size_t>(_options.maxFramesPerTurn, 1);
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollFd == -1)
+    {
+        std::cerr << "epoll_create1 error: " << strerror(errno) << std::endl;
+    }
+}
+
+CommsReactor::~CommsReactor()
+{
+    // The derived class has already closed everything through closeAll(); this only
+    // guards against descriptors leaking if it did not
+    for (Connection &connection : _connections)
+    {
+        if (connection.fd != -1)
+        {
+            ::close(connection.fd);
+        }
+    }
+    if (_listenFd != -1)
+    {
+        ::close(_listenFd);
+    }
+    if (_epollFd != -1)
+    {
+        ::close(_epollFd);
+    }
+}
+
+void CommsReactor::setHandlers(Handlers handlers)
+{
+    _defaultHandlers = std::make_shared<const Handlers>(std::move(handlers));
+}
+
+void CommsReactor::setHandlers(ConnectionId id, Handlers handlers)
+{
+    if (Connection *connection = find(id))
+    {
+        connection->handlers = std::make_shared<const Handlers>(std::move(handlers));
+    }
+}
+
+bool CommsReactor::listenOn(const std::string &port, const std::string &bindAddress)
+{
+    if (_listenFd != -1)
+    {
+        std::cerr << "Error: Already listening." << std::endl;
+        return false;
+    }
+
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    int status = getaddrinfo(bindAddress.empty() ? NULL : bindAddress.c_str(), port.c_str(), &hints, &res);
+    if (status != 0)
+    {
+        std::cerr << "getaddrinfo error: " << gai_strerror(status) << std::endl;
+        return false;
+    }
+
+    for (struct addrinfo *p = res; p != NULL && _listenFd == -1; p = p->ai_next)
+    {
+        int fd = socket(p->ai_family, p->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, p->ai_protocol);
+        if (fd == -1)
+        {
+            std::cerr << "socket error: " << strerror(errno) << std::endl;
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+        if (bind(fd, p->ai_addr, p->ai_addrlen) == -1 || ::listen(fd, _options.backlog) == -1)
+        {
+            std::cerr << "bind/listen error: " << strerror(errno) << std::endl;
+            ::close(fd);
+            continue;
+        }
+        _listenFd = fd;
+    }
+    freeaddrinfo(res);
+
+    if (_listenFd == -1)
+    {
+        std::cerr << "Error: Failed to listen on port " << port << std::endl;
+        return false;
+    }
+
+    struct sockaddr_storage local;
+    socklen_t length = sizeof local;
+    getsockname(_listenFd, reinterpret_cast<sockaddr *>(&local), &length);
+    _port = ntohs(local.ss_family == AF_INET6 ? reinterpret_cast<sockaddr_in6 *>(&local)->sin6_port
+                                               : reinterpret_cast<sockaddr_in *>(&local)->sin_port);
+
+    epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = kListenToken;
+    epoll_ctl(_epollFd, EPOLL_CTL_ADD, _listenFd, &ev);
+    return true;
+}
+
+CommsReactor::ConnectionId CommsReactor::startConnect(const std::string &host, const std::string &port)
+{
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    int status = getaddrinfo(host.c_str(), port.c_str(), &hints, &res);
+    if (status != 0)
+    {
+        std::cerr << "getaddrinfo error: " << gai_strerror(status) << std::endl;
+        return 0;
+    }
+
+    int fd = socket(res->ai_family, res->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, res->ai_protocol);
+    if (fd == -1)
+    {
+        std::cerr << "socket error: " << strerror(errno) << std::endl;
+        freeaddrinfo(res);
+        return 0;
+    }
+    // An immediate failure is not reported here: epoll flags the socket at once and
+    // completeConnect() finds it unconnected, so every failure reaches onClose the same way
+    ::connect(fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+
+    uint32_t slot = openSlot(fd, true);
+    return makeId(slot, _connections[slot].generation);
+}
+
+uint32_t CommsReactor::openSlot(int fd, bool connecting)
+{
+    uint32_t slot;
+    if (!_freeSlots.empty())
+    {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(_connections.size());
+        _connections.emplace_back();
+    }
+
+    Connection &connection = _connections[slot];
+    connection.fd = fd;
+    ++connection.generation;
+    connection.connecting = connecting;
+    connection.readable = false;
+    connection.peerClosed = false;
+    connection.scheduled = false;
+    connection.dirty = false;
+    connection.writableArmed = false;
+    connection.pendingStart = 0;
+    connection.outputSent = 0;
+    connection.handlers = _defaultHandlers;
+    openCodec(slot);
+
+    epoll_event ev {};
+    ev.events = connecting ? EPOLLOUT : EPOLLIN | EPOLLRDHUP;
+    ev.data.u64 = makeId(slot, connection.generation);
+    epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev);
+    ++_openCount;
+    return slot;
+}
+
+void CommsReactor::updateInterest(uint32_t slot)
+{
+    Connection &connection = _connections[slot];
+    epoll_event ev {};
+    if (connection.connecting)
+    {
+        ev.events = EPOLLOUT;
+    }
+    else
+    {
+        uint32_t events = 0;
+        if (!connection.peerClosed)
+        {
+            events |= EPOLLIN | EPOLLRDHUP;
+        }
+        if (connection.writableArmed)
+        {
+            events |= EPOLLOUT;
+        }
+        ev.events = events;
+    }
+    ev.data.u64 = makeId(slot, connection.generation);
+    epoll_ctl(_epollFd, EPOLL_CTL_MOD, connection.fd, &ev);
+}
+
+CommsReactor::Connection *CommsReactor::find(ConnectionId id)
+{
+    uint32_t slot = static_cast<uint32_t>(id);
+    if (slot >= _connections.size() || !isSlotOpen(slot, static_cast<uint32_t>(id >> 32)))
+    {
+        return nullptr;
+    }
+    return &_connections[slot];
+}
+
+bool CommsReactor::isOpen(ConnectionId id) const
+{
+    return const_cast<CommsReactor *>(this)->find(id) != nullptr;
+}
+
+size_t CommsReactor::getQueuedBytes(ConnectionId id) const
+{
+    const Connection *connection = const_cast<CommsReactor *>(this)->find(id);
+    return connection ? connection->output.size() - connection->outputSent : 0;
+}
+
+void CommsReactor::close(ConnectionId id)
+{
+    if (find(id) != nullptr)
+    {
+        closeSlot(static_cast<uint32_t>(id), CloseReason::Local);
+    }
+}
+
+void CommsReactor::closeAll()
+{
+    for (uint32_t slot = 0; slot < _connections.size(); ++slot)
+    {
+        if (_connections[slot].fd != -1)
+        {
+            closeSlot(slot, CloseReason::Local);
+        }
+    }
+    if (_listenFd != -1)
+    {
+        ::close(_listenFd);
+        _listenFd = -1;
+        _port = 0;
+    }
+}
+
+void CommsReactor::closeSlot(uint32_t slot, CloseReason reason)
+{
+    Connection &connection = _connections[slot];
+    if (connection.fd == -1)
+    {
+        return;
+    }
+    if ((reason == CloseReason::PeerClosed || reason == CloseReason::Local) && !connection.connecting &&
+        connection.outputSent < connection.output.size())
+    {
+        // Best effort: replies to a peer that half-closed, or output queued before close()
+        ::send(connection.fd, connection.output.data() + connection.outputSent,
+               connection.output.size() - connection.outputSent, MSG_NOSIGNAL | MSG_DONTWAIT);
+    }
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+    ::close(connection.fd);
+    connection.fd = -1;
+    connection.scheduled = false;
+    connection.dirty = false;
+    std::vector<char>().swap(connection.pending);
+    std::string().swap(connection.output);
+    std::shared_ptr<const Handlers> handlers = std::move(connection.handlers);
+    --_openCount;
+    ++_stats.closed;
+    _freeSlots.push_back(slot);
+
+    if (handlers && handlers->onClose)
+    {
+        handlers->onClose(makeId(slot, connection.generation), reason);
+    }
+}
+
+void CommsReactor::acceptConnections()
+{
+    for (int accepted = 0; accepted < kMaxAcceptsPerPoll; ++accepted)
+    {
+        int fd = accept4(_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                std::cerr << "accept error: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+        if (_options.noDelay)
+        {
+            setNoDelay(fd);
+        }
+        uint32_t slot = openSlot(fd, false);
+        ++_stats.accepted;
+        std::shared_ptr<const Handlers> handlers = _connections[slot].handlers;
+        if (handlers->onOpen)
+        {
+            handlers->onOpen(makeId(slot, _connections[slot].generation));
+        }
+    }
+}
+
+void CommsReactor::completeConnect(uint32_t slot)
+{
+    Connection &connection = _connections[slot];
+    // SO_ERROR is already cleared if connect() itself failed, but the socket has no peer either way
+    sockaddr_storage peer;
+    socklen_t length = sizeof peer;
+    if (getpeername(connection.fd, reinterpret_cast<sockaddr *>(&peer), &length) == -1)
+    {
+        closeSlot(slot, CloseReason::ConnectFailed);
+        return;
+    }
+
+    connection.connecting = false;
+    updateInterest(slot);
+    if (_options.noDelay)
+    {
+        setNoDelay(connection.fd);
+    }
+    ++_stats.connected;
+    if (connection.outputSent < connection.output.size() && !connection.dirty)
+    {
+        connection.dirty = true;
+        _dirty.push_back(slot);
+    }
+    std::shared_ptr<const Handlers> handlers = connection.handlers;
+    if (handlers->onOpen)
+    {
+        handlers->onOpen(makeId(slot, connection.generation));
+    }
+}
+
+void CommsReactor::schedule(uint32_t slot)
+{
+    Connection &connection = _connections[slot];
+    if (!connection.scheduled)
+    {
+        connection.scheduled = true;
+        _ready.push_back(slot);
+    }
+}
+
+void CommsReactor::deliver(uint32_t slot, std::string &message)
+{
+    ++_stats.messagesReceived;
+    // Held so the handler may replace the connection's handlers while it runs
+    std::shared_ptr<const Handlers> handlers = _connections[slot].handlers;
+    if (handlers->onMessage)
+    {
+        handlers->onMessage(makeId(slot, _connections[slot].generation), message);
+    }
+}
+
+void CommsReactor::serve(uint32_t slot)
+{
+    Connection &connection = _connections[slot];
+    uint32_t generation = connection.generation;
+    connection.scheduled = false;
+
+    std::span<const char> input;
+    bool fromScratch = false;
+    if (connection.readable && !connection.peerClosed)
+    {
+        connection.readable = false;
+        ssize_t received;
+        do
+        {
+            ++_stats.recvCalls;
+            received = recv(connection.fd, _scratch.data(), _scratch.size(), MSG_DONTWAIT);
+        } while (received == -1 && errno == EINTR);
+
+        if (received > 0)
+        {
+            _stats.bytesReceived += static_cast<uint64_t>(received);
+            if (_idleTimeoutMs >= 0)
+            {
+                connection.lastReceive = Clock::now();
+                _idleDeadlines.emplace_back(connection.lastReceive + std::chrono::milliseconds(_idleTimeoutMs),
+                                            makeId(slot, generation));
+            }
+            if (connection.pendingStart == connection.pending.size())
+            {
+                // Nothing carried over: decode straight from the scratch buffer
+                input = std::span<const char>(_scratch.data(), static_cast<size_t>(received));
+                fromScratch = true;
+            }
+            else
+            {
+                connection.pending.insert(connection.pending.end(), _scratch.data(), _scratch.data() + received);
+            }
+        }
+        else if (received == 0)
+        {
+            connection.peerClosed = true;
+            updateInterest(slot);
+        }
+        else if (errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            closeSlot(slot, CloseReason::Error);
+            return;
+        }
+    }
+    if (!fromScratch)
+    {
+        input = std::span<const char>(connection.pending.data() + connection.pendingStart,
+                                      connection.pending.size() - connection.pendingStart);
+    }
+
+    size_t frames = 0;
+    size_t consumed = input.empty() ? 0 : decodeFrames(slot, input, _options.maxFramesPerTurn, frames);
+    if (!isSlotOpen(slot, generation))
+    {
+        return; // Closed by a handler or an invalid frame
+    }
+
+    // Carry what is left to the next turn
+    if (fromScratch)
+    {
+        connection.pending.assign(input.begin() + consumed, input.end());
+        connection.pendingStart = 0;
+    }
+    else
+    {
+        connection.pendingStart += consumed;
+        if (connection.pendingStart == connection.pending.size())
+        {
+            connection.pending.clear();
+            connection.pendingStart = 0;
+        }
+        else if (connection.pendingStart > connection.pending.size() / 2)
+        {
+            connection.pending.erase(connection.pending.begin(), connection.pending.begin() + connection.pendingStart);
+            connection.pendingStart = 0;
+        }
+    }
+    if (connection.pending.empty() && connection.pending.capacity() > kRetainedCapacity)
+    {
+        std::vector<char>().swap(connection.pending);
+    }
+
+    bool inputLeft = connection.pendingStart < connection.pending.size();
+    if (frames == _options.maxFramesPerTurn && inputLeft)
+    {
+        ++_stats.deferredTurns;
+        schedule(slot); // Behind every other connection with input
+    }
+    else if (connection.peerClosed)
+    {
+        finishFrame(slot, std::span<const char>(connection.pending.data() + connection.pendingStart,
+                                                connection.pending.size() - connection.pendingStart));
+        if (isSlotOpen(slot, generation))
+        {
+            closeSlot(slot, CloseReason::PeerClosed);
+        }
+    }
+}
+
+void CommsReactor::queueOutput(uint32_t slot)
+{
+    Connection &connection = _connections[slot];
+    ++_stats.messagesSent;
+    if (connection.output.size() - connection.outputSent > _options.maxQueuedBytes)
+    {
+        closeSlot(slot, CloseReason::Backlog);
+        return;
+    }
+    if (!connection.dirty && !connection.writableArmed)
+    {
+        connection.dirty = true;
+        _dirty.push_back(slot);
+    }
+}
+
+void CommsReactor::flushSlot(uint32_t slot)
+{
+    Connection &connection = _connections[slot];
+    connection.dirty = false;
+    if (connection.connecting)
+    {
+        return; // Written once the connect completes
+    }
+    while (connection.outputSent < connection.output.size())
+    {
+        ++_stats.sendCalls;
+        ssize_t sent = ::send(connection.fd, connection.output.data() + connection.outputSent,
+                              connection.output.size() - connection.outputSent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent > 0)
+        {
+            connection.outputSent += static_cast<size_t>(sent);
+            _stats.bytesSent += static_cast<uint64_t>(sent);
+        }
+        else if (sent == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            // A peer that never fully drains would otherwise keep the sent prefix forever
+            if (connection.outputSent > connection.output.size() / 2)
+            {
+                connection.output.erase(0, connection.outputSent);
+                connection.outputSent = 0;
+            }
+            if (!connection.writableArmed)
+            {
+                connection.writableArmed = true;
+                updateInterest(slot);
+            }
+            return;
+        }
+        else
+        {
+            closeSlot(slot, CloseReason::Error);
+            return;
+        }
+    }
+
+    connection.output.clear();
+    connection.outputSent = 0;
+    if (connection.output.capacity() > kRetainedCapacity)
+    {
+        std::string().swap(connection.output);
+    }
+    if (connection.writableArmed)
+    {
+        connection.writableArmed = false;
+        updateInterest(slot);
+    }
+}
+
+void CommsReactor::flushDirty()
+{
+    // Swapped out: a close handler run by a failed write may queue output elsewhere
+    std::vector<uint32_t> dirty;
+    dirty.swap(_dirty);
+    for (uint32_t slot : dirty)
+    {
+        if (_connections[slot].fd != -1 && _connections[slot].dirty)
+        {
+            flushSlot(slot);
+        }
+    }
+    if (_dirty.empty())
+    {
+        dirty.clear();
+        _dirty.swap(dirty); // Keep the capacity
+    }
+}
+
+void CommsReactor::flush()
+{
+    flushDirty();
+}
+
+void CommsReactor::expireIdle()
+{
+    Clock::time_point now = Clock::now();
+    while (!_idleDeadlines.empty() && _idleDeadlines.front().first <= now)
+    {
+        ConnectionId id = _idleDeadlines.front().second;
+        _idleDeadlines.pop_front();
+        Connection *connection = find(id);
+        // Only the deadline of the last receive counts; earlier ones are stale
+        if (connection == nullptr || connection->lastReceive + std::chrono::milliseconds(_idleTimeoutMs) > now ||
+            connection->pendingStart == connection->pending.size())
+        {
+            continue;
+        }
+        uint32_t slot = static_cast<uint32_t>(id);
+        std::vector<char> input;
+        input.swap(connection->pending);
+        size_t start = connection->pendingStart;
+        connection->pendingStart = 0;
+        finishFrame(slot, std::span<const char>(input.data() + start, input.size() - start));
+    }
+}
+
+int CommsReactor::waitTimeoutMs(unsigned int timeoutMs) const
+{
+    if (!_ready.empty() || !_dirty.empty())
+    {
+        return 0;
+    }
+    long long wait = timeoutMs;
+    if (!_idleDeadlines.empty())
+    {
+        auto untilDeadline = std::chrono::ceil<std::chrono::milliseconds>(_idleDeadlines.front().first - Clock::now());
+        wait = std::min<long long>(wait, std::max<long long>(untilDeadline.count(), 0));
+    }
+    return static_cast<int>(wait);
+}
+
+void CommsReactor::poll(unsigned int timeoutMs)
+{
+    flushDirty();
+
+    epoll_event events[kMaxEventsPerWait];
+    int count = epoll_wait(_epollFd, events, kMaxEventsPerWait, waitTimeoutMs(timeoutMs));
+    if (count == -1 && errno != EINTR)
+    {
+        std::cerr << "epoll_wait error: " << strerror(errno) << std::endl;
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        if (events[i].data.u64 == kListenToken)
+        {
+            acceptConnections();
+            continue;
+        }
+        uint32_t slot = static_cast<uint32_t>(events[i].data.u64);
+        if (!isSlotOpen(slot, static_cast<uint32_t>(events[i].data.u64 >> 32)))
+        {
+            continue; // Closed earlier in this batch
+        }
+        Connection &connection = _connections[slot];
+        if (connection.connecting)
+        {
+            completeConnect(slot);
+            continue;
+        }
+        if ((events[i].events & EPOLLOUT) && connection.writableArmed)
+        {
+            flushSlot(slot);
+            if (connection.fd == -1)
+            {
+                continue;
+            }
+        }
+        if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+        {
+            connection.readable = true;
+            schedule(slot);
+        }
+    }
+
+    // One turn each for the connections ready now; those rescheduled go to the back
+    for (size_t turns = _ready.size(); turns > 0 && !_ready.empty(); --turns)
+    {
+        uint32_t slot = _ready.front();
+        _ready.pop_front();
+        if (_connections[slot].fd != -1 && _connections[slot].scheduled)
+        {
+            serve(slot);
+        }
+    }
+
+    if (_idleTimeoutMs >= 0)
+    {
+        expireIdle();
+    }
+    flushDirty();
+}
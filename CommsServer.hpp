@@ -0,0 +1,357 @@
+/**
+ * @file CommsServer.hpp
+ * @brief Non-blocking, epoll-driven framed TCP connections: CommsServer accepts them,
+ * CommsClientPool opens them (Linux only).
+ * @details Both run any FramingCodec (see FramingCodecs.hpp) over thousands of connections
+ * from one thread. Every connection has its own codec state and handlers, and poll() serves
+ * them round-robin. Each turn a connection gets at most one recv() of
+ * Options::readBudgetBytes and delivers at most Options::maxFramesPerTurn frames, so a
+ * chatty peer cannot starve the others. Anything it has left waits for its next turn.
+ *
+ * Received bytes go into one shared scratch buffer and frames are decoded straight from it.
+ * Only the unfinished tail of a frame is copied into the connection, so an idle connection
+ * holds no receive memory. Messages given to send() are framed into the connection's output
+ * buffer and written once per poll(). Everything a handler sends in one turn therefore goes
+ * out in one syscall.
+ *
+ * Time-based framing (TimeoutCodec) is driven by idle deadlines kept in poll(), not by a
+ * blocking select() per message.
+ *
+ * ## Example Usage
+ *
+ * ```cpp
+ * CommsServer<CrlfCodec> server;
+ * CommsReactor::Handlers handlers;
+ * handlers.onMessage = [&](CommsReactor::ConnectionId id, std::string& line) {
+ *     server.send(id, "ACK " + line);
+ * };
+ * server.setHandlers(handlers);
+ * server.listen("10110");
+ * while (running) {
+ *     server.poll(100);
+ * }
+ * ```
+ */
+
+#ifndef COMMS_SERVER_HPP
+#define COMMS_SERVER_HPP
+
+#include "FramingCodecs.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// @brief Connection table, epoll loop and socket I/O shared by CommsServer and CommsClientPool.
+class CommsReactor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// @brief Identifies a connection; never reused, so a stale id is simply not open.
+    using ConnectionId = uint64_t;
+
+    enum class CloseReason {
+        PeerClosed,    ///< The peer closed its side
+        Error,         ///< A socket error
+        ConnectFailed, ///< An outbound connect did not complete
+        InvalidFrame,  ///< The codec rejected the input
+        Backlog,       ///< Unsent output exceeded Options::maxQueuedBytes
+        Local          ///< close() was called
+    };
+
+    /// @brief Callbacks for a connection. Any may be empty. They may call send() and close()
+    /// on any connection, and open new ones, but must not call poll().
+    struct Handlers {
+        /// @brief A decoded message; it may be moved from.
+        std::function<void(ConnectionId, std::string&)> onMessage;
+        /// @brief Accepted, or the outbound connect completed.
+        std::function<void(ConnectionId)> onOpen;
+        /// @brief The connection is gone; its id is no longer open.
+        std::function<void(ConnectionId, CloseReason)> onClose;
+    };
+
+    struct Options {
+        size_t readBudgetBytes = 64 * 1024;      ///< Most bytes read from one connection per turn
+        size_t maxFramesPerTurn = 64;            ///< Most messages delivered from one connection per turn
+        size_t maxQueuedBytes = 4 * 1024 * 1024; ///< Output backlog at which a connection is closed
+        int backlog = 1024;                      ///< listen() backlog
+        bool noDelay = true;                     ///< TCP_NODELAY on every connection
+    };
+
+    struct Stats {
+        uint64_t accepted = 0;        ///< Inbound connections accepted
+        uint64_t connected = 0;       ///< Outbound connects that completed
+        uint64_t closed = 0;          ///< Connections closed for any reason
+        uint64_t messagesReceived = 0;
+        uint64_t messagesSent = 0;
+        uint64_t bytesReceived = 0;
+        uint64_t bytesSent = 0;
+        uint64_t recvCalls = 0;
+        uint64_t sendCalls = 0;
+        uint64_t deferredTurns = 0;   ///< Turns that ended at maxFramesPerTurn with input left over
+    };
+
+    virtual ~CommsReactor();
+
+    CommsReactor(const CommsReactor&) = delete;
+    CommsReactor& operator=(const CommsReactor&) = delete;
+
+    /// @brief Handlers given to connections opened from now on.
+    void setHandlers(Handlers handlers);
+
+    /// @brief Replaces the handlers of one open connection.
+    void setHandlers(ConnectionId id, Handlers handlers);
+
+    /**
+     * @brief Runs one round: accepts and completes connections, gives every connection with
+     * input one turn, delivers idle-timeout frames and writes queued output.
+     * Connections still holding complete frames after their turn are served again next round
+     * without waiting.
+     * @param timeoutMs Maximum time to wait for activity in milliseconds; 0 does not block.
+     */
+    void poll(unsigned int timeoutMs);
+
+    /// @brief Writes queued output of every connection without waiting for poll().
+    void flush();
+
+    /// @brief Closes a connection; its onClose handler runs with CloseReason::Local.
+    void close(ConnectionId id);
+
+    /// @brief Closes every connection and stops listening.
+    void closeAll();
+
+    bool isOpen(ConnectionId id) const;
+
+    /// @brief Output queued for the connection and not yet accepted by the socket.
+    size_t getQueuedBytes(ConnectionId id) const;
+
+    size_t getConnectionCount() const { return _openCount; }
+
+    /// @brief Returns the epoll descriptor, for embedding in another event loop.
+    int getPollDescriptor() const { return _epollFd; }
+
+    const Stats& getStats() const { return _stats; }
+
+protected:
+    // A connection slot. Slots are reused; the generation tells their occupants apart
+    struct Connection {
+        int fd = -1;
+        uint32_t generation = 0;
+        bool connecting = false;
+        bool readable = false;      // Reported readable since its last read
+        bool peerClosed = false;    // recv() returned 0; deliver what is left, then close
+        bool scheduled = false;     // In _ready
+        bool dirty = false;         // In _dirty
+        bool writableArmed = false; // EPOLLOUT armed after a short write
+        std::vector<char> pending;  // Undecoded input carried to the next turn
+        size_t pendingStart = 0;
+        std::string output;
+        size_t outputSent = 0;
+        Clock::time_point lastReceive;
+        std::shared_ptr<const Handlers> handlers;
+    };
+
+    CommsReactor(const Options& options, int idleTimeoutMs);
+
+    // Binds and listens; false on failure
+    bool listenOn(const std::string& port, const std::string& bindAddress);
+    unsigned short listeningPort() const { return _port; }
+    // Starts a non-blocking connect; the id is valid at once and output may be queued
+    ConnectionId startConnect(const std::string& host, const std::string& port);
+
+    // Codec hooks, called with the slot of an open connection
+    virtual void openCodec(uint32_t slot) = 0;
+    // Decodes and delivers up to maxFrames frames from input; returns the bytes consumed
+    virtual size_t decodeFrames(uint32_t slot, std::span<const char> input, size_t maxFrames, size_t& frames) = 0;
+    // No more input will complete a frame: deliver what input makes of it, if anything
+    virtual void finishFrame(uint32_t slot, std::span<const char> input) = 0;
+
+    static ConnectionId makeId(uint32_t slot, uint32_t generation) {
+        return (static_cast<ConnectionId>(generation) << 32) | slot;
+    }
+    // The open connection id refers to, or null
+    Connection* find(ConnectionId id);
+    Connection& slotConnection(uint32_t slot) { return _connections[slot]; }
+    bool isSlotOpen(uint32_t slot, uint32_t generation) const {
+        return _connections[slot].fd != -1 && _connections[slot].generation == generation;
+    }
+
+    void deliver(uint32_t slot, std::string& message);
+    // Marks output appended to connection.output for writing; closes on backlog
+    void queueOutput(uint32_t slot);
+    void closeSlot(uint32_t slot, CloseReason reason);
+
+private:
+    Options _options;
+    Stats _stats;
+    int _idleTimeoutMs;
+    int _epollFd;
+    int _listenFd;
+    unsigned short _port;
+    size_t _openCount;
+    std::deque<Connection> _connections; // A deque so handlers may open connections mid-turn
+    std::vector<uint32_t> _freeSlots;
+    std::deque<uint32_t> _ready;         // Round-robin order of connections with input
+    std::vector<uint32_t> _dirty;        // Connections with output to write
+    std::deque<std::pair<Clock::time_point, ConnectionId>> _idleDeadlines; // Oldest first
+    std::vector<char> _scratch;
+    std::shared_ptr<const Handlers> _defaultHandlers;
+
+    uint32_t openSlot(int fd, bool connecting);
+    void updateInterest(uint32_t slot);
+    void acceptConnections();
+    void completeConnect(uint32_t slot);
+    void schedule(uint32_t slot);
+    void serve(uint32_t slot);
+    void flushSlot(uint32_t slot);
+    void flushDirty();
+    void expireIdle();
+    int waitTimeoutMs(unsigned int timeoutMs) const;
+};
+
+/// @brief The codec-dependent half: per-connection codec state, send() and frame delivery.
+template <FramingCodec Codec>
+class BasicCommsReactor : public CommsReactor {
+public:
+    /**
+     * @brief Frames a message into the connection's output; it is written by the next
+     * poll() or flush(). Ignored if the connection is not open.
+     */
+    void send(ConnectionId id, std::string_view message) {
+        Connection* connection = find(id);
+        if (connection == nullptr) {
+            return;
+        }
+        std::string& out = connection->output;
+        if constexpr (GatherCodec<Codec>) {
+            char header[Codec::kMaxHeader + 1];
+            char trailer[Codec::kMaxTrailer + 1];
+            out.append(header, _prototype.header(message, header));
+            out.append(message);
+            out.append(trailer, _prototype.trailer(message, trailer));
+        } else {
+            _prototype.encode(message, out);
+        }
+        queueOutput(static_cast<uint32_t>(id));
+    }
+
+protected:
+    BasicCommsReactor(const Options& options, Codec codec)
+        : CommsReactor(options, Codec::kIdleTimeoutMs), _prototype(std::move(codec)) {}
+
+    ~BasicCommsReactor() override { closeAll(); } // onClose handlers still see a live object
+
+private:
+    Codec _prototype;           // Copied into each new connection; also used to encode
+    std::deque<Codec> _codecs;  // By slot
+    std::string _message;
+
+    void openCodec(uint32_t slot) override {
+        if (slot == _codecs.size()) {
+            _codecs.push_back(_prototype);
+        } else {
+            _codecs[slot] = _prototype;
+        }
+        _codecs[slot].reset();
+    }
+
+    size_t decodeFrames(uint32_t slot, std::span<const char> input, size_t maxFrames, size_t& frames) override {
+        uint32_t generation = slotConnection(slot).generation;
+        size_t consumed = 0;
+        frames = 0;
+        try {
+            while (frames < maxFrames) {
+                size_t frameBytes = _codecs[slot].decode(input.subspan(consumed), _message);
+                if (frameBytes == 0) {
+                    break;
+                }
+                consumed += frameBytes;
+                ++frames;
+                deliver(slot, _message);
+                if constexpr (BatchingCodec<Codec>) {
+                    // The rest of a batch frame, delivered in the same turn
+                    while (isSlotOpen(slot, generation) && _codecs[slot].takePending(_message)) {
+                        deliver(slot, _message);
+                    }
+                }
+                if (!isSlotOpen(slot, generation)) {
+                    break; // Closed by its handler
+                }
+            }
+        } catch (const std::runtime_error&) {
+            closeSlot(slot, CloseReason::InvalidFrame);
+        }
+        return consumed;
+    }
+
+    void finishFrame(uint32_t slot, std::span<const char> input) override {
+        if (input.empty()) {
+            return;
+        }
+        uint32_t generation = slotConnection(slot).generation;
+        try {
+            _message = _codecs[slot].finish(input);
+        } catch (const std::runtime_error&) {
+            return; // Truncated frame: dropped with the connection
+        }
+        deliver(slot, _message);
+        if constexpr (BatchingCodec<Codec>) {
+            while (isSlotOpen(slot, generation) && _codecs[slot].takePending(_message)) {
+                deliver(slot, _message);
+            }
+        }
+    }
+};
+
+/// @brief Accepts framed TCP connections.
+template <FramingCodec Codec>
+class CommsServer : public BasicCommsReactor<Codec> {
+public:
+    using Options = CommsReactor::Options;
+
+    CommsServer() : CommsServer(Options()) {}
+    explicit CommsServer(const Options& options, Codec codec = Codec())
+        : BasicCommsReactor<Codec>(options, std::move(codec)) {}
+
+    /**
+     * @brief Starts accepting connections.
+     * @param port The TCP port to listen on ("0" picks an ephemeral port, see getPort()).
+     * @param bindAddress Local address to bind; empty binds all interfaces.
+     * @return True on success, false otherwise.
+     */
+    bool listen(const std::string& port, const std::string& bindAddress = "") {
+        return this->listenOn(port, bindAddress);
+    }
+
+    /// @brief The port actually bound, or 0 if not listening.
+    unsigned short getPort() const { return this->listeningPort(); }
+};
+
+/// @brief Opens and serves many outbound framed TCP connections.
+template <FramingCodec Codec>
+class CommsClientPool : public BasicCommsReactor<Codec> {
+public:
+    using Options = CommsReactor::Options;
+
+    CommsClientPool() : CommsClientPool(Options()) {}
+    explicit CommsClientPool(const Options& options, Codec codec = Codec())
+        : BasicCommsReactor<Codec>(options, std::move(codec)) {}
+
+    /**
+     * @brief Starts connecting to host:port (the first address it resolves to).
+     * Messages sent before the connect completes are written once it does; a failed
+     * connect is reported to onClose with CloseReason::ConnectFailed.
+     * @return The connection's id, or 0 if no socket could be created.
+     */
+    CommsReactor::ConnectionId connect(const std::string& host, const std::string& port) {
+        return this->startConnect(host, port);
+    }
+};
+
+#endif // COMMS_SERVER_HPP
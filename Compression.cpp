@@ -0,0 +1,474 @@
+/**
+ * @file Compression.cpp
+ * @brief Implementation of LzBlock, CompressionDictionary and FrameCompressor.
+ */
+
+#include "Compression.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+// LZ4 block format constants
+constexpr size_t kMinMatch = 4;
+constexpr size_t kLastLiterals = 5;   // The last 5 bytes are always literals
+constexpr size_t kMatchFindLimit = 12; // No match starts in the last 12 bytes
+constexpr size_t kMaxOffset = 65535;
+constexpr int kMaxInputHashBits = 12;
+
+// Frame body flags
+constexpr uint8_t kCompressed = 0x01;
+constexpr uint8_t kBatch = 0x02;
+constexpr uint8_t kDictionary = 0x04;
+
+uint32_t read32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint64_t read64(const char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t hashSequence(uint32_t sequence, int bits) { return (sequence * 2654435761u) >> (32 - bits); }
+
+// Number of bytes from ip on that equal those from match, stopping at limit
+size_t matchLength(const char* ip, const char* match, const char* limit) {
+    const char* start = ip;
+    if constexpr (std::endian::native == std::endian::little) {
+        while (ip + 8 <= limit) {
+            uint64_t difference = read64(ip) ^ read64(match);
+            if (difference != 0) {
+                return static_cast<size_t>(ip - start) + (std::countr_zero(difference) >> 3);
+            }
+            ip += 8;
+            match += 8;
+        }
+    }
+    while (ip < limit && *ip == *match) {
+        ++ip;
+        ++match;
+    }
+    return static_cast<size_t>(ip - start);
+}
+
+char* writeLength(char* op, size_t length) {
+    while (length >= 255) {
+        *op++ = static_cast<char>(255);
+        length -= 255;
+    }
+    *op++ = static_cast<char>(length);
+    return op;
+}
+
+char* writeLiterals(char* op, const char* literals, size_t length, uint8_t matchCode) {
+    *op++ = static_cast<char>((std::min<size_t>(length, 15) << 4) | matchCode);
+    if (length >= 15) {
+        op = writeLength(op, length - 15);
+    }
+    std::memcpy(op, literals, length);
+    return op + length;
+}
+
+char* writeSequence(char* op, const char* literals, size_t literalLength, size_t offset, size_t length) {
+    size_t matchCode = length - kMinMatch;
+    op = writeLiterals(op, literals, literalLength, static_cast<uint8_t>(std::min<size_t>(matchCode, 15)));
+    *op++ = static_cast<char>(offset & 0xFF);
+    *op++ = static_cast<char>(offset >> 8);
+    if (matchCode >= 15) {
+        op = writeLength(op, matchCode - 15);
+    }
+    return op;
+}
+
+[[noreturn]] void corrupt() { throw std::runtime_error("Invalid compressed block"); }
+
+size_t readLength(const uint8_t*& ip, const uint8_t* end) {
+    size_t length = 0;
+    uint8_t byte;
+    do {
+        if (ip == end) {
+            corrupt();
+        }
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return length;
+}
+
+void appendVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+uint64_t readVarint(const char*& p, const char* end) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p == end) {
+            throw std::runtime_error("Truncated compressed frame");
+        }
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        value |= uint64_t(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Invalid varint in compressed frame");
+}
+
+uint32_t fnv1a(std::string_view data) {
+    uint32_t hash = 2166136261u;
+    for (char c : data) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+} // namespace
+
+CompressionDictionary::CompressionDictionary(std::string content)
+    : content(content.size() > kMaxSize ? content.substr(content.size() - kMaxSize) : std::move(content)),
+      id(fnv1a(this->content)), table(size_t(1) << kHashBits, 0) {
+    for (size_t i = 0; i + kMinMatch <= this->content.size(); ++i) {
+        table[hashSequence(read32(this->content.data() + i), kHashBits)] = static_cast<uint32_t>(i + 1);
+    }
+}
+
+CompressionDictionary CompressionDictionary::train(std::span<const std::string> samples, size_t maxSize) {
+    constexpr size_t kGram = 8;
+    maxSize = std::min(maxSize, kMaxSize);
+
+    // How many samples each substring occurs in
+    std::unordered_map<std::string_view, uint32_t> sampleCount;
+    std::unordered_set<std::string_view> seen;
+    for (const std::string& sample : samples) {
+        seen.clear();
+        for (size_t i = 0; i + kGram <= sample.size(); ++i) {
+            std::string_view gram(sample.data() + i, kGram);
+            if (seen.insert(gram).second) {
+                ++sampleCount[gram];
+            }
+        }
+    }
+
+    // A sample is worth the samples it shares substrings with that the dictionary does not cover yet
+    std::unordered_set<std::string_view> covered;
+    auto score = [&](const std::string& sample) {
+        uint64_t total = 0;
+        for (size_t i = 0; i + kGram <= sample.size(); ++i) {
+            std::string_view gram(sample.data() + i, kGram);
+            uint32_t count = sampleCount[gram];
+            if (count > 1 && !covered.contains(gram)) {
+                total += count;
+            }
+        }
+        return total;
+    };
+
+    // Lazy greedy selection: a score only drops as coverage grows, so a sample whose
+    // refreshed score still beats every stale score is the best one
+    std::priority_queue<std::pair<uint64_t, size_t>> candidates;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        candidates.emplace(score(samples[i]), i);
+    }
+    std::vector<size_t> chosen;
+    size_t size = 0;
+    while (!candidates.empty() && size < maxSize) {
+        size_t index = candidates.top().second;
+        candidates.pop();
+        uint64_t current = score(samples[index]);
+        if (current == 0 || samples[index].size() > maxSize - size) {
+            continue;
+        }
+        if (!candidates.empty() && current < candidates.top().first) {
+            candidates.emplace(current, index);
+            continue;
+        }
+        chosen.push_back(index);
+        size += samples[index].size();
+        for (size_t i = 0; i + kGram <= samples[index].size(); ++i) {
+            covered.insert(std::string_view(samples[index].data() + i, kGram));
+        }
+    }
+
+    // The best samples go last, nearest to the data
+    std::string content;
+    content.reserve(size);
+    for (auto it = chosen.rbegin(); it != chosen.rend(); ++it) {
+        content += samples[*it];
+    }
+    return CompressionDictionary(std::move(content));
+}
+
+size_t LzBlock::compress(std::string_view input, std::string& out, const CompressionDictionary* dictionary) {
+    size_t start = out.size();
+    out.resize(start + maxCompressedSize(input.size()));
+    char* op = out.data() + start;
+
+    const char* base = input.data();
+    const char* iend = base + input.size();
+    const char* anchor = base;
+
+    if (input.size() > kMatchFindLimit) {
+        const char* ip = base;
+        const char* mflimit = iend - kMatchFindLimit;
+        const char* matchlimit = iend - kLastLiterals;
+
+        // Sized to the input so small messages do not clear a large table
+        int bits = std::clamp(static_cast<int>(std::bit_width(input.size())) - 1, 6, kMaxInputHashBits);
+        thread_local std::vector<uint32_t> table;
+        table.assign(size_t(1) << bits, 0);
+
+        const char* dictionaryBase = dictionary != nullptr ? dictionary->content.data() : nullptr;
+        size_t dictionarySize = dictionary != nullptr ? dictionary->content.size() : 0;
+
+        while (ip <= mflimit) {
+            uint32_t sequence = read32(ip);
+            size_t position = static_cast<size_t>(ip - base);
+            size_t length = 0;
+            size_t offset = 0;
+
+            uint32_t& entry = table[hashSequence(sequence, bits)];
+            if (entry != 0) {
+                const char* candidate = base + (entry - 1);
+                if (position - (entry - 1) <= kMaxOffset && read32(candidate) == sequence) {
+                    length = kMinMatch + matchLength(ip + kMinMatch, candidate + kMinMatch, matchlimit);
+                    offset = position - (entry - 1);
+                }
+            }
+            entry = static_cast<uint32_t>(position + 1);
+
+            if (dictionary != nullptr) {
+                uint32_t dictionaryEntry = dictionary->table[hashSequence(sequence, CompressionDictionary::kHashBits)];
+                if (dictionaryEntry != 0) {
+                    size_t candidatePosition = dictionaryEntry - 1;
+                    size_t candidateOffset = dictionarySize - candidatePosition + position;
+                    const char* candidate = dictionaryBase + candidatePosition;
+                    if (candidateOffset <= kMaxOffset && read32(candidate) == sequence) {
+                        // The match may run off the end of the dictionary into the input
+                        size_t inDictionary = dictionarySize - candidatePosition;
+                        const char* limit = std::min(matchlimit, ip + inDictionary);
+                        size_t candidateLength = matchLength(ip, candidate, limit);
+                        if (candidateLength == inDictionary) {
+                            candidateLength += matchLength(ip + candidateLength, base, matchlimit);
+                        }
+                        if (candidateLength > length) {
+                            length = candidateLength;
+                            offset = candidateOffset;
+                        }
+                    }
+                }
+            }
+
+            if (length < kMinMatch) {
+                ip += 1 + (static_cast<size_t>(ip - anchor) >> 6); // Skip faster through incompressible data
+                continue;
+            }
+            op = writeSequence(op, anchor, static_cast<size_t>(ip - anchor), offset, length);
+            ip += length;
+            anchor = ip;
+            if (ip <= mflimit) {
+                table[hashSequence(read32(ip - 2), bits)] = static_cast<uint32_t>(ip - 2 - base + 1);
+            }
+        }
+    }
+    op = writeLiterals(op, anchor, static_cast<size_t>(iend - anchor), 0);
+    out.resize(static_cast<size_t>(op - out.data()));
+    return out.size() - start;
+}
+
+void LzBlock::decompress(std::span<const char> block, size_t rawSize, std::string& out,
+                         const CompressionDictionary* dictionary) {
+    out.resize(rawSize);
+    char* const ostart = out.data();
+    char* const oend = ostart + rawSize;
+    char* op = ostart;
+    const uint8_t* ip = reinterpret_cast<const uint8_t*>(block.data());
+    const uint8_t* const iend = ip + block.size();
+
+    while (true) {
+        if (ip == iend) {
+            corrupt();
+        }
+        uint8_t token = *ip++;
+        size_t literalLength = token >> 4;
+        if (literalLength == 15) {
+            literalLength += readLength(ip, iend);
+        }
+        if (literalLength > static_cast<size_t>(iend - ip) || literalLength > static_cast<size_t>(oend - op)) {
+            corrupt();
+        }
+        std::memcpy(op, ip, literalLength);
+        op += literalLength;
+        ip += literalLength;
+        if (ip == iend) {
+            break; // The last sequence has literals only
+        }
+
+        if (iend - ip < 2) {
+            corrupt();
+        }
+        size_t offset = ip[0] | (size_t(ip[1]) << 8);
+        ip += 2;
+        size_t length = (token & 15) + kMinMatch;
+        if ((token & 15) == 15) {
+            length += readLength(ip, iend);
+        }
+        if (offset == 0 || length > static_cast<size_t>(oend - op)) {
+            corrupt();
+        }
+
+        size_t produced = static_cast<size_t>(op - ostart);
+        if (offset > produced) {
+            // Starts in the dictionary, and may continue into the output
+            size_t back = offset - produced;
+            if (dictionary == nullptr || back > dictionary->content.size()) {
+                corrupt();
+            }
+            size_t count = std::min(back, length);
+            std::memcpy(op, dictionary->content.data() + dictionary->content.size() - back, count);
+            op += count;
+            length -= count;
+        }
+        const char* match = op - offset;
+        if (offset >= length) {
+            std::memcpy(op, match, length);
+            op += length;
+        } else {
+            for (size_t i = 0; i < length; ++i) {
+                *op++ = *match++; // Overlapping copy repeats the last offset bytes
+            }
+        }
+    }
+    if (op != oend) {
+        corrupt();
+    }
+}
+
+FrameCompressor::FrameCompressor(std::shared_ptr<const CompressionDictionary> dictionary)
+    : FrameCompressor(std::move(dictionary), Options()) {}
+
+FrameCompressor::FrameCompressor(std::shared_ptr<const CompressionDictionary> dictionary, const Options& options)
+    : dictionary(std::move(dictionary)), options(options) {}
+
+void FrameCompressor::pack(std::string_view message, std::string& body) const {
+    body.clear();
+    packContent(message, false, body);
+}
+
+void FrameCompressor::packBatch(std::span<const std::string> messages, std::string& body) const {
+    content.clear();
+    for (const std::string& message : messages) {
+        appendVarint(content, message.size());
+        content += message;
+    }
+    body.clear();
+    packContent(content, true, body);
+}
+
+void FrameCompressor::packContent(std::string_view raw, bool isBatch, std::string& body) const {
+    uint8_t flags = isBatch ? kBatch : 0;
+    body += static_cast<char>(flags);
+    ++stats.framesPacked;
+    stats.contentBytes += raw.size();
+    if (raw.size() >= options.minCompressSize) {
+        if (dictionary != nullptr) {
+            flags |= kDictionary;
+            uint32_t id = dictionary->getId();
+            for (int shift = 0; shift < 32; shift += 8) {
+                body += static_cast<char>(id >> shift);
+            }
+        }
+        appendVarint(body, raw.size());
+        LzBlock::compress(raw, body, dictionary.get());
+        if (body.size() < raw.size() + 1) {
+            body[0] = static_cast<char>(flags | kCompressed);
+            ++stats.framesCompressed;
+            stats.bodyBytes += body.size();
+            return;
+        }
+        body.resize(1); // Compression did not pay off
+    }
+    body.append(raw);
+    stats.bodyBytes += body.size();
+}
+
+void FrameCompressor::unpack(std::string_view body, std::string& message) {
+    if (body.empty()) {
+        throw std::runtime_error("Empty compressed frame");
+    }
+    uint8_t flags = static_cast<uint8_t>(body[0]);
+    if ((flags & ~(kCompressed | kBatch | kDictionary)) != 0) {
+        throw std::runtime_error("Unknown compressed frame flags");
+    }
+    const char* p = body.data() + 1;
+    const char* end = body.data() + body.size();
+
+    const CompressionDictionary* frameDictionary = nullptr;
+    if ((flags & kDictionary) != 0) {
+        if (end - p < 4) {
+            throw std::runtime_error("Truncated compressed frame");
+        }
+        uint32_t id = 0;
+        for (int i = 0; i < 4; ++i) {
+            id |= uint32_t(static_cast<uint8_t>(p[i])) << (8 * i);
+        }
+        p += 4;
+        if (dictionary == nullptr || dictionary->getId() != id) {
+            throw std::runtime_error("Frame compressed with an unknown dictionary");
+        }
+        frameDictionary = dictionary.get();
+    }
+
+    std::string& raw = (flags & kBatch) != 0 ? batch : message;
+    if ((flags & kCompressed) != 0) {
+        uint64_t rawSize = readVarint(p, end);
+        if (rawSize > options.maxContentSize) {
+            throw FrameTooLargeError(rawSize, options.maxContentSize);
+        }
+        LzBlock::decompress(std::span<const char>(p, static_cast<size_t>(end - p)), static_cast<size_t>(rawSize), raw,
+                            frameDictionary);
+    } else {
+        raw.assign(p, end);
+    }
+
+    if ((flags & kBatch) != 0) {
+        batchOffset = 0;
+        if (!takePending(message)) {
+            throw std::runtime_error("Empty message batch");
+        }
+    }
+}
+
+bool FrameCompressor::takePending(std::string& message) {
+    if (batchOffset >= batch.size()) {
+        return false;
+    }
+    const char* p = batch.data() + batchOffset;
+    const char* end = batch.data() + batch.size();
+    uint64_t length = readVarint(p, end);
+    if (length > static_cast<uint64_t>(end - p)) {
+        batchOffset = batch.size();
+        throw std::runtime_error("Truncated message in batch");
+    }
+    message.assign(p, static_cast<size_t>(length));
+    batchOffset = static_cast<size_t>(p - batch.data()) + static_cast<size_t>(length);
+    return true;
+}
+
+void FrameCompressor::reset() {
+    batch.clear();
+    batchOffset = 0;
+}
@@ -0,0 +1,231 @@
+/**
+ * @file Compression.hpp
+ * @brief Per-frame LZ compression for Comms: LzBlock, CompressionDictionary, and
+ * CompressingCodec, a framing codec that compresses and batches messages inside another
+ * codec's frames.
+ * @details LzBlock writes the LZ4 block format (a byte-oriented LZ77 with 16-bit offsets
+ * and no entropy stage), so compression costs a few hash lookups per input byte and
+ * decompression is little more than memcpy. Small messages share little with themselves;
+ * most of their redundancy is with earlier messages. Two things recover it:
+ *  - a CompressionDictionary trained on typical traffic, which matches may reference as if
+ *    it preceded every frame;
+ *  - batching: sendMessages() on a BatchingCodec packs many messages into one frame.
+ *
+ * Each frame says how it was packed, so the choice is made per frame and per connection:
+ * a receiving CompressingCodec accepts compressed and stored frames, batched or single, and
+ * rejects a frame compressed with a dictionary it does not hold (checked by id). A rejected
+ * frame is skipped: BasicComms throws for it once and the next receive continues after it. Both ends
+ * of a connection must use CompressingCodec; it is not wire compatible with its inner codec.
+ *
+ * ## Example Usage
+ *
+ * ```cpp
+ * auto dictionary = std::make_shared<const CompressionDictionary>(CompressionDictionary::train(recorded));
+ * BasicComms<CompressingCodec<>> comms(SocketBackend::BSD, CompressingCodec<>(dictionary));
+ * comms.connectToServer("10.0.0.2", 10110);
+ * comms.sendMessages(sentences); // One compressed frame
+ * ```
+ */
+
+#ifndef COMPRESSION_HPP
+#define COMPRESSION_HPP
+
+#include "FramingCodecs.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/// @brief Bytes that compressed data may refer back to, shared by both ends of a connection.
+class CompressionDictionary {
+public:
+    /// @brief Longest usable dictionary: LZ4 offsets are 16-bit.
+    static constexpr size_t kMaxSize = 65535;
+
+    /// @brief Uses content as the dictionary; only its last kMaxSize bytes are kept.
+    explicit CompressionDictionary(std::string content);
+
+    /**
+     * @brief Builds a dictionary from sample messages (a few thousand is plenty).
+     * @details Greedily picks the samples that share the most 8-byte substrings with the other
+     * samples, so the dictionary holds one of each recurring message shape rather than many
+     * copies of the most common one.
+     */
+    static CompressionDictionary train(std::span<const std::string> samples, size_t maxSize = 16 * 1024);
+
+    const std::string& getContent() const { return content; }
+
+    /// @brief Hash of the content, carried in frames compressed with this dictionary.
+    uint32_t getId() const { return id; }
+
+private:
+    friend struct LzBlock;
+    static constexpr int kHashBits = 14;
+
+    std::string content;
+    uint32_t id;
+    std::vector<uint32_t> table; // Position + 1 of the last 4-byte sequence with each hash
+};
+
+/// @brief LZ4 block format compressor and decompressor.
+struct LzBlock {
+    /// @brief Largest block compress() can produce for inputSize bytes.
+    static size_t maxCompressedSize(size_t inputSize) { return inputSize + inputSize / 255 + 16; }
+
+    /// @brief Appends the compressed block for input to out; returns its size.
+    static size_t compress(std::string_view input, std::string& out,
+                           const CompressionDictionary* dictionary = nullptr);
+
+    /// @brief Replaces out with the rawSize bytes block decompresses to.
+    /// Throws std::runtime_error if the block is corrupt or does not decompress to rawSize bytes.
+    static void decompress(std::span<const char> block, size_t rawSize, std::string& out,
+                           const CompressionDictionary* dictionary = nullptr);
+};
+
+/**
+ * @brief Packs messages into compressed frame bodies and back; the codec-independent half of
+ * CompressingCodec.
+ * @details A body is a flags byte, the dictionary id (if compressed with one), the varint
+ * decompressed size (if compressed), then the content: one message, or for a batch a varint
+ * length before each message. Content is stored uncompressed when compression does not
+ * shrink it.
+ */
+class FrameCompressor {
+public:
+    struct Options {
+        size_t minCompressSize = 32;    ///< Content shorter than this is sent stored
+        size_t maxBatchBytes = 64 * 1024; ///< encodeBatch() starts a new frame beyond this
+        size_t maxContentSize = LengthPrefixCodec::kDefaultMaxFrameSize; ///< Receive limit, see FrameTooLargeError
+    };
+
+    /// @brief Compression and decompression counters.
+    struct Stats {
+        uint64_t framesPacked = 0;
+        uint64_t framesCompressed = 0; ///< Frames where compression paid off
+        uint64_t contentBytes = 0;     ///< Bytes before compression
+        uint64_t bodyBytes = 0;        ///< Bytes of packed bodies, excluding the inner framing
+    };
+
+    explicit FrameCompressor(std::shared_ptr<const CompressionDictionary> dictionary = nullptr);
+    FrameCompressor(std::shared_ptr<const CompressionDictionary> dictionary, const Options& options);
+
+    /// @brief Replaces body with one packed message.
+    void pack(std::string_view message, std::string& body) const;
+    /// @brief Replaces body with the messages packed as one batch.
+    void packBatch(std::span<const std::string> messages, std::string& body) const;
+
+    /// @brief Unpacks a body into its first message and keeps the rest of a batch for takePending().
+    /// Throws std::runtime_error for a corrupt body or an unknown dictionary.
+    void unpack(std::string_view body, std::string& message);
+    bool takePending(std::string& message);
+    void reset();
+
+    const Options& getOptions() const { return options; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    std::shared_ptr<const CompressionDictionary> dictionary;
+    Options options;
+    mutable Stats stats;
+    mutable std::string content; // Scratch: a batch before compression
+    std::string batch;           // Received batch content; messages from batchOffset on are pending
+    size_t batchOffset = 0;
+
+    void packContent(std::string_view raw, bool isBatch, std::string& body) const;
+};
+
+/**
+ * @brief Compresses (and with sendMessages(), batches) messages inside Inner's frames.
+ * @details Inner must carry arbitrary bytes: LengthPrefixCodec, VarintLengthCodec, SlipCodec
+ * or CobsCodec. Copies share the dictionary, so one codec can serve as a reactor prototype.
+ */
+template <FramingCodec Inner = LengthPrefixCodec>
+class CompressingCodec {
+public:
+    static constexpr int kIdleTimeoutMs = Inner::kIdleTimeoutMs;
+
+    explicit CompressingCodec(std::shared_ptr<const CompressionDictionary> dictionary = nullptr,
+                              FrameCompressor::Options options = FrameCompressor::Options(), Inner inner = Inner())
+        : compressor(std::move(dictionary), options), inner(std::move(inner)) {}
+
+    void encode(std::string_view payload, std::string& out) const {
+        compressor.pack(payload, body);
+        appendFrame(out);
+    }
+
+    /// @brief Packs messages into as few frames as Options::maxBatchBytes allows.
+    void encodeBatch(std::span<const std::string> messages, std::string& out) const {
+        size_t first = 0;
+        while (first < messages.size()) {
+            size_t last = first;
+            size_t bytes = 0;
+            do {
+                bytes += messages[last].size();
+                ++last;
+            } while (last < messages.size() && bytes + messages[last].size() <= compressor.getOptions().maxBatchBytes);
+            compressor.packBatch(messages.subspan(first, last - first), body);
+            appendFrame(out);
+            first = last;
+        }
+    }
+
+    /// @brief Throws std::runtime_error (or FrameTooLargeError for oversized content) for a
+    /// frame that does not unpack; takeRejectedFrame() then gives its length so it can be skipped.
+    size_t decode(std::span<const char> input, std::string& message) {
+        size_t frameBytes = inner.decode(input, body);
+        if (frameBytes != 0) {
+            try {
+                compressor.unpack(body, message);
+            } catch (const std::runtime_error&) {
+                rejectedFrameBytes = frameBytes;
+                throw;
+            }
+        }
+        return frameBytes;
+    }
+
+    /// @brief Length of the frame the last decode() rejected, or 0; clears it.
+    size_t takeRejectedFrame() { return std::exchange(rejectedFrameBytes, 0); }
+
+    bool takePending(std::string& message) { return compressor.takePending(message); }
+
+    std::string finish(std::span<const char> input) {
+        body = inner.finish(input);
+        std::string message;
+        compressor.unpack(body, message);
+        return message;
+    }
+
+    void reset() {
+        inner.reset();
+        compressor.reset();
+        rejectedFrameBytes = 0;
+    }
+
+    const FrameCompressor& getCompressor() const { return compressor; }
+
+private:
+    FrameCompressor compressor;
+    Inner inner;
+    mutable std::string body; // Scratch: the packed body being framed or unframed
+    size_t rejectedFrameBytes = 0;
+
+    void appendFrame(std::string& out) const {
+        if constexpr (GatherCodec<Inner>) {
+            std::array<char, Inner::kMaxHeader> header;
+            std::array<char, Inner::kMaxTrailer> trailer;
+            out.append(header.data(), inner.header(body, header.data()));
+            out.append(body);
+            out.append(trailer.data(), inner.trailer(body, trailer.data()));
+        } else {
+            inner.encode(body, out);
+        }
+    }
+};
+
+#endif // COMPRESSION_HPP
@@ -0,0 +1,170 @@
+#include "ConnectionManager.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr int kMaxEvents = 64;
+}
+
+ConnectionManager::ConnectionManager(const Options &options)
+    : _options(options),
+      _epollFd(epoll_create1(EPOLL_CLOEXEC)),
+      _connectedCount(0),
+      _random(options.seed != 0 ? options.seed : std::random_device()())
+{
+    if (_epollFd == -1)
+    {
+        std::cerr << "epoll_create1 error: " << strerror(errno) << std::endl;
+    }
+}
+
+ConnectionManager::~ConnectionManager()
+{
+    // Connectors deregister their sockets, so they go before the epoll instance
+    _feeds.clear();
+    if (_epollFd != -1)
+    {
+        ::close(_epollFd);
+    }
+}
+
+ConnectionManager::FeedId ConnectionManager::add(const std::string &host, const std::string &port)
+{
+    return add(std::vector<Endpoint>{{host, port}});
+}
+
+ConnectionManager::FeedId ConnectionManager::add(const std::vector<Endpoint> &endpoints)
+{
+    FeedId id = _feeds.size();
+    Feed feed;
+    feed.endpoints = endpoints;
+    feed.comms = std::make_unique<NetworkComms>();
+    feed.connector = std::make_unique<TcpConnector>(_options.connect);
+    feed.connector->setEpoll(_epollFd, id);
+    feed.state = FeedState::Waiting;
+    feed.nextAttempt = Clock::now();
+    feed.failures = 0;
+    _feeds.push_back(std::move(feed));
+    return id;
+}
+
+void ConnectionManager::startConnect(FeedId id)
+{
+    Feed &feed = _feeds[id];
+    ++_stats.connectAttempts;
+    feed.state = FeedState::Connecting;
+    // Resolve on every connect so DNS changes are picked up by reconnects
+    std::vector<TcpConnector::Address> addresses;
+    for (const Endpoint &endpoint : feed.endpoints)
+    {
+        std::vector<TcpConnector::Address> resolved = TcpConnector::resolve(endpoint.host, endpoint.port);
+        addresses.insert(addresses.end(), resolved.begin(), resolved.end());
+    }
+    feed.connector->start(std::move(addresses));
+    if (feed.connector->getState() != TcpConnector::State::Connecting)
+    {
+        completeConnect(id); // Connected synchronously, or every address failed at once
+    }
+}
+
+void ConnectionManager::completeConnect(FeedId id)
+{
+    Feed &feed = _feeds[id];
+    TcpConnector::State state = feed.connector->getState();
+    if (state == TcpConnector::State::Connecting)
+    {
+        return;
+    }
+
+    if (state == TcpConnector::State::Connected && feed.comms->attach(feed.connector->takeSocket()))
+    {
+        feed.state = FeedState::Connected;
+        feed.failures = 0;
+        ++_stats.connects;
+        ++_connectedCount;
+        return;
+    }
+
+    ++feed.failures;
+    ++_stats.failures;
+    scheduleRetry(feed, Clock::now());
+}
+
+void ConnectionManager::scheduleRetry(Feed &feed, Clock::time_point now)
+{
+    // Exponential backoff with "equal jitter": half fixed, half random, so retries
+    // neither hammer a dead host nor line up across feeds that failed together
+    unsigned int exponent = feed.failures > 0 ? feed.failures - 1 : 0;
+    double backoff = std::min<double>(_options.maxBackoffMs,
+                                      _options.initialBackoffMs * std::pow(_options.backoffMultiplier, exponent));
+    std::uniform_real_distribution<double> jitter(backoff / 2, backoff);
+    feed.state = FeedState::Waiting;
+    feed.nextAttempt = now + std::chrono::microseconds(static_cast<int64_t>(jitter(_random) * 1000));
+}
+
+void ConnectionManager::poll(unsigned int timeoutMs)
+{
+    Clock::time_point now = Clock::now();
+    long long timeout = timeoutMs;
+
+    for (FeedId id = 0; id < _feeds.size(); ++id)
+    {
+        Feed &feed = _feeds[id];
+        if (feed.state == FeedState::Connected && !feed.comms->isOpen())
+        {
+            --_connectedCount;
+            ++_stats.disconnects;
+            feed.comms->close();
+            feed.failures = 0;
+            scheduleRetry(feed, now);
+        }
+        if (feed.state == FeedState::Waiting && now >= feed.nextAttempt)
+        {
+            startConnect(id);
+        }
+
+        if (feed.state == FeedState::Waiting)
+        {
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(feed.nextAttempt - now).count() + 1;
+            timeout = std::min<long long>(timeout, ms);
+        }
+        else if (feed.state == FeedState::Connecting)
+        {
+            timeout = std::min<long long>(timeout, feed.connector->getTimeoutMs());
+        }
+    }
+
+    struct epoll_event events[kMaxEvents];
+    int count = epoll_wait(_epollFd, events, kMaxEvents, static_cast<int>(std::max<long long>(0, timeout)));
+    if (count == -1 && errno != EINTR)
+    {
+        std::cerr << "epoll_wait error: " << strerror(errno) << std::endl;
+        return;
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        FeedId id = static_cast<FeedId>(events[i].data.u64);
+        if (_feeds[id].state == FeedState::Connecting)
+        {
+            _feeds[id].connector->advance();
+            completeConnect(id);
+        }
+    }
+
+    // Timer work: attempt deadlines and staggered starts of the next address
+    now = Clock::now();
+    for (FeedId id = 0; id < _feeds.size(); ++id)
+    {
+        Feed &feed = _feeds[id];
+        if (feed.state == FeedState::Connecting && feed.connector->getNextDeadline() <= now)
+        {
+            feed.connector->advance();
+            completeConnect(id);
+        }
+    }
+}
@@ -0,0 +1,152 @@
+/**
+ * @file ConnectionManager.hpp
+ * @brief Brings many TCP feeds up concurrently and keeps them connected (Linux only).
+ * @details Each feed owns a NetworkComms. Connects run in parallel through TcpConnector,
+ * all driven from one epoll instance, so restarting hundreds of feeds takes about as
+ * long as the slowest single connect rather than their sum. A feed that fails to connect,
+ * or whose NetworkComms reports closed, is retried after an exponential backoff with
+ * random jitter so that feeds dropped together do not reconnect in lockstep.
+ *
+ * ## Example Usage
+ *
+ * ```cpp
+ * ConnectionManager manager;
+ * std::vector<ConnectionManager::FeedId> feeds;
+ * for (const auto& [host, port] : endpoints) {
+ *     feeds.push_back(manager.add(host, port));
+ * }
+ * while (running) {
+ *     manager.poll(10);
+ *     for (auto feed : feeds) {
+ *         if (manager.isConnected(feed)) {
+ *             // read from manager.getComms(feed), e.g. through an NMEAReader
+ *         }
+ *     }
+ * }
+ * ```
+ */
+
+#ifndef CONNECTION_MANAGER_HPP
+#define CONNECTION_MANAGER_HPP
+
+#include "NetworkComms.hpp"
+#include "TcpConnector.hpp"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+class ConnectionManager {
+public:
+    using FeedId = size_t;
+
+    /// @brief One address a feed can be reached at.
+    struct Endpoint {
+        std::string host;
+        std::string port;
+    };
+
+    struct Options {
+        NetworkComms::ConnectOptions connect;  ///< Per-feed address racing
+        unsigned int initialBackoffMs = 100;   ///< Delay before the first retry
+        unsigned int maxBackoffMs = 30000;     ///< Upper bound on the retry delay
+        double backoffMultiplier = 2.0;        ///< Growth per consecutive failure
+        uint32_t seed = 0;                     ///< Jitter seed; 0 seeds from std::random_device
+    };
+
+    struct Stats {
+        uint64_t connectAttempts = 0; ///< Connects started (each may race several addresses)
+        uint64_t connects = 0;        ///< Connects that succeeded
+        uint64_t failures = 0;        ///< Connects that failed or timed out
+        uint64_t disconnects = 0;     ///< Connected feeds found closed
+    };
+
+    enum class FeedState {
+        Waiting,    ///< Backing off until the next attempt
+        Connecting, ///< Connect in flight
+        Connected   ///< getComms() is open
+    };
+
+    ConnectionManager() : ConnectionManager(Options()) {}
+    explicit ConnectionManager(const Options& options);
+
+    /**
+     * @brief Destructor. Cancels connects in flight and closes every feed.
+     */
+    ~ConnectionManager();
+
+    ConnectionManager(const ConnectionManager&) = delete;
+    ConnectionManager& operator=(const ConnectionManager&) = delete;
+
+    /**
+     * @brief Adds a feed; its first connect starts on the next poll().
+     * @param host The hostname or IP address to connect to.
+     * @param port The port number to connect to.
+     * @return Identifier used by the other calls.
+     */
+    FeedId add(const std::string& host, const std::string& port);
+
+    /**
+     * @brief Adds a feed reachable at several endpoints (e.g. primary and backup mux).
+     * Every connect races the addresses of all endpoints, in the order given.
+     * @param endpoints Endpoints to try; must not be empty.
+     * @return Identifier used by the other calls.
+     */
+    FeedId add(const std::vector<Endpoint>& endpoints);
+
+    /**
+     * @brief Starts due connects, completes finished ones, and schedules reconnects for
+     * feeds whose NetworkComms has closed. Waits up to timeoutMs for connect progress.
+     * @param timeoutMs Maximum time to wait in milliseconds; 0 does not block.
+     */
+    void poll(unsigned int timeoutMs);
+
+    /**
+     * @brief Returns the feed's NetworkComms. Read from it only while isConnected(id);
+     * a peer close it detects is picked up by the next poll() and retried.
+     */
+    NetworkComms& getComms(FeedId id) { return *_feeds[id].comms; }
+
+    bool isConnected(FeedId id) const { return _feeds[id].state == FeedState::Connected; }
+    FeedState getState(FeedId id) const { return _feeds[id].state; }
+
+    /// @brief Consecutive failed connects of the feed since it was last connected.
+    unsigned int getFailureCount(FeedId id) const { return _feeds[id].failures; }
+
+    size_t getFeedCount() const { return _feeds.size(); }
+    size_t getConnectedCount() const { return _connectedCount; }
+
+    /// @brief Returns the epoll descriptor that connect attempts are registered with.
+    int getPollDescriptor() const { return _epollFd; }
+
+    /// @brief Returns counters since construction.
+    const Stats& getStats() const { return _stats; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Feed {
+        std::vector<Endpoint> endpoints;
+        std::unique_ptr<NetworkComms> comms;
+        std::unique_ptr<TcpConnector> connector;
+        FeedState state;
+        Clock::time_point nextAttempt;
+        unsigned int failures;
+    };
+
+    Options _options;
+    Stats _stats;
+    int _epollFd;
+    size_t _connectedCount;
+    std::vector<Feed> _feeds;
+    std::mt19937 _random;
+
+    void startConnect(FeedId id);
+    // Hands a finished connect to the feed's NetworkComms, or schedules a retry
+    void completeConnect(FeedId id);
+    void scheduleRetry(Feed& feed, Clock::time_point now);
+};
+
+#endif // CONNECTION_MANAGER_HPP
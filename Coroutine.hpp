@@ -0,0 +1,221 @@
+/**
+ * @file Coroutine.hpp
+ * @brief Minimal C++20 coroutine types used by the asynchronous comms stack.
+ * @details Provides a lazily started `Task<T>` that resumes its awaiter by symmetric
+ * transfer, and an `AsyncGenerator<T>` whose consumer pulls values with
+ * `co_await generator.next()`.
+ *
+ * ## Example Usage
+ *
+ * ```cpp
+ * AsyncGenerator<int> counter() { for (int i = 0; i < 3; ++i) co_yield i; }
+ *
+ * Task<void> consume() {
+ *     auto gen = counter();
+ *     while (auto value = co_await gen.next()) {
+ *         std::cout << *value << std::endl;
+ *     }
+ * }
+ * ```
+ */
+
+#ifndef COROUTINE_HPP
+#define COROUTINE_HPP
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+/// @brief Resumes whoever awaited the finished coroutine, or returns to the caller of resume().
+struct ContinuationAwaiter {
+    std::coroutine_handle<> continuation;
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<>) const noexcept {
+        return continuation ? continuation : std::noop_coroutine();
+    }
+    void await_resume() const noexcept {}
+};
+
+/// @brief State shared by all Task promises.
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    ContinuationAwaiter final_suspend() const noexcept { return {continuation}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+    void return_value(T result) { value.emplace(std::move(result)); }
+
+    T result() {
+        if (error) std::rethrow_exception(error);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object() noexcept;
+    void return_void() const noexcept {}
+
+    void result() const {
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+/// @brief Fire-and-forget coroutine that destroys itself on completion.
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+} // namespace detail
+
+/**
+ * @brief Lazily started coroutine producing a single value of type T.
+ * The body runs when the task is first awaited; the awaiter is resumed directly
+ * (no executor hop) when the body completes.
+ */
+template <typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {}
+    Task(Task&& other) noexcept : _handle(std::exchange(other._handle, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (_handle) _handle.destroy();
+            _handle = std::exchange(other._handle, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (_handle) _handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return !_handle || _handle.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        _handle.promise().continuation = awaiting;
+        return _handle;
+    }
+    T await_resume() { return _handle.promise().result(); }
+
+private:
+    std::coroutine_handle<promise_type> _handle;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+} // namespace detail
+
+/**
+ * @brief Starts a task without awaiting it. The task frame is owned by the
+ * coroutine machinery and released when the task finishes.
+ * @param task The task to run. It executes synchronously up to its first suspension.
+ */
+inline void startDetached(Task<void> task) {
+    [](Task<void> owned) -> detail::DetachedTask { co_await owned; }(std::move(task));
+}
+
+/**
+ * @brief Asynchronous sequence of values. The producer may `co_await` between
+ * `co_yield`s; the consumer pulls the next value with `co_await next()`, which
+ * yields std::nullopt once the producer has finished.
+ */
+template <typename T>
+class AsyncGenerator {
+public:
+    struct promise_type {
+        std::optional<T> current;
+        std::coroutine_handle<> consumer;
+        std::exception_ptr error;
+
+        AsyncGenerator get_return_object() noexcept {
+            return AsyncGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        detail::ContinuationAwaiter final_suspend() const noexcept { return {consumer}; }
+        detail::ContinuationAwaiter yield_value(T value) {
+            current.emplace(std::move(value));
+            return {consumer};
+        }
+        void return_void() const noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+    /// @brief Awaitable returned by next().
+    class NextAwaiter {
+    public:
+        explicit NextAwaiter(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {}
+
+        bool await_ready() const noexcept { return !_handle || _handle.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            _handle.promise().current.reset();
+            _handle.promise().consumer = awaiting;
+            return _handle;
+        }
+        std::optional<T> await_resume() {
+            if (!_handle) return std::nullopt;
+            promise_type& promise = _handle.promise();
+            if (promise.error) std::rethrow_exception(std::exchange(promise.error, {}));
+            if (_handle.done()) return std::nullopt;
+            return std::move(promise.current);
+        }
+
+    private:
+        std::coroutine_handle<promise_type> _handle;
+    };
+
+    explicit AsyncGenerator(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {}
+    AsyncGenerator(AsyncGenerator&& other) noexcept : _handle(std::exchange(other._handle, {})) {}
+    AsyncGenerator& operator=(AsyncGenerator&& other) noexcept {
+        if (this != &other) {
+            if (_handle) _handle.destroy();
+            _handle = std::exchange(other._handle, {});
+        }
+        return *this;
+    }
+    AsyncGenerator(const AsyncGenerator&) = delete;
+    AsyncGenerator& operator=(const AsyncGenerator&) = delete;
+    ~AsyncGenerator() {
+        if (_handle) _handle.destroy();
+    }
+
+    /// @brief Resumes the producer until it yields the next value or finishes.
+    NextAwaiter next() noexcept { return NextAwaiter(_handle); }
+
+private:
+    std::coroutine_handle<promise_type> _handle;
+};
+
+#endif // COROUTINE_HPP
@@ -0,0 +1,208 @@
+/**
+ * @file EventLoop.cpp
+ * @brief Implementation of the epoll-backed coroutine executor.
+ */
+
+#include "EventLoop.hpp"
+#include <stdexcept>
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace {
+    constexpr int kMaxEventsPerWait = 256;
+}
+
+EventLoop::EventLoop() : _epollFd(-1), _wakeFd(-1), _stopRequested(false), _sleepers(0) {
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollFd == -1) {
+        throw std::runtime_error(std::string("epoll_create1 failed: ") + strerror(errno));
+    }
+
+    _wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wakeFd == -1) {
+        ::close(_epollFd);
+        throw std::runtime_error(std::string("eventfd failed: ") + strerror(errno));
+    }
+
+    epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.fd = _wakeFd;
+    epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeFd, &ev);
+}
+
+EventLoop::~EventLoop() {
+    ::close(_wakeFd);
+    ::close(_epollFd);
+}
+
+bool EventLoop::ReadableAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    _waiter.handle = handle;
+    return _loop.arm(_waiter, _timeoutMs);
+}
+
+void EventLoop::SleepAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    _waiter.handle = handle;
+    _loop.addDeadline(_waiter, _timeoutMs == 0 ? 1 : _timeoutMs);
+    ++_loop._sleepers;
+}
+
+bool EventLoop::arm(Waiter& waiter, unsigned int timeoutMs) {
+    // One-shot registration: each wait re-arms with EPOLL_CTL_MOD, so a source that is
+    // not being awaited never produces wake-ups.
+    epoll_event ev {};
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    ev.data.fd = waiter.fd;
+
+    bool known = _registered.count(waiter.fd) != 0;
+    int rc = epoll_ctl(_epollFd, known ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, waiter.fd, &ev);
+    if (rc == -1 && known && errno == ENOENT) {
+        // Descriptor was closed and reused without forget(); register it again.
+        rc = epoll_ctl(_epollFd, EPOLL_CTL_ADD, waiter.fd, &ev);
+    }
+    if (rc == -1) {
+        std::cerr << "epoll_ctl error on fd " << waiter.fd << ": " << strerror(errno) << std::endl;
+        waiter.ready = false;
+        return false; // Resume immediately, reporting "not readable"
+    }
+    _registered.insert(waiter.fd);
+    _waiters[waiter.fd] = &waiter;
+
+    if (timeoutMs > 0) {
+        addDeadline(waiter, timeoutMs);
+    }
+    return true;
+}
+
+void EventLoop::addDeadline(Waiter& waiter, unsigned int timeoutMs) {
+    waiter.deadline = _deadlines.emplace(Clock::now() + std::chrono::milliseconds(timeoutMs), &waiter);
+    waiter.hasDeadline = true;
+}
+
+void EventLoop::forget(int fd) {
+    if (_registered.erase(fd) != 0) {
+        epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+    auto it = _waiters.find(fd);
+    if (it != _waiters.end()) {
+        // Wake the waiter so it observes the closed source rather than hanging forever.
+        Waiter* waiter = it->second;
+        _waiters.erase(it);
+        if (waiter->hasDeadline) {
+            _deadlines.erase(waiter->deadline);
+            waiter->hasDeadline = false;
+        }
+        waiter->ready = false;
+        _runnable.push_back(waiter);
+    }
+}
+
+void EventLoop::cancel(int fd) {
+    if (_registered.erase(fd) != 0) {
+        epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+    auto it = _waiters.find(fd);
+    if (it != _waiters.end()) {
+        Waiter* waiter = it->second;
+        _waiters.erase(it);
+        if (waiter->hasDeadline) {
+            _deadlines.erase(waiter->deadline);
+            waiter->hasDeadline = false;
+        }
+    }
+    // A waiter woken earlier in this iteration is queued but not yet resumed.
+    std::erase_if(_runnable, [fd](const Waiter* queued) { return queued->fd == fd; });
+}
+
+int EventLoop::nextTimeoutMs() const {
+    if (!_runnable.empty()) return 0;
+    if (_deadlines.empty()) return -1;
+
+    auto remaining = _deadlines.begin()->first - Clock::now();
+    if (remaining <= Clock::duration::zero()) return 0;
+    // Round up so we never wake just before the deadline and spin.
+    auto ms = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+    return static_cast<int>(ms);
+}
+
+void EventLoop::expireDeadlines() {
+    auto now = Clock::now();
+    while (!_deadlines.empty() && _deadlines.begin()->first <= now) {
+        Waiter* waiter = _deadlines.begin()->second;
+        _deadlines.erase(_deadlines.begin());
+        waiter->hasDeadline = false;
+        waiter->ready = false;
+        if (waiter->fd >= 0) {
+            _waiters.erase(waiter->fd);
+        } else {
+            --_sleepers;
+        }
+        _runnable.push_back(waiter);
+    }
+}
+
+void EventLoop::run() {
+    try {
+        runUntilIdleOrStopped();
+    } catch (...) {
+        _stopRequested = false;
+        throw;
+    }
+    // Cleared on the way out, not on entry, so a stop() issued just before run() is honoured
+    _stopRequested = false;
+}
+
+void EventLoop::runUntilIdleOrStopped() {
+    epoll_event events[kMaxEventsPerWait];
+
+    while (!_stopRequested) {
+        while (!_runnable.empty()) {
+            Waiter* waiter = _runnable.front();
+            _runnable.pop_front();
+            waiter->handle.resume();
+            if (_stopRequested) return;
+        }
+
+        if (_waiters.empty() && _deadlines.empty()) {
+            return; // Nothing can ever become runnable again
+        }
+
+        int n = epoll_wait(_epollFd, events, kMaxEventsPerWait, nextTimeoutMs());
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("epoll_wait failed: ") + strerror(errno));
+        }
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == _wakeFd) {
+                uint64_t count;
+                while (::read(_wakeFd, &count, sizeof(count)) > 0) {}
+                continue;
+            }
+
+            auto it = _waiters.find(fd);
+            if (it == _waiters.end()) continue; // Waiter already timed out
+            Waiter* waiter = it->second;
+            _waiters.erase(it);
+            if (waiter->hasDeadline) {
+                _deadlines.erase(waiter->deadline);
+                waiter->hasDeadline = false;
+            }
+            waiter->ready = true;
+            _runnable.push_back(waiter);
+        }
+
+        expireDeadlines();
+    }
+}
+
+void EventLoop::stop() {
+    _stopRequested = true;
+    uint64_t one = 1;
+    ssize_t ignored = ::write(_wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
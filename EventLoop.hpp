@@ -0,0 +1,138 @@
+/**
+ * @file EventLoop.hpp
+ * @brief Single-threaded, readiness-based coroutine executor built on epoll (Linux only).
+ * @details Coroutines suspend on `co_await loop.readable(fd, timeoutMs)` and are resumed
+ * by `run()` when the descriptor becomes readable or the timeout expires. An idle waiter
+ * costs one epoll registration plus its coroutine frame, so thousands of sources can be
+ * served from one thread.
+ */
+
+#ifndef EVENT_LOOP_HPP
+#define EVENT_LOOP_HPP
+
+#include "Coroutine.hpp"
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Registration of one suspended coroutine waiting for a descriptor.
+     * Lives in the awaiting coroutine's frame for the duration of the wait.
+     */
+    struct Waiter {
+        int fd = -1;
+        std::coroutine_handle<> handle;
+        bool ready = false;
+        bool hasDeadline = false;
+        std::multimap<Clock::time_point, Waiter*>::iterator deadline;
+    };
+
+    /// @brief Awaitable returned by readable(). Resumes with true if readable, false on timeout.
+    class ReadableAwaiter {
+    public:
+        ReadableAwaiter(EventLoop& loop, int fd, unsigned int timeoutMs) noexcept
+            : _loop(loop), _timeoutMs(timeoutMs) { _waiter.fd = fd; }
+
+        bool await_ready() const noexcept { return _waiter.fd < 0; }
+        bool await_suspend(std::coroutine_handle<> handle);
+        bool await_resume() const noexcept { return _waiter.ready; }
+
+    private:
+        EventLoop& _loop;
+        unsigned int _timeoutMs;
+        Waiter _waiter;
+    };
+
+    /// @brief Awaitable returned by sleepFor(). Always resumes from the loop.
+    class SleepAwaiter {
+    public:
+        SleepAwaiter(EventLoop& loop, unsigned int timeoutMs) noexcept : _loop(loop), _timeoutMs(timeoutMs) {}
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+
+    private:
+        EventLoop& _loop;
+        unsigned int _timeoutMs;
+        Waiter _waiter;
+    };
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * @brief Suspends the calling coroutine until fd is readable or the timeout expires.
+     * Only one coroutine may wait on a given descriptor at a time.
+     * @param fd The descriptor to wait on. A negative fd completes immediately with false.
+     * @param timeoutMs Timeout in milliseconds; 0 waits indefinitely.
+     */
+    ReadableAwaiter readable(int fd, unsigned int timeoutMs = 0) { return ReadableAwaiter(*this, fd, timeoutMs); }
+
+    /// @brief Suspends the calling coroutine for timeoutMs milliseconds.
+    SleepAwaiter sleepFor(unsigned int timeoutMs) { return SleepAwaiter(*this, timeoutMs); }
+
+    /**
+     * @brief Starts a task on this loop. It runs up to its first suspension immediately.
+     * @param task The task; its frame is released when it completes.
+     */
+    void spawn(Task<void> task) { startDetached(std::move(task)); }
+
+    /**
+     * @brief Removes a descriptor from the epoll set. Call before closing a descriptor
+     * that has been waited on, so a recycled descriptor number is registered afresh.
+     */
+    void forget(int fd);
+
+    /**
+     * @brief Removes a descriptor from the epoll set and drops its waiter without
+     * resuming it, including one already queued to resume. Use when the state the
+     * waiting coroutine refers to is being destroyed; that coroutine stays suspended
+     * until its owning Task releases the frame.
+     */
+    void cancel(int fd);
+
+    /**
+     * @brief Runs until stop() is called or nothing is left waiting.
+     * A stop() that arrives before run() starts makes it return at once.
+     */
+    void run();
+
+    /**
+     * @brief Asks run() to return. Safe to call from any thread. If run() is not in
+     * progress, the next run() returns without doing any work.
+     */
+    void stop();
+
+    /// @brief Number of coroutines currently suspended on a descriptor or timer.
+    size_t pendingWaiters() const { return _waiters.size() + _sleepers; }
+
+private:
+    int _epollFd;
+    int _wakeFd;
+    std::atomic<bool> _stopRequested;
+    std::unordered_map<int, Waiter*> _waiters;
+    std::unordered_set<int> _registered;
+    std::multimap<Clock::time_point, Waiter*> _deadlines;
+    std::deque<Waiter*> _runnable;
+    size_t _sleepers;
+
+    void runUntilIdleOrStopped();
+    bool arm(Waiter& waiter, unsigned int timeoutMs);
+    void addDeadline(Waiter& waiter, unsigned int timeoutMs);
+    int nextTimeoutMs() const;
+    void expireDeadlines();
+};
+
+#endif // EVENT_LOOP_HPP
@@ -0,0 +1,409 @@
+/**
+ * @file FramingCodecs.hpp
+ * @brief Framing codec policies for BasicComms, and the FramingCodec concept they satisfy.
+ * @details A codec turns messages into frames on the wire and back. BasicComms is templated
+ * on its codec, so encode and decode inline into the send and receive paths; codecs defined
+ * outside this file work the same way.
+ *
+ * A codec provides:
+ *  - size_t decode(std::span<const char> input, std::string& message):
+ *    decodes the first frame of input into message and returns the number of input bytes
+ *    it spanned, or returns 0 if input does not hold a complete frame yet. The codec may
+ *    remember how far it has looked, since the next call sees the same bytes plus more;
+ *    reset() forgets that state and is called for every new connection.
+ *  - std::string finish(std::span<const char> input):
+ *    called when no more input will complete a frame (the peer closed, or the idle timeout
+ *    passed); returns a last message made of the leftover input or throws std::runtime_error.
+ *  - static constexpr int kIdleTimeoutMs: when >= 0, receiving ends after the line has been
+ *    quiet that long and finish() is applied to whatever arrived (time-based framing).
+ *  - Either header()/trailer() with kMaxHeader/kMaxTrailer, for codecs that send the payload
+ *    unchanged (it is then gathered into the send call without a copy), or encode(), which
+ *    appends a complete frame to a string, for codecs that transform the payload.
+ *  - Optionally encodeBatch() and takePending() (BatchingCodec), for codecs that pack several
+ *    messages into one frame: sendMessages() hands them the whole batch, and on receive
+ *    decode() returns the first message of a frame and takePending() the others in order.
+ *  - Optionally takeRejectedFrame() (RejectingCodec), for codecs whose decode() can throw for
+ *    a frame it has fully delimited (e.g. content that fails to decompress): it returns that
+ *    frame's length, so the caller can drop the frame and keep the connection.
+ */
+
+#ifndef FRAMING_CODECS_HPP
+#define FRAMING_CODECS_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+/// @brief Thrown by decode() when a length header announces a frame above the codec's maximum.
+/// The stream cannot be resynchronized after it; the connection should be dropped.
+class FrameTooLargeError : public std::runtime_error {
+public:
+    FrameTooLargeError(uint64_t frameSize, size_t maxFrameSize)
+        : std::runtime_error("Frame of " + std::to_string(frameSize) + " bytes exceeds the maximum of " +
+                             std::to_string(maxFrameSize)),
+          frameSize(frameSize), maxFrameSize(maxFrameSize) {}
+
+    uint64_t frameSize;
+    size_t maxFrameSize;
+};
+
+/// @brief A codec that frames the payload with a header and/or trailer, sending it unchanged.
+template <class C>
+concept GatherCodec = requires(const C codec, std::string_view payload, char* out) {
+    { C::kMaxHeader } -> std::convertible_to<size_t>;
+    { C::kMaxTrailer } -> std::convertible_to<size_t>;
+    { codec.header(payload, out) } -> std::convertible_to<size_t>;
+    { codec.trailer(payload, out) } -> std::convertible_to<size_t>;
+};
+
+/// @brief A codec that rewrites the payload (escaping, stuffing) while framing it.
+template <class C>
+concept EncodingCodec = requires(const C codec, std::string_view payload, std::string& out) {
+    codec.encode(payload, out);
+};
+
+/// @brief A codec that can carry several messages in one frame (see CompressingCodec).
+template <class C>
+concept BatchingCodec = requires(C codec, const C constCodec, std::span<const std::string> messages,
+                                 std::string& out) {
+    constCodec.encodeBatch(messages, out);
+    { codec.takePending(out) } -> std::convertible_to<bool>;
+};
+
+/// @brief A codec that can reject one delimited frame without losing its place in the stream.
+template <class C>
+concept RejectingCodec = requires(C codec) {
+    { codec.takeRejectedFrame() } -> std::convertible_to<size_t>;
+};
+
+template <class C>
+concept FramingCodec = std::movable<C> && (GatherCodec<C> || EncodingCodec<C>) &&
+    requires(C codec, std::span<const char> input, std::string& message) {
+        { C::kIdleTimeoutMs } -> std::convertible_to<int>;
+        { codec.decode(input, message) } -> std::convertible_to<size_t>;
+        { codec.finish(input) } -> std::convertible_to<std::string>;
+        codec.reset();
+    };
+
+/// @brief Message ends with "\r\n". An unterminated tail is returned when the peer closes.
+struct CrlfCodec {
+    static constexpr size_t kMaxHeader = 0;
+    static constexpr size_t kMaxTrailer = 2;
+    static constexpr int kIdleTimeoutMs = -1;
+
+    size_t header(std::string_view, char*) const { return 0; }
+    size_t trailer(std::string_view, char* out) const {
+        out[0] = '\r';
+        out[1] = '\n';
+        return 2;
+    }
+
+    size_t decode(std::span<const char> input, std::string& message) {
+        // Only bytes that arrived since the last search need scanning
+        const char* begin = input.data();
+        const char* end = begin + input.size();
+        const char* lf = begin + scanned;
+        while ((lf = static_cast<const char*>(std::memchr(lf, '\n', end - lf))) != nullptr) {
+            if (lf > begin && lf[-1] == '\r') {
+                message.assign(begin, lf - 1);
+                scanned = 0;
+                return static_cast<size_t>(lf + 1 - begin);
+            }
+            ++lf;
+        }
+        scanned = input.size();
+        return 0;
+    }
+
+    std::string finish(std::span<const char> input) {
+        scanned = 0;
+        return std::string(input.data(), input.size());
+    }
+
+    void reset() { scanned = 0; }
+
+    size_t scanned = 0; // Bytes at the front of the input already searched
+};
+
+/// @brief Message begins with a 4-byte length field (network byte order).
+/// A length above maxFrameSize throws FrameTooLargeError as soon as the header arrives,
+/// before anything is buffered for the body.
+struct LengthPrefixCodec {
+    static constexpr size_t kMaxHeader = 4;
+    static constexpr size_t kMaxTrailer = 0;
+    static constexpr int kIdleTimeoutMs = -1;
+    static constexpr size_t kDefaultMaxFrameSize = 16 * 1024 * 1024;
+
+    explicit LengthPrefixCodec(size_t maxFrameSize = kDefaultMaxFrameSize) : maxFrameSize(maxFrameSize) {}
+
+    size_t header(std::string_view payload, char* out) const {
+        uint32_t length = static_cast<uint32_t>(payload.size());
+        out[0] = static_cast<char>(length >> 24);
+        out[1] = static_cast<char>(length >> 16);
+        out[2] = static_cast<char>(length >> 8);
+        out[3] = static_cast<char>(length);
+        return 4;
+    }
+    size_t trailer(std::string_view, char*) const { return 0; }
+
+    size_t decode(std::span<const char> input, std::string& message) {
+        if (input.size() < 4) {
+            return 0;
+        }
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(input.data());
+        size_t length = (size_t(bytes[0]) << 24) | (size_t(bytes[1]) << 16) | (size_t(bytes[2]) << 8) | bytes[3];
+        if (length > maxFrameSize) {
+            throw FrameTooLargeError(length, maxFrameSize);
+        }
+        if (input.size() < 4 + length) {
+            return 0;
+        }
+        message.assign(input.data() + 4, length);
+        return 4 + length;
+    }
+
+    std::string finish(std::span<const char> input) {
+        throw std::runtime_error(input.size() < 4 ? "Failed to receive message length"
+                                                  : "Failed to receive message body");
+    }
+
+    void reset() {}
+
+    size_t maxFrameSize;
+};
+
+/// @brief Message ends when no data has been received for 30 ms.
+struct TimeoutCodec {
+    static constexpr size_t kMaxHeader = 0;
+    static constexpr size_t kMaxTrailer = 0;
+    static constexpr int kIdleTimeoutMs = 30;
+
+    size_t header(std::string_view, char*) const { return 0; }
+    size_t trailer(std::string_view, char*) const { return 0; }
+
+    size_t decode(std::span<const char>, std::string&) { return 0; } // Only silence ends a message
+    std::string finish(std::span<const char> input) { return std::string(input.data(), input.size()); }
+    void reset() {}
+};
+
+/// @brief Raw stream: each receive returns whatever bytes have arrived.
+struct RawCodec {
+    static constexpr size_t kMaxHeader = 0;
+    static constexpr size_t kMaxTrailer = 0;
+    static constexpr int kIdleTimeoutMs = -1;
+
+    size_t header(std::string_view, char*) const { return 0; }
+    size_t trailer(std::string_view, char*) const { return 0; }
+
+    size_t decode(std::span<const char> input, std::string& message) {
+        message.assign(input.data(), input.size());
+        return input.size();
+    }
+
+    std::string finish(std::span<const char>) {
+        throw std::runtime_error("Connection closed or error receiving data");
+    }
+
+    void reset() {}
+};
+
+/// @brief Message ends with a NUL byte; the payload must not contain one.
+struct NulTerminatedCodec {
+    static constexpr size_t kMaxHeader = 0;
+    static constexpr size_t kMaxTrailer = 1;
+    static constexpr int kIdleTimeoutMs = -1;
+
+    size_t header(std::string_view, char*) const { return 0; }
+    size_t trailer(std::string_view, char* out) const {
+        out[0] = '\0';
+        return 1;
+    }
+
+    size_t decode(std::span<const char> input, std::string& message) {
+        const char* nul = static_cast<const char*>(std::memchr(input.data(), '\0', input.size()));
+        if (nul == nullptr) {
+            return 0;
+        }
+        message.assign(input.data(), nul);
+        return static_cast<size_t>(nul + 1 - input.data());
+    }
+
+    std::string finish(std::span<const char>) { throw std::runtime_error("Connection closed before a complete frame"); }
+    void reset() {}
+};
+
+/// @brief Message begins with its length as an unsigned LEB128 varint (1 byte below 128).
+/// Lengths above maxFrameSize throw FrameTooLargeError, as for LengthPrefixCodec.
+struct VarintLengthCodec {
+    static constexpr size_t kMaxHeader = 5; // Enough for 32-bit lengths
+    static constexpr size_t kMaxTrailer = 0;
+    static constexpr int kIdleTimeoutMs = -1;
+
+    explicit VarintLengthCodec(size_t maxFrameSize = LengthPrefixCodec::kDefaultMaxFrameSize)
+        : maxFrameSize(maxFrameSize) {}
+
+    size_t header(std::string_view payload, char* out) const {
+        uint32_t length = static_cast<uint32_t>(payload.size());
+        size_t count = 0;
+        do {
+            uint8_t byte = length & 0x7F;
+            length >>= 7;
+            out[count++] = static_cast<char>(length != 0 ? byte | 0x80 : byte);
+        } while (length != 0);
+        return count;
+    }
+    size_t trailer(std::string_view, char*) const { return 0; }
+
+    size_t decode(std::span<const char> input, std::string& message) {
+        uint64_t length = 0;
+        size_t headerSize = 0;
+        while (true) {
+            if (headerSize == input.size()) {
+                return 0;
+            }
+            uint8_t byte = static_cast<uint8_t>(input[headerSize]);
+            length |= uint64_t(byte & 0x7F) << (7 * headerSize);
+            ++headerSize;
+            if ((byte & 0x80) == 0) {
+                break;
+            }
+            if (headerSize == kMaxHeader) {
+                throw std::runtime_error("Invalid varint length prefix");
+            }
+        }
+        if (length > maxFrameSize) {
+            throw FrameTooLargeError(length, maxFrameSize);
+        }
+        if (input.size() - headerSize < length) {
+            return 0;
+        }
+        message.assign(input.data() + headerSize, static_cast<size_t>(length));
+        return headerSize + static_cast<size_t>(length);
+    }
+
+    std::string finish(std::span<const char>) { throw std::runtime_error("Connection closed before a complete frame"); }
+    void reset() {}
+
+    size_t maxFrameSize;
+};
+
+/// @brief SLIP (RFC 1055): frames delimited by END, with END and ESC bytes escaped.
+/// Empty frames are skipped on receive, so empty messages cannot be sent.
+struct SlipCodec {
+    static constexpr char kEnd = static_cast<char>(0xC0);
+    static constexpr char kEsc = static_cast<char>(0xDB);
+    static constexpr char kEscEnd = static_cast<char>(0xDC);
+    static constexpr char kEscEsc = static_cast<char>(0xDD);
+    static constexpr int kIdleTimeoutMs = -1;
+
+    void encode(std::string_view payload, std::string& out) const {
+        out.reserve(out.size() + payload.size() + 2);
+        out += kEnd; // Flushes any line noise the receiver has accumulated
+        size_t start = 0;
+        for (size_t i = 0; i < payload.size(); ++i) {
+            if (payload[i] == kEnd || payload[i] == kEsc) {
+                out.append(payload.data() + start, i - start);
+                out += kEsc;
+                out += payload[i] == kEnd ? kEscEnd : kEscEsc;
+                start = i + 1;
+            }
+        }
+        out.append(payload.data() + start, payload.size() - start);
+        out += kEnd;
+    }
+
+    size_t decode(std::span<const char> input, std::string& message) {
+        size_t start = 0;
+        while (start < input.size()) {
+            const char* end = static_cast<const char*>(std::memchr(input.data() + start, kEnd, input.size() - start));
+            if (end == nullptr) {
+                return 0;
+            }
+            size_t stop = static_cast<size_t>(end - input.data());
+            if (stop == start) {
+                ++start; // Empty frame between two ENDs
+                continue;
+            }
+            // Copy the runs between escapes whole
+            message.clear();
+            message.reserve(stop - start);
+            const char* from = input.data() + start;
+            const char* frameEnd = end;
+            while (const char* esc = static_cast<const char*>(std::memchr(from, kEsc, frameEnd - from))) {
+                message.append(from, esc);
+                if (esc + 1 == frameEnd) {
+                    from = frameEnd; // Dangling ESC before END: dropped
+                    break;
+                }
+                message += esc[1] == kEscEnd ? kEnd : esc[1] == kEscEsc ? kEsc : esc[1];
+                from = esc + 2;
+            }
+            message.append(from, frameEnd);
+            return stop + 1;
+        }
+        return 0;
+    }
+
+    std::string finish(std::span<const char>) { throw std::runtime_error("Connection closed before a complete frame"); }
+    void reset() {}
+};
+
+/// @brief COBS: the payload is byte-stuffed so it contains no zero, and each frame ends with 0x00.
+/// Overhead is at most one byte per 254 payload bytes plus the delimiter.
+struct CobsCodec {
+    static constexpr int kIdleTimeoutMs = -1;
+
+    void encode(std::string_view payload, std::string& out) const {
+        out.reserve(out.size() + payload.size() + payload.size() / 254 + 2);
+        // Each block is a code byte followed by up to 254 non-zero bytes; code - 1 is the run length
+        size_t position = 0;
+        while (true) {
+            size_t limit = std::min<size_t>(payload.size() - position, 254);
+            const char* zero = static_cast<const char*>(std::memchr(payload.data() + position, '\0', limit));
+            size_t run = zero != nullptr ? static_cast<size_t>(zero - payload.data()) - position : limit;
+            out += static_cast<char>(run + 1);
+            out.append(payload.data() + position, run);
+            position += run;
+            if (zero != nullptr) {
+                ++position; // The zero is implied by the block ending early
+            } else if (run < 254) {
+                break;
+            }
+        }
+        out += '\0'; // Frame delimiter
+    }
+
+    size_t decode(std::span<const char> input, std::string& message) {
+        const char* zero = static_cast<const char*>(std::memchr(input.data(), '\0', input.size()));
+        if (zero == nullptr) {
+            return 0;
+        }
+        size_t length = static_cast<size_t>(zero - input.data());
+        message.clear();
+        message.reserve(length);
+        size_t i = 0;
+        while (i < length) {
+            uint8_t code = static_cast<uint8_t>(input[i]);
+            if (i + code > length) {
+                throw std::runtime_error("Invalid COBS frame"); // Block runs past the delimiter
+            }
+            message.append(input.data() + i + 1, code - 1u);
+            i += code;
+            if (code != 0xFF && i < length) {
+                message += '\0';
+            }
+        }
+        return length + 1;
+    }
+
+    std::string finish(std::span<const char>) { throw std::runtime_error("Connection closed before a complete frame"); }
+    void reset() {}
+};
+
+#endif // FRAMING_CODECS_HPP
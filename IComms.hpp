@@ -3,6 +3,10 @@
 
 #include <string>
 #include <vector>
+#include <span>
+#include <cstddef>
+#include <chrono>
+#include <optional>
 
 /**
  * @brief Abstract interface for communication classes (Serial, Network, etc.).
@@ -11,22 +15,87 @@
 class IComms
 {
 public:
+    /// @brief Wall-clock arrival time, comparable with std::chrono::system_clock::now().
+    using ReceiveTime = std::chrono::system_clock::time_point;
+
     virtual ~IComms() = default;
 
+    /**
+     * @brief Reads up to buffer.size() bytes directly into the caller's buffer with a timeout.
+     * Waits up to timeoutMs for data to arrive, then returns whatever is immediately available.
+     * @param buffer Destination memory (e.g. free space in the caller's ring buffer).
+     * @param timeoutMs The timeout in milliseconds for the read operation.
+     * @return The number of bytes written into buffer. Returns 0 if no data is
+     *         available within the timeout or an error occurs.
+     */
+    virtual size_t readInto(std::span<std::byte> buffer, unsigned int timeoutMs) = 0;
+
+    /**
+     * @brief Scatter variant of readInto: fills the buffers in order.
+     * Useful for ring buffers whose free space wraps around the end of storage.
+     * The default implementation issues one readInto per buffer, waiting only for the first.
+     * @param buffers Destination buffers, filled in order.
+     * @param timeoutMs The timeout in milliseconds for the read operation.
+     * @return The total number of bytes written across all buffers.
+     */
+    virtual size_t readIntoScatter(std::span<const std::span<std::byte>> buffers, unsigned int timeoutMs)
+    {
+        size_t total = 0;
+        for (const std::span<std::byte> &buffer : buffers)
+        {
+            size_t received = readInto(buffer, total == 0 ? timeoutMs : 0);
+            total += received;
+            if (received < buffer.size())
+            {
+                break; // Medium drained (or timed out); later buffers stay untouched
+            }
+        }
+        return total;
+    }
+
     /**
      * @brief Reads a specified number of bytes from the communication medium with a timeout.
+     * Compatibility wrapper around readInto that allocates a new string per call.
      * @param numBytes The maximum number of bytes to attempt to read.
      * @param timeoutMs The timeout in milliseconds for the read operation.
      * @return A string containing the bytes read. Returns an empty string if no data
      *         is available within the timeout or an error occurs.
      */
-    virtual std::string readBytes(size_t numBytes, unsigned int timeoutMs) = 0;
+    virtual std::string readBytes(size_t numBytes, unsigned int timeoutMs)
+    {
+        std::string data(numBytes, '\0');
+        data.resize(readInto(std::as_writable_bytes(std::span<char>(data.data(), data.size())), timeoutMs));
+        return data;
+    }
 
     /**
      * @brief Checks if the communication medium is currently open.
      * @return True if open, false otherwise.
      */
     virtual bool isOpen() const = 0;
+
+    /**
+     * @brief Returns a descriptor that becomes readable when data is available.
+     * Used by readiness-based executors (e.g. EventLoop) to wait without blocking
+     * inside readBytes.
+     * @return The OS file descriptor, or -1 if the medium cannot be polled.
+     */
+    virtual int getPollDescriptor() const { return -1; }
+
+    /**
+     * @brief Returns the number of bytes already held in user space by the implementation.
+     * These can be read without waiting, and do not make the poll descriptor readable,
+     * so readiness-based callers must drain them before waiting on getPollDescriptor().
+     * @return Bytes readable without touching the medium.
+     */
+    virtual size_t getBufferedBytes() const { return 0; }
+
+    /**
+     * @brief Returns when the bytes handed out by the most recent read arrived.
+     * Only media that record arrival times (e.g. kernel socket timestamps) report one.
+     * @return The arrival time, or std::nullopt if not recorded.
+     */
+    virtual std::optional<ReceiveTime> getLastReceiveTime() const { return std::nullopt; }
 };
 
 #endif // I_COMMS_HPP
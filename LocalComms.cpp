@@ -0,0 +1,416 @@
+#include "LocalComms.hpp"
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    // Maximum AF_UNIX datagram we are prepared to forward in the spliceTo() fallback
+    constexpr size_t kMaxDatagram = 64 * 1024;
+
+    bool fillUnixAddress(const std::string &path, sockaddr_un &addr)
+    {
+        memset(&addr, 0, sizeof addr);
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path))
+        {
+            std::cerr << "Error: UNIX socket path too long: " << path << std::endl;
+            return false;
+        }
+        memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        return true;
+    }
+}
+
+LocalComms::LocalComms()
+    : _fd(-1),
+      _ownsFd(false),
+      _isOpen(false),
+      _type(Type::Stream),
+      _truncatedDatagrams(0),
+      _splicePipe{-1, -1},
+      _splicePipeFill(0),
+      _datagramStart(0),
+      _datagramEnd(0)
+{
+}
+
+LocalComms::~LocalComms()
+{
+    close();
+}
+
+bool LocalComms::connect(const std::string &path)
+{
+    if (_isOpen)
+    {
+        std::cerr << "Error: Already open." << std::endl;
+        return false;
+    }
+
+    sockaddr_un addr;
+    if (!fillUnixAddress(path, addr))
+    {
+        return false;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        std::cerr << "socket error: " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof addr) == -1)
+    {
+        std::cerr << "connect error on " << path << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    return adopt(fd, Type::Stream, true);
+}
+
+bool LocalComms::bindDatagram(const std::string &path)
+{
+    if (_isOpen)
+    {
+        std::cerr << "Error: Already open." << std::endl;
+        return false;
+    }
+
+    sockaddr_un addr;
+    if (!fillUnixAddress(path, addr))
+    {
+        return false;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        std::cerr << "socket error: " << strerror(errno) << std::endl;
+        return false;
+    }
+    ::unlink(path.c_str()); // Replace a socket file left behind by a previous run
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof addr) == -1)
+    {
+        std::cerr << "bind error on " << path << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    _boundPath = path;
+    return adopt(fd, Type::Datagram, true);
+}
+
+bool LocalComms::openFifo(const std::string &path)
+{
+    if (_isOpen)
+    {
+        std::cerr << "Error: Already open." << std::endl;
+        return false;
+    }
+
+    if (mkfifo(path.c_str(), 0660) == -1 && errno != EEXIST)
+    {
+        std::cerr << "mkfifo error on " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // O_NONBLOCK so open() does not block until a writer appears
+    int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd == -1)
+    {
+        std::cerr << "Error opening " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISFIFO(st.st_mode))
+    {
+        std::cerr << "Error: " << path << " is not a FIFO." << std::endl;
+        ::close(fd);
+        return false;
+    }
+    return adopt(fd, Type::Fifo, true);
+}
+
+bool LocalComms::attach(int fd, Type type, bool takeOwnership)
+{
+    if (_isOpen)
+    {
+        std::cerr << "Error: Already open." << std::endl;
+        return false;
+    }
+    if (fd < 0)
+    {
+        return false;
+    }
+    return adopt(fd, type, takeOwnership);
+}
+
+bool LocalComms::adopt(int fd, Type type, bool takeOwnership)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1)
+    {
+        std::cerr << "fcntl(O_NONBLOCK) error: " << strerror(errno) << std::endl;
+        if (takeOwnership)
+        {
+            ::close(fd);
+        }
+        return false;
+    }
+
+    _fd = fd;
+    _ownsFd = takeOwnership;
+    _type = type;
+    _isOpen = true;
+    _truncatedDatagrams = 0;
+    return true;
+}
+
+void LocalComms::close()
+{
+    if (_fd != -1)
+    {
+        if (_ownsFd)
+        {
+            ::close(_fd);
+        }
+        _fd = -1;
+    }
+    if (!_boundPath.empty())
+    {
+        ::unlink(_boundPath.c_str());
+        _boundPath.clear();
+    }
+    for (int &end : _splicePipe)
+    {
+        if (end != -1)
+        {
+            ::close(end);
+            end = -1;
+        }
+    }
+    _splicePipeFill = 0;
+    _datagramStart = 0;
+    _datagramEnd = 0;
+    _isOpen = false;
+}
+
+bool LocalComms::waitReadable(unsigned int timeoutMs)
+{
+    struct pollfd pfd;
+    pfd.fd = _fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    int pollResult = poll(&pfd, 1, static_cast<int>(timeoutMs));
+    if (pollResult == -1)
+    {
+        if (errno == EINTR)
+        {
+            return false; // Treat like a timeout; the caller will retry
+        }
+        std::cerr << "poll error: " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+
+    // POLLHUP/POLLERR also count: the following read reports EOF or the error
+    return pollResult > 0 && pfd.revents != 0;
+}
+
+bool LocalComms::handleReadError(const char *what)
+{
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+    {
+        // No more data immediately available
+        return true;
+    }
+    std::cerr << what << " error: " << strerror(errno) << std::endl;
+    close(); // Close source on read error
+    return false;
+}
+
+size_t LocalComms::readInto(std::span<std::byte> buffer, unsigned int timeoutMs)
+{
+    if (!_isOpen || buffer.empty())
+    {
+        return 0;
+    }
+
+    if (!waitReadable(timeoutMs))
+    {
+        return 0;
+    }
+
+    if (_type == Type::Datagram)
+    {
+        // MSG_TRUNC makes recv report the full datagram length so truncation is visible
+        ssize_t length = recv(_fd, buffer.data(), buffer.size(), MSG_TRUNC);
+        if (length < 0)
+        {
+            handleReadError("recv");
+            return 0;
+        }
+        if (static_cast<size_t>(length) > buffer.size())
+        {
+            ++_truncatedDatagrams;
+            return buffer.size();
+        }
+        return static_cast<size_t>(length);
+    }
+
+    // Stream socket or FIFO: read until the buffer is full or the source is drained.
+    size_t total = 0;
+    while (total < buffer.size())
+    {
+        ssize_t bytesRead = ::read(_fd, buffer.data() + total, buffer.size() - total);
+        if (bytesRead > 0)
+        {
+            total += static_cast<size_t>(bytesRead);
+            if (total < buffer.size())
+            {
+                break; // Short read: nothing more queued, skip the EAGAIN round trip
+            }
+        }
+        else if (bytesRead == 0)
+        {
+            // Peer closed the socket, or the last FIFO writer went away
+            close();
+            break;
+        }
+        else
+        {
+            handleReadError("read");
+            break;
+        }
+    }
+
+    return total;
+}
+
+size_t LocalComms::drainSplicePipe(int outFd)
+{
+    size_t moved = 0;
+    while (_splicePipeFill > 0)
+    {
+        ssize_t n = splice(_splicePipe[0], nullptr, outFd, nullptr, _splicePipeFill, SPLICE_F_MOVE);
+        if (n <= 0)
+        {
+            if (n < 0 && errno != EAGAIN && errno != EINTR)
+            {
+                std::cerr << "splice error: " << strerror(errno) << std::endl;
+            }
+            break; // Leave the remainder for the next call
+        }
+        _splicePipeFill -= static_cast<size_t>(n);
+        moved += static_cast<size_t>(n);
+    }
+    return moved;
+}
+
+size_t LocalComms::drainDatagramScratch(int outFd, size_t maxBytes)
+{
+    size_t moved = 0;
+    while (_datagramStart < _datagramEnd && moved < maxBytes)
+    {
+        size_t length = std::min(_datagramEnd - _datagramStart, maxBytes - moved);
+        ssize_t n = ::write(outFd, _datagramScratch.data() + _datagramStart, length);
+        if (n <= 0)
+        {
+            if (n < 0 && errno != EAGAIN && errno != EINTR)
+            {
+                std::cerr << "write error: " << strerror(errno) << std::endl;
+            }
+            break; // Leave the remainder for the next call
+        }
+        _datagramStart += static_cast<size_t>(n);
+        moved += static_cast<size_t>(n);
+    }
+    return moved;
+}
+
+size_t LocalComms::spliceTo(int outFd, size_t maxBytes, unsigned int timeoutMs)
+{
+    if (maxBytes == 0)
+    {
+        return 0;
+    }
+
+    // Bytes already pulled off the source are delivered before anything new
+    size_t moved = drainSplicePipe(outFd);
+    moved += drainDatagramScratch(outFd, maxBytes - std::min(moved, maxBytes));
+    if (_splicePipeFill > 0 || _datagramStart < _datagramEnd || moved >= maxBytes || !_isOpen)
+    {
+        return moved;
+    }
+
+    if (!waitReadable(moved > 0 ? 0 : timeoutMs))
+    {
+        return moved;
+    }
+
+    if (_type == Type::Datagram)
+    {
+        // AF_UNIX datagram sockets have no splice_read; forward one datagram by copy
+        _datagramScratch.resize(kMaxDatagram);
+        _datagramStart = 0;
+        _datagramEnd = readInto(_datagramScratch, 0);
+        return moved + drainDatagramScratch(outFd, maxBytes - moved);
+    }
+
+    int source = _fd;
+    int target = outFd;
+    if (_type == Type::Stream)
+    {
+        // A socket can only be spliced into a pipe, so stage through our own pipe
+        if (_splicePipe[0] == -1 && pipe2(_splicePipe, O_NONBLOCK | O_CLOEXEC) == -1)
+        {
+            std::cerr << "pipe2 error: " << strerror(errno) << std::endl;
+            return moved;
+        }
+        target = _splicePipe[1];
+    }
+
+    ssize_t n = splice(source, nullptr, target, nullptr, maxBytes - moved, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (n == 0)
+    {
+        close(); // Peer closed
+        return moved;
+    }
+    if (n < 0)
+    {
+        if (errno == EINVAL)
+        {
+            std::cerr << "splice error: outFd does not support splicing" << std::endl;
+        }
+        else
+        {
+            handleReadError("splice");
+        }
+        return moved;
+    }
+
+    if (_type == Type::Stream)
+    {
+        _splicePipeFill = static_cast<size_t>(n);
+        return moved + drainSplicePipe(outFd);
+    }
+    return moved + static_cast<size_t>(n);
+}
+
+bool LocalComms::isOpen() const
+{
+    return _isOpen;
+}
+
+int LocalComms::getPollDescriptor() const
+{
+    return _isOpen ? _fd : -1;
+}
@@ -0,0 +1,151 @@
+#ifndef LOCAL_COMMS_HPP
+#define LOCAL_COMMS_HPP
+
+#include "IComms.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Implements IComms for same-host sources: AF_UNIX sockets and FIFOs (POSIX).
+ *
+ * Local relays such as gpsd-style multiplexers hand data over UNIX sockets or named
+ * pipes; reading them here avoids the TCP stack that NetworkComms goes through even
+ * on loopback.
+ *
+ * - Stream sockets and FIFOs behave like NetworkComms: a read returns whatever bytes
+ *   are queued, and the source closes when the peer goes away.
+ * - Datagram sockets return exactly one datagram per read, so message boundaries set
+ *   by the sender are preserved. A datagram larger than the buffer is truncated and
+ *   counted in getTruncatedDatagrams().
+ *
+ * spliceTo() forwards data to a recorder (file or pipe) without copying it through
+ * user space, for setups that archive the raw feed as well as parsing it.
+ */
+class LocalComms : public IComms {
+public:
+    /**
+     * @brief Kind of local descriptor being read.
+     */
+    enum class Type {
+        Stream,   ///< AF_UNIX SOCK_STREAM
+        Datagram, ///< AF_UNIX SOCK_DGRAM
+        Fifo      ///< Named pipe (or anonymous pipe via attach())
+    };
+
+    LocalComms();
+
+    /**
+     * @brief Destructor. Closes the descriptor and removes a bound datagram path.
+     */
+    ~LocalComms();
+
+    LocalComms(const LocalComms&) = delete;
+    LocalComms& operator=(const LocalComms&) = delete;
+
+    /**
+     * @brief Connects to a listening AF_UNIX stream socket.
+     * @param path Filesystem path of the socket.
+     * @return True if connection is successful, false otherwise.
+     */
+    bool connect(const std::string& path);
+
+    /**
+     * @brief Binds an AF_UNIX datagram socket that senders address by path.
+     * Any stale socket file at path is replaced; the path is removed on close().
+     * @param path Filesystem path to bind.
+     * @return True on success, false otherwise.
+     */
+    bool bindDatagram(const std::string& path);
+
+    /**
+     * @brief Opens a named pipe for reading, creating it if it does not exist.
+     * Opening does not wait for a writer; reads time out until one connects.
+     * @param path Filesystem path of the FIFO.
+     * @return True on success, false otherwise.
+     */
+    bool openFifo(const std::string& path);
+
+    /**
+     * @brief Reads from an already open descriptor, e.g. one end of a socketpair() or pipe().
+     * @param fd The descriptor to read from. It is switched to non-blocking mode.
+     * @param type What kind of descriptor fd is.
+     * @param takeOwnership If true, fd is closed by close() / the destructor.
+     * @return True on success, false if fd is invalid.
+     */
+    bool attach(int fd, Type type, bool takeOwnership = true);
+
+    /**
+     * @brief Closes the descriptor.
+     */
+    void close();
+
+    /**
+     * @brief Reads available bytes directly into the caller's buffer.
+     * For datagram sockets exactly one datagram is returned per call.
+     * @param buffer Destination memory.
+     * @param timeoutMs The timeout in milliseconds for the read operation.
+     * @return The number of bytes read. Returns 0 if no data is available within
+     *         the timeout, the peer closed, or an error occurs.
+     */
+    size_t readInto(std::span<std::byte> buffer, unsigned int timeoutMs) override;
+
+    /**
+     * @brief Moves up to maxBytes from the source to outFd without a user-space copy.
+     * FIFOs splice directly; stream sockets splice through an internal pipe. Datagram
+     * sockets cannot be spliced and fall back to one recv + write per datagram; a datagram
+     * that outFd or maxBytes cannot take in full is finished by the following calls.
+     * @param outFd Destination descriptor (regular file, pipe or socket).
+     * @param maxBytes Upper bound on bytes moved by this call.
+     * @param timeoutMs The timeout in milliseconds to wait for data.
+     * @return The number of bytes written to outFd.
+     */
+    size_t spliceTo(int outFd, size_t maxBytes, unsigned int timeoutMs);
+
+    /**
+     * @brief Checks if the source is open and the peer has not closed.
+     * @return True if open, false otherwise.
+     */
+    bool isOpen() const override;
+
+    /**
+     * @brief Returns the descriptor for readiness polling.
+     * @return The descriptor, or -1 if not open.
+     */
+    int getPollDescriptor() const override;
+
+    /// @brief The kind of source currently open.
+    Type getType() const { return _type; }
+
+    /// @brief Number of datagrams cut short because the read buffer was too small.
+    uint64_t getTruncatedDatagrams() const { return _truncatedDatagrams; }
+
+private:
+    int _fd;
+    bool _ownsFd;
+    bool _isOpen;
+    Type _type;
+    std::string _boundPath;
+    uint64_t _truncatedDatagrams;
+
+    // Lazily created pipe used to splice from a stream socket
+    int _splicePipe[2];
+    size_t _splicePipeFill;
+    // Scratch buffer for the datagram copy fallback of spliceTo(); bytes of the last
+    // datagram not yet written to outFd live in [_datagramStart, _datagramEnd)
+    std::vector<std::byte> _datagramScratch;
+    size_t _datagramStart;
+    size_t _datagramEnd;
+
+    bool adopt(int fd, Type type, bool takeOwnership);
+    // Waits up to timeoutMs for the descriptor to become readable; closes on hang-up errors
+    bool waitReadable(unsigned int timeoutMs);
+    // Reports a read failure; returns true if it was only "no data right now"
+    bool handleReadError(const char* what);
+    // Writes bytes still held in the splice pipe to outFd
+    size_t drainSplicePipe(int outFd);
+    // Writes up to maxBytes of the staged datagram to outFd; the rest waits for the next call
+    size_t drainDatagramScratch(int outFd, size_t maxBytes);
+};
+
+#endif // LOCAL_COMMS_HPP
@@ -0,0 +1,83 @@
+#include "MemoryComms.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+MemoryComms::MemoryComms(std::string data, size_t chunkSize)
+    : MemoryComms(chunkSize)
+{
+    _ownedData = std::move(data);
+    setSource(std::as_bytes(std::span<const char>(_ownedData.data(), _ownedData.size())));
+}
+
+MemoryComms::MemoryComms(size_t chunkSize)
+    : _position(0),
+      _chunkSize(chunkSize),
+      _timeoutEvery(0),
+      _sleepForTimeout(false),
+      _loop(false),
+      _isOpen(true),
+      _readCount(0)
+{
+}
+
+void MemoryComms::setSource(std::span<const std::byte> source)
+{
+    _source = source;
+    rewind();
+}
+
+void MemoryComms::setSimulatedTimeouts(unsigned int everyNthRead, bool sleepForTimeout)
+{
+    _timeoutEvery = everyNthRead;
+    _sleepForTimeout = sleepForTimeout;
+}
+
+void MemoryComms::rewind()
+{
+    _position = 0;
+    _isOpen = true;
+}
+
+size_t MemoryComms::readInto(std::span<std::byte> buffer, unsigned int timeoutMs)
+{
+    ++_readCount;
+    if (!_isOpen || buffer.empty())
+    {
+        return 0;
+    }
+
+    if (_timeoutEvery > 0 && _readCount % _timeoutEvery == 0)
+    {
+        if (_sleepForTimeout)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        }
+        return 0;
+    }
+
+    if (_position == _source.size())
+    {
+        if (!_loop || _source.empty())
+        {
+            _isOpen = false; // End of data behaves like the peer closing the connection
+            return 0;
+        }
+        _position = 0;
+    }
+
+    size_t count = std::min(buffer.size(), _source.size() - _position);
+    if (_chunkSize > 0)
+    {
+        count = std::min(count, _chunkSize);
+    }
+    memcpy(buffer.data(), _source.data() + _position, count);
+    _position += count;
+    return count;
+}
+
+bool MemoryComms::isOpen() const
+{
+    return _isOpen;
+}
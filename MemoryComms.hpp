@@ -0,0 +1,99 @@
+#ifndef MEMORY_COMMS_HPP
+#define MEMORY_COMMS_HPP
+
+#include "IComms.hpp"
+#include <cstddef>
+#include <span>
+#include <string>
+
+/**
+ * @brief Implements IComms over bytes held in memory, for deterministic tests and benchmarks.
+ *
+ * Each read returns at most chunkSize bytes, mimicking how a socket or UART delivers
+ * data in fragments, and every Nth read can be made to "time out" (return nothing)
+ * so timeout handling is exercised reproducibly. No descriptor or thread is involved,
+ * so reader and parser costs can be measured in isolation.
+ */
+class MemoryComms : public IComms
+{
+public:
+    /**
+     * @brief Serves a copy of data.
+     * @param data The bytes to serve.
+     * @param chunkSize Maximum bytes returned per read; 0 means no limit.
+     */
+    explicit MemoryComms(std::string data, size_t chunkSize = 0);
+
+    MemoryComms(const MemoryComms &) = delete;
+    MemoryComms &operator=(const MemoryComms &) = delete;
+
+    /**
+     * @brief Sets the maximum number of bytes returned per read (0 = no limit).
+     */
+    void setChunkSize(size_t chunkSize) { _chunkSize = chunkSize; }
+
+    /**
+     * @brief Makes every Nth read return no data, as if the read timed out.
+     * @param everyNthRead Period of simulated timeouts; 0 disables them.
+     * @param sleepForTimeout If true, a simulated timeout also sleeps for the requested
+     *                        timeout, for tests that depend on wall-clock behaviour.
+     */
+    void setSimulatedTimeouts(unsigned int everyNthRead, bool sleepForTimeout = false);
+
+    /**
+     * @brief Restarts from the first byte when the end is reached instead of closing.
+     * Useful for benchmarks that need an endless stream.
+     */
+    void setLoop(bool loop) { _loop = loop; }
+
+    /**
+     * @brief Restarts serving from the first byte and reopens the medium.
+     */
+    void rewind();
+
+    /**
+     * @brief Copies the next chunk into the caller's buffer.
+     * @param buffer Destination memory.
+     * @param timeoutMs Only used when a simulated timeout sleeps.
+     * @return The number of bytes copied; 0 on a simulated timeout or at the end of data.
+     */
+    size_t readInto(std::span<std::byte> buffer, unsigned int timeoutMs) override;
+
+    /**
+     * @brief Open until the end of data has been reached (never closes when looping).
+     */
+    bool isOpen() const override;
+
+    /// @brief Number of readInto calls so far.
+    size_t getReadCount() const { return _readCount; }
+
+    /// @brief Bytes not yet served.
+    size_t remaining() const { return _source.size() - _position; }
+
+    /// @brief The complete data being served, for consumers that can parse in place.
+    std::span<const std::byte> view() const { return _source; }
+
+protected:
+    /**
+     * @brief For subclasses that provide their own storage (e.g. a memory-mapped file).
+     */
+    explicit MemoryComms(size_t chunkSize);
+
+    /**
+     * @brief Points the reader at new storage and rewinds. The storage must outlive its use.
+     */
+    void setSource(std::span<const std::byte> source);
+
+private:
+    std::string _ownedData;
+    std::span<const std::byte> _source;
+    size_t _position;
+    size_t _chunkSize;
+    unsigned int _timeoutEvery;
+    bool _sleepForTimeout;
+    bool _loop;
+    bool _isOpen;
+    size_t _readCount;
+};
+
+#endif // MEMORY_COMMS_HPP
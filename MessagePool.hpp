@@ -0,0 +1,134 @@
+/**
+ * @file MessagePool.hpp
+ * @brief Reusable receive buffers handed out as PooledMessage handles.
+ * @details A PooledMessage owns a string borrowed from a MessagePool and gives it back when
+ * it is destroyed. Decoding into a returned buffer reuses its capacity, so once the pool
+ * holds buffers as large as the messages, receiving allocates nothing.
+ * The pool is single-threaded: acquire and release from the thread that receives.
+ * A handle keeps its pool alive, so it may outlive the Comms it came from.
+ */
+
+#ifndef MESSAGE_POOL_HPP
+#define MESSAGE_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class MessagePool;
+
+/// @brief A received message whose buffer returns to its MessagePool on destruction.
+class PooledMessage {
+public:
+    PooledMessage() = default;
+    PooledMessage(PooledMessage&& other) noexcept = default;
+    PooledMessage& operator=(PooledMessage&& other) noexcept {
+        if (this != &other) {
+            release();
+            _pool = std::move(other._pool);
+            _buffer = std::move(other._buffer);
+        }
+        return *this;
+    }
+    PooledMessage(const PooledMessage&) = delete;
+    PooledMessage& operator=(const PooledMessage&) = delete;
+    ~PooledMessage() { release(); }
+
+    std::string_view view() const { return _buffer; }
+    const char* data() const { return _buffer.data(); }
+    size_t size() const { return _buffer.size(); }
+    bool empty() const { return _buffer.empty(); }
+
+    /// @brief The underlying buffer, for decoding into.
+    std::string& str() { return _buffer; }
+
+    /// @brief Detaches the buffer; it is not returned to the pool.
+    std::string take() {
+        _pool.reset();
+        return std::move(_buffer);
+    }
+
+    /// @brief Returns the buffer to its pool now.
+    void release();
+
+private:
+    friend class MessagePool;
+    PooledMessage(std::shared_ptr<MessagePool> pool, std::string buffer)
+        : _pool(std::move(pool)), _buffer(std::move(buffer)) {}
+
+    std::shared_ptr<MessagePool> _pool;
+    std::string _buffer;
+};
+
+class MessagePool : public std::enable_shared_from_this<MessagePool> {
+public:
+    struct Stats {
+        uint64_t acquired = 0;  ///< Handles handed out
+        uint64_t allocated = 0; ///< Acquires that found the pool empty and started a new buffer
+        uint64_t discarded = 0; ///< Returned buffers freed instead of kept (pool full or too large)
+    };
+
+    /**
+     * @param maxBuffers Most idle buffers kept.
+     * @param maxBufferCapacity Returned buffers with more capacity than this are freed,
+     * so one oversized message does not pin its memory.
+     */
+    static std::shared_ptr<MessagePool> create(size_t maxBuffers = 64, size_t maxBufferCapacity = 1024 * 1024) {
+        return std::shared_ptr<MessagePool>(new MessagePool(maxBuffers, maxBufferCapacity));
+    }
+
+    MessagePool(const MessagePool&) = delete;
+    MessagePool& operator=(const MessagePool&) = delete;
+
+    /// @brief An empty message backed by an idle buffer, or by a new one if none is left.
+    PooledMessage acquire() {
+        ++_stats.acquired;
+        std::string buffer;
+        if (_idle.empty()) {
+            ++_stats.allocated;
+        } else {
+            buffer = std::move(_idle.back());
+            _idle.pop_back();
+        }
+        return PooledMessage(shared_from_this(), std::move(buffer));
+    }
+
+    size_t getIdleCount() const { return _idle.size(); }
+    const Stats& getStats() const { return _stats; }
+
+private:
+    friend class PooledMessage;
+
+    MessagePool(size_t maxBuffers, size_t maxBufferCapacity)
+        : _maxBuffers(maxBuffers), _maxBufferCapacity(maxBufferCapacity) {
+        _idle.reserve(maxBuffers); // Releasing never allocates
+    }
+
+    void giveBack(std::string&& buffer) {
+        if (_idle.size() == _maxBuffers || buffer.capacity() > _maxBufferCapacity) {
+            ++_stats.discarded;
+            return;
+        }
+        buffer.clear();
+        _idle.push_back(std::move(buffer));
+    }
+
+    size_t _maxBuffers;
+    size_t _maxBufferCapacity;
+    std::vector<std::string> _idle;
+    Stats _stats;
+};
+
+inline void PooledMessage::release() {
+    if (_pool) {
+        _pool->giveBack(std::move(_buffer));
+        _pool.reset();
+        _buffer = std::string();
+    }
+}
+
+#endif // MESSAGE_POOL_HPP
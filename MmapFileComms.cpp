@@ -0,0 +1,127 @@
+#include "MmapFileComms.hpp"
+#include <iostream>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MmapFileComms::MmapFileComms(size_t chunkSize)
+    : MemoryComms(chunkSize),
+      _mapping(nullptr),
+      _mappingSize(0)
+#ifdef _WIN32
+      ,
+      _file(INVALID_HANDLE_VALUE),
+      _fileMapping(NULL)
+#endif
+{
+    setSource({});
+}
+
+MmapFileComms::~MmapFileComms()
+{
+    close();
+}
+
+bool MmapFileComms::open(const std::string &path)
+{
+    close();
+
+#ifdef _WIN32
+    _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (_file == INVALID_HANDLE_VALUE)
+    {
+        std::cerr << "Error opening " << path << ": " << GetLastError() << std::endl;
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(_file, &size))
+    {
+        std::cerr << "Error getting size of " << path << ": " << GetLastError() << std::endl;
+        close();
+        return false;
+    }
+    _mappingSize = static_cast<size_t>(size.QuadPart);
+    if (_mappingSize > 0)
+    {
+        _fileMapping = CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+        _mapping = _fileMapping ? MapViewOfFile(_fileMapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (_mapping == nullptr)
+        {
+            std::cerr << "Error mapping " << path << ": " << GetLastError() << std::endl;
+            close();
+            return false;
+        }
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        std::cerr << "Error opening " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        std::cerr << "Error getting size of " << path << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    _mappingSize = static_cast<size_t>(st.st_size);
+    if (_mappingSize > 0)
+    {
+        _mapping = mmap(nullptr, _mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (_mapping == MAP_FAILED)
+        {
+            std::cerr << "Error mapping " << path << ": " << strerror(errno) << std::endl;
+            _mapping = nullptr;
+            ::close(fd);
+            return false;
+        }
+        // Replay is a front-to-back scan
+        madvise(_mapping, _mappingSize, MADV_SEQUENTIAL);
+    }
+    ::close(fd); // The mapping keeps the file contents reachable
+#endif
+
+    setSource(std::span<const std::byte>(static_cast<const std::byte *>(_mapping), _mappingSize));
+    return true;
+}
+
+void MmapFileComms::close()
+{
+    setSource({});
+#ifdef _WIN32
+    if (_mapping != nullptr)
+    {
+        UnmapViewOfFile(_mapping);
+    }
+    if (_fileMapping != NULL)
+    {
+        CloseHandle(_fileMapping);
+        _fileMapping = NULL;
+    }
+    if (_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(_file);
+        _file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (_mapping != nullptr)
+    {
+        munmap(_mapping, _mappingSize);
+    }
+#endif
+    _mapping = nullptr;
+    _mappingSize = 0;
+}
+
+bool MmapFileComms::isOpen() const
+{
+    return _mapping != nullptr && MemoryComms::isOpen();
+}
@@ -0,0 +1,61 @@
+#ifndef MMAP_FILE_COMMS_HPP
+#define MMAP_FILE_COMMS_HPP
+
+#include "MemoryComms.hpp"
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+/**
+ * @brief Serves a recorded log file through IComms by memory-mapping it.
+ *
+ * The file is never read into a heap buffer: readInto copies straight from the
+ * page cache mapping, and view() exposes the whole log for zero-copy parsing.
+ * Chunking, simulated timeouts and looping behave as in MemoryComms.
+ */
+class MmapFileComms : public MemoryComms
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param chunkSize Maximum bytes returned per read; 0 means no limit.
+     */
+    explicit MmapFileComms(size_t chunkSize = 0);
+
+    /**
+     * @brief Destructor. Unmaps the file.
+     */
+    ~MmapFileComms();
+
+    MmapFileComms(const MmapFileComms &) = delete;
+    MmapFileComms &operator=(const MmapFileComms &) = delete;
+
+    /**
+     * @brief Maps a file read-only and starts serving it from the beginning.
+     * @param path The file to map.
+     * @return True on success, false if the file could not be opened or mapped.
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Unmaps the file. Subsequent reads return no data.
+     */
+    void close();
+
+    /**
+     * @brief Open while a file is mapped and the end of it has not been reached.
+     */
+    bool isOpen() const override;
+
+private:
+    void *_mapping;
+    size_t _mappingSize;
+#ifdef _WIN32
+    HANDLE _file;
+    HANDLE _fileMapping;
+#endif
+};
+
+#endif // MMAP_FILE_COMMS_HPP
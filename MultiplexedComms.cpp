@@ -0,0 +1,177 @@
+/**
+ * @file MultiplexedComms.cpp
+ * @brief Implementation of MultiplexedComms.
+ */
+
+#include "MultiplexedComms.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+#ifndef _WIN32
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+#endif
+
+namespace {
+constexpr uint8_t kLastFragment = 0x01;
+} // namespace
+
+MultiplexedComms::MultiplexedComms() : MultiplexedComms(Options()) {}
+
+MultiplexedComms::MultiplexedComms(const Options& options, SocketBackend backend)
+    : CommsSocket(backend, kDefaultReceiveBufferSize), options(options) {
+    this->options.maxFragmentSize = std::clamp<size_t>(options.maxFragmentSize, 1, 65535);
+}
+
+void MultiplexedComms::connectToServer(const std::string& ip, int port) {
+    openConnection(ip, port);
+    partial.clear();
+    {
+        std::lock_guard<std::mutex> lock(sendMutex);
+        sendFailed = false;
+    }
+
+    // Small high-priority fragments must not wait for the ACK of bulk data in flight
+    int one = 1;
+    setsockopt(socketHandle(), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+#ifdef TCP_NOTSENT_LOWAT
+    if (options.unsentLimitBytes > 0) {
+        setsockopt(socketHandle(), IPPROTO_TCP, TCP_NOTSENT_LOWAT,
+                   reinterpret_cast<const char*>(&options.unsentLimitBytes), sizeof(options.unsentLimitBytes));
+    }
+#endif
+}
+
+void MultiplexedComms::setStreamPriority(StreamId stream, int priority) {
+    std::lock_guard<std::mutex> lock(sendMutex);
+    priorities[stream] = priority;
+}
+
+MultiplexedComms::Pending* MultiplexedComms::pickNext() {
+    Pending* best = nullptr;
+    for (size_t i = 0; i < pending.size(); ++i) {
+        Pending* candidate = pending[i];
+        // Only the oldest message of a stream may send, so each stream stays in order
+        bool queuedBehind = std::any_of(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(i),
+                                        [&](const Pending* earlier) { return earlier->stream == candidate->stream; });
+        if (queuedBehind) {
+            continue;
+        }
+        if (best == nullptr || candidate->priority > best->priority ||
+            (candidate->priority == best->priority && candidate->lastServed < best->lastServed)) {
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+void MultiplexedComms::removePending(Pending* entry) {
+    pending.erase(std::find(pending.begin(), pending.end(), entry));
+}
+
+void MultiplexedComms::sendMessage(StreamId stream, std::string_view message) {
+    std::unique_lock<std::mutex> lock(sendMutex);
+    if (sendFailed) {
+        throw std::runtime_error("Failed to send message");
+    }
+    auto priority = priorities.find(stream);
+    Pending entry {stream, priority != priorities.end() ? priority->second : 0, message};
+    entry.lastServed = ticks;
+    pending.push_back(&entry);
+
+    while (!entry.done) {
+        if (sendFailed) {
+            removePending(&entry);
+            throw std::runtime_error("Failed to send message");
+        }
+        if (writing) {
+            sendProgress.wait(lock);
+            continue;
+        }
+
+        // Write fragments, highest priority first, until this caller's message is out
+        writing = true;
+        while (!entry.done) {
+            Pending* next = pickNext();
+            size_t length = std::min(options.maxFragmentSize, next->message.size() - next->offset);
+            bool last = next->offset + length == next->message.size();
+            std::array<char, kHeaderSize> header = {static_cast<char>(next->stream >> 8), static_cast<char>(next->stream),
+                                                    static_cast<char>(last ? kLastFragment : 0),
+                                                    static_cast<char>(length >> 8), static_cast<char>(length)};
+            const char* data = next->message.data() + next->offset;
+            next->lastServed = ++ticks;
+
+            lock.unlock();
+            bool sent = true;
+            try {
+                addVector(header.data(), header.size());
+                addVector(data, length);
+                sendGathered(last ? 1 : 0);
+            } catch (const std::runtime_error&) {
+                sent = false;
+            }
+            lock.lock();
+
+            if (!sent) {
+                sendFailed = true;
+                writing = false;
+                removePending(&entry);
+                sendProgress.notify_all();
+                throw std::runtime_error("Failed to send message");
+            }
+            next->offset += length;
+            if (last) {
+                // Only now may its caller return and invalidate the message
+                next->done = true;
+                removePending(next);
+                sendProgress.notify_all();
+            }
+        }
+        writing = false;
+        sendProgress.notify_all(); // Another sender takes over
+    }
+}
+
+MultiplexedComms::StreamMessage MultiplexedComms::receiveMessage() {
+    StreamMessage result;
+    while (true) {
+        std::span<const char> input = buffered();
+        if (input.size() >= kHeaderSize) {
+            const unsigned char* header = reinterpret_cast<const unsigned char*>(input.data());
+            StreamId stream = static_cast<StreamId>((header[0] << 8) | header[1]);
+            bool last = (header[2] & kLastFragment) != 0;
+            size_t length = (size_t(header[3]) << 8) | header[4];
+            if (input.size() >= kHeaderSize + length) {
+                const char* data = input.data() + kHeaderSize;
+                auto part = partial.find(stream);
+                if (part == partial.end() && last) {
+                    result.stream = stream;
+                    result.message.assign(data, length); // The common case: a message in one fragment
+                    consume(kHeaderSize + length);
+                    return result;
+                }
+                if (part == partial.end()) {
+                    part = partial.try_emplace(stream).first;
+                }
+                std::string& message = part->second;
+                if (message.size() + length > options.maxMessageSize) {
+                    throw FrameTooLargeError(message.size() + length, options.maxMessageSize);
+                }
+                message.append(data, length);
+                consume(kHeaderSize + length);
+                if (last) {
+                    result.stream = stream;
+                    result.message = std::move(message);
+                    partial.erase(part);
+                    return result;
+                }
+                continue;
+            }
+        }
+        if (!fillReceiveBuffer()) {
+            throw std::runtime_error(input.empty() && partial.empty() ? "Connection closed"
+                                                                      : "Connection closed before a complete frame");
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/**
+ * @file MultiplexedComms.hpp
+ * @brief Several prioritised message streams over one TCP connection.
+ * @details Each message is sent on a stream id and arrives on the same stream, in order
+ * within that stream. Messages are cut into fragments of at most Options::maxFragmentSize
+ * bytes; the sender picks every fragment from the highest-priority stream with data
+ * waiting, so a small alarm goes out after at most one bulk fragment instead of after the
+ * whole bulk message. Streams of equal priority share the link fragment by fragment.
+ *
+ * sendMessage() may be called from several threads at once and returns once its message
+ * has been handed to the socket. One caller at a time does the writing, for its own
+ * message and for whatever has higher priority meanwhile, so no thread is started.
+ * receiveMessage() is for one receiving thread, which may run alongside the senders.
+ *
+ * Data the kernel has accepted but not yet sent cannot be overtaken. TCP_NOTSENT_LOWAT
+ * (Options::unsentLimitBytes, Linux and macOS) keeps that backlog small, so priorities are
+ * applied to nearly everything still waiting.
+ *
+ * Wire format per fragment: stream id (2 bytes), flags (1 byte, 0x01 on the last fragment
+ * of a message), length (2 bytes), all in network byte order, then the fragment.
+ *
+ * ## Example Usage
+ *
+ * ```cpp
+ * MultiplexedComms comms;
+ * comms.setStreamPriority(kAlarmStream, 10);
+ * comms.connectToServer("10.0.0.2", 10110);
+ * std::thread bulk([&] { while (running) comms.sendMessage(kAisStream, nextBatch()); });
+ * comms.sendMessage(kAlarmStream, alarm); // Overtakes the AIS batch in flight
+ * ```
+ */
+
+#ifndef MULTIPLEXED_COMMS_HPP
+#define MULTIPLEXED_COMMS_HPP
+
+#include "Comms.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Prioritised logical streams over one TCP connection.
+class MultiplexedComms : private CommsSocket {
+public:
+    using StreamId = uint16_t;
+    using CommsSocket::Stats;
+
+    struct Options {
+        size_t maxFragmentSize = 16 * 1024; ///< Largest fragment; at most 65535
+        int unsentLimitBytes = 16 * 1024;   ///< TCP_NOTSENT_LOWAT; 0 leaves the kernel default
+        size_t maxMessageSize = LengthPrefixCodec::kDefaultMaxFrameSize; ///< Receive limit, see FrameTooLargeError
+    };
+
+    /// @brief A received message and the stream it came on.
+    struct StreamMessage {
+        StreamId stream = 0;
+        std::string message;
+    };
+
+    /// @brief Bytes of one fragment header.
+    static constexpr size_t kHeaderSize = 5;
+
+    MultiplexedComms();
+    explicit MultiplexedComms(const Options& options, SocketBackend backend = SocketBackend::BSD);
+
+    void connectToServer(const std::string& ip, int port);
+
+    /// @brief Higher priorities are sent first; streams default to 0. Affects messages sent later.
+    void setStreamPriority(StreamId stream, int priority);
+
+    /// @brief Sends message on stream; blocks until all of it has been written to the socket.
+    /// Thread-safe. Throws std::runtime_error if the connection fails, for every waiting sender.
+    void sendMessage(StreamId stream, std::string_view message);
+
+    /// @brief Receives the next complete message on any stream.
+    /// Throws std::runtime_error when the peer closes, and FrameTooLargeError for a message
+    /// over Options::maxMessageSize.
+    StreamMessage receiveMessage();
+
+    using CommsSocket::getBufferedBytes;
+    using CommsSocket::getStats;
+
+private:
+    // A sendMessage() call in progress; lives on its caller's stack
+    struct Pending {
+        StreamId stream;
+        int priority;
+        std::string_view message;
+        size_t offset = 0;
+        uint64_t lastServed = 0; // Scheduling tick of its last fragment, for round-robin
+        bool done = false;
+    };
+
+    Options options;
+
+    std::mutex sendMutex;
+    std::condition_variable sendProgress;
+    std::vector<Pending*> pending; // In the order sendMessage() was called
+    std::unordered_map<StreamId, int> priorities;
+    bool writing = false;
+    bool sendFailed = false;
+    uint64_t ticks = 0;
+
+    // Receive side: fragments of a message not yet complete, by stream
+    std::unordered_map<StreamId, std::string> partial;
+
+    // The first pending message of the stream that should send next; called with sendMutex held
+    Pending* pickNext();
+    void removePending(Pending* entry);
+};
+
+#endif // MULTIPLEXED_COMMS_HPP
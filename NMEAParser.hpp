@@ -4,6 +4,8 @@
 #include <string>
 #include <stdexcept>
 #include <memory>
+#include <chrono>
+#include <optional>
 
 // Forward declaration for NMEAMessage base class
 class NMEAMessage
@@ -21,6 +23,8 @@ public:
     virtual MessageType getType() const = 0;
     virtual std::string toString() const = 0;
     std::string rawSentence;
+    // When the sentence's last byte reached the host, if the comms medium records it
+    std::optional<std::chrono::system_clock::time_point> receiveTime;
 };
 
 // Example derived NMEA message type
@@ -12,46 +12,91 @@ std::optional<std::shared_ptr<NMEAMessage>> NMEAReader::readAndParseSentence()
 {
     while (true)
     {
-        // 1. Try to extract a complete sentence from the buffer first
-        std::optional<std::string> nmeaSentence = extractCompleteSentence();
-        if (nmeaSentence.has_value())
+        // 1. Try to extract and parse a complete sentence from the buffer first
+        std::optional<std::shared_ptr<NMEAMessage>> message = parseBufferedSentence();
+        if (message.has_value())
         {
-            // Found a complete sentence, try to parse it
-            try
-            {
-                std::shared_ptr<NMEAMessage> message = NMEAParser::parse(nmeaSentence.value());
-                return message; // Successfully parsed a valid NMEA message
-            }
-            catch (const std::runtime_error &e)
-            {
-                // Parsing failed (e.g., invalid checksum, unknown sentence type)
-                std::cerr << "NMEA Parsing Error: " << e.what() << " for sentence: " << nmeaSentence.value() << std::endl;
-                // Continue to read more data, as this sentence was invalid
-            }
+            return message; // Successfully parsed a valid NMEA message
         }
 
         // 2. If no complete sentence or parsing failed, read more data from communication medium
-        // Changed _serialComms.readBytes to _comms.readBytes
-        std::string newData = _comms.readBytes(128, _readTimeoutMs); // Read up to 128 bytes
-
-        if (newData.empty())
+        // directly into the tail of the receive buffer (no temporary string per read)
+        if (readIntoBuffer(128, _readTimeoutMs) == 0) // Read up to 128 bytes
         {
             // No new data received within timeout, and no complete sentence in buffer
             // This could mean no data is coming, or a sentence is very long and still partial.
-            // If the buffer is empty, we truly have no data.
-            if (_receiveBuffer.empty())
+            // Either way we return nullopt to indicate no *complete* sentence was found;
+            // any partial sentence stays buffered for the next call.
+            return std::nullopt;
+        }
+        // std::cout << "Buffer after append: " << _receiveBuffer << std::endl; // Debugging
+    }
+}
+
+size_t NMEAReader::readIntoBuffer(size_t maxBytes, unsigned int timeoutMs)
+{
+    size_t oldSize = _receiveBuffer.size();
+    // resize() only reallocates while the buffer is still growing to its working size
+    _receiveBuffer.resize(oldSize + maxBytes);
+    std::span<char> tail(_receiveBuffer.data() + oldSize, maxBytes);
+    size_t received = _comms.readInto(std::as_writable_bytes(tail), timeoutMs);
+    _receiveBuffer.resize(oldSize + received);
+    if (received > 0)
+    {
+        if (std::optional<IComms::ReceiveTime> time = _comms.getLastReceiveTime())
+        {
+            _arrivals.push_back({_receiveBuffer.size(), *time});
+        }
+    }
+    return received;
+}
+
+void NMEAReader::appendData(const std::string &data)
+{
+    _receiveBuffer.append(data);
+}
+
+void NMEAReader::consumeBuffer(size_t count)
+{
+    _receiveBuffer.erase(0, count);
+    while (!_arrivals.empty() && _arrivals.front().end <= count)
+    {
+        _arrivals.pop_front();
+    }
+    for (Arrival &arrival : _arrivals)
+    {
+        arrival.end -= count;
+    }
+}
+
+std::optional<std::shared_ptr<NMEAMessage>> NMEAReader::parseBufferedSentence()
+{
+    while (true)
+    {
+        std::optional<std::string> nmeaSentence = extractCompleteSentence();
+        if (!nmeaSentence.has_value())
+        {
+            // Distinguish "rejected sentence, keep scanning" from "nothing complete buffered"
+            if (_receiveBuffer.find("\r\n") == std::string::npos)
             {
-                return std::nullopt; // No data, no sentence, nothing to do
+                return std::nullopt;
             }
-            // If buffer is not empty, it means we have a partial sentence and timed out.
-            // We can either return nullopt and wait for next call, or keep trying.
-            // For now, we return nullopt to indicate no *complete* sentence was found.
-            return std::nullopt;
+            continue;
         }
 
-        // 3. Append new data to the buffer
-        _receiveBuffer.append(newData);
-        // std::cout << "Buffer after append: " << _receiveBuffer << std::endl; // Debugging
+        // Found a complete sentence, try to parse it
+        try
+        {
+            std::shared_ptr<NMEAMessage> message = NMEAParser::parse(nmeaSentence.value());
+            message->receiveTime = _sentenceReceiveTime;
+            return message; // Successfully parsed a valid NMEA message
+        }
+        catch (const std::runtime_error &e)
+        {
+            // Parsing failed (e.g., invalid checksum, unknown sentence type)
+            std::cerr << "NMEA Parsing Error: " << e.what() << " for sentence: " << nmeaSentence.value() << std::endl;
+            // Continue with the rest of the buffer, as this sentence was invalid
+        }
     }
 }
 
@@ -64,7 +109,7 @@ std::optional<std::string> NMEAReader::extractCompleteSentence()
     {
         // No '$' found, buffer contains only garbage or partial data without a start.
         // Clear the buffer to prevent it from growing indefinitely with garbage.
-        _receiveBuffer.clear();
+        consumeBuffer(_receiveBuffer.size());
         return std::nullopt;
     }
 
@@ -72,7 +117,7 @@ std::optional<std::string> NMEAReader::extractCompleteSentence()
     if (startPos > 0)
     {
         // std::cout << "Discarding garbage: " << _receiveBuffer.substr(0, startPos) << std::endl; // Debugging
-        _receiveBuffer.erase(0, startPos);
+        consumeBuffer(startPos);
     }
 
     // Now, the buffer starts with '$'. Find the end of the sentence (CRLF).
@@ -88,8 +133,19 @@ std::optional<std::string> NMEAReader::extractCompleteSentence()
     // NMEA sentences include the '$' but not the CRLF.
     std::string completeSentence = _receiveBuffer.substr(0, endPos);
 
+    // The sentence arrived with the read that delivered its final '\n'
+    _sentenceReceiveTime.reset();
+    for (const Arrival &arrival : _arrivals)
+    {
+        if (arrival.end >= endPos + 2)
+        {
+            _sentenceReceiveTime = arrival.time;
+            break;
+        }
+    }
+
     // Remove the extracted sentence (including CRLF) from the buffer
-    _receiveBuffer.erase(0, endPos + 2); // +2 for \r\n
+    consumeBuffer(endPos + 2); // +2 for \r\n
 
     // Basic NMEA sentence validation: must contain a checksum part (*XX)
     size_t checksumDelimiterPos = completeSentence.find('*');
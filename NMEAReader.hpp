@@ -4,7 +4,9 @@
 #include "IComms.hpp" // Include the new IComms interface
 #include "NMEAParser.hpp" // Assuming NMEAParser.hpp is available
 #include <string>
+#include <span>
 #include <optional>
+#include <deque>
 #include <memory> // For std::shared_ptr
 #include <iostream> // For debugging output
 
@@ -14,6 +16,9 @@
  * This class handles buffering and extracting complete NMEA sentences from a
  * raw byte stream provided by any class implementing IComms, and then uses NMEAParser to
  * validate and parse them.
+ *
+ * If the comms medium records arrival times, each parsed message carries the arrival
+ * time of the read that delivered its final byte in NMEAMessage::receiveTime.
  */
 class NMEAReader {
 public:
@@ -38,11 +43,50 @@ public:
      */
     std::optional<std::shared_ptr<NMEAMessage>> readAndParseSentence();
 
+    /**
+     * @brief Appends raw bytes to the internal buffer without touching the comms medium.
+     *
+     * Used by callers that perform their own (e.g. asynchronous) reads and only need
+     * the framing and parsing done here.
+     *
+     * @param data The bytes received from the communication medium.
+     */
+    void appendData(const std::string &data);
+
+    /**
+     * @brief Parses the next complete sentence already held in the internal buffer.
+     *
+     * Invalid sentences are reported and skipped. No read is performed.
+     *
+     * @return An optional shared pointer to an NMEAMessage if a valid sentence
+     *         is buffered, otherwise std::nullopt.
+     */
+    std::optional<std::shared_ptr<NMEAMessage>> parseBufferedSentence();
+
+    /**
+     * @brief Reads from the communication medium straight into the internal buffer.
+     * @param maxBytes The maximum number of bytes to read.
+     * @param timeoutMs The timeout in milliseconds for the read.
+     * @return The number of bytes appended (0 on timeout, error or closed medium).
+     */
+    size_t readIntoBuffer(size_t maxBytes, unsigned int timeoutMs);
+
 private:
     IComms& _comms; // Changed from Serial_Comms& to IComms&
     unsigned int _readTimeoutMs;
     std::string _receiveBuffer; // Buffer to hold partial sentences and multiple sentences
 
+    // Arrival time of each timestamped read; `end` is the buffer offset just past its bytes
+    struct Arrival {
+        size_t end;
+        IComms::ReceiveTime time;
+    };
+    std::deque<Arrival> _arrivals; // Stays empty when the medium records no times
+    std::optional<IComms::ReceiveTime> _sentenceReceiveTime;
+
+    // Removes count bytes from the front of the buffer, keeping arrivals aligned
+    void consumeBuffer(size_t count);
+
     /**
      * @brief Attempts to extract a complete NMEA sentence from the internal buffer.
      *
@@ -1,12 +1,69 @@
 #include "NetworkComms.hpp"
+#ifndef _WIN32
+#include "TcpConnector.hpp"
+#endif
 #include <stdexcept> // For std::runtime_error
+#include <algorithm>
 #include <chrono>
 #include <thread>
+#include <cstring> // For memset, strerror
 
 #ifndef _WIN32
 #include <netdb.h> // Explicitly include for addrinfo, getaddrinfo, etc. on non-Windows
+#include <net/if.h> // For if_nametoindex
+#include <sys/uio.h> // For iovec
+#include <netinet/tcp.h> // For TCP_NODELAY, TCP_QUICKACK, TCP_CORK
+
+namespace
+{
+    // How long connect() sleeps per TcpConnector::wait(); attempts may have no deadline
+    constexpr unsigned int kConnectWaitSliceMs = 1000;
+}
 #endif
 
+#ifdef SO_TIMESTAMPNS
+namespace
+{
+    // Room for the one SCM_TIMESTAMPNS control message a receive can carry
+    constexpr size_t kTimestampControlSize = CMSG_SPACE(sizeof(struct timespec));
+
+    // Kernel arrival time from recvmsg() control data. SO_TIMESTAMPNS takes effect in the
+    // kernel some time after it is set, so early segments may carry no stamp: nullopt then,
+    // rather than a user-space time that could not be told apart from a kernel one.
+    std::optional<IComms::ReceiveTime> receiveTimeFromControl(struct msghdr &msg)
+    {
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS)
+            {
+                struct timespec ts;
+                memcpy(&ts, CMSG_DATA(cmsg), sizeof ts);
+                return IComms::ReceiveTime(std::chrono::duration_cast<IComms::ReceiveTime::duration>(
+                    std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+            }
+        }
+        return std::nullopt;
+    }
+}
+#endif
+
+struct NetworkComms::UdpBatch
+{
+    size_t maxDatagramSize;
+    std::vector<std::byte> storage;  // batchSize slots of maxDatagramSize bytes
+    std::vector<Datagram> datagrams; // Views into storage; sources are written in place
+    size_t count = 0;                // Datagrams received by the last batch
+    size_t next = 0;                 // First datagram not yet fully consumed
+    size_t offset = 0;               // Bytes of datagrams[next] already consumed
+#ifdef __linux__
+    std::vector<struct mmsghdr> messages;
+    std::vector<struct iovec> iovecs;
+#endif
+#ifdef SO_TIMESTAMPNS
+    std::vector<char> control; // One timestamp control slot per datagram
+#endif
+};
+
 #ifdef _WIN32
 // Windows-specific socket initialization
 bool NetworkComms::initSocketLayer()
@@ -34,7 +91,15 @@ void NetworkComms::cleanupSocketLayer()
 }
 #endif
 
-NetworkComms::NetworkComms() : _isOpen(false), _protocol(Protocol::TCP)
+NetworkComms::NetworkComms(size_t receiveBufferSize)
+    : _isOpen(false),
+      _protocol(Protocol::TCP),
+      _receiveBuffer(receiveBufferSize),
+      _receiveStart(0),
+      _receiveEnd(0),
+      _timestampsEnabled(false),
+      _profile(SocketProfile::Default),
+      _requestedReceiveBufferBytes(0)
 {
 #ifdef _WIN32
     _socket = INVALID_SOCKET;
@@ -62,7 +127,19 @@ bool NetworkComms::connect(const std::string &host, const std::string &port, Pro
         return false;
     }
 
+#ifndef _WIN32
+    if (protocol == Protocol::TCP)
+    {
+        // Keep the kernel's connect timeout, as the blocking connect this replaced did
+        ConnectOptions options;
+        options.attemptTimeoutMs = 0;
+        return connect(host, port, options);
+    }
+#endif
+
     _protocol = protocol;
+    _receiveStart = 0; // Drop anything left over from a previous connection
+    _receiveEnd = 0;
 
     struct addrinfo hints, *res;
     int status;
@@ -96,27 +173,19 @@ bool NetworkComms::connect(const std::string &host, const std::string &port, Pro
         }
 #endif
 
-        if (protocol == Protocol::TCP)
+        // For UDP, connect() only fixes the peer: datagrams from other senders are dropped
+        if (::connect(_socket, p->ai_addr, p->ai_addrlen) == -1)
         {
-            if (::connect(_socket, p->ai_addr, p->ai_addrlen) == -1)
-            {
 #ifdef _WIN32
-                std::cerr << "connect error: " << WSAGetLastError() << std::endl;
-                closesocket(_socket);
-                _socket = INVALID_SOCKET;
+            std::cerr << "connect error: " << WSAGetLastError() << std::endl;
+            closesocket(_socket);
+            _socket = INVALID_SOCKET;
 #else
-                std::cerr << "connect error: " << strerror(errno) << std::endl;
-                ::close(_socket);
-                _socket = -1;
+            std::cerr << "connect error: " << strerror(errno) << std::endl;
+            ::close(_socket);
+            _socket = -1;
 #endif
-                continue;
-            }
-        }
-        else
-        { // UDP - no explicit connect, just bind if needed or sendto
-            // For UDP, 'connect' sets the default destination for send/recv
-            // but doesn't establish a connection in the TCP sense.
-            // We'll treat it as connected if socket creation is successful.
+            continue;
         }
 
         _isOpen = true;
@@ -131,7 +200,100 @@ bool NetworkComms::connect(const std::string &host, const std::string &port, Pro
         return false;
     }
 
+    if (!finishOpen(protocol))
+    {
+        return false;
+    }
+
+    std::cout << "Successfully connected to " << host << ":" << port << std::endl;
+    return true;
+}
+
+bool NetworkComms::connect(const std::string &host, const std::string &port, const ConnectOptions &options)
+{
+    if (_isOpen)
+    {
+        std::cerr << "Error: Already connected." << std::endl;
+        return false;
+    }
+
+#ifdef _WIN32
+    // No non-blocking racer on Windows: fall back to trying the addresses in turn
+    (void)options;
+    return connect(host, port, Protocol::TCP);
+#else
+    TcpConnector connector(options);
+    connector.start(host, port);
+    // Every attempt ends by its own deadline or the kernel's, so this loop terminates
+    while (connector.wait(kConnectWaitSliceMs) == TcpConnector::State::Connecting)
+    {
+    }
+
+    if (connector.getState() != TcpConnector::State::Connected)
+    {
+        std::cerr << "Error: Failed to connect to " << host << ":" << port;
+        if (connector.getLastError() != 0)
+        {
+            std::cerr << " (" << strerror(connector.getLastError()) << ")";
+        }
+        std::cerr << std::endl;
+        return false;
+    }
+    if (!attach(connector.takeSocket(), Protocol::TCP))
+    {
+        return false;
+    }
+
+    std::cout << "Successfully connected to " << host << ":" << port << std::endl;
+    return true;
+#endif
+}
+
+#ifndef _WIN32
+bool NetworkComms::attach(int socket, Protocol protocol)
+{
+    if (_isOpen)
+    {
+        std::cerr << "Error: Already connected." << std::endl;
+        return false;
+    }
+    if (socket < 0)
+    {
+        return false;
+    }
+
+    _socket = socket;
+    _isOpen = true;
+    _receiveStart = 0;
+    _receiveEnd = 0;
+    return finishOpen(protocol);
+}
+#endif
+
+bool NetworkComms::finishOpen(Protocol protocol)
+{
+    _protocol = protocol;
+    _requestedReceiveBufferBytes = 0;
     // Set socket to non-blocking for readBytes timeout
+    if (!setNonBlocking() || !applyTimestampOption())
+    {
+        return false;
+    }
+    if (!applySocketProfile())
+    {
+        close(); // Otherwise the next connect() fails with "Already connected"
+        return false;
+    }
+    if (protocol == Protocol::UDP)
+    {
+        UdpReceiveOptions defaults;
+        setupUdpBatch(defaults.batchSize, defaults.maxDatagramSize);
+    }
+    return true;
+}
+
+bool NetworkComms::setNonBlocking()
+{
 #ifdef _WIN32
     u_long mode = 1; // 1 to enable non-blocking socket
     if (ioctlsocket(_socket, FIONBIO, &mode) != 0)
@@ -155,12 +317,377 @@ bool NetworkComms::connect(const std::string &host, const std::string &port, Pro
         return false;
     }
 #endif
+    return true;
+}
+
+bool NetworkComms::setReceiveTimestamps(bool enable)
+{
+#ifdef SO_TIMESTAMPNS
+    _timestampsEnabled = enable;
+    _lastReceiveTime.reset();
+    return !_isOpen || applyTimestampOption();
+#else
+    (void)enable;
+    std::cerr << "Error: Receive timestamps are not supported on this platform." << std::endl;
+    return false;
+#endif
+}
 
-    std::cout << "Successfully connected to " << host << ":" << port << std::endl;
+bool NetworkComms::applyTimestampOption()
+{
+#ifdef SO_TIMESTAMPNS
+    int enable = _timestampsEnabled ? 1 : 0;
+    if (setsockopt(_socket, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof enable) != 0)
+    {
+        std::cerr << "setsockopt(SO_TIMESTAMPNS) error: " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+#endif
+    return true;
+}
+
+bool NetworkComms::setSocketProfile(SocketProfile profile, const SocketProfileOptions &options)
+{
+    _profile = profile;
+    _profileOptions = options;
+    return !_isOpen || applySocketProfile();
+}
+
+bool NetworkComms::applySocketProfile()
+{
+    if (_profile == SocketProfile::Default)
+    {
+        return true;
+    }
+
+    bool tcp = _protocol == Protocol::TCP;
+    int one = 1;
+    int bufferBytes = _profile == SocketProfile::LowLatency ? _profileOptions.lowLatencyBufferBytes
+                                                            : _profileOptions.highThroughputBufferBytes;
+    // Buffer sizes are requests: the kernel doubles and caps them (rmem_max / wmem_max).
+    // A receive buffer the caller sized explicitly in bindUdp() is left alone.
+    if (_requestedReceiveBufferBytes == 0)
+    {
+        setsockopt(_socket, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char *>(&bufferBytes), sizeof bufferBytes);
+    }
+    setsockopt(_socket, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char *>(&bufferBytes), sizeof bufferBytes);
+
+    if (_profile == SocketProfile::LowLatency)
+    {
+        // Small writes go out at once instead of waiting for the previous segment's ACK
+        if (tcp && setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&one), sizeof one) != 0)
+        {
+            std::cerr << "setsockopt(TCP_NODELAY) error: " << strerror(errno) << std::endl;
+            return false;
+        }
+#ifdef TCP_QUICKACK
+        if (tcp)
+        {
+            setsockopt(_socket, IPPROTO_TCP, TCP_QUICKACK, &one, sizeof one);
+        }
+#endif
+#ifdef SO_BUSY_POLL
+        // Raising it above net.core.busy_read needs CAP_NET_ADMIN; skip quietly without it
+        if (_profileOptions.busyPollMicros > 0)
+        {
+            setsockopt(_socket, SOL_SOCKET, SO_BUSY_POLL, &_profileOptions.busyPollMicros,
+                       sizeof _profileOptions.busyPollMicros);
+        }
+#endif
+    }
+#ifdef TCP_CORK
+    else if (tcp && setsockopt(_socket, IPPROTO_TCP, TCP_CORK, &one, sizeof one) != 0)
+    {
+        std::cerr << "setsockopt(TCP_CORK) error: " << strerror(errno) << std::endl;
+        return false;
+    }
+#endif
+    return true;
+}
+
+bool NetworkComms::waitWritable(unsigned int timeoutMs)
+{
+    ++_stats.pollCalls;
+#ifdef _WIN32
+    WSAPOLLFD pfd;
+    pfd.fd = _socket;
+    pfd.events = POLLWRNORM;
+    pfd.revents = 0;
+    int pollResult = WSAPoll(&pfd, 1, static_cast<INT>(timeoutMs));
+#else
+    struct pollfd pfd;
+    pfd.fd = _socket;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    int pollResult = poll(&pfd, 1, static_cast<int>(timeoutMs));
+#endif
+    return pollResult > 0 && pfd.revents != 0;
+}
+
+size_t NetworkComms::write(std::span<const std::byte> data, unsigned int timeoutMs)
+{
+    if (!_isOpen)
+    {
+        return 0;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    size_t total = 0;
+    while (total < data.size())
+    {
+        ++_stats.sendCalls;
+#ifdef _WIN32
+        int sent = send(_socket, reinterpret_cast<const char *>(data.data()) + total,
+                        static_cast<int>(data.size() - total), 0);
+        bool wouldBlock = sent < 0 && WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        // MSG_NOSIGNAL: a vanished peer is an error return, not SIGPIPE
+        ssize_t sent = send(_socket, data.data() + total, data.size() - total, MSG_NOSIGNAL);
+        bool wouldBlock = sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+#endif
+        if (sent > 0)
+        {
+            total += static_cast<size_t>(sent);
+            continue;
+        }
+        if (!wouldBlock)
+        {
+#ifdef _WIN32
+            std::cerr << "send error: " << WSAGetLastError() << std::endl;
+#else
+            std::cerr << "send error: " << strerror(errno) << std::endl;
+#endif
+            closeSocket();
+            break;
+        }
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0 || !waitWritable(static_cast<unsigned int>(remaining.count())))
+        {
+            break; // Timed out with the send buffer still full
+        }
+    }
+    return total;
+}
+
+size_t NetworkComms::write(const std::string &data, unsigned int timeoutMs)
+{
+    return write(std::as_bytes(std::span<const char>(data.data(), data.size())), timeoutMs);
+}
+
+bool NetworkComms::flush()
+{
+#ifdef TCP_CORK
+    if (!_isOpen || _profile != SocketProfile::HighThroughput || _protocol != Protocol::TCP)
+    {
+        return true;
+    }
+    // Removing the cork transmits the partial segment; put it straight back for the next burst
+    int off = 0, on = 1;
+    return setsockopt(_socket, IPPROTO_TCP, TCP_CORK, &off, sizeof off) == 0 &&
+           setsockopt(_socket, IPPROTO_TCP, TCP_CORK, &on, sizeof on) == 0;
+#else
+    return true;
+#endif
+}
+
+std::optional<IComms::ReceiveTime> NetworkComms::getLastReceiveTime() const
+{
+    return _lastReceiveTime;
+}
+
+int NetworkComms::receiveOnce(char *dest, size_t length)
+{
+    ++_stats.recvCalls;
+#ifdef SO_TIMESTAMPNS
+    if (_timestampsEnabled)
+    {
+        struct iovec iov;
+        iov.iov_base = dest;
+        iov.iov_len = length;
+        alignas(struct cmsghdr) char control[kTimestampControlSize];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof msg);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof control;
+        ssize_t bytesRead = recvmsg(_socket, &msg, 0);
+        if (bytesRead > 0)
+        {
+            _lastReceiveTime = receiveTimeFromControl(msg);
+        }
+        return static_cast<int>(bytesRead);
+    }
+#endif
+    return recv(_socket, dest, static_cast<int>(length), 0);
+}
+
+bool NetworkComms::bindUdp(const std::string &port, const UdpReceiveOptions &options)
+{
+    if (_isOpen)
+    {
+        std::cerr << "Error: Already connected." << std::endl;
+        return false;
+    }
+
+    _protocol = Protocol::UDP;
+    _receiveStart = 0;
+    _receiveEnd = 0;
+
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    // A multicast listener binds the wildcard address of the group's family
+    if (!options.multicastGroup.empty() && options.bindAddress.empty())
+    {
+        hints.ai_family = options.multicastGroup.find(':') != std::string::npos ? AF_INET6 : AF_INET;
+    }
+
+    const char *node = options.bindAddress.empty() ? NULL : options.bindAddress.c_str();
+    int status = getaddrinfo(node, port.c_str(), &hints, &res);
+    if (status != 0)
+    {
+        std::cerr << "getaddrinfo error: " << gai_strerror(status) << std::endl;
+        return false;
+    }
+
+    for (struct addrinfo *p = res; p != NULL && !_isOpen; p = p->ai_next)
+    {
+        _socket = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+#ifdef _WIN32
+        if (_socket == INVALID_SOCKET)
+        {
+            std::cerr << "socket error: " << WSAGetLastError() << std::endl;
+            continue;
+        }
+#else
+        if (_socket == -1)
+        {
+            std::cerr << "socket error: " << strerror(errno) << std::endl;
+            continue;
+        }
+#endif
+
+        // Several listeners (e.g. display and logger) may share a broadcast/multicast port
+        int one = 1;
+        setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&one), sizeof one);
+        if (options.receiveBufferBytes > 0)
+        {
+            setsockopt(_socket, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char *>(&options.receiveBufferBytes),
+                       sizeof options.receiveBufferBytes);
+        }
+
+        if (bind(_socket, p->ai_addr, static_cast<int>(p->ai_addrlen)) == -1)
+        {
+#ifdef _WIN32
+            std::cerr << "bind error: " << WSAGetLastError() << std::endl;
+            closesocket(_socket);
+            _socket = INVALID_SOCKET;
+#else
+            std::cerr << "bind error: " << strerror(errno) << std::endl;
+            ::close(_socket);
+            _socket = -1;
+#endif
+            continue;
+        }
+        _isOpen = true;
+    }
+
+    freeaddrinfo(res);
+
+    if (!_isOpen)
+    {
+        std::cerr << "Error: Failed to bind UDP port " << port << std::endl;
+        return false;
+    }
+    if (!options.multicastGroup.empty() && !joinMulticastGroup(options))
+    {
+        close();
+        return false;
+    }
+    if (!setNonBlocking() || !applyTimestampOption())
+    {
+        return false;
+    }
+    _requestedReceiveBufferBytes = options.receiveBufferBytes;
+    if (!applySocketProfile())
+    {
+        close();
+        return false;
+    }
+
+    setupUdpBatch(options.batchSize, options.maxDatagramSize);
+    return true;
+}
+
+bool NetworkComms::joinMulticastGroup(const UdpReceiveOptions &options)
+{
+    struct addrinfo hints, *group;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_NUMERICHOST;
+    int status = getaddrinfo(options.multicastGroup.c_str(), NULL, &hints, &group);
+    if (status != 0)
+    {
+        std::cerr << "Invalid multicast group " << options.multicastGroup << ": " << gai_strerror(status) << std::endl;
+        return false;
+    }
+
+    int rc;
+    if (group->ai_family == AF_INET)
+    {
+        struct ip_mreq request;
+        memset(&request, 0, sizeof request);
+        request.imr_multiaddr = reinterpret_cast<sockaddr_in *>(group->ai_addr)->sin_addr;
+        request.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (!options.interfaceAddress.empty() &&
+            inet_pton(AF_INET, options.interfaceAddress.c_str(), &request.imr_interface) != 1)
+        {
+            std::cerr << "Invalid multicast interface address " << options.interfaceAddress << std::endl;
+            freeaddrinfo(group);
+            return false;
+        }
+        rc = setsockopt(_socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, reinterpret_cast<const char *>(&request), sizeof request);
+    }
+    else
+    {
+        struct ipv6_mreq request;
+        memset(&request, 0, sizeof request);
+        request.ipv6mr_multiaddr = reinterpret_cast<sockaddr_in6 *>(group->ai_addr)->sin6_addr;
+#ifdef _WIN32
+        request.ipv6mr_interface = options.interfaceAddress.empty() ? 0 : std::stoul(options.interfaceAddress);
+#else
+        request.ipv6mr_interface = options.interfaceAddress.empty() ? 0 : if_nametoindex(options.interfaceAddress.c_str());
+#endif
+        rc = setsockopt(_socket, IPPROTO_IPV6, IPV6_JOIN_GROUP, reinterpret_cast<const char *>(&request), sizeof request);
+    }
+    freeaddrinfo(group);
+
+    if (rc != 0)
+    {
+#ifdef _WIN32
+        std::cerr << "multicast join error: " << WSAGetLastError() << std::endl;
+#else
+        std::cerr << "multicast join error: " << strerror(errno) << std::endl;
+#endif
+        return false;
+    }
     return true;
 }
 
 void NetworkComms::close()
+{
+    closeSocket();
+    _receiveStart = 0;
+    _receiveEnd = 0;
+    _udp.reset();
+}
+
+void NetworkComms::closeSocket()
 {
     if (_isOpen)
     {
@@ -176,94 +703,452 @@ void NetworkComms::close()
     }
 }
 
-std::string NetworkComms::readBytes(size_t numBytes, unsigned int timeoutMs)
+bool NetworkComms::waitReadable(unsigned int timeoutMs)
 {
-    if (!_isOpen)
+    // poll() rather than select(): select() cannot watch descriptors >= FD_SETSIZE
+    ++_stats.pollCalls;
+#ifdef _WIN32
+    WSAPOLLFD pfd;
+    pfd.fd = _socket;
+    pfd.events = POLLRDNORM;
+    pfd.revents = 0;
+    int pollResult = WSAPoll(&pfd, 1, static_cast<INT>(timeoutMs));
+#else
+    struct pollfd pfd;
+    pfd.fd = _socket;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int pollResult = poll(&pfd, 1, static_cast<int>(timeoutMs));
+#endif
+
+    if (pollResult == -1)
+    {
+#ifdef _WIN32
+        std::cerr << "poll error: " << WSAGetLastError() << std::endl;
+#else
+        if (errno == EINTR)
+        {
+            return false; // Interrupted: report a timeout, the caller retries
+        }
+        std::cerr << "poll error: " << strerror(errno) << std::endl;
+#endif
+        closeSocket(); // Close connection on poll error
+        return false;
+    }
+
+    // pollResult == 0 means timeout. POLLHUP/POLLERR also count as readable so
+    // the following recv() observes the close or error.
+    return pollResult > 0 && pfd.revents != 0;
+}
+
+bool NetworkComms::handleRecvError()
+{
+#ifdef _WIN32
+    int error = WSAGetLastError();
+    if (error == WSAEWOULDBLOCK)
+    {
+        // No more data immediately available
+        return true;
+    }
+    std::cerr << "recv error: " << error << std::endl;
+#else
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+    {
+        // No more data immediately available
+        return true;
+    }
+    std::cerr << "recv error: " << strerror(errno) << std::endl;
+#endif
+    closeSocket(); // Close connection on recv error
+    return false;
+}
+
+size_t NetworkComms::takeBuffered(std::span<std::byte> buffer)
+{
+    size_t n = std::min(buffer.size(), _receiveEnd - _receiveStart);
+    if (n > 0)
+    {
+        memcpy(buffer.data(), _receiveBuffer.data() + _receiveStart, n);
+        _receiveStart += n;
+        if (_receiveStart == _receiveEnd)
+        {
+            _receiveStart = 0;
+            _receiveEnd = 0;
+        }
+    }
+    return n;
+}
+
+size_t NetworkComms::receiveDirect(std::span<std::byte> buffer)
+{
+    // Receive straight into the destination until it is full or the socket is drained.
+    size_t total = 0;
+    while (total < buffer.size())
+    {
+        char *dest = reinterpret_cast<char *>(buffer.data()) + total;
+        int bytesRead = receiveOnce(dest, buffer.size() - total);
+        if (bytesRead > 0)
+        {
+            total += static_cast<size_t>(bytesRead);
+            if (total < buffer.size())
+            {
+                break; // Short read: nothing more queued, skip the EAGAIN round trip
+            }
+        }
+        else if (bytesRead == 0)
+        {
+            // Connection closed by peer
+            std::cerr << "Network connection closed by peer." << std::endl;
+            closeSocket();
+            break;
+        }
+        else
+        {
+            handleRecvError();
+            break;
+        }
+    }
+
+    if (total > 0)
+    {
+        rearmQuickAck();
+    }
+    return total;
+}
+
+void NetworkComms::rearmQuickAck()
+{
+#ifdef TCP_QUICKACK
+    if (_isOpen && _profile == SocketProfile::LowLatency && _protocol == Protocol::TCP)
+    {
+        // The kernel drops back to delayed ACKs after a while; keep acknowledging at once
+        int one = 1;
+        setsockopt(_socket, IPPROTO_TCP, TCP_QUICKACK, &one, sizeof one);
+    }
+#endif
+}
+
+size_t NetworkComms::readInto(std::span<std::byte> buffer, unsigned int timeoutMs)
+{
+    if (buffer.empty())
+    {
+        return 0;
+    }
+
+    if (_udp)
+    {
+        // Datagram payloads are handed out back to back; NMEA framing restores sentences
+        if (getBufferedBytes() == 0 && receiveDatagramBatch(timeoutMs) == 0)
+        {
+            return 0;
+        }
+        return takeDatagramBytes(buffer);
+    }
+
+    // Serve earlier bulk reads from memory first; never wait while data is buffered
+    if (_receiveEnd > _receiveStart)
     {
-        // std::cerr << "Error: Network not connected. Cannot read bytes." << std::endl;
-        return "";
+        return takeBuffered(buffer);
     }
 
-    std::string receivedData;
-    receivedData.reserve(numBytes);
-    char buffer[1]; // Read one byte at a time for simplicity, can optimize with larger buffer
+    if (!_isOpen || !waitReadable(timeoutMs))
+    {
+        return 0;
+    }
 
-    fd_set readSet;
-    struct timeval tv;
+    if (buffer.size() >= _receiveBuffer.size())
+    {
+        return receiveDirect(buffer); // Large reads gain nothing from staging
+    }
 
-    FD_ZERO(&readSet);
-    FD_SET(_socket, &readSet);
+    _receiveEnd = receiveDirect(_receiveBuffer);
+    return takeBuffered(buffer);
+}
 
-    tv.tv_sec = timeoutMs / 1000;
-    tv.tv_usec = (timeoutMs % 1000) * 1000;
+size_t NetworkComms::readIntoScatter(std::span<const std::span<std::byte>> buffers, unsigned int timeoutMs)
+{
+#ifdef _WIN32
+    return IComms::readIntoScatter(buffers, timeoutMs);
+#else
+    if (buffers.empty())
+    {
+        return 0;
+    }
 
-    int selectResult = select(static_cast<int>(_socket) + 1, &readSet, NULL, NULL, &tv);
+    if (_udp)
+    {
+        return IComms::readIntoScatter(buffers, timeoutMs);
+    }
 
-    if (selectResult == -1)
+    // Buffered bytes come first; the base implementation drains them without waiting
+    if (_receiveEnd > _receiveStart)
     {
+        return IComms::readIntoScatter(buffers, 0);
+    }
+
+    if (!_isOpen)
+    {
+        return 0;
+    }
+
+    struct iovec iov[kMaxScatterBuffers];
+    size_t count = 0;
+    for (const std::span<std::byte> &buffer : buffers)
+    {
+        if (count == kMaxScatterBuffers)
+        {
+            break;
+        }
+        iov[count].iov_base = buffer.data();
+        iov[count].iov_len = buffer.size();
+        ++count;
+    }
+
+    if (!waitReadable(timeoutMs))
+    {
+        return 0;
+    }
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+#ifdef SO_TIMESTAMPNS
+    alignas(struct cmsghdr) char control[kTimestampControlSize];
+    if (_timestampsEnabled)
+    {
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof control;
+    }
+#endif
+
+    ++_stats.recvCalls;
+    ssize_t bytesRead = recvmsg(_socket, &msg, 0);
+    if (bytesRead > 0)
+    {
+#ifdef SO_TIMESTAMPNS
+        if (_timestampsEnabled)
+        {
+            _lastReceiveTime = receiveTimeFromControl(msg);
+        }
+#endif
+        rearmQuickAck();
+        return static_cast<size_t>(bytesRead);
+    }
+    if (bytesRead == 0)
+    {
+        std::cerr << "Network connection closed by peer." << std::endl;
+        closeSocket();
+        return 0;
+    }
+    handleRecvError();
+    return 0;
+#endif
+}
+
+bool NetworkComms::isOpen() const
+{
+    return _isOpen || getBufferedBytes() > 0;
+}
+
+int NetworkComms::getPollDescriptor() const
+{
 #ifdef _WIN32
-        std::cerr << "select error: " << WSAGetLastError() << std::endl;
+    return -1;
 #else
-        std::cerr << "select error: " << strerror(errno) << std::endl;
+    return _isOpen ? _socket : -1;
 #endif
-        close(); // Close connection on select error
-        return "";
+}
+
+size_t NetworkComms::getBufferedBytes() const
+{
+    if (_udp)
+    {
+        size_t total = 0;
+        for (size_t i = _udp->next; i < _udp->count; ++i)
+        {
+            total += _udp->datagrams[i].payload.size();
+        }
+        return total - _udp->offset;
+    }
+    return _receiveEnd - _receiveStart;
+}
+
+int NetworkComms::getSocketReceiveBufferSize() const
+{
+    if (!_isOpen)
+    {
+        return 0;
     }
-    else if (selectResult == 0)
+    int size = 0;
+    socklen_t length = sizeof size;
+    if (getsockopt(_socket, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<char *>(&size), &length) != 0)
     {
-        // Timeout, no data available
-        return "";
+        return 0;
     }
+    return size;
+}
 
-    // Data is available, attempt to read
-    if (FD_ISSET(_socket, &readSet))
+void NetworkComms::setupUdpBatch(unsigned int batchSize, size_t maxDatagramSize)
+{
+    batchSize = std::max(batchSize, 1u);
+    _udp = std::make_unique<UdpBatch>();
+    _udp->maxDatagramSize = maxDatagramSize;
+    _udp->storage.resize(batchSize * maxDatagramSize);
+    _udp->datagrams.resize(batchSize);
+#ifdef __linux__
+    // The headers point at fixed slots, so they are built once and reused by every recvmmsg
+    _udp->messages.resize(batchSize);
+    _udp->iovecs.resize(batchSize);
+    for (unsigned int i = 0; i < batchSize; ++i)
     {
-        // Read up to numBytes, or until no more data is immediately available
-        // This loop is to drain as much data as possible within the non-blocking context
-        // without waiting for another select timeout.
-        while (receivedData.length() < numBytes)
+        _udp->iovecs[i].iov_base = _udp->storage.data() + i * maxDatagramSize;
+        _udp->iovecs[i].iov_len = maxDatagramSize;
+        memset(&_udp->messages[i], 0, sizeof(struct mmsghdr));
+        _udp->messages[i].msg_hdr.msg_iov = &_udp->iovecs[i];
+        _udp->messages[i].msg_hdr.msg_iovlen = 1;
+        _udp->messages[i].msg_hdr.msg_name = &_udp->datagrams[i].source;
+    }
+#endif
+#ifdef SO_TIMESTAMPNS
+    _udp->control.resize(batchSize * kTimestampControlSize);
+#endif
+}
+
+size_t NetworkComms::receiveDatagramBatch(unsigned int timeoutMs)
+{
+    UdpBatch &batch = *_udp;
+    batch.count = 0;
+    batch.next = 0;
+    batch.offset = 0;
+
+    if (!_isOpen || !waitReadable(timeoutMs))
+    {
+        return 0;
+    }
+
+#ifdef __linux__
+    for (struct mmsghdr &message : batch.messages)
+    {
+        message.msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+        message.msg_hdr.msg_flags = 0;
+    }
+    if (_timestampsEnabled)
+    {
+        // The kernel shrinks msg_controllen to what it wrote, so reset it every batch
+        for (size_t i = 0; i < batch.messages.size(); ++i)
         {
-            int bytesRead = recv(_socket, buffer, 1, 0);
-            if (bytesRead > 0)
-            {
-                receivedData += buffer[0];
-            }
-            else if (bytesRead == 0)
-            {
-                // Connection closed by peer
-                std::cerr << "Network connection closed by peer." << std::endl;
-                close();
-                break;
-            }
-            else
-            {
-                // bytesRead < 0
+            batch.messages[i].msg_hdr.msg_control = batch.control.data() + i * kTimestampControlSize;
+            batch.messages[i].msg_hdr.msg_controllen = kTimestampControlSize;
+        }
+    }
+    ++_stats.recvCalls;
+    int received = recvmmsg(_socket, batch.messages.data(), static_cast<unsigned int>(batch.messages.size()), MSG_DONTWAIT, nullptr);
+    if (received < 0)
+    {
+        if (errno != ECONNREFUSED) // ICMP error from a connected peer: keep listening
+        {
+            handleRecvError();
+        }
+        return 0;
+    }
+    for (int i = 0; i < received; ++i)
+    {
+        Datagram &datagram = batch.datagrams[i];
+        size_t length = std::min<size_t>(batch.messages[i].msg_len, batch.maxDatagramSize);
+        datagram.payload = std::span<const std::byte>(batch.storage.data() + i * batch.maxDatagramSize, length);
+        datagram.truncated = (batch.messages[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+        datagram.receiveTime.reset();
+        if (_timestampsEnabled)
+        {
+            datagram.receiveTime = receiveTimeFromControl(batch.messages[i].msg_hdr);
+        }
+    }
+    batch.count = static_cast<size_t>(received);
+#else
+    // No recvmmsg: one recvfrom per datagram until the socket is drained or the batch is full
+    while (batch.count < batch.datagrams.size())
+    {
+        Datagram &datagram = batch.datagrams[batch.count];
+        char *slot = reinterpret_cast<char *>(batch.storage.data() + batch.count * batch.maxDatagramSize);
+        socklen_t sourceLength = sizeof(sockaddr_storage);
+        ++_stats.recvCalls;
+        int length = recvfrom(_socket, slot, static_cast<int>(batch.maxDatagramSize), 0,
+                              reinterpret_cast<sockaddr *>(&datagram.source), &sourceLength);
 #ifdef _WIN32
-                int error = WSAGetLastError();
-                if (error == WSAEWOULDBLOCK)
-                {
-                    // No more data immediately available
-                    break;
-                }
-                std::cerr << "recv error: " << error << std::endl;
+        bool truncated = length < 0 && WSAGetLastError() == WSAEMSGSIZE;
+        if (truncated)
+        {
+            length = static_cast<int>(batch.maxDatagramSize);
+        }
 #else
-                if (errno == EAGAIN || errno == EWOULDBLOCK)
-                {
-                    // No more data immediately available
-                    break;
-                }
-                std::cerr << "recv error: " << strerror(errno) << std::endl;
-#endif
-                close(); // Close connection on recv error
-                break;
+        bool truncated = false; // Not detectable without MSG_TRUNC reporting
+#endif
+        if (length < 0)
+        {
+            if (batch.count == 0)
+            {
+                handleRecvError();
             }
+            break;
+        }
+        datagram.payload = std::span<const std::byte>(reinterpret_cast<std::byte *>(slot), static_cast<size_t>(length));
+        datagram.truncated = truncated;
+        datagram.receiveTime.reset();
+        ++batch.count;
+    }
+#endif
+
+    for (size_t i = 0; i < batch.count; ++i)
+    {
+        if (batch.datagrams[i].truncated)
+        {
+            ++_stats.truncatedDatagrams;
         }
     }
+    _stats.datagrams += batch.count;
+    return batch.count;
+}
 
-    return receivedData;
+size_t NetworkComms::takeDatagramBytes(std::span<std::byte> buffer)
+{
+    UdpBatch &batch = *_udp;
+    size_t copied = 0;
+    while (batch.next < batch.count && copied < buffer.size())
+    {
+        std::span<const std::byte> payload = batch.datagrams[batch.next].payload.subspan(batch.offset);
+        size_t n = std::min(payload.size(), buffer.size() - copied);
+        memcpy(buffer.data() + copied, payload.data(), n);
+        copied += n;
+        batch.offset += n;
+        _lastReceiveTime = batch.datagrams[batch.next].receiveTime;
+        if (batch.offset == batch.datagrams[batch.next].payload.size())
+        {
+            ++batch.next;
+            batch.offset = 0;
+        }
+    }
+    return copied;
 }
 
-bool NetworkComms::isOpen() const
+std::span<const NetworkComms::Datagram> NetworkComms::readDatagrams(unsigned int timeoutMs)
 {
-    return _isOpen;
+    if (!_udp)
+    {
+        return {};
+    }
+
+    UdpBatch &batch = *_udp;
+    if (batch.next >= batch.count && receiveDatagramBatch(timeoutMs) == 0)
+    {
+        return {};
+    }
+
+    // Drop the part of a datagram already handed out through readInto()
+    Datagram &first = batch.datagrams[batch.next];
+    first.payload = first.payload.subspan(batch.offset);
+    std::span<const Datagram> result(batch.datagrams.data() + batch.next, batch.count - batch.next);
+    batch.next = batch.count;
+    batch.offset = 0;
+    return result;
 }
@@ -2,6 +2,8 @@
 #define NETWORK_COMMS_HPP
 
 #include "IComms.hpp"
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <iostream>
 #include <vector>
@@ -19,12 +21,27 @@
     #include <unistd.h>
     #include <fcntl.h>
     #include <errno.h>
-    #include <sys/select.h>
+    #include <poll.h>
 #endif
 
 /**
  * @brief Implements IComms for network (TCP/UDP) communication.
- * Currently supports TCP client connections.
+ * Supports TCP client connections and UDP receive (unicast, broadcast, multicast).
+ *
+ * Small reads are served from a per-connection receive buffer that is refilled with
+ * one large recv() at a time, so reading a TCP segment sentence by sentence costs a
+ * single syscall. Reads at least as large as the buffer bypass it. Readiness is
+ * checked with poll(), which unlike select() works for any descriptor number.
+ *
+ * UDP sockets receive in batches into a preallocated datagram array (one recvmmsg()
+ * per batch on Linux). readDatagrams() exposes each datagram with its sender, while
+ * the IComms read functions return the payloads back to back as a byte stream.
+ *
+ * With setReceiveTimestamps(true) the kernel stamps each received segment or datagram
+ * (SO_TIMESTAMPNS, Linux); the time is reported per datagram and by getLastReceiveTime(),
+ * and NMEAReader attaches it to each parsed message. The option takes effect in the kernel
+ * shortly after it is set; data received before then has no time (std::nullopt), never a
+ * user-space substitute. When disabled the read path is unchanged.
  */
 class NetworkComms : public IComms {
 public:
@@ -33,13 +50,65 @@ public:
      */
     enum class Protocol {
         TCP,
-        UDP // Not implemented yet, but for future expansion
+        UDP
+    };
+
+    /**
+     * @brief Socket tuning applied whenever a socket is opened.
+     */
+    enum class SocketProfile {
+        Default,       ///< Kernel defaults
+        LowLatency,    ///< TCP_NODELAY, TCP_QUICKACK, SO_BUSY_POLL where permitted, small socket buffers
+        HighThroughput ///< Large SO_RCVBUF/SO_SNDBUF, TCP_CORK so small writes leave as full segments
+    };
+
+    /// @brief Sizes used by the socket profiles.
+    struct SocketProfileOptions {
+        int lowLatencyBufferBytes = 32 * 1024;           ///< SO_RCVBUF/SO_SNDBUF for LowLatency
+        int highThroughputBufferBytes = 4 * 1024 * 1024; ///< SO_RCVBUF/SO_SNDBUF for HighThroughput (capped by the kernel)
+        int busyPollMicros = 50;                         ///< SO_BUSY_POLL for LowLatency; 0 disables
+    };
+
+    /// @brief Syscall counters for profiling the read path.
+    struct Stats {
+        uint64_t pollCalls = 0;          ///< Readiness waits issued
+        uint64_t recvCalls = 0;          ///< recv()/recvmsg()/recvmmsg() calls issued
+        uint64_t sendCalls = 0;          ///< send() calls issued by write()
+        uint64_t datagrams = 0;          ///< UDP datagrams received
+        uint64_t truncatedDatagrams = 0; ///< UDP datagrams larger than maxDatagramSize
+    };
+
+    /// @brief Settings for bindUdp().
+    struct UdpReceiveOptions {
+        std::string bindAddress;      ///< Local address to bind; empty binds the wildcard address
+        std::string multicastGroup;   ///< Group to join; empty for unicast/broadcast only
+        std::string interfaceAddress; ///< Interface for the group: IPv4 address, or interface name for IPv6
+        int receiveBufferBytes = 0;   ///< SO_RCVBUF request, kept over the socket profile's; 0 keeps the default
+        unsigned int batchSize = 64;  ///< Datagrams received per syscall
+        size_t maxDatagramSize = 2048; ///< Larger datagrams are truncated (and counted)
+    };
+
+    /// @brief One received UDP datagram. The payload stays valid until the next read.
+    struct Datagram {
+        std::span<const std::byte> payload;
+        sockaddr_storage source;
+        bool truncated;
+        std::optional<ReceiveTime> receiveTime; ///< Kernel arrival time, if timestamps are enabled
+    };
+
+    /// @brief Settings for racing a host's addresses in connect() (TCP, POSIX).
+    struct ConnectOptions {
+        unsigned int attemptDelayMs = 250;    ///< Head start of each attempt before the next address is tried
+        /// Each attempt is abandoned after this long; 0 leaves it to the kernel's connect
+        /// timeout (SYN retries, about two minutes on Linux), for slow links such as satellite
+        unsigned int attemptTimeoutMs = 3000;
     };
 
     /**
      * @brief Constructor for NetworkComms.
+     * @param receiveBufferSize Size of the per-connection receive buffer in bytes.
      */
-    NetworkComms();
+    explicit NetworkComms(size_t receiveBufferSize = kDefaultReceiveBufferSize);
 
     /**
      * @brief Destructor. Closes the connection.
@@ -48,6 +117,9 @@ public:
 
     /**
      * @brief Establishes a connection to a remote host.
+     * TCP races the host's addresses as the ConnectOptions overload does, but with no
+     * per-attempt deadline: as with a blocking connect, an attempt only fails when the
+     * kernel gives up, however slow the handshake.
      * @param host The hostname or IP address to connect to.
      * @param port The port number to connect to.
      * @param protocol The network protocol to use (TCP or UDP).
@@ -56,25 +128,156 @@ public:
     bool connect(const std::string& host, const std::string& port, Protocol protocol = Protocol::TCP);
 
     /**
-     * @brief Closes the network connection.
+     * @brief Connects over TCP, racing all addresses of host with non-blocking connects.
+     * An unreachable address costs at most options.attemptDelayMs before the next one is
+     * tried, and the call gives up once every attempt has failed or timed out (see TcpConnector).
+     * @param host The hostname or IP address to connect to.
+     * @param port The port number to connect to.
+     * @param options Attempt stagger and per-attempt deadline.
+     * @return True if connection is successful, false otherwise.
+     */
+    bool connect(const std::string& host, const std::string& port, const ConnectOptions& options);
+
+#ifndef _WIN32
+    /**
+     * @brief Takes over an already connected socket, e.g. one established by TcpConnector.
+     * @param socket The connected descriptor; it is closed by close() / the destructor.
+     * @param protocol The protocol of the socket.
+     * @return True on success, false if already open or the socket is invalid.
+     */
+    bool attach(int socket, Protocol protocol = Protocol::TCP);
+#endif
+
+    /**
+     * @brief Opens a UDP socket that receives datagrams sent to a local port.
+     * Broadcasts are received when bound to the wildcard address; set
+     * options.multicastGroup to also join a multicast group (IEC 61162-450 style).
+     * @param port The local port to listen on.
+     * @param options Bind address, multicast group, socket buffer and batch settings.
+     * @return True on success, false otherwise.
+     */
+    bool bindUdp(const std::string& port, const UdpReceiveOptions& options);
+    bool bindUdp(const std::string& port) { return bindUdp(port, UdpReceiveOptions()); }
+
+    /**
+     * @brief Returns the next batch of UDP datagrams, keeping message boundaries.
+     * Datagrams left over from a partial readInto() are returned first (minus the
+     * bytes already consumed); otherwise waits up to timeoutMs and receives a new batch.
+     * @param timeoutMs The timeout in milliseconds to wait for the first datagram.
+     * @return The datagrams, valid until the next read call. Empty on timeout, error or for TCP.
+     */
+    std::span<const Datagram> readDatagrams(unsigned int timeoutMs);
+
+    /**
+     * @brief Enables or disables kernel receive timestamps (SO_TIMESTAMPNS).
+     * May be called before or after connecting; the setting is kept across reconnects.
+     * @param enable True to record arrival times.
+     * @return True if the platform supports it and the socket accepted the option.
+     */
+    bool setReceiveTimestamps(bool enable);
+
+    /**
+     * @brief Selects the socket tuning for this connection.
+     * May be called before or after connecting; the profile is kept across reconnects.
+     * Options the platform or the process's privileges do not allow (SO_BUSY_POLL
+     * needs CAP_NET_ADMIN to exceed the system default) are skipped.
+     * With LowLatency, TCP_QUICKACK is re-armed after every receive because the kernel
+     * clears it. With HighThroughput, write() data is held until a segment fills; call
+     * flush() at the end of a burst.
+     * @param profile The profile to apply.
+     * @param options Buffer sizes and busy-poll budget used by the profiles.
+     * @return False if the open socket rejected a required option (TCP_NODELAY, TCP_CORK).
+     */
+    bool setSocketProfile(SocketProfile profile, const SocketProfileOptions& options);
+    bool setSocketProfile(SocketProfile profile) { return setSocketProfile(profile, SocketProfileOptions()); }
+
+    /// @brief The profile set by setSocketProfile().
+    SocketProfile getSocketProfile() const { return _profile; }
+
+    /**
+     * @brief Sends data to the peer (TCP, or a connected UDP socket).
+     * Waits up to timeoutMs in total for the socket to accept all of it.
+     * @param data The bytes to send.
+     * @param timeoutMs The timeout in milliseconds while the send buffer is full.
+     * @return The number of bytes sent; less than data.size() on timeout or error.
+     */
+    size_t write(std::span<const std::byte> data, unsigned int timeoutMs);
+    size_t write(const std::string& data, unsigned int timeoutMs);
+
+    /**
+     * @brief Pushes out data held back by TCP_CORK (HighThroughput profile).
+     * A no-op for the other profiles.
+     * @return True on success.
+     */
+    bool flush();
+
+    /**
+     * @brief Returns the kernel arrival time of the data handed out by the most recent read.
+     * For TCP this is the time of the latest segment consumed by the recv that supplied it.
+     * @return The arrival time, or std::nullopt if timestamps are disabled or nothing was read.
+     */
+    std::optional<ReceiveTime> getLastReceiveTime() const override;
+
+    /**
+     * @brief Returns the socket receive buffer size actually granted by the kernel.
+     * @return SO_RCVBUF in bytes, or 0 if not open.
+     */
+    int getSocketReceiveBufferSize() const;
+
+    /**
+     * @brief Closes the network connection and discards any buffered data.
      */
     void close();
 
     /**
-     * @brief Reads a specified number of bytes from the network with a timeout.
-     * @param numBytes The maximum number of bytes to attempt to read.
+     * @brief Reads available bytes into the caller's buffer.
+     * Bytes already in the receive buffer are returned without a syscall. Otherwise
+     * waits up to timeoutMs for the socket to become readable and receives in bulk:
+     * into the receive buffer for small reads, or directly into the caller's buffer.
+     * @param buffer Destination memory.
      * @param timeoutMs The timeout in milliseconds for the read operation.
-     * @return A string containing the bytes read. Returns an empty string if no data
-     *         is available within the timeout or an error occurs.
+     * @return The number of bytes received. Returns 0 if no data is available within
+     *         the timeout or an error occurs.
      */
-    std::string readBytes(size_t numBytes, unsigned int timeoutMs) override;
+    size_t readInto(std::span<std::byte> buffer, unsigned int timeoutMs) override;
 
     /**
-     * @brief Checks if the network connection is currently open.
+     * @brief Scatter read: fills several buffers with a single recvmsg call.
+     * At most kMaxScatterBuffers buffers are used per call.
+     * @param buffers Destination buffers, filled in order.
+     * @param timeoutMs The timeout in milliseconds for the read operation.
+     * @return The total number of bytes received.
+     */
+    size_t readIntoScatter(std::span<const std::span<std::byte>> buffers, unsigned int timeoutMs) override;
+
+    /**
+     * @brief Checks if the network connection is open or buffered data remains.
+     * After the peer closes, stays open until data received before the close has been read.
+     * A UDP socket stays open until close().
      * @return True if open, false otherwise.
      */
     bool isOpen() const override;
 
+    /// @brief Maximum number of buffers consumed by one readIntoScatter call.
+    static constexpr size_t kMaxScatterBuffers = 16;
+
+    /// @brief Default size of the per-connection receive buffer.
+    static constexpr size_t kDefaultReceiveBufferSize = 64 * 1024;
+
+    /**
+     * @brief Returns the connected socket for readiness polling.
+     * @return The socket descriptor, or -1 if not connected (always -1 on Windows).
+     */
+    int getPollDescriptor() const override;
+
+    /**
+     * @brief Returns the number of received bytes waiting in the receive buffer.
+     */
+    size_t getBufferedBytes() const override;
+
+    /// @brief Returns syscall counters since construction.
+    const Stats& getStats() const { return _stats; }
+
 private:
 #ifdef _WIN32
     SOCKET _socket;
@@ -84,6 +287,54 @@ private:
     bool _isOpen;
     Protocol _protocol;
 
+    // Received but not yet consumed bytes live in [_receiveStart, _receiveEnd)
+    std::vector<std::byte> _receiveBuffer;
+    size_t _receiveStart;
+    size_t _receiveEnd;
+    Stats _stats;
+    bool _timestampsEnabled;
+    std::optional<ReceiveTime> _lastReceiveTime;
+    SocketProfile _profile;
+    SocketProfileOptions _profileOptions;
+    int _requestedReceiveBufferBytes; // From UdpReceiveOptions; the profile does not override it
+
+    // Preallocated datagram array and syscall headers, only present for UDP sockets
+    struct UdpBatch;
+    std::unique_ptr<UdpBatch> _udp;
+
+    // Finishes opening _socket: non-blocking mode, timestamps, UDP batch
+    bool finishOpen(Protocol protocol);
+    // Sets the socket non-blocking; closes it on failure
+    bool setNonBlocking();
+    // Applies _timestampsEnabled to the open socket
+    bool applyTimestampOption();
+    // Applies _profile to the open socket
+    bool applySocketProfile();
+    // Waits up to timeoutMs for room in the send buffer
+    bool waitWritable(unsigned int timeoutMs);
+    // Re-enables TCP_QUICKACK after a receive (LowLatency profile)
+    void rearmQuickAck();
+    // One recv(), or recvmsg() collecting the arrival time when timestamps are enabled
+    int receiveOnce(char* dest, size_t length);
+    // Allocates the datagram batch for a freshly opened UDP socket
+    void setupUdpBatch(unsigned int batchSize, size_t maxDatagramSize);
+    // Joins options.multicastGroup on the bound socket
+    bool joinMulticastGroup(const UdpReceiveOptions& options);
+    // Waits, then receives up to one batch of datagrams; returns the count received
+    size_t receiveDatagramBatch(unsigned int timeoutMs);
+    // Copies undelivered datagram payloads back to back into buffer
+    size_t takeDatagramBytes(std::span<std::byte> buffer);
+    // Closes the socket but keeps buffered data readable (peer close, errors)
+    void closeSocket();
+    // Copies buffered bytes into buffer; returns the count copied
+    size_t takeBuffered(std::span<std::byte> buffer);
+    // Receives directly into buffer until full or drained; returns the count received
+    size_t receiveDirect(std::span<std::byte> buffer);
+    // Waits up to timeoutMs for the socket to become readable; closes on error
+    bool waitReadable(unsigned int timeoutMs);
+    // Reports a recv() failure; returns true if it was only "no data right now"
+    bool handleRecvError();
+
     // Helper for platform-specific socket initialization
     bool initSocketLayer();
     // Helper for platform-specific socket cleanup
@@ -0,0 +1,249 @@
+/**
+ * @file RequestClient.cpp
+ * @brief Implementation of RequestClient.
+ */
+
+#include "RequestClient.hpp"
+#include <array>
+
+namespace {
+
+constexpr size_t kIdSize = 4;
+
+void putBigEndian32(char* out, uint32_t value) {
+    out[0] = static_cast<char>(value >> 24);
+    out[1] = static_cast<char>(value >> 16);
+    out[2] = static_cast<char>(value >> 8);
+    out[3] = static_cast<char>(value);
+}
+
+} // namespace
+
+RequestClient::RequestClient(size_t maxFrameSize, SocketBackend backend)
+    : CommsSocket(backend, kDefaultReceiveBufferSize), codec(maxFrameSize) {}
+
+RequestClient::~RequestClient() {
+    stopReceiver();
+    failAll();
+}
+
+void RequestClient::connectToServer(const std::string& ip, int port) {
+    stopReceiver();
+    failAll(); // Replies to requests on the previous connection can no longer arrive
+    openConnection(ip, port);
+    codec.reset();
+    {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        connected = true;
+    }
+    receiver = std::thread([this] { receiveReplies(); });
+}
+
+RequestClient::RequestId RequestClient::send(std::string_view request, Callback onReply,
+                                             std::chrono::milliseconds timeout) {
+    RequestId id;
+    {
+        // Registered before sending: the reply may arrive before send() returns
+        std::lock_guard<std::mutex> lock(tableMutex);
+        if (!connected) {
+            throw std::runtime_error("Not connected");
+        }
+        id = nextId++;
+        Clock::time_point deadline = Clock::now() + timeout;
+        pending.emplace(id, Pending {std::move(onReply), deadline});
+        deadlines.emplace(deadline, id);
+        ++stats.requests;
+    }
+
+    std::array<char, LengthPrefixCodec::kMaxHeader + kIdSize> header;
+    putBigEndian32(header.data(), static_cast<uint32_t>(kIdSize + request.size()));
+    putBigEndian32(header.data() + LengthPrefixCodec::kMaxHeader, id);
+    try {
+        std::lock_guard<std::mutex> lock(sendMutex);
+        if (isCoalescing()) {
+            queueBuffer().append(header.data(), header.size()).append(request);
+            queueMessage();
+        } else {
+            addVector(header.data(), header.size());
+            addVector(request.data(), request.size());
+            sendGathered(1);
+        }
+    } catch (const std::runtime_error&) {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        pending.erase(id);
+        throw;
+    }
+    return id;
+}
+
+std::future<std::string> RequestClient::request(std::string_view request, std::chrono::milliseconds timeout) {
+    // Shared: Callback must be copyable and std::promise is not
+    auto promise = std::make_shared<std::promise<std::string>>();
+    std::future<std::string> reply = promise->get_future();
+    send(
+        request,
+        [promise](Status status, std::string& message) {
+            switch (status) {
+                case Status::Ok:
+                    promise->set_value(std::move(message));
+                    break;
+                case Status::TimedOut:
+                    promise->set_exception(std::make_exception_ptr(RequestTimeoutError()));
+                    break;
+                case Status::ConnectionLost:
+                    promise->set_exception(std::make_exception_ptr(std::runtime_error("Connection lost")));
+                    break;
+            }
+        },
+        timeout);
+    return reply;
+}
+
+void RequestClient::setCoalescing(size_t maxMessages, std::chrono::microseconds maxDelay) {
+    std::lock_guard<std::mutex> lock(sendMutex);
+    CommsSocket::setCoalescing(maxMessages, maxDelay);
+}
+
+void RequestClient::flush() {
+    std::lock_guard<std::mutex> lock(sendMutex);
+    CommsSocket::flush();
+}
+
+size_t RequestClient::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    return pending.size();
+}
+
+RequestClient::Stats RequestClient::getStats() const {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    return stats;
+}
+
+uint64_t RequestClient::getSendCalls() const {
+    std::lock_guard<std::mutex> lock(sendMutex); // recvCalls belongs to the receiver thread
+    return CommsSocket::getStats().sendCalls;
+}
+
+RequestClient::RequestId RequestClient::correlationId(std::string_view body) {
+    if (body.size() < kIdSize) {
+        throw std::runtime_error("Frame too short for a correlation id");
+    }
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(body.data());
+    return (RequestId(bytes[0]) << 24) | (RequestId(bytes[1]) << 16) | (RequestId(bytes[2]) << 8) | bytes[3];
+}
+
+std::string_view RequestClient::payload(std::string_view body) {
+    return body.size() < kIdSize ? std::string_view() : body.substr(kIdSize);
+}
+
+std::string RequestClient::replyBody(RequestId id, std::string_view payload) {
+    std::string body(kIdSize, '\0');
+    putBigEndian32(body.data(), id);
+    body.append(payload);
+    return body;
+}
+
+void RequestClient::receiveReplies() {
+    std::string body;
+    while (!stopping) {
+        bool replied = false;
+        if (waitReadable(static_cast<int>(kTimerResolution.count()))) {
+            bool open = true;
+            try {
+                open = fillReceiveBuffer();
+                while (size_t frameBytes = codec.decode(buffered(), body)) {
+                    consume(frameBytes);
+                    complete(body);
+                    replied = true;
+                }
+            } catch (const FrameTooLargeError&) {
+                open = false; // The stream cannot be resynchronised
+            }
+            if (!open) {
+                failAll();
+                return;
+            }
+        }
+        expireTimeouts();
+
+        // Requests the callbacks queued for one read go out together, and other queued
+        // requests once due. Skipped while a sender holds the lock, which flushes anyway,
+        // so the receiver never blocks behind a full socket.
+        std::unique_lock<std::mutex> lock(sendMutex, std::try_to_lock);
+        if (lock.owns_lock()) {
+            try {
+                if (replied) {
+                    CommsSocket::flush();
+                } else {
+                    flushIfDue();
+                }
+            } catch (const std::runtime_error&) {
+                // The failed connection shows up on the receive side
+            }
+        }
+    }
+}
+
+void RequestClient::complete(std::string& body) {
+    if (body.size() < kIdSize) {
+        return; // Not a reply this client can match
+    }
+    RequestId id = correlationId(body);
+    Callback onReply;
+    {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        auto entry = pending.find(id);
+        if (entry == pending.end()) {
+            ++stats.lateReplies;
+            return;
+        }
+        onReply = std::move(entry->second.onReply);
+        pending.erase(entry);
+        ++stats.replies;
+    }
+    body.erase(0, kIdSize);
+    onReply(Status::Ok, body);
+}
+
+void RequestClient::expireTimeouts() {
+    std::vector<Callback> expired;
+    {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        Clock::time_point now = Clock::now();
+        while (!deadlines.empty() && deadlines.top().first <= now) {
+            auto entry = pending.find(deadlines.top().second);
+            if (entry != pending.end() && entry->second.deadline == deadlines.top().first) {
+                expired.push_back(std::move(entry->second.onReply));
+                pending.erase(entry);
+                ++stats.timeouts;
+            }
+            deadlines.pop();
+        }
+    }
+    std::string none;
+    for (Callback& onReply : expired) {
+        onReply(Status::TimedOut, none);
+    }
+}
+
+void RequestClient::failAll() {
+    std::unordered_map<RequestId, Pending> lost;
+    {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        connected = false;
+        lost.swap(pending);
+        deadlines = {};
+    }
+    std::string none;
+    for (auto& [id, entry] : lost) {
+        entry.onReply(Status::ConnectionLost, none);
+    }
+}
+
+void RequestClient::stopReceiver() {
+    if (receiver.joinable()) {
+        stopping = true; // Seen within kTimerResolution
+        receiver.join();
+        stopping = false;
+    }
+}
@@ -0,0 +1,146 @@
+/**
+ * @file RequestClient.hpp
+ * @brief Pipelined request/response over one TCP connection, matched by correlation id.
+ * @details Requests are sent without waiting for earlier replies. Each carries a 32-bit
+ * correlation id that the server copies into its reply, and a completion table maps reply
+ * ids back to their requests, so replies may arrive in any order. A request completes with
+ * its reply, or with TimedOut once its timeout passes, or with ConnectionLost.
+ *
+ * Frames use LengthPrefixCodec; the body is the correlation id (4 bytes, network byte
+ * order) followed by the payload. Servers answer with replyBody(correlationId(body), ...).
+ *
+ * A receiver thread, started by connectToServer(), reads replies and expires timeouts
+ * (checked every kTimerResolution). Callbacks run on that thread: keep them short and do
+ * not let them throw. They may send further requests. send() and request() may be called
+ * from any thread.
+ *
+ * ## Example Usage
+ *
+ * ```cpp
+ * RequestClient client;
+ * client.connectToServer("10.0.0.2", 5000);
+ * std::vector<std::future<std::string>> replies;
+ * for (const std::string& query : queries) {
+ *     replies.push_back(client.request(query, std::chrono::seconds(1)));
+ * }
+ * for (auto& reply : replies) {
+ *     handle(reply.get()); // Throws RequestTimeoutError if the server did not answer in time
+ * }
+ * ```
+ */
+
+#ifndef REQUEST_CLIENT_HPP
+#define REQUEST_CLIENT_HPP
+
+#include "Comms.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// @brief Thrown from a request() future whose reply did not arrive in time.
+class RequestTimeoutError : public std::runtime_error {
+public:
+    RequestTimeoutError() : std::runtime_error("Request timed out") {}
+};
+
+/// @brief Client for pipelined requests whose replies are matched by correlation id.
+class RequestClient : private CommsSocket {
+public:
+    using RequestId = uint32_t;
+
+    enum class Status {
+        Ok,            ///< The reply arrived
+        TimedOut,      ///< No reply within the timeout; a later reply is dropped
+        ConnectionLost ///< The connection closed or failed before the reply
+    };
+
+    /// @brief Completion callback; reply is empty unless status is Ok, and may be moved from.
+    using Callback = std::function<void(Status status, std::string& reply)>;
+
+    struct Stats {
+        uint64_t requests = 0;
+        uint64_t replies = 0;
+        uint64_t timeouts = 0;
+        uint64_t lateReplies = 0; ///< Replies to requests that had timed out
+    };
+
+    /// @brief How often timeouts are checked while no reply arrives.
+    static constexpr std::chrono::milliseconds kTimerResolution {10};
+
+    explicit RequestClient(size_t maxFrameSize = LengthPrefixCodec::kDefaultMaxFrameSize,
+                           SocketBackend backend = SocketBackend::BSD);
+    /// @brief Stops the receiver; requests still pending complete with ConnectionLost.
+    ~RequestClient();
+
+    void connectToServer(const std::string& ip, int port);
+
+    /**
+     * @brief Sends a request; onReply runs on the receiver thread when it completes.
+     * Throws std::runtime_error if not connected or the send fails (onReply is then not called).
+     */
+    RequestId send(std::string_view request, Callback onReply, std::chrono::milliseconds timeout);
+
+    /// @brief Sends a request whose future holds the reply, or throws RequestTimeoutError or
+    /// std::runtime_error (connection lost).
+    std::future<std::string> request(std::string_view request, std::chrono::milliseconds timeout);
+
+    /// @copydoc CommsSocket::setCoalescing
+    /// Pipelined requests then share send calls. The receiver thread flushes those that are due,
+    /// and after each read the requests its callbacks queued.
+    void setCoalescing(size_t maxMessages, std::chrono::microseconds maxDelay);
+    void flush();
+
+    size_t getPendingCount() const;
+    Stats getStats() const;
+    /// @brief Send calls issued so far (see setCoalescing()).
+    uint64_t getSendCalls() const;
+
+    /// @brief For servers: the correlation id of a request body. Throws if the body is too short.
+    static RequestId correlationId(std::string_view body);
+    /// @brief For servers: the payload of a request body.
+    static std::string_view payload(std::string_view body);
+    /// @brief For servers: the body of the reply to request id, to send with any LengthPrefix sender.
+    static std::string replyBody(RequestId id, std::string_view payload);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Pending {
+        Callback onReply;
+        Clock::time_point deadline;
+    };
+
+    LengthPrefixCodec codec;
+
+    mutable std::mutex sendMutex; // Socket send machinery and coalescing queue
+    mutable std::mutex tableMutex; // Everything below
+    std::unordered_map<RequestId, Pending> pending;
+    std::priority_queue<std::pair<Clock::time_point, RequestId>, std::vector<std::pair<Clock::time_point, RequestId>>,
+                        std::greater<>>
+        deadlines; // May hold ids that already completed
+    RequestId nextId = 1;
+    bool connected = false;
+    Stats stats;
+
+    std::thread receiver;
+    std::atomic<bool> stopping {false};
+
+    void receiveReplies();
+    void complete(std::string& body);
+    void expireTimeouts();
+    void failAll();
+    void stopReceiver();
+};
+
+#endif // REQUEST_CLIENT_HPP
@@ -0,0 +1,197 @@
+#include "SerialAggregator.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr int kMaxEvents = 64;
+}
+
+SerialAggregator::SerialAggregator()
+    : _epollFd(epoll_create1(EPOLL_CLOEXEC)),
+      _openCount(0)
+{
+    if (_epollFd == -1)
+    {
+        std::cerr << "epoll_create1 error: " << strerror(errno) << std::endl;
+    }
+}
+
+SerialAggregator::~SerialAggregator()
+{
+    _ports.clear(); // Closing a port removes it from the epoll set
+    if (_epollFd != -1)
+    {
+        ::close(_epollFd);
+    }
+}
+
+std::optional<SerialAggregator::PortId> SerialAggregator::add(const PortConfig &config)
+{
+    if (_epollFd == -1)
+    {
+        return std::nullopt;
+    }
+    auto comms = std::make_unique<Serial_Comms>();
+    if (!comms->open(config.device) ||
+        !comms->configure(config.baudRate, config.dataBits, config.parity, config.stopBits, config.flowControl))
+    {
+        return std::nullopt; // Serial_Comms reported why
+    }
+
+    // Non-blocking: readiness comes from epoll, and VMIN must not hold up the other ports
+    int fd = comms->getPollDescriptor();
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1)
+    {
+        std::cerr << "fcntl error for " << config.device << ": " << strerror(errno) << std::endl;
+        return std::nullopt;
+    }
+
+    PortId id = _ports.size();
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = id;
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event) != 0)
+    {
+        std::cerr << "epoll_ctl error for " << config.device << ": " << strerror(errno) << std::endl;
+        return std::nullopt;
+    }
+
+    Port port;
+    port.comms = std::move(comms);
+    port.termination = config.termination;
+    port.maxSentenceLength = config.maxSentenceLength;
+    port.scanned = 0;
+    port.open = true;
+    _ports.push_back(std::move(port));
+    ++_openCount;
+    return id;
+}
+
+void SerialAggregator::setHandlers(Handlers handlers)
+{
+    _handlers = std::move(handlers);
+}
+
+size_t SerialAggregator::poll(unsigned int timeoutMs)
+{
+    struct epoll_event events[kMaxEvents];
+    int count = epoll_wait(_epollFd, events, kMaxEvents, static_cast<int>(timeoutMs));
+    if (count == -1 && errno != EINTR)
+    {
+        std::cerr << "epoll_wait error: " << strerror(errno) << std::endl;
+        return 0;
+    }
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    // One clock read per wakeup: the ports it serves were read within microseconds of each other
+    ++_stats.wakeups;
+    Clock::time_point arrival = Clock::now();
+    size_t delivered = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        bool hungUp = (events[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+        delivered += readPort(static_cast<PortId>(events[i].data.u64), hungUp, arrival);
+    }
+    return delivered;
+}
+
+size_t SerialAggregator::readPort(PortId id, bool hungUp, Clock::time_point arrival)
+{
+    Port &port = _ports[id];
+    if (!port.open)
+    {
+        return 0;
+    }
+
+    // Read straight into the pending buffer; epoll has already reported the port readable
+    size_t oldSize = port.pending.size();
+    port.pending.resize(oldSize + kReadSize);
+    ++_stats.reads;
+    ssize_t bytesRead = ::read(port.comms->getPollDescriptor(), port.pending.data() + oldSize, kReadSize);
+    port.pending.resize(oldSize + static_cast<size_t>(std::max<ssize_t>(bytesRead, 0)));
+    if (bytesRead > 0)
+    {
+        _stats.bytes += static_cast<uint64_t>(bytesRead);
+        return deliverSentences(id, arrival);
+    }
+    if (bytesRead == 0 || hungUp || (errno != EAGAIN && errno != EINTR))
+    {
+        closePort(id); // End of file, or EIO once a pty or USB adapter has gone
+    }
+    return 0;
+}
+
+size_t SerialAggregator::deliverSentences(PortId id, Clock::time_point arrival)
+{
+    Port &port = _ports[id];
+    std::string &pending = port.pending;
+    size_t delivered = 0;
+    size_t start = 0;
+
+    auto deliver = [&](size_t end) {
+        ++delivered;
+        if (_handlers.onSentence)
+        {
+            _handlers.onSentence(Sentence{id, std::string_view(pending.data() + start, end - start), arrival});
+        }
+        start = end;
+    };
+
+    if (port.termination == Serial_Comms::TerminationMethod::None)
+    {
+        deliver(pending.size());
+    }
+    else
+    {
+        char terminator = port.termination == Serial_Comms::TerminationMethod::CR ? '\r' : '\n';
+        size_t position = port.scanned;
+        while (const char *found = static_cast<const char *>(
+                   std::memchr(pending.data() + position, terminator, pending.size() - position)))
+        {
+            position = static_cast<size_t>(found - pending.data());
+            // For CRLF the '\r' may have come with the previous read; it is still in pending
+            bool ends = port.termination != Serial_Comms::TerminationMethod::CRLF ||
+                        (position > start && pending[position - 1] == '\r');
+            ++position;
+            if (ends)
+            {
+                deliver(position);
+            }
+        }
+    }
+
+    pending.erase(0, start);
+    if (pending.size() > port.maxSentenceLength)
+    {
+        _stats.discardedBytes += pending.size();
+        pending.clear();
+    }
+    port.scanned = pending.size();
+    _stats.sentences += delivered;
+    return delivered;
+}
+
+void SerialAggregator::closePort(PortId id)
+{
+    Port &port = _ports[id];
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, port.comms->getPollDescriptor(), nullptr);
+    port.comms->close();
+    port.pending.clear();
+    port.scanned = 0;
+    port.open = false;
+    --_openCount;
+    if (_handlers.onClose)
+    {
+        _handlers.onClose(id);
+    }
+}
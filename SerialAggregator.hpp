@@ -0,0 +1,149 @@
+/**
+ * @file SerialAggregator.hpp
+ * @brief Reads many serial ports from one thread and one epoll instance (Linux only).
+ * @details Each port is a Serial_Comms opened and configured with the usual enums, then
+ * registered with a shared epoll instance instead of getting a reader thread of its own.
+ * poll() reads every port that has input, frames its bytes into sentences by the port's
+ * termination method, and hands each sentence to onSentence tagged with its port id and
+ * arrival time. A bridge with 32 ports then costs one thread and a wakeup per burst of
+ * input across all ports, rather than 32 threads each waking for their own bytes.
+ *
+ * ## Example Usage
+ *
+ * ```cpp
+ * SerialAggregator aggregator;
+ * SerialAggregator::Handlers handlers;
+ * handlers.onSentence = [&](const SerialAggregator::Sentence& sentence) {
+ *     feeds[sentence.port].handle(sentence.text, sentence.arrival);
+ * };
+ * aggregator.setHandlers(handlers);
+ * auto gnss = aggregator.add({.device = "/dev/ttyS0", .baudRate = Serial_Comms::BaudRate::BR_9600});
+ * auto ais = aggregator.add({.device = "/dev/ttyUSB0", .baudRate = Serial_Comms::BaudRate::BR_38400});
+ * while (running) {
+ *     aggregator.poll(100);
+ * }
+ * ```
+ */
+
+#ifndef SERIAL_AGGREGATOR_HPP
+#define SERIAL_AGGREGATOR_HPP
+
+#include "Serial_Comms.hpp"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+class SerialAggregator {
+public:
+    using PortId = size_t;
+    using Clock = std::chrono::steady_clock;
+
+    /// @brief How to open, configure and frame one port.
+    struct PortConfig {
+        std::string device;
+        Serial_Comms::BaudRate baudRate = Serial_Comms::BaudRate::BR_38400;
+        Serial_Comms::DataBits dataBits = Serial_Comms::DataBits::DB_8;
+        Serial_Comms::Parity parity = Serial_Comms::Parity::None;
+        Serial_Comms::StopBits stopBits = Serial_Comms::StopBits::SB_1;
+        Serial_Comms::FlowControl flowControl = Serial_Comms::FlowControl::None;
+        /// @brief Sentence terminator; None delivers every read as it arrives.
+        Serial_Comms::TerminationMethod termination = Serial_Comms::TerminationMethod::CRLF;
+        /// @brief Unterminated input longer than this is discarded (line noise, wrong baud rate).
+        size_t maxSentenceLength = 1024;
+    };
+
+    struct Sentence {
+        PortId port;
+        std::string_view text;     ///< Including its terminator; valid during the call only
+        Clock::time_point arrival; ///< When the read completing the sentence returned
+    };
+
+    struct Handlers {
+        std::function<void(const Sentence&)> onSentence;
+        /// @brief The port hung up or failed (e.g. a USB adapter was unplugged); it is no longer read.
+        std::function<void(PortId)> onClose;
+    };
+
+    struct Stats {
+        uint64_t wakeups = 0;        ///< epoll_wait calls that returned ready ports
+        uint64_t reads = 0;          ///< read() calls across all ports
+        uint64_t bytes = 0;          ///< Bytes read across all ports
+        uint64_t sentences = 0;      ///< Sentences delivered
+        uint64_t discardedBytes = 0; ///< Unterminated input dropped for exceeding maxSentenceLength
+    };
+
+    /// @brief Bytes read from a port per call.
+    static constexpr size_t kReadSize = 4096;
+
+    SerialAggregator();
+
+    /**
+     * @brief Destructor. Closes every port and the epoll instance.
+     */
+    ~SerialAggregator();
+
+    SerialAggregator(const SerialAggregator&) = delete;
+    SerialAggregator& operator=(const SerialAggregator&) = delete;
+
+    /**
+     * @brief Opens and configures a port and registers it for reading.
+     * Its descriptor is made non-blocking, so reads never wait whatever its read profile.
+     * @param config Device, line settings and framing.
+     * @return The port's id, or std::nullopt if it cannot be opened or configured.
+     */
+    std::optional<PortId> add(const PortConfig& config);
+
+    void setHandlers(Handlers handlers);
+
+    /**
+     * @brief Waits up to timeoutMs for input, then reads each ready port once and delivers
+     * the sentences it completed. Handlers may call add() but must not call poll().
+     * @param timeoutMs Maximum time to wait in milliseconds; 0 does not block.
+     * @return The number of sentences delivered.
+     */
+    size_t poll(unsigned int timeoutMs);
+
+    /**
+     * @brief Returns the port's Serial_Comms, e.g. to write commands to it or change its
+     * baud rate. Do not read from it; poll() owns its input.
+     */
+    Serial_Comms& getPort(PortId id) { return *_ports[id].comms; }
+
+    bool isOpen(PortId id) const { return _ports[id].open; }
+    size_t getPortCount() const { return _ports.size(); }
+    size_t getOpenCount() const { return _openCount; }
+
+    /// @brief Returns the epoll descriptor all ports are registered with.
+    int getPollDescriptor() const { return _epollFd; }
+
+    /// @brief Returns counters since construction.
+    const Stats& getStats() const { return _stats; }
+
+private:
+    struct Port {
+        std::unique_ptr<Serial_Comms> comms;
+        Serial_Comms::TerminationMethod termination;
+        size_t maxSentenceLength;
+        std::string pending; // Received bytes not yet delivered
+        size_t scanned;      // Bytes of pending already searched for a terminator
+        bool open;
+    };
+
+    Stats _stats;
+    Handlers _handlers;
+    int _epollFd;
+    size_t _openCount;
+    std::deque<Port> _ports; // Stable addresses: handlers may add() ports while one is being read
+
+    // Reads the port once and delivers its complete sentences; returns how many
+    size_t readPort(PortId id, bool hungUp, Clock::time_point arrival);
+    size_t deliverSentences(PortId id, Clock::time_point arrival);
+    void closePort(PortId id);
+};
+
+#endif // SERIAL_AGGREGATOR_HPP
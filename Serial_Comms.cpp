@@ -0,0 +1,1250 @@
+#include "Serial_Comms.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#ifndef _WIN32
+#include <termios.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/eventfd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
+
+#if defined(__linux__) && defined(TCGETS2) && \
+    (defined(__x86_64__) || defined(__i386__) || defined(__aarch64__) || defined(__arm__) || defined(__riscv))
+#define SERIAL_COMMS_HAVE_TERMIOS2 1
+namespace
+{
+// The kernel's struct termios2 and BOTHER (asm-generic/termbits.h), which cannot be included
+// alongside <termios.h>. Other architectures lay it out differently and fall back to Bxxx rates.
+struct termios2
+{
+    tcflag_t c_iflag;
+    tcflag_t c_oflag;
+    tcflag_t c_cflag;
+    tcflag_t c_lflag;
+    cc_t c_line;
+    cc_t c_cc[19];
+    speed_t c_ispeed;
+    speed_t c_ospeed;
+};
+constexpr tcflag_t kBother = 0010000;
+} // namespace
+#endif
+
+#ifndef _WIN32
+namespace
+{
+// Bxxx constant for a standard rate, or B0 if the rate has none
+speed_t standardSpeed(unsigned int baud)
+{
+    struct Rate
+    {
+        unsigned int baud;
+        speed_t speed;
+    };
+    static const Rate rates[] = {
+        {1200, B1200}, {2400, B2400}, {4800, B4800}, {9600, B9600}, {19200, B19200}, {38400, B38400},
+        {57600, B57600}, {115200, B115200}, {230400, B230400},
+#ifdef B460800
+        {460800, B460800},
+#endif
+#ifdef B921600
+        {921600, B921600},
+#endif
+#ifdef B1500000
+        {1500000, B1500000},
+#endif
+#ifdef B2000000
+        {2000000, B2000000},
+#endif
+#ifdef B3000000
+        {3000000, B3000000},
+#endif
+#ifdef B4000000
+        {4000000, B4000000},
+#endif
+    };
+    for (const Rate &rate : rates)
+    {
+        if (rate.baud == baud)
+        {
+            return rate.speed;
+        }
+    }
+    return B0;
+}
+} // namespace
+#endif
+
+// Single-producer single-consumer ring: the reader thread appends, the caller's reads consume.
+// Positions count bytes (and chunks) ever written, so they never wrap.
+struct Serial_Comms::BackgroundReader
+{
+    struct Chunk
+    {
+        uint64_t start;                               // Ring position of the chunk's first byte
+        std::chrono::steady_clock::time_point arrival; // When the read returning it completed
+    };
+
+    std::vector<char> bytes;
+    std::vector<Chunk> chunks;
+
+    alignas(64) std::atomic<uint64_t> writePosition{0}; // Published after the bytes and their chunk
+    std::atomic<uint64_t> chunkWrite{0};
+    alignas(64) std::atomic<uint64_t> readPosition{0}; // Published after the bytes were copied out
+    std::atomic<uint64_t> chunkRead{0};
+
+    alignas(64) std::atomic<bool> stopping{false};
+    std::atomic<bool> failed{false}; // The port reported an error or hangup; the thread has exited
+    std::atomic<uint64_t> chunkCount{0};
+    std::atomic<uint64_t> byteCount{0};
+    std::atomic<uint64_t> overrunBytes{0};
+    std::atomic<uint64_t> untimedChunks{0};
+    std::atomic<uint64_t> highWaterBytes{0};
+
+    Stats stats; // Syscalls made by the thread, kept apart from the caller's
+#ifdef _WIN32
+    HANDLE wakeEvent = NULL; // Auto-reset event, set for each chunk
+#else
+    int wakeFd = -1; // eventfd, signalled for each chunk
+#endif
+    std::thread thread;
+
+    BackgroundReader(size_t capacity) : bytes(capacity), chunks(std::max<size_t>(64, capacity / 16)) {}
+
+    ~BackgroundReader()
+    {
+#ifdef _WIN32
+        if (wakeEvent != NULL)
+        {
+            CloseHandle(wakeEvent);
+        }
+#else
+        if (wakeFd != -1)
+        {
+            ::close(wakeFd);
+        }
+#endif
+    }
+
+    size_t pending() const
+    {
+        return static_cast<size_t>(writePosition.load(std::memory_order_acquire) -
+                                   readPosition.load(std::memory_order_relaxed));
+    }
+
+    void signal()
+    {
+#ifdef _WIN32
+        SetEvent(wakeEvent);
+#else
+        uint64_t one = 1;
+        (void)!::write(wakeFd, &one, sizeof(one));
+#endif
+    }
+
+    // Waits up to timeoutMs for a signal() and consumes it
+    void wait(unsigned int timeoutMs)
+    {
+#ifdef _WIN32
+        WaitForSingleObject(wakeEvent, timeoutMs);
+#else
+        struct pollfd pfd = {wakeFd, POLLIN, 0};
+        if (poll(&pfd, 1, static_cast<int>(timeoutMs)) > 0)
+        {
+            clearSignal();
+        }
+#endif
+    }
+
+    void clearSignal()
+    {
+#ifdef _WIN32
+        ResetEvent(wakeEvent);
+#else
+        uint64_t count;
+        (void)!::read(wakeFd, &count, sizeof(count));
+#endif
+    }
+};
+
+namespace
+{
+// How often an idle reader thread checks for stopReader()
+constexpr unsigned int kReaderWakeMs = 20;
+
+size_t ringCapacityFor(size_t requested)
+{
+    size_t capacity = Serial_Comms::kReceiveBufferSize;
+    while (capacity < requested)
+    {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+} // namespace
+
+Serial_Comms::Serial_Comms() :
+#ifdef _WIN32
+                               hSerial(INVALID_HANDLE_VALUE),
+                               _appliedTimeoutMs(static_cast<unsigned int>(-1)),
+#else
+                               fd(-1),
+#endif
+                               _isOpen(false),
+                               _readProfile(ReadProfile::LowLatency),
+                               _receiveBuffer(kReceiveBufferSize),
+                               _receiveStart(0),
+                               _receiveEnd(0)
+{
+}
+
+Serial_Comms::~Serial_Comms()
+{
+    close();
+}
+
+bool Serial_Comms::open(const std::string &portName)
+{
+    if (_isOpen)
+    {
+        std::cerr << "Error: Port already open." << std::endl;
+        return false;
+    }
+
+#ifdef _WIN32
+    hSerial = CreateFileA(
+        portName.c_str(),
+        GENERIC_READ | GENERIC_WRITE,
+        0,    // No sharing
+        NULL, // No security attributes
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, // | FILE_FLAG_OVERLAPPED for async I/O
+        NULL);
+
+    if (hSerial == INVALID_HANDLE_VALUE)
+    {
+        std::cerr << "Error opening serial port " << portName << ": " << GetLastError() << std::endl;
+        return false;
+    }
+
+    // Set default timeouts (can be reconfigured later)
+    COMMTIMEOUTS timeouts = {0};
+    timeouts.ReadIntervalTimeout = 50;
+    timeouts.ReadTotalTimeoutConstant = 50;
+    timeouts.ReadTotalTimeoutMultiplier = 10;
+    timeouts.WriteTotalTimeoutConstant = 50;
+    timeouts.WriteTotalTimeoutMultiplier = 10;
+    if (!SetCommTimeouts(hSerial, &timeouts))
+    {
+        std::cerr << "Error setting default timeouts: " << GetLastError() << std::endl;
+        CloseHandle(hSerial);
+        hSerial = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    _appliedTimeoutMs = static_cast<unsigned int>(-1); // The defaults above are not a read timeout
+
+#else // Linux
+    fd = ::open(portName.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK); // O_NONBLOCK for non-blocking reads
+
+    if (fd == -1)
+    {
+        std::cerr << "Error opening serial port " << portName << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Clear O_NONBLOCK for blocking reads by default, will be handled by VMIN/VTIME
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+
+#endif
+    _receiveStart = _receiveEnd = 0;
+    _isOpen = true;
+    return true;
+}
+
+void Serial_Comms::close()
+{
+    stopReader();
+    _reader.reset();
+    _lastArrival.reset();
+    if (_isOpen)
+    {
+#ifdef _WIN32
+        CloseHandle(hSerial);
+        hSerial = INVALID_HANDLE_VALUE;
+#else
+        ::close(fd);
+        fd = -1;
+#endif
+        _receiveStart = _receiveEnd = 0;
+        _isOpen = false;
+    }
+}
+
+bool Serial_Comms::configure(
+    BaudRate baudRate,
+    DataBits dataBits,
+    Parity parity,
+    StopBits stopBits,
+    FlowControl flowControl)
+{
+    if (!_isOpen)
+    {
+        std::cerr << "Error: Port not open. Cannot configure." << std::endl;
+        return false;
+    }
+
+#ifdef _WIN32
+    DCB dcbSerialParams = {0};
+    dcbSerialParams.DCBlength = sizeof(dcbSerialParams);
+
+    if (!GetCommState(hSerial, &dcbSerialParams))
+    {
+        std::cerr << "Error getting current serial port state: " << GetLastError() << std::endl;
+        return false;
+    }
+
+    dcbSerialParams.BaudRate = getBaudRateValue(baudRate);
+
+    switch (dataBits)
+    {
+    case DataBits::DB_5:
+        dcbSerialParams.ByteSize = 5;
+        break;
+    case DataBits::DB_6:
+        dcbSerialParams.ByteSize = 6;
+        break;
+    case DataBits::DB_7:
+        dcbSerialParams.ByteSize = 7;
+        break;
+    case DataBits::DB_8:
+        dcbSerialParams.ByteSize = 8;
+        break;
+    }
+
+    switch (parity)
+    {
+    case Parity::None:
+        dcbSerialParams.Parity = NOPARITY;
+        break;
+    case Parity::Odd:
+        dcbSerialParams.Parity = ODDPARITY;
+        break;
+    case Parity::Even:
+        dcbSerialParams.Parity = EVENPARITY;
+        break;
+    case Parity::Mark:
+        dcbSerialParams.Parity = MARKPARITY;
+        break;
+    case Parity::Space:
+        dcbSerialParams.Parity = SPACEPARITY;
+        break;
+    }
+
+    switch (stopBits)
+    {
+    case StopBits::SB_1:
+        dcbSerialParams.StopBits = ONESTOPBIT;
+        break;
+    case StopBits::SB_1_5:
+        dcbSerialParams.StopBits = ONE5STOPBITS;
+        break;
+    case StopBits::SB_2:
+        dcbSerialParams.StopBits = TWOSTOPBITS;
+        break;
+    }
+
+    dcbSerialParams.fDtrControl = DTR_CONTROL_DISABLE; // Default to disable DTR
+    dcbSerialParams.fRtsControl = RTS_CONTROL_DISABLE; // Default to disable RTS
+
+    switch (flowControl)
+    {
+    case FlowControl::None:
+        dcbSerialParams.fOutxCtsFlow = FALSE;
+        dcbSerialParams.fRtsControl = RTS_CONTROL_DISABLE;
+        dcbSerialParams.fOutxXonOut = FALSE;
+        dcbSerialParams.fInX = FALSE;
+        break;
+    case FlowControl::Hardware:
+        dcbSerialParams.fOutxCtsFlow = TRUE;
+        dcbSerialParams.fRtsControl = RTS_CONTROL_ENABLE; // Or RTS_CONTROL_HANDSHAKE
+        dcbSerialParams.fOutxXonOut = FALSE;
+        dcbSerialParams.fInX = FALSE;
+        break;
+    case FlowControl::Software:
+        dcbSerialParams.fOutxCtsFlow = FALSE;
+        dcbSerialParams.fRtsControl = RTS_CONTROL_DISABLE;
+        dcbSerialParams.fOutxXonOut = TRUE;
+        dcbSerialParams.fInX = TRUE;
+        break;
+    }
+
+    if (!SetCommState(hSerial, &dcbSerialParams))
+    {
+        std::cerr << "Error setting serial port state: " << GetLastError() << std::endl;
+        return false;
+    }
+
+#else // Linux
+    struct termios tty;
+    if (tcgetattr(fd, &tty) != 0)
+    {
+        std::cerr << "Error getting termios attributes: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Set baud rate
+    cfsetospeed(&tty, getBaudRateValue(baudRate));
+    cfsetispeed(&tty, getBaudRateValue(baudRate));
+
+    // Set data bits
+    tty.c_cflag &= ~CSIZE; // Clear current data bit setting
+    switch (dataBits)
+    {
+    case DataBits::DB_5:
+        tty.c_cflag |= CS5;
+        break;
+    case DataBits::DB_6:
+        tty.c_cflag |= CS6;
+        break;
+    case DataBits::DB_7:
+        tty.c_cflag |= CS7;
+        break;
+    case DataBits::DB_8:
+        tty.c_cflag |= CS8;
+        break;
+    }
+
+    // Set parity
+    tty.c_cflag &= ~PARENB; // Disable parity by default
+    tty.c_cflag &= ~PARODD; // Disable odd parity by default
+    switch (parity)
+    {
+    case Parity::None:
+        tty.c_cflag &= ~PARENB;
+        break;
+    case Parity::Odd:
+        tty.c_cflag |= PARENB;
+        tty.c_cflag |= PARODD;
+        break;
+    case Parity::Even:
+        tty.c_cflag |= PARENB;
+        tty.c_cflag &= ~PARODD;
+        break;
+    case Parity::Mark:  // Not directly supported, often treated as None or Odd
+    case Parity::Space: // Not directly supported, often treated as None or Even
+        std::cerr << "Warning: Mark/Space parity not directly supported on Linux. Using None." << std::endl;
+        tty.c_cflag &= ~PARENB;
+        break;
+    }
+
+    // Set stop bits
+    tty.c_cflag &= ~CSTOPB; // Clear stop bit setting (1 stop bit)
+    switch (stopBits)
+    {
+    case StopBits::SB_1:
+        // CSTOPB is 0 for 1 stop bit
+        break;
+    case StopBits::SB_1_5: // Not directly supported on Linux, use 1 or 2
+        std::cerr << "Warning: 1.5 stop bits not directly supported on Linux. Using 1 stop bit." << std::endl;
+        break;
+    case StopBits::SB_2:
+        tty.c_cflag |= CSTOPB; // Set for 2 stop bits
+        break;
+    }
+
+    // Set flow control
+    tty.c_cflag &= ~CRTSCTS;                // Disable hardware flow control by default
+    tty.c_iflag &= ~(IXON | IXOFF | IXANY); // Disable software flow control by default
+
+    switch (flowControl)
+    {
+    case FlowControl::None:
+        break;
+    case FlowControl::Hardware:
+        tty.c_cflag |= CRTSCTS;
+        break;
+    case FlowControl::Software:
+        tty.c_iflag |= (IXON | IXOFF | IXANY);
+        break;
+    }
+
+    // Local mode (enable receiver, ignore modem control lines)
+    tty.c_cflag |= (CLOCAL | CREAD);
+
+    // Raw input mode (no special processing of input characters)
+    tty.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG);
+
+    // Raw output mode (no special processing of output characters)
+    tty.c_oflag &= ~OPOST;
+
+    // Input flags (disable parity checking, strip 8th bit, etc.)
+    tty.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL);
+
+    // VMIN/VTIME for the read profile; read timeouts are poll() deadlines, so these stay put
+    setReadCharacters(tty);
+
+    if (tcsetattr(fd, TCSANOW, &tty) != 0)
+    {
+        std::cerr << "Error setting termios attributes: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+#endif
+    return true;
+}
+
+bool Serial_Comms::write(const std::string &data, TerminationMethod termination)
+{
+    if (!_isOpen)
+    {
+        std::cerr << "Error: Port not open. Cannot write." << std::endl;
+        return false;
+    }
+
+    std::string dataToSend = applyTermination(data, termination);
+
+#ifdef _WIN32
+    DWORD bytesWritten;
+    if (!WriteFile(hSerial, dataToSend.c_str(), dataToSend.length(), &bytesWritten, NULL))
+    {
+        std::cerr << "Error writing to serial port: " << GetLastError() << std::endl;
+        return false;
+    }
+    if (bytesWritten != dataToSend.length())
+    {
+        std::cerr << "Warning: Not all bytes written to serial port." << std::endl;
+    }
+#else // Linux
+    ssize_t bytesWritten = ::write(fd, dataToSend.c_str(), dataToSend.length());
+    if (bytesWritten == -1)
+    {
+        std::cerr << "Error writing to serial port: " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (static_cast<size_t>(bytesWritten) != dataToSend.length())
+    {
+        std::cerr << "Warning: Not all bytes written to serial port." << std::endl;
+    }
+#endif
+    return true;
+}
+
+std::string Serial_Comms::read(TerminationMethod termination, unsigned int timeoutMs, size_t maxLength)
+{
+    if (!_isOpen)
+    {
+        std::cerr << "Error: Port not open. Cannot read." << std::endl;
+        return "";
+    }
+
+    std::string receivedData;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    bool waited = false;
+    while (true)
+    {
+        // Search what is already buffered before touching the port
+        size_t available = _receiveEnd - _receiveStart;
+        if (available > 0)
+        {
+            size_t room = maxLength > 0 ? maxLength - receivedData.size() : available;
+            std::string_view data(_receiveBuffer.data() + _receiveStart, std::min(available, room));
+            size_t end = findTermination(data, termination, receivedData.empty() ? '\0' : receivedData.back());
+            size_t take = end > 0 ? end : data.size();
+            receivedData.append(data.data(), take);
+            _receiveStart += take;
+            if (end > 0)
+            {
+                break;
+            }
+        }
+
+        if (maxLength > 0 && receivedData.length() >= maxLength)
+        {
+            break;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (waited && now >= deadline)
+        {
+            break;
+        }
+        auto remaining = now >= deadline ? std::chrono::milliseconds(0)
+                                         : std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+        waited = true;
+        if (fillReceiveBuffer(static_cast<unsigned int>(remaining.count())) <= 0)
+        {
+            break; // Timed out, or the port failed
+        }
+    }
+
+    return receivedData;
+}
+
+size_t Serial_Comms::readInto(std::span<std::byte> buffer, unsigned int timeoutMs)
+{
+    if (!_isOpen)
+    {
+        std::cerr << "Error: Port not open. Cannot read bytes." << std::endl;
+        return 0;
+    }
+
+    // Serve earlier bulk reads from memory first; never wait while data is buffered
+    if (_receiveEnd > _receiveStart || buffer.empty())
+    {
+        return takeBuffered(buffer);
+    }
+
+    size_t received = 0;
+    if (buffer.size() >= _receiveBuffer.size())
+    {
+        // Large reads gain nothing from staging
+        int bytesRead = receive(reinterpret_cast<char *>(buffer.data()), buffer.size(), timeoutMs);
+        received = bytesRead > 0 ? static_cast<size_t>(bytesRead) : 0;
+    }
+    else if (fillReceiveBuffer(timeoutMs) > 0)
+    {
+        received = takeBuffered(buffer);
+    }
+
+    return received;
+}
+
+bool Serial_Comms::isOpen() const
+{
+    return _isOpen;
+}
+
+int Serial_Comms::getPollDescriptor() const
+{
+#ifdef _WIN32
+    return -1;
+#else
+    if (isReaderRunning())
+    {
+        return _reader->wakeFd; // The thread drains fd, so it would rarely be readable
+    }
+    return _isOpen ? fd : -1;
+#endif
+}
+
+bool Serial_Comms::setReadProfile(ReadProfile profile)
+{
+    _readProfile = profile;
+    return !_isOpen || applyReadProfile();
+}
+
+bool Serial_Comms::applyReadProfile()
+{
+#ifdef _WIN32
+    return true; // Read timeouts are set per call in receiveOnce()
+#else
+    struct termios tty;
+    if (tcgetattr(fd, &tty) != 0)
+    {
+        std::cerr << "Error getting termios attributes: " << strerror(errno) << std::endl;
+        return false;
+    }
+    setReadCharacters(tty);
+    if (tcsetattr(fd, TCSANOW, &tty) != 0)
+    {
+        std::cerr << "Error setting termios attributes: " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+#endif
+}
+
+#ifndef _WIN32
+void Serial_Comms::setReadCharacters(struct termios &tty) const
+{
+    // VMIN = 0, VTIME = 0: read() returns what is there at once
+    // VMIN > 0, VTIME > 0: read() waits for the first byte, then returns after VMIN bytes
+    //                      or once the line has been quiet for VTIME tenths of a second
+    // Linux reads ttys in 64-byte chunks (since 5.11), so a larger VMIN acts as 64
+    bool lowLatency = _readProfile == ReadProfile::LowLatency;
+    tty.c_cc[VMIN] = lowLatency ? 0 : 64;
+    tty.c_cc[VTIME] = lowLatency ? 0 : 1;
+}
+#endif
+
+bool Serial_Comms::setBaudRate(unsigned int baud)
+{
+    if (!_isOpen)
+    {
+        std::cerr << "Error: Port not open. Cannot set baud rate." << std::endl;
+        return false;
+    }
+    if (baud == 0)
+    {
+        return false;
+    }
+
+#ifdef _WIN32
+    DCB dcbSerialParams = {0};
+    dcbSerialParams.DCBlength = sizeof(dcbSerialParams);
+    if (!GetCommState(hSerial, &dcbSerialParams))
+    {
+        std::cerr << "Error getting current serial port state: " << GetLastError() << std::endl;
+        return false;
+    }
+    dcbSerialParams.BaudRate = baud; // The driver decides whether it can divide down to this rate
+    if (!SetCommState(hSerial, &dcbSerialParams))
+    {
+        std::cerr << "Error setting baud rate " << baud << ": " << GetLastError() << std::endl;
+        return false;
+    }
+    return true;
+#else
+    speed_t speed = standardSpeed(baud);
+    if (speed != B0)
+    {
+        struct termios tty;
+        if (tcgetattr(fd, &tty) != 0 || cfsetospeed(&tty, speed) != 0 || cfsetispeed(&tty, speed) != 0 ||
+            tcsetattr(fd, TCSANOW, &tty) != 0)
+        {
+            std::cerr << "Error setting baud rate " << baud << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+#ifdef SERIAL_COMMS_HAVE_TERMIOS2
+    termios2 tio;
+    if (ioctl(fd, TCGETS2, &tio) != 0)
+    {
+        std::cerr << "Error getting termios2 attributes: " << strerror(errno) << std::endl;
+        return false;
+    }
+    tio.c_cflag &= ~CBAUD;
+    tio.c_cflag |= kBother;
+    tio.c_ispeed = baud;
+    tio.c_ospeed = baud;
+    if (ioctl(fd, TCSETS2, &tio) != 0)
+    {
+        std::cerr << "Error setting baud rate " << baud << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    // Drivers round to what their clock divides down to; report a rate they could not get close to
+    if (ioctl(fd, TCGETS2, &tio) == 0 && (tio.c_ospeed < baud - baud / 50 || tio.c_ospeed > baud + baud / 50))
+    {
+        std::cerr << "Error: Driver set " << tio.c_ospeed << " baud instead of " << baud << "." << std::endl;
+        return false;
+    }
+    return true;
+#else
+    std::cerr << "Error: Baud rate " << baud << " needs termios2, not available on this platform." << std::endl;
+    return false;
+#endif
+#endif
+}
+
+unsigned int Serial_Comms::getBaudRate() const
+{
+    if (!_isOpen)
+    {
+        return 0;
+    }
+#ifdef _WIN32
+    DCB dcbSerialParams = {0};
+    dcbSerialParams.DCBlength = sizeof(dcbSerialParams);
+    return GetCommState(hSerial, &dcbSerialParams) ? dcbSerialParams.BaudRate : 0;
+#elif defined(SERIAL_COMMS_HAVE_TERMIOS2)
+    termios2 tio;
+    return ioctl(fd, TCGETS2, &tio) == 0 ? tio.c_ospeed : 0;
+#else
+    struct termios tty;
+    if (tcgetattr(fd, &tty) != 0)
+    {
+        return 0;
+    }
+    speed_t speed = cfgetospeed(&tty);
+    for (unsigned int baud : {1200u, 2400u, 4800u, 9600u, 19200u, 38400u, 57600u, 115200u, 230400u, 460800u, 921600u})
+    {
+        if (standardSpeed(baud) == speed)
+        {
+            return baud;
+        }
+    }
+    return 0;
+#endif
+}
+
+bool Serial_Comms::setLowLatency(bool enable)
+{
+    if (!_isOpen)
+    {
+        std::cerr << "Error: Port not open. Cannot set low latency." << std::endl;
+        return false;
+    }
+#if defined(__linux__) && defined(TIOCGSERIAL)
+    struct serial_struct serial;
+    if (ioctl(fd, TIOCGSERIAL, &serial) != 0)
+    {
+        return false; // Not a UART driver (pty, some USB adapters): nothing to change
+    }
+    if (enable)
+    {
+        serial.flags |= ASYNC_LOW_LATENCY;
+    }
+    else
+    {
+        serial.flags &= ~ASYNC_LOW_LATENCY;
+    }
+    if (ioctl(fd, TIOCSSERIAL, &serial) != 0)
+    {
+        std::cerr << "Warning: Driver rejected ASYNC_LOW_LATENCY: " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+#else
+    (void)enable;
+    return false;
+#endif
+}
+
+size_t Serial_Comms::getBufferedBytes() const
+{
+    return _receiveEnd - _receiveStart + (_reader ? _reader->pending() : 0);
+}
+
+bool Serial_Comms::startReader(size_t ringCapacity)
+{
+    if (!_isOpen)
+    {
+        std::cerr << "Error: Port not open. Cannot start reader." << std::endl;
+        return false;
+    }
+    if (isReaderRunning())
+    {
+        std::cerr << "Error: Reader already running." << std::endl;
+        return false;
+    }
+    if (_reader && _reader->pending() > 0)
+    {
+        std::cerr << "Error: Previous reader still has unread data." << std::endl;
+        return false;
+    }
+
+    auto reader = std::make_unique<BackgroundReader>(ringCapacityFor(ringCapacity));
+#ifdef _WIN32
+    reader->wakeEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (reader->wakeEvent == NULL)
+    {
+        std::cerr << "Error creating reader event: " << GetLastError() << std::endl;
+        return false;
+    }
+#else
+    reader->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (reader->wakeFd == -1)
+    {
+        std::cerr << "Error creating reader eventfd: " << strerror(errno) << std::endl;
+        return false;
+    }
+#endif
+    _reader = std::move(reader);
+    _reader->thread = std::thread([this] { runReader(); });
+    return true;
+}
+
+void Serial_Comms::stopReader()
+{
+    if (_reader && _reader->thread.joinable())
+    {
+        _reader->stopping = true; // Seen within kReaderWakeMs
+        _reader->thread.join();
+    }
+}
+
+bool Serial_Comms::isReaderRunning() const
+{
+    return _reader && _reader->thread.joinable();
+}
+
+Serial_Comms::ReaderStats Serial_Comms::getReaderStats() const
+{
+    ReaderStats stats;
+    if (_reader)
+    {
+        stats.chunks = _reader->chunkCount.load(std::memory_order_relaxed);
+        stats.bytes = _reader->byteCount.load(std::memory_order_relaxed);
+        stats.overrunBytes = _reader->overrunBytes.load(std::memory_order_relaxed);
+        stats.untimedChunks = _reader->untimedChunks.load(std::memory_order_relaxed);
+        stats.highWaterBytes = _reader->highWaterBytes.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+std::optional<IComms::ReceiveTime> Serial_Comms::getLastReceiveTime() const
+{
+    if (!_lastArrival)
+    {
+        return std::nullopt;
+    }
+    // Recorded on the monotonic clock; shown on the wall clock as that long ago
+    auto age = std::chrono::steady_clock::now() - *_lastArrival;
+    return std::chrono::time_point_cast<ReceiveTime::duration>(std::chrono::system_clock::now() - age);
+}
+
+std::optional<std::chrono::steady_clock::time_point> Serial_Comms::getLastArrivalTime() const
+{
+    return _lastArrival;
+}
+
+void Serial_Comms::runReader()
+{
+    BackgroundReader &reader = *_reader;
+    const uint64_t capacity = reader.bytes.size();
+    const uint64_t chunkCapacity = reader.chunks.size();
+    std::vector<char> discard; // Receives bytes the full ring has no room for
+
+    while (!reader.stopping.load(std::memory_order_relaxed))
+    {
+        uint64_t write = reader.writePosition.load(std::memory_order_relaxed);
+        uint64_t free = capacity - (write - reader.readPosition.load(std::memory_order_acquire));
+        size_t offset = static_cast<size_t>(write & (capacity - 1));
+        char *dest;
+        size_t length;
+        if (free > 0)
+        {
+            dest = reader.bytes.data() + offset;
+            length = static_cast<size_t>(std::min<uint64_t>(free, capacity - offset));
+        }
+        else
+        {
+            // Keep draining the port so the loss is counted here, not hidden in the driver
+            discard.resize(kReceiveBufferSize);
+            dest = discard.data();
+            length = discard.size();
+        }
+
+        int bytesRead = receiveOnce(dest, length, kReaderWakeMs, reader.stats);
+        if (bytesRead < 0)
+        {
+            reader.failed = true;
+            reader.signal();
+            return;
+        }
+        if (bytesRead == 0)
+        {
+            continue;
+        }
+        auto arrival = std::chrono::steady_clock::now();
+        reader.chunkCount.fetch_add(1, std::memory_order_relaxed);
+        reader.byteCount.fetch_add(static_cast<uint64_t>(bytesRead), std::memory_order_relaxed);
+        if (free == 0)
+        {
+            reader.overrunBytes.fetch_add(static_cast<uint64_t>(bytesRead), std::memory_order_relaxed);
+            continue;
+        }
+
+        // Without a free timestamp slot the bytes extend the previous chunk and keep its time
+        uint64_t chunk = reader.chunkWrite.load(std::memory_order_relaxed);
+        if (chunk - reader.chunkRead.load(std::memory_order_acquire) < chunkCapacity)
+        {
+            reader.chunks[chunk & (chunkCapacity - 1)] = {write, arrival};
+            reader.chunkWrite.store(chunk + 1, std::memory_order_release);
+        }
+        else
+        {
+            reader.untimedChunks.fetch_add(1, std::memory_order_relaxed);
+        }
+        reader.writePosition.store(write + static_cast<uint64_t>(bytesRead), std::memory_order_release);
+
+        uint64_t held = capacity - free + static_cast<uint64_t>(bytesRead);
+        if (held > reader.highWaterBytes.load(std::memory_order_relaxed))
+        {
+            reader.highWaterBytes.store(held, std::memory_order_relaxed);
+        }
+        reader.signal();
+    }
+}
+
+int Serial_Comms::receive(char *dest, size_t length, unsigned int timeoutMs)
+{
+    if (_reader)
+    {
+        if (isReaderRunning() || _reader->pending() > 0)
+        {
+            return takeFromRing(dest, length, timeoutMs);
+        }
+        _reader.reset(); // Stopped and drained: back to reading the port directly
+    }
+    return receiveOnce(dest, length, timeoutMs, _stats);
+}
+
+int Serial_Comms::takeFromRing(char *dest, size_t length, unsigned int timeoutMs)
+{
+    BackgroundReader &reader = *_reader;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    uint64_t read = reader.readPosition.load(std::memory_order_relaxed);
+    uint64_t write = reader.writePosition.load(std::memory_order_acquire);
+    while (write == read)
+    {
+        if (reader.failed.load(std::memory_order_acquire) || !isReaderRunning())
+        {
+            write = reader.writePosition.load(std::memory_order_acquire);
+            return write == read ? -1 : takeFromRing(dest, length, 0);
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+        {
+            return 0;
+        }
+        reader.wait(static_cast<unsigned int>(std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count()));
+        write = reader.writePosition.load(std::memory_order_acquire);
+    }
+
+    // Chunks are published before their bytes, so every byte below write has one
+    const uint64_t chunkCapacity = reader.chunks.size();
+    uint64_t chunk = reader.chunkRead.load(std::memory_order_relaxed);
+    uint64_t chunkWrite = reader.chunkWrite.load(std::memory_order_acquire);
+    while (chunk + 1 < chunkWrite && reader.chunks[(chunk + 1) & (chunkCapacity - 1)].start <= read)
+    {
+        ++chunk;
+    }
+    uint64_t end = write;
+    if (chunk + 1 < chunkWrite)
+    {
+        end = std::min(end, reader.chunks[(chunk + 1) & (chunkCapacity - 1)].start);
+    }
+    _lastArrival = reader.chunks[chunk & (chunkCapacity - 1)].arrival;
+
+    const uint64_t capacity = reader.bytes.size();
+    size_t n = static_cast<size_t>(std::min<uint64_t>(end - read, length));
+    size_t offset = static_cast<size_t>(read & (capacity - 1));
+    size_t first = std::min(n, static_cast<size_t>(capacity) - offset);
+    std::memcpy(dest, reader.bytes.data() + offset, first);
+    std::memcpy(dest + first, reader.bytes.data(), n - first);
+
+    reader.chunkRead.store(chunk, std::memory_order_release);
+    reader.readPosition.store(read + n, std::memory_order_release);
+    if (read + n == write)
+    {
+        // Caught up: rearm the wake-up so readiness pollers wait for the next chunk.
+        // Data published meanwhile shows in getBufferedBytes(), which they drain first.
+        reader.clearSignal();
+    }
+    return static_cast<int>(n);
+}
+
+int Serial_Comms::receiveOnce(char *dest, size_t length, unsigned int timeoutMs, Stats &stats)
+{
+#ifdef _WIN32
+    // Return as soon as any byte arrives, or after timeoutMs; the Win32 counterpart of poll() + read().
+    // Set only when the timeout changes, as callers mostly reuse one.
+    if (timeoutMs != _appliedTimeoutMs)
+    {
+        COMMTIMEOUTS timeouts = {0};
+        timeouts.ReadIntervalTimeout = MAXDWORD;
+        timeouts.ReadTotalTimeoutMultiplier = timeoutMs > 0 ? MAXDWORD : 0;
+        timeouts.ReadTotalTimeoutConstant = timeoutMs;
+        timeouts.WriteTotalTimeoutConstant = 50;
+        timeouts.WriteTotalTimeoutMultiplier = 10;
+        if (!SetCommTimeouts(hSerial, &timeouts))
+        {
+            std::cerr << "Error setting read timeouts: " << GetLastError() << std::endl;
+            return -1;
+        }
+        _appliedTimeoutMs = timeoutMs;
+    }
+
+    DWORD bytesRead = 0;
+    ++stats.readCalls;
+    if (!ReadFile(hSerial, dest, static_cast<DWORD>(length), &bytesRead, NULL))
+    {
+        std::cerr << "Error reading from serial port: " << GetLastError() << std::endl;
+        return -1;
+    }
+    return static_cast<int>(bytesRead);
+#else
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    ++stats.pollCalls;
+    int pollResult = poll(&pfd, 1, static_cast<int>(timeoutMs));
+    if (pollResult == -1)
+    {
+        if (errno == EINTR)
+        {
+            return 0; // Interrupted: report a timeout, the caller retries
+        }
+        std::cerr << "Error polling serial port: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    if (pollResult == 0)
+    {
+        return 0;
+    }
+
+    // POLLHUP/POLLERR also end up here, so the read reports the hangup or error
+    ++stats.readCalls;
+    ssize_t bytesRead = ::read(fd, dest, length);
+    if (bytesRead == -1)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+        {
+            return 0;
+        }
+        std::cerr << "Error reading from serial port: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    return bytesRead > 0 ? static_cast<int>(bytesRead) : -1; // Readable but empty: hung up
+#endif
+}
+
+int Serial_Comms::fillReceiveBuffer(unsigned int timeoutMs)
+{
+    if (_receiveStart == _receiveEnd)
+    {
+        _receiveStart = _receiveEnd = 0;
+    }
+    else if (_receiveStart > 0)
+    {
+        // Move the unread tail to the front to make room behind it
+        std::memmove(_receiveBuffer.data(), _receiveBuffer.data() + _receiveStart, _receiveEnd - _receiveStart);
+        _receiveEnd -= _receiveStart;
+        _receiveStart = 0;
+    }
+    if (_receiveEnd == _receiveBuffer.size())
+    {
+        return 0; // Full: the caller must consume first
+    }
+
+    int bytesRead = receive(_receiveBuffer.data() + _receiveEnd, _receiveBuffer.size() - _receiveEnd, timeoutMs);
+    if (bytesRead > 0)
+    {
+        _receiveEnd += static_cast<size_t>(bytesRead);
+    }
+    return bytesRead;
+}
+
+size_t Serial_Comms::takeBuffered(std::span<std::byte> buffer)
+{
+    size_t n = std::min(buffer.size(), _receiveEnd - _receiveStart);
+    if (n > 0)
+    {
+        std::memcpy(buffer.data(), _receiveBuffer.data() + _receiveStart, n);
+        _receiveStart += n;
+    }
+    return n;
+}
+
+size_t Serial_Comms::findTermination(std::string_view data, TerminationMethod termination, char previous)
+{
+    size_t pos = std::string_view::npos;
+    switch (termination)
+    {
+    case TerminationMethod::None:
+        return 0;
+    case TerminationMethod::CR:
+        pos = data.find('\r');
+        return pos == std::string_view::npos ? 0 : pos + 1;
+    case TerminationMethod::LF:
+        pos = data.find('\n');
+        return pos == std::string_view::npos ? 0 : pos + 1;
+    case TerminationMethod::CRLF:
+        if (previous == '\r' && !data.empty() && data[0] == '\n')
+        {
+            return 1;
+        }
+        pos = data.find("\r\n");
+        return pos == std::string_view::npos ? 0 : pos + 2;
+    }
+    return 0;
+}
+
+unsigned int Serial_Comms::getBaudRateValue(BaudRate baudRate)
+{
+#ifdef _WIN32
+    switch (baudRate)
+    {
+    case BaudRate::BR_9600:
+        return CBR_9600;
+    case BaudRate::BR_19200:
+        return CBR_19200;
+    case BaudRate::BR_38400:
+        return CBR_38400;
+    case BaudRate::BR_57600:
+        return CBR_57600;
+    case BaudRate::BR_115200:
+        return CBR_115200;
+    case BaudRate::BR_230400:
+        return 230400; // Custom baud rate for Windows
+    case BaudRate::BR_460800:
+        return 460800; // Custom baud rate for Windows
+    case BaudRate::BR_921600:
+        return 921600; // Custom baud rate for Windows
+    default:
+        return CBR_9600; // Default to 9600
+    }
+#else // Linux
+    switch (baudRate)
+    {
+    case BaudRate::BR_9600:
+        return B9600;
+    case BaudRate::BR_19200:
+        return B19200;
+    case BaudRate::BR_38400:
+        return B38400;
+    case BaudRate::BR_57600:
+        return B57600;
+    case BaudRate::BR_115200:
+        return B115200;
+    case BaudRate::BR_230400:
+        return B230400;
+    case BaudRate::BR_460800:
+#ifdef B460800
+        return B460800;
+#else
+        std::cerr << "Warning: Baud rate BR_460800 not supported on this system. Falling back to 115200." << std::endl;
+        return B115200;
+#endif
+    case BaudRate::BR_921600:
+#ifdef B921600
+        return B921600;
+#else
+        std::cerr << "Warning: Baud rate BR_921600 not supported on this system. Falling back to 115200." << std::endl;
+        return B115200;
+#endif
+    default:
+        return B9600; // Default to 9600
+    }
+#endif
+}
+
+std::string Serial_Comms::applyTermination(const std::string &data, TerminationMethod termination)
+{
+    std::string terminatedData = data;
+    switch (termination)
+    {
+    case TerminationMethod::CR:
+        terminatedData += '\r';
+        break;
+    case TerminationMethod::LF:
+        terminatedData += '\n';
+        break;
+    case TerminationMethod::CRLF:
+        terminatedData += "\r\n";
+        break;
+    case TerminationMethod::None:
+        // No termination needed
+        break;
+    }
+    return terminatedData;
+}
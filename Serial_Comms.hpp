@@ -1,11 +1,13 @@
 #ifndef SERIAL_COMMS_H
 #define SERIAL_COMMS_H
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <iostream>
-#include <chrono>
-#include <thread>
 
 // Include the new IComms interface
 #include "IComms.hpp"
@@ -14,10 +16,7 @@
 #ifdef _WIN32
 #include <windows.h>
 #else
-#include <termios.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <errno.h>
+struct termios;
 #endif
 
 class Serial_Comms : public IComms
@@ -80,6 +79,36 @@ public:
         CRLF // Carriage Return + Line Feed (\r\n)
     };
 
+    // How the port trades latency for fewer reads; kept across configure() calls
+    enum class ReadProfile
+    {
+        LowLatency,    // VMIN 0, VTIME 0: every read returns what has arrived
+        HighThroughput // VMIN 64, VTIME 1: a read collects 64 bytes, or less after 0.1 s of quiet
+    };
+
+    // Syscall counters for profiling the read path
+    struct Stats
+    {
+        uint64_t pollCalls = 0; // Readiness waits issued (Linux)
+        uint64_t readCalls = 0; // read()/ReadFile() calls issued
+    };
+
+    // Counters for the background reader (startReader())
+    struct ReaderStats
+    {
+        uint64_t chunks = 0;         // Reads that returned data
+        uint64_t bytes = 0;          // Bytes read from the port, including overrun ones
+        uint64_t overrunBytes = 0;   // Bytes dropped because the ring was full
+        uint64_t untimedChunks = 0;  // Chunks merged into the previous one's timestamp (timestamp ring full)
+        uint64_t highWaterBytes = 0; // Most bytes waiting in the ring at once
+    };
+
+    // Bytes read from the port per call; the size of the Linux tty layer's receive buffer
+    static constexpr size_t kReceiveBufferSize = 4096;
+
+    // Default ring for the background reader: 1 MiB holds over 10 s at 921600 baud
+    static constexpr size_t kDefaultRingCapacity = 1 << 20;
+
     // Constructor
     Serial_Comms();
 
@@ -101,721 +130,140 @@ public:
         FlowControl flowControl
     );
 
+    // Set any integer baud rate on the open port, e.g. 1500000 for a high-rate GNSS/IMU
+    // receiver. Rates without a Bxxx constant use termios2/BOTHER on Linux (x86, ARM,
+    // RISC-V). Returns false if the platform or driver cannot run at that rate (within 2%).
+    bool setBaudRate(unsigned int baud);
+
+    // The output baud rate the port is set to, 0 if unknown
+    unsigned int getBaudRate() const;
+
+    // Set ASYNC_LOW_LATENCY on Linux UART drivers that support it: received bytes are
+    // pushed to readers at once instead of on the driver's next timer tick (ftdi_sio drops
+    // its latency timer to 1 ms). Returns false, leaving the port as it was, where the
+    // driver has no such setting (ptys, Windows).
+    bool setLowLatency(bool enable);
+
+    // Select the read profile; may be called before or after open(). Read timeouts are
+    // poll() deadlines in user space, so the termios settings are not touched per read.
+    // With HighThroughput a read may return up to 0.1 s after its timeout, and a short
+    // sentence waits for the next one or for the line to go quiet.
+    // Returns false if the open port rejected the settings.
+    bool setReadProfile(ReadProfile profile);
+
+    // The profile set by setReadProfile()
+    ReadProfile getReadProfile() const { return _readProfile; }
+
+    // Start a thread that drains the open port into a lock-free ring of ringCapacity bytes
+    // (rounded up to a power of two), stamping each chunk with its steady_clock arrival
+    // time. The port is then read continuously even while the consumer stalls, so the
+    // kernel and UART buffers cannot overrun; if the ring fills, further bytes are dropped
+    // and counted in ReaderStats::overrunBytes. read(), readInto() and the IComms calls are
+    // then served from the ring, one chunk at a time so getLastReceiveTime() tells when the
+    // returned bytes arrived. Reads must come from one thread at a time. Linux and Windows.
+    // Returns false if the port is closed or a reader is already running.
+    bool startReader(size_t ringCapacity = kDefaultRingCapacity);
+
+    // Stop the reader thread; bytes already in the ring are still returned by later reads
+    void stopReader();
+
+    bool isReaderRunning() const;
+
+    // Reader counters, all zero if no reader was started since open()
+    ReaderStats getReaderStats() const;
+
+    // When the bytes of the most recent ring read arrived (implements IComms); reads made
+    // without the background reader are not timestamped
+    std::optional<ReceiveTime> getLastReceiveTime() const override;
+
+    // The same arrival time on the monotonic clock it was recorded with
+    std::optional<std::chrono::steady_clock::time_point> getLastArrivalTime() const;
+
     // Write data to the serial port with optional termination
     bool write(const std::string &data, TerminationMethod termination = TerminationMethod::None);
 
-    // Read data from the serial port until a terminator is found or timeout/maxLength reached
+    // Read data from the serial port until a terminator is found or timeout/maxLength reached.
+    // Data is read in bulk; bytes after the terminator are kept for the next read.
     std::string read(
         TerminationMethod termination,
         unsigned int timeoutMs,
         size_t maxLength = 0 // 0 means no max length, read until terminator or timeout
     );
 
-    // Read a fixed number of bytes from the serial port with timeout (implements IComms)
-    std::string readBytes(size_t numBytes, unsigned int timeoutMs) override;
+    // Wait up to timeoutMs for data, then read what is available, up to buffer.size() bytes (implements IComms)
+    size_t readInto(std::span<std::byte> buffer, unsigned int timeoutMs) override;
 
     // Check if the port is open (implements IComms)
     bool isOpen() const override;
 
+    // File descriptor for readiness polling, -1 if closed or on Windows (implements IComms).
+    // While the background reader runs this is an eventfd it signals for each chunk.
+    int getPollDescriptor() const override;
+
+    // Bytes read from the port but not yet returned (implements IComms)
+    size_t getBufferedBytes() const override;
+
+    // Syscall counters since construction, for reads made by the caller (not the reader thread)
+    const Stats &getStats() const { return _stats; }
+
 private:
     // Platform-specific handle/file descriptor
 #ifdef _WIN32
     HANDLE hSerial;
+    unsigned int _appliedTimeoutMs; // Read timeout currently in the port's COMMTIMEOUTS
 #else
     int fd;
 #endif
     bool _isOpen;
-
-    // Helper to convert BaudRate enum to platform-specific value
-    unsigned int getBaudRateValue(BaudRate baudRate);
-
-    // Helper to apply termination characters
-    std::string applyTermination(const std::string &data, TerminationMethod termination);
-};
-
-// --- Implementation ---
-
-Serial_Comms::Serial_Comms() :
-#ifdef _WIN32
-                               hSerial(INVALID_HANDLE_VALUE),
-#else
-                               fd(-1),
-#endif
-                               _isOpen(false)
-{
-}
-
-Serial_Comms::~Serial_Comms()
-{
-    close();
-}
-
-bool Serial_Comms::open(const std::string &portName)
-{
-    if (_isOpen)
-    {
-        std::cerr << "Error: Port already open." << std::endl;
-        return false;
-    }
-
-#ifdef _WIN32
-    hSerial = CreateFileA(
-        portName.c_str(),
-        GENERIC_READ | GENERIC_WRITE,
-        0,    // No sharing
-        NULL, // No security attributes
-        OPEN_EXISTING,
-        FILE_ATTRIBUTE_NORMAL, // | FILE_FLAG_OVERLAPPED for async I/O
-        NULL);
-
-    if (hSerial == INVALID_HANDLE_VALUE)
-    {
-        std::cerr << "Error opening serial port " << portName << ": " << GetLastError() << std::endl;
-        return false;
-    }
-
-    // Set default timeouts (can be reconfigured later)
-    COMMTIMEOUTS timeouts = {0};
-    timeouts.ReadIntervalTimeout = 50;
-    timeouts.ReadTotalTimeoutConstant = 50;
-    timeouts.ReadTotalTimeoutMultiplier = 10;
-    timeouts.WriteTotalTimeoutConstant = 50;
-    timeouts.WriteTotalTimeoutMultiplier = 10;
-    if (!SetCommTimeouts(hSerial, &timeouts))
-    {
-        std::cerr << "Error setting default timeouts: " << GetLastError() << std::endl;
-        CloseHandle(hSerial);
-        hSerial = INVALID_HANDLE_VALUE;
-        return false;
-    }
-
-#else // Linux
-    fd = ::open(portName.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK); // O_NONBLOCK for non-blocking reads
-
-    if (fd == -1)
-    {
-        std::cerr << "Error opening serial port " << portName << ": " << strerror(errno) << std::endl;
-        return false;
-    }
-
-    // Clear O_NONBLOCK for blocking reads by default, will be handled by VMIN/VTIME
-    int flags = fcntl(fd, F_GETFL, 0);
-    fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
-
-#endif
-    _isOpen = true;
-    return true;
-}
-
-void Serial_Comms::close()
-{
-    if (_isOpen)
-    {
-#ifdef _WIN32
-        CloseHandle(hSerial);
-        hSerial = INVALID_HANDLE_VALUE;
-#else
-        ::close(fd);
-        fd = -1;
-#endif
-        _isOpen = false;
-    }
-}
-
-bool Serial_Comms::configure(
-    BaudRate baudRate,
-    DataBits dataBits,
-    Parity parity,
-    StopBits stopBits,
-    FlowControl flowControl)
-{
-    if (!_isOpen)
-    {
-        std::cerr << "Error: Port not open. Cannot configure." << std::endl;
-        return false;
-    }
-
-#ifdef _WIN32
-    DCB dcbSerialParams = {0};
-    dcbSerialParams.DCBlength = sizeof(dcbSerialParams);
-
-    if (!GetCommState(hSerial, &dcbSerialParams))
-    {
-        std::cerr << "Error getting current serial port state: " << GetLastError() << std::endl;
-        return false;
-    }
-
-    dcbSerialParams.BaudRate = getBaudRateValue(baudRate);
-
-    switch (dataBits)
-    {
-    case DataBits::DB_5:
-        dcbSerialParams.ByteSize = 5;
-        break;
-    case DataBits::DB_6:
-        dcbSerialParams.ByteSize = 6;
-        break;
-    case DataBits::DB_7:
-        dcbSerialParams.ByteSize = 7;
-        break;
-    case DataBits::DB_8:
-        dcbSerialParams.ByteSize = 8;
-        break;
-    }
-
-    switch (parity)
-    {
-    case Parity::None:
-        dcbSerialParams.Parity = NOPARITY;
-        break;
-    case Parity::Odd:
-        dcbSerialParams.Parity = ODDPARITY;
-        break;
-    case Parity::Even:
-        dcbSerialParams.Parity = EVENPARITY;
-        break;
-    case Parity::Mark:
-        dcbSerialParams.Parity = MARKPARITY;
-        break;
-    case Parity::Space:
-        dcbSerialParams.Parity = SPACEPARITY;
-        break;
-    }
-
-    switch (stopBits)
-    {
-    case StopBits::SB_1:
-        dcbSerialParams.StopBits = ONESTOPBIT;
-        break;
-    case StopBits::SB_1_5:
-        dcbSerialParams.StopBits = ONE5STOPBITS;
-        break;
-    case StopBits::SB_2:
-        dcbSerialParams.StopBits = TWOSTOPBITS;
-        break;
-    }
-
-    dcbSerialParams.fDtrControl = DTR_CONTROL_DISABLE; // Default to disable DTR
-    dcbSerialParams.fRtsControl = RTS_CONTROL_DISABLE; // Default to disable RTS
-
-    switch (flowControl)
-    {
-    case FlowControl::None:
-        dcbSerialParams.fOutxCtsFlow = FALSE;
-        dcbSerialParams.fRtsControl = RTS_CONTROL_DISABLE;
-        dcbSerialParams.fOutxXonOut = FALSE;
-        dcbSerialParams.fInX = FALSE;
-        break;
-    case FlowControl::Hardware:
-        dcbSerialParams.fOutxCtsFlow = TRUE;
-        dcbSerialParams.fRtsControl = RTS_CONTROL_ENABLE; // Or RTS_CONTROL_HANDSHAKE
-        dcbSerialParams.fOutxXonOut = FALSE;
-        dcbSerialParams.fInX = FALSE;
-        break;
-    case FlowControl::Software:
-        dcbSerialParams.fOutxCtsFlow = FALSE;
-        dcbSerialParams.fRtsControl = RTS_CONTROL_DISABLE;
-        dcbSerialParams.fOutxXonOut = TRUE;
-        dcbSerialParams.fInX = TRUE;
-        break;
-    }
-
-    if (!SetCommState(hSerial, &dcbSerialParams))
-    {
-        std::cerr << "Error setting serial port state: " << GetLastError() << std::endl;
-        return false;
-    }
-
-#else // Linux
-    struct termios tty;
-    if (tcgetattr(fd, &tty) != 0)
-    {
-        std::cerr << "Error getting termios attributes: " << strerror(errno) << std::endl;
-        return false;
-    }
-
-    // Set baud rate
-    cfsetospeed(&tty, getBaudRateValue(baudRate));
-    cfsetispeed(&tty, getBaudRateValue(baudRate));
-
-    // Set data bits
-    tty.c_cflag &= ~CSIZE; // Clear current data bit setting
-    switch (dataBits)
-    {
-    case DataBits::DB_5:
-        tty.c_cflag |= CS5;
-        break;
-    case DataBits::DB_6:
-        tty.c_cflag |= CS6;
-        break;
-    case DataBits::DB_7:
-        tty.c_cflag |= CS7;
-        break;
-    case DataBits::DB_8:
-        tty.c_cflag |= CS8;
-        break;
-    }
-
-    // Set parity
-    tty.c_cflag &= ~PARENB; // Disable parity by default
-    tty.c_cflag &= ~PARODD; // Disable odd parity by default
-    switch (parity)
-    {
-    case Parity::None:
-        tty.c_cflag &= ~PARENB;
-        break;
-    case Parity::Odd:
-        tty.c_cflag |= PARENB;
-        tty.c_cflag |= PARODD;
-        break;
-    case Parity::Even:
-        tty.c_cflag |= PARENB;
-        tty.c_cflag &= ~PARODD;
-        break;
-    case Parity::Mark:  // Not directly supported, often treated as None or Odd
-    case Parity::Space: // Not directly supported, often treated as None or Even
-        std::cerr << "Warning: Mark/Space parity not directly supported on Linux. Using None." << std::endl;
-        tty.c_cflag &= ~PARENB;
-        break;
-    }
-
-    // Set stop bits
-    tty.c_cflag &= ~CSTOPB; // Clear stop bit setting (1 stop bit)
-    switch (stopBits)
-    {
-    case StopBits::SB_1:
-        // CSTOPB is 0 for 1 stop bit
-        break;
-    case StopBits::SB_1_5: // Not directly supported on Linux, use 1 or 2
-        std::cerr << "Warning: 1.5 stop bits not directly supported on Linux. Using 1 stop bit." << std::endl;
-        break;
-    case StopBits::SB_2:
-        tty.c_cflag |= CSTOPB; // Set for 2 stop bits
-        break;
-    }
-
-    // Set flow control
-    tty.c_cflag &= ~CRTSCTS;                // Disable hardware flow control by default
-    tty.c_iflag &= ~(IXON | IXOFF | IXANY); // Disable software flow control by default
-
-    switch (flowControl)
-    {
-    case FlowControl::None:
-        break;
-    case FlowControl::Hardware:
-        tty.c_cflag |= CRTSCTS;
-        break;
-    case FlowControl::Software:
-        tty.c_iflag |= (IXON | IXOFF | IXANY);
-        break;
-    }
-
-    // Local mode (enable receiver, ignore modem control lines)
-    tty.c_cflag |= (CLOCAL | CREAD);
-
-    // Raw input mode (no special processing of input characters)
-    tty.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG);
-
-    // Raw output mode (no special processing of output characters)
-    tty.c_oflag &= ~OPOST;
-
-    // Input flags (disable parity checking, strip 8th bit, etc.)
-    tty.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL);
-
-    // Set VMIN and VTIME for read operations (blocking read with timeout)
-    // VMIN = 0, VTIME = 0: Non-blocking read (read returns immediately)
-    // VMIN > 0, VTIME = 0: Blocking read until VMIN bytes are received
-    // VMIN = 0, VTIME > 0: Read with timeout (VTIME * 0.1 seconds)
-    // VMIN > 0, VTIME > 0: Blocking read until VMIN bytes or timeout after first byte
-    tty.c_cc[VMIN] = 0;  // Minimum number of characters to read
-    tty.c_cc[VTIME] = 0; // Timeout in 0.1s increments (will be set dynamically for reads)
-
-    if (tcsetattr(fd, TCSANOW, &tty) != 0)
-    {
-        std::cerr << "Error setting termios attributes: " << strerror(errno) << std::endl;
-        return false;
-    }
-
+    ReadProfile _readProfile;
+
+    // Read but not yet returned bytes live in [_receiveStart, _receiveEnd)
+    std::vector<char> _receiveBuffer;
+    size_t _receiveStart;
+    size_t _receiveEnd;
+    Stats _stats;
+
+    // Ring, thread and wake-up handle of the background reader, if started
+    struct BackgroundReader;
+    std::unique_ptr<BackgroundReader> _reader;
+    std::optional<std::chrono::steady_clock::time_point> _lastArrival;
+
+    // Applies _readProfile to the open port
+    bool applyReadProfile();
+#ifndef _WIN32
+    // Sets VMIN/VTIME in tty for _readProfile
+    void setReadCharacters(struct termios &tty) const;
 #endif
-    return true;
-}
 
-bool Serial_Comms::write(const std::string &data, TerminationMethod termination)
-{
-    if (!_isOpen)
-    {
-        std::cerr << "Error: Port not open. Cannot write." << std::endl;
-        return false;
-    }
+    // Waits up to timeoutMs for data, then reads once into dest, counting syscalls in stats.
+    // Returns the bytes read, 0 on timeout, -1 on error or hangup.
+    int receiveOnce(char *dest, size_t length, unsigned int timeoutMs, Stats &stats);
 
-    std::string dataToSend = applyTermination(data, termination);
+    // receiveOnce() from the port, or takeFromRing() while the background reader has data
+    int receive(char *dest, size_t length, unsigned int timeoutMs);
 
-#ifdef _WIN32
-    DWORD bytesWritten;
-    if (!WriteFile(hSerial, dataToSend.c_str(), dataToSend.length(), &bytesWritten, NULL))
-    {
-        std::cerr << "Error writing to serial port: " << GetLastError() << std::endl;
-        return false;
-    }
-    if (bytesWritten != dataToSend.length())
-    {
-        std::cerr << "Warning: Not all bytes written to serial port." << std::endl;
-    }
-#else // Linux
-    ssize_t bytesWritten = ::write(fd, dataToSend.c_str(), dataToSend.length());
-    if (bytesWritten == -1)
-    {
-        std::cerr << "Error writing to serial port: " << strerror(errno) << std::endl;
-        return false;
-    }
-    if (static_cast<size_t>(bytesWritten) != dataToSend.length())
-    {
-        std::cerr << "Warning: Not all bytes written to serial port." << std::endl;
-    }
-#endif
-    return true;
-}
+    // Waits up to timeoutMs for the ring to hold data, then copies bytes of one chunk into dest.
+    // Returns the bytes copied, 0 on timeout, -1 once the reader has failed and the ring is empty.
+    int takeFromRing(char *dest, size_t length, unsigned int timeoutMs);
 
-std::string Serial_Comms::read(TerminationMethod termination, unsigned int timeoutMs, size_t maxLength)
-{
-    if (!_isOpen)
-    {
-        std::cerr << "Error: Port not open. Cannot read." << std::endl;
-        return "";
-    }
-
-    std::string receivedData;
-    char buffer[1]; // Read one byte at a time
-    auto startTime = std::chrono::high_resolution_clock::now();
-
-    // Define termination characters
-    char termChar1 = 0;
-    char termChar2 = 0;
-    if (termination == TerminationMethod::CR || termination == TerminationMethod::CRLF)
-    {
-        termChar1 = '\r';
-    }
-    if (termination == TerminationMethod::LF || termination == TerminationMethod::CRLF)
-    {
-        termChar2 = '\n';
-    }
+    // Body of the reader thread
+    void runReader();
 
-#ifdef _WIN32
-    COMMTIMEOUTS originalTimeouts;
-    if (!GetCommTimeouts(hSerial, &originalTimeouts))
-    {
-        std::cerr << "Error getting original timeouts: " << GetLastError() << std::endl;
-        return "";
-    }
-
-    COMMTIMEOUTS timeouts = {0};
-    timeouts.ReadIntervalTimeout = 0;              // No interval timeout
-    timeouts.ReadTotalTimeoutConstant = timeoutMs; // Total timeout for the read operation
-    timeouts.ReadTotalTimeoutMultiplier = 0;       // No multiplier
-    if (!SetCommTimeouts(hSerial, &timeouts))
-    {
-        std::cerr << "Error setting read timeouts: " << GetLastError() << std::endl;
-        return "";
-    }
-#else // Linux
-    struct termios originalTty;
-    if (tcgetattr(fd, &originalTty) != 0)
-    {
-        std::cerr << "Error getting original termios attributes: " << strerror(errno) << std::endl;
-        return "";
-    }
-    struct termios tty = originalTty;
-    tty.c_cc[VMIN] = 0;                // Read at least 0 bytes
-    tty.c_cc[VTIME] = timeoutMs / 100; // Timeout in 0.1s increments
-    if (tty.c_cc[VTIME] == 0 && timeoutMs > 0)
-        tty.c_cc[VTIME] = 1; // Ensure at least 1 unit if timeout > 0
-    if (tcsetattr(fd, TCSANOW, &tty) != 0)
-    {
-        std::cerr << "Error setting read timeouts: " << strerror(errno) << std::endl;
-        return "";
-    }
-#endif
-
-    while (true)
-    {
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - startTime).count();
-
-        if (elapsed > timeoutMs)
-        {
-            // std::cerr << "Read timeout occurred." << std::endl; // Uncomment for debug
-            break;
-        }
+    // receive() into the free end of _receiveBuffer
+    int fillReceiveBuffer(unsigned int timeoutMs);
 
-        if (maxLength > 0 && receivedData.length() >= maxLength)
-        {
-            // std::cerr << "Max length reached." << std::endl; // Uncomment for debug
-            break;
-        }
+    // Copies buffered bytes into buffer; returns the count copied
+    size_t takeBuffered(std::span<std::byte> buffer);
 
-#ifdef _WIN32
-        DWORD bytesRead;
-        if (!ReadFile(hSerial, buffer, 1, &bytesRead, NULL))
-        {
-            if (GetLastError() == ERROR_IO_PENDING)
-            {
-                // This would be handled with overlapped I/O, but for simple blocking,
-                // we just assume it's a timeout if no data is available.
-                std::this_thread::sleep_for(std::chrono::milliseconds(1)); // Small delay to prevent busy-waiting
-                continue;
-            }
-            std::cerr << "Error reading from serial port: " << GetLastError() << std::endl;
-            break;
-        }
-        if (bytesRead == 0)
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-            continue;
-        }
-#else // Linux
-        ssize_t bytesRead = ::read(fd, buffer, 1);
-        if (bytesRead == -1)
-        {
-            if (errno == EAGAIN || errno == EWOULDBLOCK)
-            {
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                continue; // No data available yet, continue waiting
-            }
-            std::cerr << "Error reading from serial port: " << strerror(errno) << std::endl;
-            break;
-        }
-        if (bytesRead == 0)
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-            continue;
-        }
-#endif
-        receivedData += buffer[0];
-
-        // Check for termination
-        if (termination != TerminationMethod::None)
-        {
-            if (termination == TerminationMethod::CR && buffer[0] == termChar1)
-            {
-                break;
-            }
-            else if (termination == TerminationMethod::LF && buffer[0] == termChar2)
-            {
-                break;
-            }
-            else if (termination == TerminationMethod::CRLF)
-            {
-                if (receivedData.length() >= 2 &&
-                    receivedData[receivedData.length() - 2] == termChar1 &&
-                    receivedData[receivedData.length() - 1] == termChar2)
-                {
-                    break;
-                }
-            }
-        }
-    }
-
-    // Restore original timeouts/termios settings
-#ifdef _WIN32
-    SetCommTimeouts(hSerial, &originalTimeouts);
-#else
-    tcsetattr(fd, TCSANOW, &originalTty);
-#endif
-
-    return receivedData;
-}
-
-std::string Serial_Comms::readBytes(size_t numBytes, unsigned int timeoutMs)
-{
-    if (!_isOpen)
-    {
-        std::cerr << "Error: Port not open. Cannot read bytes." << std::endl;
-        return "";
-    }
+    // Length of data up to and including the first terminator, 0 if there is none.
+    // previous is the byte received just before data, for a CRLF split between reads.
+    static size_t findTermination(std::string_view data, TerminationMethod termination, char previous);
 
-    std::string receivedData;
-    receivedData.reserve(numBytes); // Pre-allocate memory
-    char buffer[1];
-    auto startTime = std::chrono::high_resolution_clock::now();
-
-#ifdef _WIN32
-    COMMTIMEOUTS originalTimeouts;
-    if (!GetCommTimeouts(hSerial, &originalTimeouts))
-    {
-        std::cerr << "Error getting original timeouts: " << GetLastError() << std::endl;
-        return "";
-    }
-
-    COMMTIMEOUTS timeouts = {0};
-    timeouts.ReadIntervalTimeout = 0;
-    timeouts.ReadTotalTimeoutConstant = timeoutMs;
-    timeouts.ReadTotalTimeoutMultiplier = 0;
-    if (!SetCommTimeouts(hSerial, &timeouts))
-    {
-        std::cerr << "Error setting read timeouts: " << GetLastError() << std::endl;
-        return "";
-    }
-#else // Linux
-    struct termios originalTty;
-    if (tcgetattr(fd, &originalTty) != 0)
-    {
-        std::cerr << "Error getting original termios attributes: " << strerror(errno) << std::endl;
-        return "";
-    }
-    struct termios tty = originalTty;
-    tty.c_cc[VMIN] = 0;                // Read at least 0 bytes
-    tty.c_cc[VTIME] = timeoutMs / 100; // Timeout in 0.1s increments
-    if (tty.c_cc[VTIME] == 0 && timeoutMs > 0)
-        tty.c_cc[VTIME] = 1;
-    if (tcsetattr(fd, TCSANOW, &tty) != 0)
-    {
-        std::cerr << "Error setting read timeouts: " << strerror(errno) << std::endl;
-        return "";
-    }
-#endif
-
-    while (receivedData.length() < numBytes)
-    {
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - startTime).count();
-
-        if (elapsed > timeoutMs)
-        {
-            // std::cerr << "Read bytes timeout occurred. Read " << receivedData.length() << " of " << numBytes << " bytes." << std::endl; // Uncomment for debug
-            break;
-        }
-
-#ifdef _WIN32
-        DWORD bytesRead;
-        if (!ReadFile(hSerial, buffer, 1, &bytesRead, NULL))
-        {
-            if (GetLastError() == ERROR_IO_PENDING)
-            {
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                continue;
-            }
-            std::cerr << "Error reading from serial port: " << GetLastError() << std::endl;
-            break;
-        }
-        if (bytesRead == 0)
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-            continue;
-        }
-#else // Linux
-        ssize_t bytesRead = ::read(fd, buffer, 1);
-        if (bytesRead == -1)
-        {
-            if (errno == EAGAIN || errno == EWOULDBLOCK)
-            {
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                continue;
-            }
-            std::cerr << "Error reading from serial port: " << strerror(errno) << std::endl;
-            break;
-        }
-        if (bytesRead == 0)
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-            continue;
-        }
-#endif
-        receivedData += buffer[0];
-    }
-
-    // Restore original timeouts/termios settings
-#ifdef _WIN32
-    SetCommTimeouts(hSerial, &originalTimeouts);
-#else
-    tcsetattr(fd, TCSANOW, &originalTty);
-#endif
-
-    return receivedData;
-}
-
-bool Serial_Comms::isOpen() const
-{
-    return _isOpen;
-}
-
-unsigned int Serial_Comms::getBaudRateValue(BaudRate baudRate)
-{
-#ifdef _WIN32
-    switch (baudRate)
-    {
-    case BaudRate::BR_9600:
-        return CBR_9600;
-    case BaudRate::BR_19200:
-        return CBR_19200;
-    case BaudRate::BR_38400:
-        return CBR_38400;
-    case BaudRate::BR_57600:
-        return CBR_57600;
-    case BaudRate::BR_115200:
-        return CBR_115200;
-    case BaudRate::BR_230400:
-        return 230400; // Custom baud rate for Windows
-    case BaudRate::BR_460800:
-        return 460800; // Custom baud rate for Windows
-    case BaudRate::BR_921600:
-        return 921600; // Custom baud rate for Windows
-    default:
-        return CBR_9600; // Default to 9600
-    }
-#else // Linux
-    switch (baudRate)
-    {
-    case BaudRate::BR_9600:
-        return B9600;
-    case BaudRate::BR_19200:
-        return B19200;
-    case BaudRate::BR_38400:
-        return B38400;
-    case BaudRate::BR_57600:
-        return B57600;
-    case BaudRate::BR_115200:
-        return B115200;
-    case BaudRate::BR_230400:
-        return B230400;
-    case BaudRate::BR_460800:
-#ifdef B460800
-        return B460800;
-#else
-        std::cerr << "Warning: Baud rate BR_460800 not supported on this system. Falling back to 115200." << std::endl;
-        return B115200;
-#endif
-    case BaudRate::BR_921600:
-#ifdef B921600
-        return B921600;
-#else
-        std::cerr << "Warning: Baud rate BR_921600 not supported on this system. Falling back to 115200." << std::endl;
-        return B115200;
-#endif
-    default:
-        return B9600; // Default to 9600
-    }
-#endif
-}
+    // Helper to convert BaudRate enum to platform-specific value
+    unsigned int getBaudRateValue(BaudRate baudRate);
 
-std::string Serial_Comms::applyTermination(const std::string &data, TerminationMethod termination)
-{
-    std::string terminatedData = data;
-    switch (termination)
-    {
-    case TerminationMethod::CR:
-        terminatedData += '\r';
-        break;
-    case TerminationMethod::LF:
-        terminatedData += '\n';
-        break;
-    case TerminationMethod::CRLF:
-        terminatedData += "\r\n";
-        break;
-    case TerminationMethod::None:
-        // No termination needed
-        break;
-    }
-    return terminatedData;
-}
+    // Helper to apply termination characters
+    std::string applyTermination(const std::string &data, TerminationMethod termination);
+};
 
 #endif // SERIAL_COMMS_H
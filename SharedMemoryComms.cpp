@@ -0,0 +1,293 @@
+#include "SharedMemoryComms.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <climits>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+    constexpr uint32_t kRingMagic = 0x4E4D4541; // "NMEA"
+    constexpr uint32_t kRingVersion = 1;
+
+    // Shared (not FUTEX_PRIVATE) so waiters in other processes are woken
+    int futexWait(std::atomic<uint32_t> *word, uint32_t expected, unsigned int timeoutMs)
+    {
+        struct timespec ts;
+        ts.tv_sec = timeoutMs / 1000;
+        ts.tv_nsec = static_cast<long>(timeoutMs % 1000) * 1000000;
+        return static_cast<int>(syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT, expected, &ts, nullptr, 0));
+    }
+
+    void futexWakeAll(std::atomic<uint32_t> *word)
+    {
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    size_t roundUpToPowerOfTwo(size_t value)
+    {
+        size_t result = 4096;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+// --- SharedMemoryWriter ---
+
+SharedMemoryWriter::SharedMemoryWriter() : _header(nullptr), _data(nullptr), _mappingSize(0)
+{
+}
+
+SharedMemoryWriter::~SharedMemoryWriter()
+{
+    close();
+}
+
+bool SharedMemoryWriter::create(const std::string &name, size_t capacity)
+{
+    if (_header != nullptr)
+    {
+        std::cerr << "Error: shared memory ring already created." << std::endl;
+        return false;
+    }
+
+    capacity = roundUpToPowerOfTwo(capacity);
+    shm_unlink(name.c_str()); // Start from a clean object if a previous writer crashed
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+    if (fd == -1)
+    {
+        std::cerr << "shm_open error for " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    _mappingSize = sizeof(SharedRingHeader) + capacity;
+    if (ftruncate(fd, static_cast<off_t>(_mappingSize)) != 0)
+    {
+        std::cerr << "ftruncate error for " << name << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void *mapping = mmap(nullptr, _mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "mmap error for " << name << ": " << strerror(errno) << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    _name = name;
+    _header = new (mapping) SharedRingHeader{kRingMagic, kRingVersion, capacity, {0}, {0}, {0}, {0}, {0}};
+    _data = reinterpret_cast<std::byte *>(_header + 1);
+    return true;
+}
+
+bool SharedMemoryWriter::write(std::span<const std::byte> data)
+{
+    if (_header == nullptr || data.size() > _header->capacity)
+    {
+        return false;
+    }
+
+    const uint64_t mask = _header->capacity - 1;
+    uint64_t position = _header->writePosition.load(std::memory_order_relaxed);
+
+    // Seqlock-style reservation: readers that copied bytes this write overwrites will see it
+    _header->reservedPosition.store(position + data.size(), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    size_t offset = static_cast<size_t>(position & mask);
+    size_t first = std::min(data.size(), static_cast<size_t>(_header->capacity) - offset);
+    memcpy(_data + offset, data.data(), first);
+    memcpy(_data, data.data() + first, data.size() - first);
+
+    // Publish: readers acquire writePosition before touching the bytes. seq_cst, not just
+    // release, so this store cannot be reordered after the sleepers load below. That pairs
+    // with the reader's sleepers.fetch_add followed by its writePosition re-check: either
+    // the reader sees the new position, or this load sees the sleeper and wakes it.
+    _header->writePosition.store(position + data.size(), std::memory_order_seq_cst);
+
+    // Only pay for a wake-up syscall when a reader is actually asleep
+    if (_header->sleepers.load(std::memory_order_seq_cst) > 0)
+    {
+        _header->sequence.fetch_add(1, std::memory_order_seq_cst);
+        futexWakeAll(&_header->sequence);
+    }
+    return true;
+}
+
+bool SharedMemoryWriter::write(const std::string &data)
+{
+    return write(std::as_bytes(std::span<const char>(data.data(), data.size())));
+}
+
+void SharedMemoryWriter::close()
+{
+    if (_header == nullptr)
+    {
+        return;
+    }
+    _header->closed.store(1, std::memory_order_release);
+    _header->sequence.fetch_add(1, std::memory_order_seq_cst);
+    futexWakeAll(&_header->sequence);
+
+    munmap(_header, _mappingSize);
+    shm_unlink(_name.c_str()); // Attached readers keep their mapping until they close
+    _header = nullptr;
+    _data = nullptr;
+}
+
+// --- SharedMemoryComms ---
+
+SharedMemoryComms::SharedMemoryComms()
+    : _header(nullptr), _data(nullptr), _mappingSize(0), _cursor(0), _overrunBytes(0)
+{
+}
+
+SharedMemoryComms::~SharedMemoryComms()
+{
+    close();
+}
+
+bool SharedMemoryComms::open(const std::string &name)
+{
+    if (_header != nullptr)
+    {
+        std::cerr << "Error: shared memory reader already open." << std::endl;
+        return false;
+    }
+
+    int fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        std::cerr << "shm_open error for " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SharedRingHeader))
+    {
+        std::cerr << "Error: " << name << " is not a shared memory ring." << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    // Read-write: readers register themselves as sleepers in the header
+    void *mapping = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "mmap error for " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    SharedRingHeader *header = static_cast<SharedRingHeader *>(mapping);
+    if (header->magic != kRingMagic || header->version != kRingVersion ||
+        sizeof(SharedRingHeader) + header->capacity > static_cast<size_t>(st.st_size))
+    {
+        std::cerr << "Error: " << name << " has an incompatible ring layout." << std::endl;
+        munmap(mapping, static_cast<size_t>(st.st_size));
+        return false;
+    }
+
+    _header = header;
+    _data = reinterpret_cast<const std::byte *>(header + 1);
+    _mappingSize = static_cast<size_t>(st.st_size);
+    _cursor = header->writePosition.load(std::memory_order_acquire); // New readers start live
+    _overrunBytes = 0;
+    return true;
+}
+
+void SharedMemoryComms::close()
+{
+    if (_header != nullptr)
+    {
+        munmap(_header, _mappingSize);
+        _header = nullptr;
+        _data = nullptr;
+    }
+}
+
+bool SharedMemoryComms::waitForData(unsigned int timeoutMs)
+{
+    uint32_t sequence = _header->sequence.load(std::memory_order_seq_cst);
+    _header->sleepers.fetch_add(1, std::memory_order_seq_cst);
+
+    // Re-check after registering so a write between the checks cannot be missed
+    bool ready = _header->writePosition.load(std::memory_order_seq_cst) != _cursor ||
+                 _header->closed.load(std::memory_order_acquire) != 0;
+    if (!ready && timeoutMs > 0)
+    {
+        futexWait(&_header->sequence, sequence, timeoutMs);
+        ready = _header->writePosition.load(std::memory_order_acquire) != _cursor;
+    }
+
+    _header->sleepers.fetch_sub(1, std::memory_order_seq_cst);
+    return ready;
+}
+
+size_t SharedMemoryComms::readInto(std::span<std::byte> buffer, unsigned int timeoutMs)
+{
+    if (_header == nullptr || buffer.empty())
+    {
+        return 0;
+    }
+
+    uint64_t written = _header->writePosition.load(std::memory_order_acquire);
+    if (written == _cursor)
+    {
+        if (!waitForData(timeoutMs))
+        {
+            return 0;
+        }
+    }
+
+    const uint64_t capacity = _header->capacity;
+    while (true)
+    {
+        written = _header->writePosition.load(std::memory_order_acquire);
+        uint64_t reserved = _header->reservedPosition.load(std::memory_order_acquire);
+        if (reserved - _cursor > capacity)
+        {
+            // Lapped by the writer: the oldest bytes are gone, resume from the oldest intact byte
+            _overrunBytes += reserved - capacity - _cursor;
+            _cursor = reserved - capacity;
+        }
+
+        size_t count = static_cast<size_t>(std::min<uint64_t>(buffer.size(), written - _cursor));
+        size_t offset = static_cast<size_t>(_cursor & (capacity - 1));
+        size_t first = std::min(count, static_cast<size_t>(capacity) - offset);
+        memcpy(buffer.data(), _data + offset, first);
+        memcpy(buffer.data() + first, _data, count - first);
+
+        // The writer may have started overwriting what we copied while we were copying it
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_header->reservedPosition.load(std::memory_order_relaxed) - _cursor > capacity)
+        {
+            continue; // Torn copy: skip ahead and copy again
+        }
+
+        _cursor += count;
+        return count;
+    }
+}
+
+bool SharedMemoryComms::isOpen() const
+{
+    if (_header == nullptr)
+    {
+        return false;
+    }
+    return _header->closed.load(std::memory_order_acquire) == 0 ||
+           _header->writePosition.load(std::memory_order_acquire) != _cursor;
+}
@@ -0,0 +1,126 @@
+#ifndef SHARED_MEMORY_COMMS_HPP
+#define SHARED_MEMORY_COMMS_HPP
+
+#include "IComms.hpp"
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <string>
+
+/**
+ * @brief Layout of the shared ring, placed at the start of the POSIX shared memory object.
+ * The data area follows immediately and is `capacity` bytes long (a power of two).
+ */
+struct SharedRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+    std::atomic<uint64_t> writePosition; ///< Total bytes ever written (monotonic)
+    std::atomic<uint64_t> reservedPosition; ///< End of the write in progress; bytes below reserved - capacity may be overwritten
+    std::atomic<uint32_t> sequence;      ///< Futex word, bumped when sleeping readers must wake
+    std::atomic<uint32_t> sleepers;      ///< Readers currently waiting on the futex
+    std::atomic<uint32_t> closed;        ///< Set by the writer on close
+};
+
+/**
+ * @brief Single producer side of a shared-memory NMEA transport (Linux).
+ *
+ * Creates a named POSIX shared memory ring. Writes never block: a reader that falls
+ * more than one ring behind skips ahead and counts the loss, so a stalled analytics
+ * process cannot hold up the receiver. Sleeping readers are woken with a futex only
+ * when one is actually waiting, so a busy stream costs no syscall per write.
+ */
+class SharedMemoryWriter {
+public:
+    SharedMemoryWriter();
+    ~SharedMemoryWriter();
+
+    SharedMemoryWriter(const SharedMemoryWriter&) = delete;
+    SharedMemoryWriter& operator=(const SharedMemoryWriter&) = delete;
+
+    /**
+     * @brief Creates (or replaces) the shared memory object.
+     * @param name POSIX shm name, e.g. "/nmea_feed".
+     * @param capacity Ring size in bytes, rounded up to a power of two.
+     * @return True on success.
+     */
+    bool create(const std::string& name, size_t capacity = 1 << 20);
+
+    /**
+     * @brief Appends bytes to the ring and wakes sleeping readers.
+     * @param data The bytes to publish; must not exceed the ring capacity.
+     * @return True on success, false if not created or data is too large.
+     */
+    bool write(std::span<const std::byte> data);
+
+    /// @brief Convenience overload for text such as NMEA sentences.
+    bool write(const std::string& data);
+
+    /**
+     * @brief Marks the stream closed, wakes readers and removes the shm name.
+     */
+    void close();
+
+    bool isOpen() const { return _header != nullptr; }
+
+private:
+    std::string _name;
+    SharedRingHeader* _header;
+    std::byte* _data;
+    size_t _mappingSize;
+};
+
+/**
+ * @brief Reader side of the shared-memory transport, usable wherever an IComms is expected.
+ *
+ * Any number of readers may attach to one writer; each keeps its own cursor and
+ * starts at the writer's current position. Reads copy straight out of the shared
+ * mapping and only enter the kernel (futex wait) when no data is pending.
+ */
+class SharedMemoryComms : public IComms {
+public:
+    SharedMemoryComms();
+    ~SharedMemoryComms();
+
+    SharedMemoryComms(const SharedMemoryComms&) = delete;
+    SharedMemoryComms& operator=(const SharedMemoryComms&) = delete;
+
+    /**
+     * @brief Attaches to a ring created by SharedMemoryWriter.
+     * @param name The POSIX shm name used by the writer.
+     * @return True on success.
+     */
+    bool open(const std::string& name);
+
+    /**
+     * @brief Detaches from the ring.
+     */
+    void close();
+
+    /**
+     * @brief Copies pending bytes into the caller's buffer, waiting up to timeoutMs if none are pending.
+     * @param buffer Destination memory.
+     * @param timeoutMs The timeout in milliseconds for the read operation.
+     * @return The number of bytes copied (0 on timeout, or once the writer has closed and all data was read).
+     */
+    size_t readInto(std::span<std::byte> buffer, unsigned int timeoutMs) override;
+
+    /**
+     * @brief Open while attached and the writer has not closed (or unread data remains).
+     */
+    bool isOpen() const override;
+
+    /// @brief Bytes skipped because this reader fell more than one ring behind the writer.
+    uint64_t getOverrunBytes() const { return _overrunBytes; }
+
+private:
+    SharedRingHeader* _header;
+    const std::byte* _data;
+    size_t _mappingSize;
+    uint64_t _cursor;
+    uint64_t _overrunBytes;
+
+    bool waitForData(unsigned int timeoutMs);
+};
+
+#endif // SHARED_MEMORY_COMMS_HPP
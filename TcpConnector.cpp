@@ -0,0 +1,312 @@
+#include "TcpConnector.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <netdb.h>
+#include <sys/epoll.h>
+
+TcpConnector::TcpConnector(const NetworkComms::ConnectOptions &options)
+    : _options(options),
+      _state(State::Idle),
+      _nextAddress(0),
+      _winner(-1),
+      _attemptsStarted(0),
+      _lastError(0),
+      _epollFd(-1),
+      _epollToken(0)
+{
+}
+
+TcpConnector::~TcpConnector()
+{
+    cancel();
+}
+
+std::vector<TcpConnector::Address> TcpConnector::resolve(const std::string &host, const std::string &port)
+{
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    int status = getaddrinfo(host.c_str(), port.c_str(), &hints, &res);
+    if (status != 0)
+    {
+        std::cerr << "getaddrinfo error for " << host << ": " << gai_strerror(status) << std::endl;
+        return {};
+    }
+
+    // Split by family, keeping getaddrinfo's (RFC 6724) order within each family
+    std::vector<Address> preferred, other;
+    int firstFamily = res->ai_family;
+    for (struct addrinfo *p = res; p != NULL; p = p->ai_next)
+    {
+        Address address;
+        memset(&address.storage, 0, sizeof address.storage);
+        memcpy(&address.storage, p->ai_addr, p->ai_addrlen);
+        address.length = static_cast<socklen_t>(p->ai_addrlen);
+        (p->ai_family == firstFamily ? preferred : other).push_back(address);
+    }
+    freeaddrinfo(res);
+
+    // Alternate families so a broken IPv6 (or IPv4) path costs at most one attempt delay
+    std::vector<Address> ordered;
+    ordered.reserve(preferred.size() + other.size());
+    for (size_t i = 0; i < std::max(preferred.size(), other.size()); ++i)
+    {
+        if (i < preferred.size())
+        {
+            ordered.push_back(preferred[i]);
+        }
+        if (i < other.size())
+        {
+            ordered.push_back(other[i]);
+        }
+    }
+    return ordered;
+}
+
+bool TcpConnector::start(const std::string &host, const std::string &port)
+{
+    return start(resolve(host, port));
+}
+
+bool TcpConnector::start(std::vector<Address> addresses)
+{
+    cancel();
+    _addresses = std::move(addresses);
+    _nextAddress = 0;
+    _attemptsStarted = 0;
+    _lastError = 0;
+    if (_addresses.empty())
+    {
+        _state = State::Failed;
+        return false;
+    }
+    _state = State::Connecting;
+    startNextAttempt(Clock::now());
+    return _state != State::Failed;
+}
+
+void TcpConnector::startNextAttempt(Clock::time_point now)
+{
+    while (_nextAddress < _addresses.size())
+    {
+        const Address &address = _addresses[_nextAddress++];
+        ++_attemptsStarted;
+        _lastStart = now;
+
+        int fd = socket(address.storage.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd == -1)
+        {
+            _lastError = errno;
+            continue;
+        }
+        if (::connect(fd, reinterpret_cast<const sockaddr *>(&address.storage), address.length) == 0)
+        {
+            // Completed synchronously (possible on loopback): no need to race further
+            _attempts.push_back({fd, now});
+            finish(_attempts.size() - 1);
+            return;
+        }
+        if (errno != EINPROGRESS)
+        {
+            // Refused or unreachable right away: move straight on to the next address
+            _lastError = errno;
+            ::close(fd);
+            continue;
+        }
+
+        // attemptTimeoutMs == 0: no deadline of our own, the kernel's SYN retries decide
+        Clock::time_point deadline = _options.attemptTimeoutMs == 0
+                                         ? Clock::time_point::max()
+                                         : now + std::chrono::milliseconds(_options.attemptTimeoutMs);
+        _attempts.push_back({fd, deadline});
+        if (_epollFd != -1)
+        {
+            struct epoll_event event;
+            event.events = EPOLLOUT;
+            event.data.u64 = _epollToken;
+            epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event);
+        }
+        return;
+    }
+
+    if (_attempts.empty())
+    {
+        _state = State::Failed;
+    }
+}
+
+TcpConnector::State TcpConnector::advance()
+{
+    if (_state != State::Connecting)
+    {
+        return _state;
+    }
+
+    // Connect completion shows up as writability; SO_ERROR tells success from failure
+    if (!_attempts.empty())
+    {
+        preparePollSet();
+        size_t count = _pollFds.size();
+        if (::poll(_pollFds.data(), count, 0) > 0)
+        {
+            for (size_t i = count; i-- > 0;)
+            {
+                if (_pollFds[i].revents == 0)
+                {
+                    continue;
+                }
+                int error = 0;
+                socklen_t length = sizeof error;
+                if (getsockopt(_attempts[i].fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0)
+                {
+                    finish(i);
+                    return _state;
+                }
+                _lastError = error != 0 ? error : errno;
+                closeAttempt(i);
+            }
+        }
+    }
+
+    Clock::time_point now = Clock::now();
+    for (size_t i = _attempts.size(); i-- > 0;)
+    {
+        if (now >= _attempts[i].deadline)
+        {
+            _lastError = ETIMEDOUT;
+            closeAttempt(i);
+        }
+    }
+
+    // A failure starts the next address at once; otherwise stagger by attemptDelayMs
+    if (_attempts.empty() || now - _lastStart >= std::chrono::milliseconds(_options.attemptDelayMs))
+    {
+        startNextAttempt(now);
+    }
+    return _state;
+}
+
+TcpConnector::State TcpConnector::wait(unsigned int timeoutMs)
+{
+    Clock::time_point end = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (advance() == State::Connecting)
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(end - Clock::now()).count();
+        if (remaining <= 0)
+        {
+            break;
+        }
+        preparePollSet();
+        size_t count = _pollFds.size();
+        int timeout = std::min<long long>(remaining, getTimeoutMs());
+        if (::poll(_pollFds.data(), count, timeout) == -1 && errno != EINTR)
+        {
+            std::cerr << "poll error: " << strerror(errno) << std::endl;
+            cancel();
+            _state = State::Failed;
+            break;
+        }
+    }
+    return _state;
+}
+
+void TcpConnector::preparePollSet()
+{
+    _pollFds.resize(_attempts.size());
+    for (size_t i = 0; i < _attempts.size(); ++i)
+    {
+        _pollFds[i].fd = _attempts[i].fd;
+        _pollFds[i].events = POLLOUT;
+        _pollFds[i].revents = 0;
+    }
+}
+
+std::chrono::steady_clock::time_point TcpConnector::getNextDeadline() const
+{
+    Clock::time_point next = Clock::time_point::max();
+    if (_state != State::Connecting)
+    {
+        return next;
+    }
+    for (const Attempt &attempt : _attempts)
+    {
+        next = std::min(next, attempt.deadline);
+    }
+    if (_nextAddress < _addresses.size())
+    {
+        next = std::min(next, _lastStart + std::chrono::milliseconds(_options.attemptDelayMs));
+    }
+    return next;
+}
+
+int TcpConnector::getTimeoutMs() const
+{
+    if (_state != State::Connecting)
+    {
+        return -1;
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(getNextDeadline() - Clock::now()).count();
+    // Round up so a caller sleeping this long does not wake just before the deadline
+    return static_cast<int>(std::clamp<long long>(ms + 1, 0, std::numeric_limits<int>::max()));
+}
+
+void TcpConnector::setEpoll(int epollFd, uint64_t token)
+{
+    _epollFd = epollFd;
+    _epollToken = token;
+}
+
+void TcpConnector::closeAttempt(size_t index)
+{
+    if (_epollFd != -1)
+    {
+        epoll_ctl(_epollFd, EPOLL_CTL_DEL, _attempts[index].fd, NULL);
+    }
+    ::close(_attempts[index].fd);
+    _attempts.erase(_attempts.begin() + static_cast<std::ptrdiff_t>(index));
+}
+
+void TcpConnector::finish(size_t winnerIndex)
+{
+    int winner = _attempts[winnerIndex].fd;
+    if (_epollFd != -1)
+    {
+        epoll_ctl(_epollFd, EPOLL_CTL_DEL, winner, NULL);
+    }
+    _attempts.erase(_attempts.begin() + static_cast<std::ptrdiff_t>(winnerIndex));
+    while (!_attempts.empty())
+    {
+        closeAttempt(_attempts.size() - 1);
+    }
+    _winner = winner;
+    _state = State::Connected;
+}
+
+int TcpConnector::takeSocket()
+{
+    if (_state != State::Connected)
+    {
+        return -1;
+    }
+    int fd = _winner;
+    _winner = -1;
+    _state = State::Idle;
+    return fd;
+}
+
+void TcpConnector::cancel()
+{
+    while (!_attempts.empty())
+    {
+        closeAttempt(_attempts.size() - 1);
+    }
+    if (_winner != -1)
+    {
+        ::close(_winner);
+        _winner = -1;
+    }
+    _state = State::Idle;
+}
@@ -0,0 +1,148 @@
+#ifndef TCP_CONNECTOR_HPP
+#define TCP_CONNECTOR_HPP
+
+#include "NetworkComms.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Non-blocking TCP connect that races a host's addresses (happy eyeballs, POSIX).
+ *
+ * NetworkComms::connect() used to try each getaddrinfo() result in turn with a blocking
+ * ::connect(), so one unreachable address stalled startup for the full SYN timeout.
+ * Here every address gets a non-blocking socket: the next attempt starts when the
+ * previous one fails or after attemptDelayMs (RFC 8305), the first to complete wins and
+ * the rest are closed. Each attempt is abandoned after attemptTimeoutMs, or left to the
+ * kernel's connect timeout when attemptTimeoutMs is 0.
+ *
+ * The connector never blocks unless wait() is called, so a caller can drive many of them
+ * from one event loop: setEpoll() registers every attempt socket for EPOLLOUT, and
+ * advance() is called when one fires or when getTimeoutMs() runs out.
+ */
+class TcpConnector {
+public:
+    enum class State {
+        Idle,       ///< start() not called yet
+        Connecting, ///< Attempts in flight or still to start
+        Connected,  ///< takeSocket() returns the winning socket
+        Failed      ///< Every address failed or timed out
+    };
+
+    /// @brief A resolved peer address.
+    struct Address {
+        sockaddr_storage storage;
+        socklen_t length;
+    };
+
+    explicit TcpConnector(const NetworkComms::ConnectOptions& options = NetworkComms::ConnectOptions());
+
+    /**
+     * @brief Destructor. Closes any attempt still in flight and an untaken winner.
+     */
+    ~TcpConnector();
+
+    TcpConnector(const TcpConnector&) = delete;
+    TcpConnector& operator=(const TcpConnector&) = delete;
+
+    /**
+     * @brief Resolves host for TCP and orders the results for racing: address families
+     * alternate, starting with the family getaddrinfo() preferred.
+     * @return The addresses; empty (with a message on std::cerr) if resolution failed.
+     */
+    static std::vector<Address> resolve(const std::string& host, const std::string& port);
+
+    /**
+     * @brief Resolves host and starts the first attempt.
+     * Resolution itself is a blocking getaddrinfo(); numeric addresses return at once.
+     * @return False if nothing could be resolved or every address failed immediately.
+     */
+    bool start(const std::string& host, const std::string& port);
+
+    /**
+     * @brief Races the given addresses in order.
+     * @return False if the list is empty or every address failed immediately.
+     */
+    bool start(std::vector<Address> addresses);
+
+    /**
+     * @brief Collects finished attempts, expires overdue ones and starts due ones. Never blocks.
+     * @return The state after the update.
+     */
+    State advance();
+
+    /**
+     * @brief Waits up to timeoutMs for an attempt to finish, then advances.
+     * Returns early once the connector is Connected or Failed.
+     */
+    State wait(unsigned int timeoutMs);
+
+    /**
+     * @brief Milliseconds until advance() has timer work to do (next attempt start or
+     * attempt expiry); -1 if the connector is not connecting.
+     */
+    int getTimeoutMs() const;
+
+    /**
+     * @brief When advance() next has timer work to do; time_point::max() if the
+     * connector is not connecting. Compare with now() to test for due work exactly.
+     */
+    std::chrono::steady_clock::time_point getNextDeadline() const;
+
+    /**
+     * @brief Registers attempt sockets with an epoll instance (Linux).
+     * Each attempt socket is added for EPOLLOUT with data.u64 = token and removed when it
+     * finishes; the winner is removed before takeSocket() hands it out.
+     */
+    void setEpoll(int epollFd, uint64_t token);
+
+    /**
+     * @brief Hands the connected socket to the caller, who then owns it.
+     * @return The non-blocking socket, or -1 unless the state is Connected.
+     */
+    int takeSocket();
+
+    /**
+     * @brief Closes every attempt and returns to Idle.
+     */
+    void cancel();
+
+    State getState() const { return _state; }
+
+    /// @brief Attempts started since the last start() call.
+    size_t getAttemptCount() const { return _attemptsStarted; }
+
+    /// @brief errno of the most recent failed attempt (ETIMEDOUT for an expired one).
+    int getLastError() const { return _lastError; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Attempt {
+        int fd;
+        Clock::time_point deadline;
+    };
+
+    NetworkComms::ConnectOptions _options;
+    State _state;
+    std::vector<Address> _addresses;
+    size_t _nextAddress;
+    std::vector<Attempt> _attempts;
+    Clock::time_point _lastStart;
+    int _winner;
+    size_t _attemptsStarted;
+    int _lastError;
+    int _epollFd;
+    uint64_t _epollToken;
+    std::vector<struct pollfd> _pollFds; // One entry per attempt, reused across calls
+
+    // Starts attempts until one is in flight or the addresses run out
+    void startNextAttempt(Clock::time_point now);
+    void closeAttempt(size_t index);
+    void finish(size_t winnerIndex);
+    // Fills _pollFds with every in-flight attempt, waiting for writability
+    void preparePollSet();
+};
+
+#endif // TCP_CONNECTOR_HPP
@@ -0,0 +1,100 @@
+/**
+ * @file TestSupport.hpp
+ * @brief Peers for the comms tests: a loopback TCP listener, a blocking send helper and
+ * a pseudo-terminal pair standing in for a serial device (POSIX only).
+ */
+
+#ifndef TEST_SUPPORT_HPP
+#define TEST_SUPPORT_HPP
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <string>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+// Loopback TCP listener on an ephemeral port; accept() hands back the server side
+class LoopbackListener {
+public:
+    LoopbackListener() {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(_fd, 64);
+        socklen_t len = sizeof(addr);
+        getsockname(_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        _port = ntohs(addr.sin_port);
+    }
+    ~LoopbackListener() { ::close(_fd); }
+
+    LoopbackListener(const LoopbackListener&) = delete;
+    LoopbackListener& operator=(const LoopbackListener&) = delete;
+
+    int port() const { return _port; }
+    // The port as a service name, for APIs that take getaddrinfo() strings
+    std::string service() const { return std::to_string(_port); }
+    int accept() { return ::accept(_fd, nullptr, nullptr); }
+
+private:
+    int _fd;
+    unsigned short _port;
+};
+
+// Sends all of data, failing the test if the peer stops taking it
+inline void sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        ASSERT_GT(n, 0);
+        sent += static_cast<size_t>(n);
+    }
+}
+
+// Pseudo-terminal pair: the code under test opens the slave side, the test drives the master
+class PtyPair {
+public:
+    PtyPair() {
+        _master = posix_openpt(O_RDWR | O_NOCTTY);
+        grantpt(_master);
+        unlockpt(_master);
+        _slaveName = ptsname(_master);
+    }
+    ~PtyPair() { closeMaster(); }
+
+    PtyPair(const PtyPair&) = delete;
+    PtyPair& operator=(const PtyPair&) = delete;
+
+    const std::string& slaveName() const { return _slaveName; }
+    void write(const std::string& data) {
+        ASSERT_EQ(::write(_master, data.data(), data.size()), static_cast<ssize_t>(data.size()));
+    }
+    // Writes without blocking, like a UART that cannot wait for the reader; returns the bytes
+    // the pty refused because its buffers were full
+    size_t writeOrDrop(const std::string& data) {
+        int flags = fcntl(_master, F_GETFL);
+        fcntl(_master, F_SETFL, flags | O_NONBLOCK);
+        ssize_t written = ::write(_master, data.data(), data.size());
+        fcntl(_master, F_SETFL, flags);
+        return written < 0 ? data.size() : data.size() - static_cast<size_t>(written);
+    }
+    // Hangs up the slave side, as unplugging a USB adapter does
+    void closeMaster() {
+        if (_master != -1) {
+            ::close(_master);
+            _master = -1;
+        }
+    }
+
+private:
+    int _master;
+    std::string _slaveName;
+};
+
+#endif // TEST_SUPPORT_HPP
@@ -0,0 +1,476 @@
+#include "UringComms.hpp"
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+    constexpr uint16_t kBufferGroup = 0;
+    constexpr uint64_t kReadTag = 1;
+    constexpr unsigned kSubmissionEntries = 8;
+    constexpr unsigned int kMaxBufferCount = 32768;
+
+    int sysSetup(unsigned entries, io_uring_params *params)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int sysEnter(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags, void *arg, size_t argSize)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, arg, argSize));
+    }
+
+    int sysRegister(int ringFd, unsigned opcode, void *arg, unsigned count)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_register, ringFd, opcode, arg, count));
+    }
+
+    unsigned int roundUpToPowerOfTwo(unsigned int value)
+    {
+        unsigned int result = 1;
+        while (result < value && result < kMaxBufferCount)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+UringComms::UringComms(unsigned int bufferCount, unsigned int bufferSize)
+    : _fd(-1), _ownsFd(false), _isSocket(false), _isOpen(false), _atEof(false), _multishot(true),
+      _readInFlight(false), _ringFd(-1),
+      _sqRing(nullptr), _sqRingSize(0), _cqRing(nullptr), _cqRingSize(0), _sqes(nullptr), _sqesSize(0),
+      _sqHead(nullptr), _sqTail(nullptr), _sqMask(nullptr), _sqArray(nullptr),
+      _cqHead(nullptr), _cqTail(nullptr), _cqMask(nullptr), _cqes(nullptr), _pendingSubmissions(0),
+      _bufferCount(roundUpToPowerOfTwo(bufferCount)), _bufferSize(bufferSize),
+      _bufRing(nullptr), _bufRingSize(0),
+      _chunkHead(0), _chunkCount(0)
+{
+}
+
+UringComms::~UringComms()
+{
+    close();
+}
+
+bool UringComms::isSupported()
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof params);
+    int ringFd = sysSetup(2, &params);
+    if (ringFd < 0)
+    {
+        return false; // ENOSYS (old kernel) or EPERM (disabled by sysctl / seccomp)
+    }
+
+    bool supported = (params.features & IORING_FEAT_EXT_ARG) != 0;
+    if (supported)
+    {
+        // Provided buffer rings (5.19+) are required for buffer-select reads
+        size_t ringSize = 2 * sizeof(io_uring_buf);
+        void *ring = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        io_uring_buf_reg reg;
+        memset(&reg, 0, sizeof reg);
+        reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+        reg.ring_entries = 2;
+        reg.bgid = kBufferGroup;
+        supported = ring != MAP_FAILED && sysRegister(ringFd, IORING_REGISTER_PBUF_RING, &reg, 1) == 0;
+        if (ring != MAP_FAILED)
+        {
+            munmap(ring, ringSize);
+        }
+    }
+    ::close(ringFd);
+    return supported;
+}
+
+bool UringComms::attach(int fd, bool takeOwnership)
+{
+    if (_isOpen)
+    {
+        std::cerr << "Error: UringComms already attached." << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        std::cerr << "Error: invalid descriptor for UringComms." << std::endl;
+        return false;
+    }
+
+    _fd = fd;
+    _ownsFd = takeOwnership;
+    _isSocket = S_ISSOCK(st.st_mode);
+    _multishot = _isSocket;
+    _atEof = false;
+    _readInFlight = false;
+    _stats = Stats();
+
+    if (!setupRing() || !registerBufferRing())
+    {
+        close();
+        return false;
+    }
+
+    _chunks.assign(_bufferCount, Chunk{0, 0, 0});
+    _chunkHead = 0;
+    _chunkCount = 0;
+    _isOpen = true;
+
+    // Post the first read now so data starts landing in the buffer ring immediately
+    queueRead();
+    enter(0, 0);
+    return _isOpen;
+}
+
+bool UringComms::setupRing()
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof params);
+    // Room for one completion per provided buffer plus error/termination completions
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = _bufferCount * 2;
+
+    _ringFd = sysSetup(kSubmissionEntries, &params);
+    if (_ringFd < 0)
+    {
+        std::cerr << "io_uring_setup error: " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (!(params.features & IORING_FEAT_EXT_ARG))
+    {
+        std::cerr << "Error: kernel io_uring lacks timed waits (IORING_FEAT_EXT_ARG)." << std::endl;
+        return false;
+    }
+
+    _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMmap)
+    {
+        _sqRingSize = _cqRingSize = std::max(_sqRingSize, _cqRingSize);
+    }
+
+    _sqRing = mmap(nullptr, _sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQ_RING);
+    if (_sqRing == MAP_FAILED)
+    {
+        _sqRing = nullptr;
+        std::cerr << "io_uring SQ ring mmap error: " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (singleMmap)
+    {
+        _cqRing = _sqRing;
+    }
+    else
+    {
+        _cqRing = mmap(nullptr, _cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_CQ_RING);
+        if (_cqRing == MAP_FAILED)
+        {
+            _cqRing = nullptr;
+            std::cerr << "io_uring CQ ring mmap error: " << strerror(errno) << std::endl;
+            return false;
+        }
+    }
+    _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    _sqes = mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQES);
+    if (_sqes == MAP_FAILED)
+    {
+        _sqes = nullptr;
+        std::cerr << "io_uring SQE mmap error: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    char *sq = static_cast<char *>(_sqRing);
+    char *cq = static_cast<char *>(_cqRing);
+    _sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    _sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    _sqMask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    _sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    _cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    _cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    _cqMask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    _cqes = cq + params.cq_off.cqes;
+    _pendingSubmissions = 0;
+    return true;
+}
+
+bool UringComms::registerBufferRing()
+{
+    _bufRingSize = _bufferCount * sizeof(io_uring_buf);
+    _bufRing = mmap(nullptr, _bufRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (_bufRing == MAP_FAILED)
+    {
+        _bufRing = nullptr;
+        std::cerr << "Buffer ring mmap error: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof reg);
+    reg.ring_addr = reinterpret_cast<uint64_t>(_bufRing);
+    reg.ring_entries = _bufferCount;
+    reg.bgid = kBufferGroup;
+    if (sysRegister(_ringFd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0)
+    {
+        std::cerr << "io_uring buffer ring registration error: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    _bufferStorage.assign(static_cast<size_t>(_bufferCount) * _bufferSize, std::byte{0});
+    for (unsigned int i = 0; i < _bufferCount; ++i)
+    {
+        recycleBuffer(static_cast<uint16_t>(i));
+    }
+    return true;
+}
+
+void UringComms::recycleBuffer(uint16_t bufferId)
+{
+    // The ring is indexed by hand: in C++ the header's flexible-array wrapper adds an
+    // empty struct that shifts io_uring_buf_ring::bufs by 8 bytes. The tail overlays
+    // the resv field of entry 0. We are the only producer, so a plain read of the tail
+    // is safe; the release store publishes the filled entry to the kernel.
+    io_uring_buf *entries = static_cast<io_uring_buf *>(_bufRing);
+    uint16_t *tailPtr = &entries[0].resv;
+    uint16_t tail = *tailPtr;
+    io_uring_buf *buf = &entries[tail & (_bufferCount - 1)];
+    buf->addr = reinterpret_cast<uint64_t>(_bufferStorage.data() + static_cast<size_t>(bufferId) * _bufferSize);
+    buf->len = _bufferSize;
+    buf->bid = bufferId;
+    __atomic_store_n(tailPtr, static_cast<uint16_t>(tail + 1), __ATOMIC_RELEASE);
+}
+
+void UringComms::queueRead()
+{
+    unsigned tail = *_sqTail;
+    unsigned index = tail & *_sqMask;
+    io_uring_sqe *sqe = static_cast<io_uring_sqe *>(_sqes) + index;
+    memset(sqe, 0, sizeof *sqe);
+
+    if (_isSocket)
+    {
+        sqe->opcode = IORING_OP_RECV;
+        sqe->ioprio = _multishot ? IORING_RECV_MULTISHOT : 0;
+        sqe->len = 0; // Length comes from the selected buffer
+    }
+    else
+    {
+        sqe->opcode = IORING_OP_READ;
+        sqe->off = static_cast<uint64_t>(-1); // Current position; ttys and pipes are not seekable
+        sqe->len = _bufferSize;
+    }
+    sqe->fd = _fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufferGroup;
+    sqe->user_data = kReadTag;
+
+    _sqArray[index] = index;
+    __atomic_store_n(_sqTail, tail + 1, __ATOMIC_RELEASE);
+    ++_pendingSubmissions;
+    _readInFlight = true;
+    ++_stats.rearms;
+}
+
+bool UringComms::enter(unsigned int waitForCompletions, unsigned int timeoutMs)
+{
+    if (_pendingSubmissions == 0 && waitForCompletions == 0)
+    {
+        return true;
+    }
+
+    __kernel_timespec ts;
+    ts.tv_sec = timeoutMs / 1000;
+    ts.tv_nsec = static_cast<long long>(timeoutMs % 1000) * 1000000;
+    io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof arg);
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+
+    unsigned flags = waitForCompletions > 0 ? (IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG) : 0;
+    int rc = sysEnter(_ringFd, _pendingSubmissions, waitForCompletions, flags,
+                      waitForCompletions > 0 ? &arg : nullptr, waitForCompletions > 0 ? sizeof arg : 0);
+    ++_stats.enterCalls;
+    _pendingSubmissions = *_sqTail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+
+    if (rc < 0 && errno != ETIME && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+    {
+        std::cerr << "io_uring_enter error: " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void UringComms::reapCompletions()
+{
+    unsigned head = *_cqHead;
+    unsigned tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+    io_uring_cqe *cqes = static_cast<io_uring_cqe *>(_cqes);
+
+    for (; head != tail; ++head)
+    {
+        const io_uring_cqe &cqe = cqes[head & *_cqMask];
+        if (cqe.user_data != kReadTag)
+        {
+            continue;
+        }
+        if (!(cqe.flags & IORING_CQE_F_MORE))
+        {
+            _readInFlight = false; // Request finished; must be re-armed
+        }
+
+        if (cqe.res > 0)
+        {
+            Chunk &chunk = _chunks[(_chunkHead + _chunkCount) % _chunks.size()];
+            chunk.bufferId = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            chunk.offset = 0;
+            chunk.length = static_cast<uint32_t>(cqe.res);
+            ++_chunkCount;
+            ++_stats.completions;
+            continue;
+        }
+
+        if (cqe.flags & IORING_CQE_F_BUFFER)
+        {
+            recycleBuffer(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+        }
+
+        if (cqe.res == 0)
+        {
+            _atEof = true; // Peer closed / end of file
+        }
+        else if (cqe.res == -ENOBUFS || cqe.res == -EAGAIN || cqe.res == -EINTR)
+        {
+            // Out of provided buffers or spurious wake-up: re-armed once buffers are recycled
+        }
+        else if (cqe.res == -EINVAL && _multishot)
+        {
+            _multishot = false; // Kernel without multishot recv: fall back to one-shot
+        }
+        else
+        {
+            std::cerr << "io_uring read error: " << strerror(-cqe.res) << std::endl;
+            _atEof = true;
+        }
+    }
+    __atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+}
+
+size_t UringComms::readInto(std::span<std::byte> buffer, unsigned int timeoutMs)
+{
+    if (!isOpen() || buffer.empty())
+    {
+        return 0;
+    }
+
+    // 1. Completions already in shared memory cost no syscall
+    reapCompletions();
+
+    // 2. Nothing queued: make sure a read is posted, then wait (or just submit for timeout 0)
+    if (_chunkCount == 0 && !_atEof)
+    {
+        if (!_readInFlight)
+        {
+            queueRead();
+        }
+        if (!enter(timeoutMs > 0 ? 1 : 0, timeoutMs))
+        {
+            return 0;
+        }
+        reapCompletions();
+    }
+
+    // 3. Copy out of the provided buffers, returning each to the kernel once drained
+    size_t copied = 0;
+    while (_chunkCount > 0 && copied < buffer.size())
+    {
+        Chunk &chunk = _chunks[_chunkHead];
+        size_t n = std::min<size_t>(chunk.length, buffer.size() - copied);
+        const std::byte *src = _bufferStorage.data() + static_cast<size_t>(chunk.bufferId) * _bufferSize + chunk.offset;
+        memcpy(buffer.data() + copied, src, n);
+        copied += n;
+        chunk.offset += static_cast<uint32_t>(n);
+        chunk.length -= static_cast<uint32_t>(n);
+        if (chunk.length == 0)
+        {
+            recycleBuffer(chunk.bufferId);
+            _chunkHead = (_chunkHead + 1) % _chunks.size();
+            --_chunkCount;
+        }
+    }
+
+    // 4. Keep a read posted so data lands (and the ring fd polls readable) while the caller works
+    if (!_readInFlight && !_atEof && _isOpen)
+    {
+        queueRead();
+        enter(0, 0);
+    }
+
+    return copied;
+}
+
+void UringComms::close()
+{
+    if (_ringFd >= 0)
+    {
+        ::close(_ringFd); // Cancels any in-flight reads
+        _ringFd = -1;
+    }
+    if (_bufRing != nullptr)
+    {
+        munmap(_bufRing, _bufRingSize);
+        _bufRing = nullptr;
+    }
+    if (_sqes != nullptr)
+    {
+        munmap(_sqes, _sqesSize);
+        _sqes = nullptr;
+    }
+    if (_cqRing != nullptr && _cqRing != _sqRing)
+    {
+        munmap(_cqRing, _cqRingSize);
+    }
+    _cqRing = nullptr;
+    if (_sqRing != nullptr)
+    {
+        munmap(_sqRing, _sqRingSize);
+        _sqRing = nullptr;
+    }
+    if (_ownsFd && _fd >= 0)
+    {
+        ::close(_fd);
+    }
+    _fd = -1;
+    _ownsFd = false;
+    _isOpen = false;
+    _readInFlight = false;
+    _chunkCount = 0;
+}
+
+bool UringComms::isOpen() const
+{
+    // Stay open until data received before EOF has been handed out
+    return _isOpen && !(_atEof && _chunkCount == 0);
+}
+
+int UringComms::getPollDescriptor() const
+{
+    return _isOpen ? _ringFd : -1;
+}
+
+size_t UringComms::getBufferedBytes() const
+{
+    size_t total = 0;
+    for (size_t i = 0; i < _chunkCount; ++i)
+    {
+        const Chunk &chunk = _chunks[(_chunkHead + i) % _chunks.size()];
+        total += chunk.length; // length counts the bytes not yet copied out
+    }
+    return total;
+}
@@ -0,0 +1,152 @@
+#ifndef URING_COMMS_HPP
+#define URING_COMMS_HPP
+
+#include "IComms.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Implements IComms on top of io_uring (Linux 6.0+).
+ *
+ * Reads are posted once and completed into a kernel-registered provided-buffer
+ * ring: sockets use a multishot recv that keeps producing completions until it
+ * runs out of buffers, tty/pipe descriptors use a buffer-select read re-armed per
+ * completion. readInto() first drains completions straight from the shared
+ * completion queue, so while data is flowing most reads cost no syscall at all;
+ * io_uring_enter is only called to wait (with timeout) or to submit a re-arm.
+ *
+ * The ring descriptor is returned by getPollDescriptor(), so the class can also
+ * be driven from the EventLoop (it becomes readable when completions are queued).
+ *
+ * Use isSupported() to check the running kernel before choosing this backend.
+ */
+class UringComms : public IComms {
+public:
+    /// @brief Counters for comparing against the epoll and poll() NetworkComms paths.
+    struct Stats {
+        uint64_t enterCalls = 0;   ///< io_uring_enter syscalls issued
+        uint64_t completions = 0;  ///< Data completions reaped
+        uint64_t rearms = 0;       ///< Read requests (re)submitted
+    };
+
+    /**
+     * @brief Constructor.
+     * @param bufferCount Number of provided buffers (rounded up to a power of two, max 32768).
+     * @param bufferSize Size in bytes of each provided buffer.
+     */
+    explicit UringComms(unsigned int bufferCount = 64, unsigned int bufferSize = 4096);
+
+    /**
+     * @brief Destructor. Tears down the ring and closes the descriptor if owned.
+     */
+    ~UringComms();
+
+    UringComms(const UringComms&) = delete;
+    UringComms& operator=(const UringComms&) = delete;
+
+    /**
+     * @brief Checks whether the running kernel provides io_uring with provided buffer rings.
+     * @return True if this backend can be used.
+     */
+    static bool isSupported();
+
+    /**
+     * @brief Starts reading from an already open descriptor (connected socket, tty, pipe).
+     * @param fd The descriptor to read from.
+     * @param takeOwnership If true, fd is closed by close() / the destructor.
+     * @return True on success, false if io_uring could not be set up for fd.
+     */
+    bool attach(int fd, bool takeOwnership = false);
+
+    /**
+     * @brief Tears down the ring and releases the descriptor.
+     */
+    void close();
+
+    /**
+     * @brief Copies completed data into the caller's buffer, waiting up to timeoutMs
+     *        only if no completion is already queued.
+     * @param buffer Destination memory.
+     * @param timeoutMs The timeout in milliseconds for the read operation.
+     * @return The number of bytes written into buffer (0 on timeout, error or EOF).
+     */
+    size_t readInto(std::span<std::byte> buffer, unsigned int timeoutMs) override;
+
+    /**
+     * @brief Checks if the descriptor is attached and has not reached EOF or an error.
+     * @return True if open, false otherwise.
+     */
+    bool isOpen() const override;
+
+    /**
+     * @brief Returns the io_uring descriptor, readable whenever completions are queued.
+     * @return The ring descriptor, or -1 if not attached.
+     */
+    int getPollDescriptor() const override;
+
+    /**
+     * @brief Returns bytes from already reaped completions that have not been copied out.
+     */
+    size_t getBufferedBytes() const override;
+
+    /// @brief Returns syscall and completion counters since attach().
+    const Stats& getStats() const { return _stats; }
+
+private:
+    // One completed read whose bytes sit in a provided buffer, partially consumed
+    struct Chunk {
+        uint16_t bufferId;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    int _fd;
+    bool _ownsFd;
+    bool _isSocket;
+    bool _isOpen;
+    bool _atEof;
+    bool _multishot;
+    bool _readInFlight;
+    int _ringFd;
+
+    // Submission/completion ring mappings
+    void* _sqRing;
+    size_t _sqRingSize;
+    void* _cqRing;
+    size_t _cqRingSize;
+    void* _sqes;
+    size_t _sqesSize;
+    unsigned* _sqHead;
+    unsigned* _sqTail;
+    unsigned* _sqMask;
+    unsigned* _sqArray;
+    unsigned* _cqHead;
+    unsigned* _cqTail;
+    unsigned* _cqMask;
+    void* _cqes;
+    unsigned _pendingSubmissions;
+
+    // Provided buffer ring and its backing storage
+    unsigned int _bufferCount;
+    unsigned int _bufferSize;
+    void* _bufRing;
+    size_t _bufRingSize;
+    std::vector<std::byte> _bufferStorage;
+
+    // Completed chunks not yet copied out (at most _bufferCount outstanding)
+    std::vector<Chunk> _chunks;
+    size_t _chunkHead;
+    size_t _chunkCount;
+
+    Stats _stats;
+
+    bool setupRing();
+    bool registerBufferRing();
+    void recycleBuffer(uint16_t bufferId);
+    void queueRead();
+    bool enter(unsigned int waitForCompletions, unsigned int timeoutMs);
+    void reapCompletions();
+};
+
+#endif // URING_COMMS_HPP
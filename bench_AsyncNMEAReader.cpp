@@ -0,0 +1,127 @@
+/**
+ * @file bench_AsyncNMEAReader.cpp
+ * @brief Measures memory per idle AsyncNMEAReader source and wake-up latency.
+ * @details Usage: bench_AsyncNMEAReader [sources] [samples]
+ * Each source is one end of a socketpair served by a coroutine suspended on the EventLoop.
+ */
+
+#include "AsyncNMEAReader.hpp"
+#include "EventLoop.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// IComms over a nonblocking socket descriptor
+class SocketFdComms : public IComms {
+public:
+    explicit SocketFdComms(int fd) : _fd(fd) { fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL, 0) | O_NONBLOCK); }
+    ~SocketFdComms() override { ::close(_fd); }
+
+    size_t readInto(std::span<std::byte> buffer, unsigned int /*timeoutMs*/) override {
+        ssize_t n = recv(_fd, buffer.data(), buffer.size(), 0);
+        if (n == 0) _open = false;
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+    bool isOpen() const override { return _open; }
+    int getPollDescriptor() const override { return _fd; }
+
+private:
+    int _fd;
+    bool _open = true;
+};
+
+long residentKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) return std::stol(line.substr(6));
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t sources = argc > 1 ? std::stoul(argv[1]) : 1000;
+    const size_t samples = argc > 2 ? std::stoul(argv[2]) : 2000;
+    const std::string sentence = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+
+    EventLoop loop;
+    std::vector<int> writers;
+    std::vector<std::unique_ptr<SocketFdComms>> comms;
+    std::vector<std::unique_ptr<AsyncNMEAReader>> readers;
+    writers.reserve(sources);
+    comms.reserve(sources);
+    readers.reserve(sources);
+
+    // Create descriptors first so the RSS delta below covers only reader + coroutine state
+    for (size_t i = 0; i < sources; ++i) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            std::cerr << "socketpair failed after " << i << " sources (raise ulimit -n)" << std::endl;
+            return 1;
+        }
+        comms.push_back(std::make_unique<SocketFdComms>(fds[0]));
+        writers.push_back(fds[1]);
+    }
+
+    std::atomic<long long> sentAtNs {0};
+    std::atomic<size_t> handled {0};
+    std::vector<double> latenciesUs;
+    latenciesUs.reserve(samples);
+
+    long before = residentKb();
+    for (size_t i = 0; i < sources; ++i) {
+        readers.push_back(std::make_unique<AsyncNMEAReader>(*comms[i], loop));
+        loop.spawn([&, reader = readers.back().get()]() -> Task<void> {
+            auto messages = reader->messages();
+            while (auto message = co_await messages.next()) {
+                auto now = std::chrono::steady_clock::now().time_since_epoch();
+                long long nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+                latenciesUs.push_back((nowNs - sentAtNs.load()) / 1000.0);
+                if (++handled == samples) loop.stop();
+            }
+        }());
+    }
+    long after = residentKb();
+
+    std::cout << "Idle sources:          " << sources << " (" << loop.pendingWaiters() << " suspended)" << std::endl;
+    std::cout << "Memory per idle source: " << (after - before) * 1024.0 / sources << " bytes (RSS delta)" << std::endl;
+
+    std::thread producer([&]() {
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<size_t> pick(0, sources - 1);
+        for (size_t i = 0; i < samples; ++i) {
+            size_t expected = handled.load() + 1;
+            auto now = std::chrono::steady_clock::now().time_since_epoch();
+            sentAtNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+            ssize_t written = ::write(writers[pick(rng)], sentence.data(), sentence.size());
+            (void)written;
+            while (handled.load() < expected) std::this_thread::yield();
+        }
+    });
+
+    loop.run();
+    producer.join();
+
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+    auto percentile = [&](double p) { return latenciesUs[static_cast<size_t>(p * (latenciesUs.size() - 1))]; };
+    std::cout << "Wake-up latency (us):   p50=" << percentile(0.50) << " p99=" << percentile(0.99)
+              << " max=" << latenciesUs.back() << " over " << latenciesUs.size() << " samples" << std::endl;
+
+    readers.clear();
+    for (int fd : writers) ::close(fd);
+    return 0;
+}
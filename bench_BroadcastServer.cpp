@@ -0,0 +1,162 @@
+/**
+ * @file bench_BroadcastServer.cpp
+ * @brief Fan-out of an NMEA feed to hundreds of local TCP clients.
+ * @details Usage: bench_BroadcastServer [clients] [sentences]
+ * The server thread publishes GGA sentences as fast as it can; one drain thread reads every
+ * client with epoll. Compared against a naive relay that send()s each sentence to each
+ * client in turn. Server CPU is taken from getrusage(RUSAGE_THREAD).
+ */
+
+#include "BroadcastServer.hpp"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+
+const std::string kSentence = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+
+double threadCpuSeconds() {
+    rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+std::vector<int> connectClients(unsigned short port, size_t count) {
+    std::vector<int> fds;
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (size_t i = 0; i < count; ++i) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        fds.push_back(fd);
+    }
+    return fds;
+}
+
+// Reads every client until each has received `perClient` bytes
+std::thread startDrain(const std::vector<int>& fds, size_t perClient, std::atomic<size_t>& finished) {
+    return std::thread([=, &finished]() {
+        int epollFd = epoll_create1(0);
+        std::vector<size_t> received(fds.size(), 0);
+        for (size_t i = 0; i < fds.size(); ++i) {
+            epoll_event ev {};
+            ev.events = EPOLLIN;
+            ev.data.u64 = i;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fds[i], &ev);
+        }
+        std::vector<char> buffer(256 * 1024);
+        epoll_event events[256];
+        while (finished < fds.size()) {
+            int n = epoll_wait(epollFd, events, 256, 100);
+            for (int e = 0; e < n; ++e) {
+                size_t i = events[e].data.u64;
+                ssize_t r = recv(fds[i], buffer.data(), buffer.size(), MSG_DONTWAIT);
+                if (r <= 0) continue;
+                received[i] += static_cast<size_t>(r);
+                if (received[i] >= perClient) {
+                    ++finished;
+                    epoll_ctl(epollFd, EPOLL_CTL_DEL, fds[i], nullptr);
+                }
+            }
+        }
+        ::close(epollFd);
+    });
+}
+
+void report(const char* name, size_t clients, size_t bytesPerClient, double seconds, double cpu, uint64_t writes) {
+    double delivered = static_cast<double>(clients) * bytesPerClient;
+    std::cout << name << ": " << delivered / seconds / (1024 * 1024) << " MB/s delivered, server CPU "
+              << cpu * 1e9 / (delivered / 1024) << " ns/KB, " << writes / (delivered / (1024 * 1024))
+              << " writes/MB" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t clientCount = argc > 1 ? std::stoul(argv[1]) : 200;
+    const size_t sentences = argc > 2 ? std::stoul(argv[2]) : 50000;
+    const size_t perClient = sentences * kSentence.size();
+
+    // --- BroadcastServer: shared chunks, one gathered write per client per poll ---
+    {
+        BroadcastServer::Options options;
+        options.maxQueuedBytes = 64 * 1024 * 1024; // Measure throughput, not skip-ahead
+        options.backlog = static_cast<int>(clientCount); // All clients connect before the first accept
+        BroadcastServer server(options);
+        server.listen("0", "127.0.0.1");
+        std::vector<int> fds = connectClients(server.getPort(), clientCount);
+        while (server.getClientCount() < clientCount) server.poll(10);
+
+        std::atomic<size_t> finished {0};
+        std::thread drain = startDrain(fds, perClient, finished);
+        auto start = std::chrono::steady_clock::now();
+        double cpuBefore = threadCpuSeconds();
+        uint64_t peakChunks = 0;
+        for (size_t i = 0; i < sentences; ++i) {
+            server.publish(kSentence);
+            if (i % 64 == 63) server.poll(0);
+            peakChunks = std::max(peakChunks, server.getStats().liveChunks);
+        }
+        while (finished < clientCount) server.poll(1);
+        double cpu = threadCpuSeconds() - cpuBefore;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        drain.join();
+        report("BroadcastServer  ", clientCount, perClient, seconds, cpu, server.getStats().writevCalls);
+        std::cout << "  peak live chunks " << peakChunks << " x " << options.chunkSize / 1024 << " KB shared by "
+                  << clientCount << " clients" << std::endl;
+        for (int fd : fds) ::close(fd);
+    }
+
+    // --- Naive relay: send() each sentence to each client (blocking sockets) ---
+    {
+        int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(listenFd, 1024);
+        socklen_t len = sizeof(addr);
+        getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+        std::vector<int> fds = connectClients(ntohs(addr.sin_port), clientCount);
+        std::vector<int> peers;
+        for (size_t i = 0; i < clientCount; ++i) {
+            int peer = accept(listenFd, nullptr, nullptr);
+            int one = 1;
+            setsockopt(peer, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            peers.push_back(peer);
+        }
+
+        std::atomic<size_t> finished {0};
+        std::thread drain = startDrain(fds, perClient, finished);
+        auto start = std::chrono::steady_clock::now();
+        double cpuBefore = threadCpuSeconds();
+        uint64_t writes = 0;
+        for (size_t i = 0; i < sentences; ++i) {
+            for (int peer : peers) {
+                send(peer, kSentence.data(), kSentence.size(), MSG_NOSIGNAL);
+                ++writes;
+            }
+        }
+        double cpu = threadCpuSeconds() - cpuBefore;
+        drain.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report("naive send() loop", clientCount, perClient, seconds, cpu, writes);
+        for (int fd : fds) ::close(fd);
+        for (int fd : peers) ::close(fd);
+        ::close(listenFd);
+    }
+    return 0;
+}
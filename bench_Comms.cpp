@@ -0,0 +1,304 @@
+/**
+ * @file bench_Comms.cpp
+ * @brief Messages/s through Comms at 64 B and 4 KB, against the former implementations.
+ * @details Usage: bench_Comms [megabytes]
+ * Receive: a writer thread streams framed messages over loopback TCP as fast as it can.
+ * The reader decodes them with Comms (buffered), with Comms::receivePooled (pooled), and
+ * with copies of the previous implementations: one recv() per byte for CRLF, and a recv()
+ * for the length plus one for the body for LengthPrefix. Heap allocations made by the
+ * reading thread are counted through a replaced operator new.
+ * Send: LengthPrefix messages go out through the former copy-and-send sendMessage, the
+ * gathered sendMessage, sendMessages in batches of 64, and sendMessage with coalescing
+ * (64 messages / 200 us), while a thread drains the peer side.
+ */
+
+#include "Comms.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+thread_local uint64_t threadAllocations = 0;
+} // namespace
+
+void* operator new(size_t size) {
+    ++threadAllocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+class LoopbackListener {
+public:
+    LoopbackListener() {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(_fd, 4);
+        socklen_t len = sizeof(addr);
+        getsockname(_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        _port = ntohs(addr.sin_port);
+    }
+    ~LoopbackListener() { ::close(_fd); }
+    int port() const { return _port; }
+    int accept() { return ::accept(_fd, nullptr, nullptr); }
+
+private:
+    int _fd;
+    unsigned short _port;
+};
+
+// The former Comms::receiveUntilCRLF
+std::string legacyReceiveUntilCRLF(int sock) {
+    std::string buffer;
+    char ch;
+    while (true) {
+        int result = recv(sock, &ch, 1, 0);
+        if (result <= 0) break;
+        buffer += ch;
+        if (buffer.size() >= 2 && buffer.substr(buffer.size() - 2) == "\r\n") {
+            buffer.resize(buffer.size() - 2);
+            break;
+        }
+    }
+    return buffer;
+}
+
+// The former Comms::receiveWithLengthPrefix
+std::string legacyReceiveWithLengthPrefix(int sock) {
+    uint32_t len = 0;
+    int total = 0;
+    char* lenPtr = reinterpret_cast<char*>(&len);
+    while (total < 4) {
+        int received = recv(sock, lenPtr + total, 4 - total, 0);
+        if (received <= 0) return {};
+        total += received;
+    }
+    len = ntohl(len);
+    std::string buffer(len, 0);
+    total = 0;
+    while (total < static_cast<int>(len)) {
+        int received = recv(sock, &buffer[total], len - total, 0);
+        if (received <= 0) return {};
+        total += received;
+    }
+    return buffer;
+}
+
+std::string frame(FramingStrategy framing, size_t size) {
+    std::string message(size, 'x');
+    if (framing == FramingStrategy::CRLF) return message + "\r\n";
+    uint32_t len = htonl(static_cast<uint32_t>(size));
+    return std::string(reinterpret_cast<char*>(&len), sizeof(len)) + message;
+}
+
+double cpuSeconds() {
+    rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+struct Result {
+    double messagesPerSecond;
+    double cpuMicrosPerMessage;
+    double allocationsPerMessage;
+};
+
+// Streams count copies of wire over loopback and times receive() until all are decoded
+Result run(const std::string& wire, size_t count, const std::function<void(int, LoopbackListener&)>& connect,
+           const std::function<size_t()>& receive) {
+    LoopbackListener listener;
+    std::thread writer([&] {
+        int peer = listener.accept();
+        std::string batch;
+        for (size_t i = 0; i < 64; ++i) batch += wire;
+        for (size_t sent = 0; sent < count; sent += 64) {
+            ::send(peer, batch.data(), batch.size(), MSG_NOSIGNAL);
+        }
+        ::shutdown(peer, SHUT_WR);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        ::close(peer);
+    });
+    connect(listener.port(), listener);
+
+    auto start = std::chrono::steady_clock::now();
+    double cpuStart = cpuSeconds();
+    uint64_t allocationsStart = threadAllocations;
+    size_t decoded = 0;
+    while (decoded < count && receive() > 0) ++decoded;
+    uint64_t allocations = threadAllocations - allocationsStart;
+    double cpu = cpuSeconds() - cpuStart;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    writer.join();
+    return {static_cast<double>(decoded) / seconds, cpu / static_cast<double>(decoded) * 1e6,
+            static_cast<double>(allocations) / static_cast<double>(decoded)};
+}
+
+void report(const char* label, const Result& result) {
+    std::cout << "    " << label << result.messagesPerSecond / 1e3 << " k msg/s, " << result.cpuMicrosPerMessage
+              << " us CPU/msg, " << result.allocationsPerMessage << " allocations/msg\n";
+}
+
+// The former Comms::sendMessage for LengthPrefix
+void legacySendWithLengthPrefix(int sock, const std::string& message) {
+    std::string framedMessage = message;
+    uint32_t len = htonl(static_cast<uint32_t>(message.size()));
+    framedMessage = std::string(reinterpret_cast<char*>(&len), sizeof(len)) + message;
+    ::send(sock, framedMessage.c_str(), static_cast<int>(framedMessage.size()), 0);
+}
+
+// Times send() pushing count messages while a thread drains the peer
+void runSend(const char* label, size_t count, size_t wireBytes, const std::function<void(int)>& connect,
+             const std::function<void()>& send, const std::function<uint64_t()>& sendCalls) {
+    LoopbackListener listener;
+    std::thread drain([&] {
+        int peer = listener.accept();
+        std::vector<char> buffer(256 * 1024);
+        size_t total = 0;
+        while (total < count * wireBytes) {
+            ssize_t n = ::recv(peer, buffer.data(), buffer.size(), 0);
+            if (n <= 0) break;
+            total += static_cast<size_t>(n);
+        }
+        ::close(peer);
+    });
+    connect(listener.port());
+
+    auto start = std::chrono::steady_clock::now();
+    double cpuStart = cpuSeconds();
+    send();
+    double cpu = cpuSeconds() - cpuStart;
+    drain.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "    " << label << static_cast<double>(count) / seconds / 1e3 << " k msg/s, "
+              << cpu / static_cast<double>(count) * 1e6 << " us CPU/msg, "
+              << static_cast<double>(sendCalls()) / static_cast<double>(count) << " syscalls/msg\n";
+}
+
+void benchSend(size_t megabytes) {
+    for (size_t size : {size_t(64), size_t(4096)}) {
+        std::string message(size, 'x');
+        size_t wireBytes = size + 4;
+        size_t count = (megabytes * 1024 * 1024 / wireBytes + 63) / 64 * 64;
+        std::cout << "Send LengthPrefix, " << size << "-byte messages:\n";
+
+        int sock = -1;
+        runSend(
+            "former:      ", count, wireBytes,
+            [&](int port) {
+                sock = socket(AF_INET, SOCK_STREAM, 0);
+                sockaddr_in addr {};
+                addr.sin_family = AF_INET;
+                addr.sin_port = htons(port);
+                addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                ::connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+            },
+            [&] {
+                for (size_t i = 0; i < count; ++i) legacySendWithLengthPrefix(sock, message);
+                ::close(sock);
+            },
+            [&] { return static_cast<uint64_t>(count); });
+
+        std::vector<std::string> batch(64, message);
+        uint64_t sendCallsResult = 0;
+        struct Variant {
+            const char* label;
+            size_t coalesce;
+            bool batched;
+        };
+        for (Variant variant : {Variant {"gathered:    ", 0, false}, Variant {"batched x64: ", 0, true},
+                                Variant {"coalesced:   ", 64, false}}) {
+            std::unique_ptr<Comms> comms;
+            runSend(
+                variant.label, count, wireBytes,
+                [&](int port) {
+                    comms = std::make_unique<Comms>(SocketBackend::BSD, FramingStrategy::LengthPrefix);
+                    comms->connectToServer("127.0.0.1", port);
+                    comms->setCoalescing(variant.coalesce, std::chrono::microseconds(200));
+                },
+                [&] {
+                    if (variant.batched) {
+                        for (size_t i = 0; i < count; i += 64) comms->sendMessages(batch);
+                    } else {
+                        for (size_t i = 0; i < count; ++i) comms->sendMessage(message);
+                    }
+                    comms->flush();
+                    uint64_t calls = comms->getStats().sendCalls;
+                    comms.reset(); // Closes the socket so the drain sees the end
+                    sendCallsResult = calls;
+                },
+                [&] { return sendCallsResult; });
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+
+    for (FramingStrategy framing : {FramingStrategy::CRLF, FramingStrategy::LengthPrefix}) {
+        for (size_t size : {size_t(64), size_t(4096)}) {
+            std::string wire = frame(framing, size);
+            size_t count = (megabytes * 1024 * 1024 / wire.size() + 63) / 64 * 64;
+            // The byte-at-a-time decoder needs a smaller sample to finish in reasonable time
+            size_t legacyCount = framing == FramingStrategy::CRLF ? count / 16 / 64 * 64 : count;
+
+            std::cout << (framing == FramingStrategy::CRLF ? "CRLF" : "LengthPrefix") << ", " << size
+                      << "-byte messages:\n";
+
+            int legacySock = -1;
+            Result legacy = run(
+                wire, legacyCount,
+                [&](int port, LoopbackListener&) {
+                    legacySock = socket(AF_INET, SOCK_STREAM, 0);
+                    sockaddr_in addr {};
+                    addr.sin_family = AF_INET;
+                    addr.sin_port = htons(port);
+                    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                    ::connect(legacySock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+                },
+                [&]() -> size_t {
+                    std::string message = framing == FramingStrategy::CRLF ? legacyReceiveUntilCRLF(legacySock)
+                                                                           : legacyReceiveWithLengthPrefix(legacySock);
+                    return message.size();
+                });
+            ::close(legacySock);
+            report("former:   ", legacy);
+
+            Comms comms(SocketBackend::BSD, framing);
+            Result buffered = run(
+                wire, count, [&](int port, LoopbackListener&) { comms.connectToServer("127.0.0.1", port); },
+                [&]() -> size_t { return comms.receiveMessage().size(); });
+            report("buffered: ", buffered);
+            std::cout << "    recv() calls per message: "
+                      << static_cast<double>(comms.getStats().recvCalls) / static_cast<double>(count) << "\n";
+
+            Comms pooledComms(SocketBackend::BSD, framing);
+            Result pooled = run(
+                wire, count, [&](int port, LoopbackListener&) { pooledComms.connectToServer("127.0.0.1", port); },
+                [&]() -> size_t { return pooledComms.receivePooled().size(); });
+            report("pooled:   ", pooled);
+        }
+    }
+
+    benchSend(megabytes);
+    return 0;
+}
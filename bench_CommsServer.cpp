@@ -0,0 +1,218 @@
+/**
+ * @file bench_CommsServer.cpp
+ * @brief Thousands of local framed connections through CommsServer, against thread-per-connection Comms.
+ * @details Usage: bench_CommsServer [connections] [roundTrips]
+ * A CommsServer<CrlfCodec> on its own thread echoes every line. Each client connection
+ * sends a sentence-sized line and waits for its echo, roundTrips times.
+ *  - pool:    all connections on one CommsClientPool thread.
+ *  - threads: one blocking Comms client per thread, as Comms requires. Both run with
+ *    at most 1000 connections; the pool is then run again with all of them.
+ * Fairness: the pool run is repeated while one extra connection floods the server with
+ * lines as fast as it can. Round-trip percentiles of the other connections show whether
+ * it starves them.
+ */
+
+#include "Comms.hpp"
+#include "CommsServer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using ConnectionId = CommsReactor::ConnectionId;
+
+const std::string kSentence = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47";
+
+// Echo server running until stopped
+class EchoServer {
+public:
+    EchoServer() {
+        CommsReactor::Handlers handlers;
+        handlers.onMessage = [this](ConnectionId id, std::string& line) { _server.send(id, line); };
+        _server.setHandlers(handlers);
+        _server.listen("0", "127.0.0.1");
+        _thread = std::thread([this] {
+            while (!_stop) _server.poll(10);
+        });
+    }
+    ~EchoServer() { stop(); }
+    void stop() {
+        _stop = true;
+        if (_thread.joinable()) _thread.join();
+    }
+    unsigned short port() const { return _server.getPort(); }
+    // Read after stop()
+    uint64_t deferredTurns() const { return _server.getStats().deferredTurns; }
+
+private:
+    CommsServer<CrlfCodec> _server;
+    std::atomic<bool> _stop {false};
+    std::thread _thread;
+};
+
+void printPercentiles(std::vector<double>& micros) {
+    std::sort(micros.begin(), micros.end());
+    std::cout << "p50 " << micros[micros.size() / 2] << " us, p99 " << micros[micros.size() * 99 / 100]
+              << " us, max " << micros.back() << " us";
+}
+
+void runPool(unsigned short port, size_t connections, size_t roundTrips) {
+    CommsClientPool<CrlfCodec> pool;
+    std::vector<Clock::time_point> sentAt(connections);
+    std::vector<size_t> remaining(connections, roundTrips);
+    std::vector<ConnectionId> ids;
+    std::vector<double> micros;
+    micros.reserve(connections * roundTrips);
+    size_t done = 0;
+
+    std::vector<size_t> indexBySlot;
+    CommsReactor::Handlers handlers;
+    handlers.onMessage = [&](ConnectionId id, std::string&) {
+        size_t i = indexBySlot[static_cast<uint32_t>(id)];
+        micros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sentAt[i]).count());
+        if (--remaining[i] == 0) {
+            ++done;
+            return;
+        }
+        sentAt[i] = Clock::now();
+        pool.send(id, kSentence);
+    };
+    pool.setHandlers(handlers);
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < connections; ++i) {
+        ids.push_back(pool.connect("127.0.0.1", std::to_string(port)));
+        uint32_t slot = static_cast<uint32_t>(ids.back());
+        if (indexBySlot.size() <= slot) indexBySlot.resize(slot + 1);
+        indexBySlot[slot] = i;
+        sentAt[i] = Clock::now();
+        pool.send(ids.back(), kSentence);
+    }
+    while (done < connections && pool.getConnectionCount() > 0) pool.poll(10);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << "    pool:    " << static_cast<double>(micros.size()) / seconds / 1e3 << " k round trips/s, ";
+    printPercentiles(micros);
+    std::cout << "\n";
+}
+
+void runThreads(unsigned short port, size_t connections, size_t roundTrips) {
+    std::vector<std::vector<double>> perThread(connections);
+    std::vector<std::thread> threads;
+    std::atomic<size_t> failed {0};
+    auto start = Clock::now();
+    for (size_t i = 0; i < connections; ++i) {
+        threads.emplace_back([&, i] {
+            try {
+                Comms comms(SocketBackend::BSD, FramingStrategy::CRLF, 4096);
+                comms.connectToServer("127.0.0.1", port);
+                perThread[i].reserve(roundTrips);
+                for (size_t r = 0; r < roundTrips; ++r) {
+                    auto sent = Clock::now();
+                    comms.sendMessage(kSentence);
+                    comms.receiveMessage();
+                    perThread[i].push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent).count());
+                }
+            } catch (const std::exception&) {
+                ++failed;
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> micros;
+    for (auto& samples : perThread) micros.insert(micros.end(), samples.begin(), samples.end());
+    std::cout << "    threads: " << static_cast<double>(micros.size()) / seconds / 1e3 << " k round trips/s, ";
+    printPercentiles(micros);
+    std::cout << (failed > 0 ? " (" + std::to_string(failed) + " clients failed)" : std::string()) << "\n";
+}
+
+// One connection writing lines as fast as the server takes them
+class Flooder {
+public:
+    explicit Flooder(unsigned short port) {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::connect(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        _writer = std::thread([this] {
+            std::string batch;
+            for (int i = 0; i < 512; ++i) batch += kSentence + "\r\n";
+            while (!_stop) {
+                if (::send(_fd, batch.data(), batch.size(), MSG_NOSIGNAL) <= 0) break;
+            }
+        });
+        // Echoes are discarded
+        _reader = std::thread([this] {
+            char buffer[65536];
+            while (::recv(_fd, buffer, sizeof(buffer), 0) > 0) {
+            }
+        });
+    }
+    ~Flooder() {
+        _stop = true;
+        ::shutdown(_fd, SHUT_RDWR);
+        _writer.join();
+        _reader.join();
+        ::close(_fd);
+    }
+
+private:
+    int _fd;
+    std::atomic<bool> _stop {false};
+    std::thread _writer;
+    std::thread _reader;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t connections = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    size_t roundTrips = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 50;
+
+    // Both ends of every connection live in this process
+    rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    if (limit.rlim_cur < 2 * connections + 64) {
+        connections = (limit.rlim_cur - 64) / 2;
+        std::cout << "Descriptor limit allows " << connections << " connections\n";
+    }
+
+    EchoServer server;
+    size_t threaded = std::min<size_t>(connections, 1000);
+    std::cout << threaded << " connections x " << roundTrips << " round trips of " << kSentence.size() + 2
+              << "-byte lines:\n";
+    runPool(server.port(), threaded, roundTrips);
+    runThreads(server.port(), threaded, roundTrips);
+    if (threaded < connections) {
+        std::cout << connections << " connections:\n";
+        runPool(server.port(), connections, roundTrips);
+    }
+
+    std::cout << connections << " connections while one more floods the server:\n";
+    {
+        Flooder flooder(server.port());
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        runPool(server.port(), connections, roundTrips);
+    }
+    server.stop();
+    std::cout << "    server turns cut short by maxFramesPerTurn: " << server.deferredTurns() << "\n";
+    return 0;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file bench_Compression.cpp
+ * @brief Compression ratio and speed of CompressingCodec on NMEA traffic.
+ * @details Usage: bench_Compression [logFile] [trainingSentences]
+ * Reads one sentence per line from logFile (a recorded NMEA log), or generates a 1 Hz
+ * receiver log of GGA, RMC, GSA, GSV and VTG sentences with a drifting position.
+ * The first trainingSentences sentences (default 1000) train the dictionary and are not
+ * measured. The rest are encoded and decoded with CompressingCodec<LengthPrefixCodec>
+ * one per frame and in batches, with and without the dictionary.
+ * Ratio is sentence bytes over wire bytes, including framing; against plain
+ * LengthPrefixCodec it would be a little over 1.
+ */
+
+#include "Compression.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string withChecksum(const std::string& body) {
+    uint8_t checksum = 0;
+    for (char c : body) checksum ^= static_cast<uint8_t>(c);
+    char suffix[4];
+    std::snprintf(suffix, sizeof(suffix), "*%02X", checksum);
+    return "$" + body + suffix;
+}
+
+std::vector<std::string> generateLog(size_t seconds) {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> step(-0.0005, 0.0005);
+    std::vector<std::string> log;
+    double lat = 4807.038;
+    double lon = 1131.000;
+    char buffer[160];
+    for (size_t s = 0; s < seconds; ++s) {
+        lat += step(random);
+        lon += step(random);
+        unsigned hh = 12 + s / 3600 % 12, mm = s / 60 % 60, ss = s % 60;
+        std::snprintf(buffer, sizeof(buffer), "GPGGA,%02u%02u%02u.00,%09.4f,N,%010.4f,E,1,%02u,0.9,%.1f,M,46.9,M,,",
+                      hh, mm, ss, lat, lon, 7 + unsigned(random() % 4), 545.0 + step(random) * 1000);
+        log.push_back(withChecksum(buffer));
+        std::snprintf(buffer, sizeof(buffer), "GPRMC,%02u%02u%02u.00,A,%09.4f,N,%010.4f,E,%05.1f,%05.1f,230394,003.1,W",
+                      hh, mm, ss, lat, lon, 22.0 + step(random) * 1000, 84.0 + step(random) * 1000);
+        log.push_back(withChecksum(buffer));
+        log.push_back(withChecksum("GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1"));
+        for (int part = 1; part <= 3; ++part) {
+            std::snprintf(buffer, sizeof(buffer), "GPGSV,3,%d,11,%02d,%02u,%03u,%02u,%02d,%02u,%03u,%02u", part,
+                          part * 3, 40 + unsigned(random() % 5), 80 + unsigned(random() % 5), 40 + unsigned(random() % 9),
+                          part * 3 + 1, 20 + unsigned(random() % 5), 200 + unsigned(random() % 5),
+                          35 + unsigned(random() % 9));
+            log.push_back(withChecksum(buffer));
+        }
+        std::snprintf(buffer, sizeof(buffer), "GPVTG,%05.1f,T,,M,%05.1f,N,%05.1f,K", 84.0 + step(random) * 1000,
+                      22.0 + step(random) * 1000, 40.7 + step(random) * 1000);
+        log.push_back(withChecksum(buffer));
+    }
+    return log;
+}
+
+std::vector<std::string> readLog(const char* path) {
+    std::ifstream file(path);
+    std::vector<std::string> log;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) log.push_back(line);
+    }
+    return log;
+}
+
+void run(const char* label, const std::vector<std::string>& sentences, size_t batchSize,
+         std::shared_ptr<const CompressionDictionary> dictionary) {
+    using Clock = std::chrono::steady_clock;
+    CompressingCodec<> sender(dictionary);
+    CompressingCodec<> receiver(dictionary);
+    size_t sentenceBytes = 0;
+    for (const std::string& sentence : sentences) sentenceBytes += sentence.size();
+
+    constexpr int kRepeats = 20;
+    std::string wire;
+    double compressSeconds = 0;
+    double decompressSeconds = 0;
+    for (int repeat = 0; repeat < kRepeats; ++repeat) {
+        wire.clear();
+        auto start = Clock::now();
+        if (batchSize == 1) {
+            for (const std::string& sentence : sentences) sender.encode(sentence, wire);
+        } else {
+            std::span<const std::string> all(sentences);
+            for (size_t i = 0; i < all.size(); i += batchSize) {
+                sender.encodeBatch(all.subspan(i, std::min(batchSize, all.size() - i)), wire);
+            }
+        }
+        compressSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+        start = Clock::now();
+        std::string message;
+        size_t decoded = 0;
+        std::span<const char> input(wire);
+        while (size_t frameBytes = receiver.decode(input, message)) {
+            ++decoded;
+            while (receiver.takePending(message)) ++decoded;
+            input = input.subspan(frameBytes);
+        }
+        decompressSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+        if (decoded != sentences.size()) {
+            std::cerr << label << ": decoded " << decoded << " of " << sentences.size() << "\n";
+        }
+    }
+    double megabytes = static_cast<double>(sentenceBytes) * kRepeats / 1e6;
+    std::cout << "    " << label << "ratio " << static_cast<double>(sentenceBytes) / static_cast<double>(wire.size())
+              << ", compress " << megabytes / compressSeconds << " MB/s, decompress "
+              << megabytes / decompressSeconds << " MB/s\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> log = argc > 1 ? readLog(argv[1]) : generateLog(20000);
+    size_t training = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+    if (log.size() <= training) {
+        std::cerr << "Need more than " << training << " sentences\n";
+        return 1;
+    }
+    std::vector<std::string> samples(log.begin(), log.begin() + training);
+    std::vector<std::string> sentences(log.begin() + training, log.end());
+
+    auto start = std::chrono::steady_clock::now();
+    auto dictionary = std::make_shared<const CompressionDictionary>(CompressionDictionary::train(samples));
+    double trainMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << sentences.size() << " sentences; dictionary of " << dictionary->getContent().size()
+              << " bytes trained on " << training << " in " << trainMs << " ms\n";
+
+    for (size_t batchSize : {size_t(1), size_t(16), size_t(64)}) {
+        std::cout << (batchSize == 1 ? std::string("One sentence per frame:\n")
+                                     : "Batches of " + std::to_string(batchSize) + ":\n");
+        run("no dictionary: ", sentences, batchSize, nullptr);
+        run("dictionary:    ", sentences, batchSize, dictionary);
+    }
+    return 0;
+}
@@ -0,0 +1,243 @@
+/**
+ * @file bench_ConnectionManager.cpp
+ * @brief Time-to-all-connected for many feeds, serial blocking connects vs ConnectionManager.
+ * @details Usage: bench_ConnectionManager [feeds] [blackholedPercent]
+ * All feeds point at one loopback listener. In the second pass the given share of feeds
+ * lists a blackholed endpoint (a listener whose accept queue is full, so SYNs are
+ * dropped) before the live one. The serial baseline connects feed after feed with the
+ * former blocking loop, given a per-connect timeout equal to the attempt timeout (the
+ * old code had none and waited out the kernel SYN timeout); blackholed feeds are timed
+ * on a sample and extrapolated. A last pass drops every connection at once and reports
+ * how the reconnects spread out.
+ */
+
+#include "ConnectionManager.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr unsigned int kAttemptDelayMs = 250;
+constexpr unsigned int kAttemptTimeoutMs = 2000;
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int listenOnLoopback(int backlog, unsigned short& port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    listen(fd, backlog);
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+
+sockaddr_in loopback(unsigned short port) {
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    return addr;
+}
+
+// Accepts in the background, keeping the server side open until dropAll()
+class AcceptingListener {
+public:
+    AcceptingListener() : _running(true) {
+        _fd = listenOnLoopback(4096, _port);
+        _thread = std::thread([this] { run(); });
+    }
+    ~AcceptingListener() {
+        _running = false;
+        _thread.join();
+        dropAll();
+        ::close(_fd);
+    }
+    unsigned short port() const { return _port; }
+
+    // Closes every accepted connection; returns the times of later accepts via takeAcceptTimes()
+    void dropAll() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (int fd : _accepted) ::close(fd);
+        _accepted.clear();
+        _acceptTimes.clear();
+    }
+    std::vector<Clock::time_point> takeAcceptTimes() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return std::move(_acceptTimes);
+    }
+
+private:
+    int _fd;
+    unsigned short _port;
+    std::atomic<bool> _running;
+    std::thread _thread;
+    std::mutex _mutex;
+    std::vector<int> _accepted;
+    std::vector<Clock::time_point> _acceptTimes;
+
+    void run() {
+        while (_running) {
+            pollfd pfd {_fd, POLLIN, 0};
+            if (::poll(&pfd, 1, 20) <= 0) continue;
+            int fd = ::accept(_fd, nullptr, nullptr);
+            if (fd < 0) continue;
+            std::lock_guard<std::mutex> lock(_mutex);
+            _accepted.push_back(fd);
+            _acceptTimes.push_back(Clock::now());
+        }
+    }
+};
+
+// Full accept queue: further SYNs are dropped, like an unreachable host
+class Blackhole {
+public:
+    Blackhole() {
+        _fd = listenOnLoopback(0, _port);
+        _filler = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        sockaddr_in addr = loopback(_port);
+        ::connect(_filler, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        pollfd pfd {_filler, POLLOUT, 0};
+        ::poll(&pfd, 1, 1000);
+    }
+    ~Blackhole() {
+        ::close(_filler);
+        ::close(_fd);
+    }
+    unsigned short port() const { return _port; }
+
+private:
+    int _fd;
+    int _filler;
+    unsigned short _port;
+};
+
+// The former NetworkComms::connect: each address in turn with a blocking ::connect
+int connectSerially(const std::vector<unsigned short>& ports) {
+    for (unsigned short port : ports) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        timeval timeout {kAttemptTimeoutMs / 1000, (kAttemptTimeoutMs % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        sockaddr_in addr = loopback(port);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) return fd;
+        ::close(fd);
+    }
+    return -1;
+}
+
+double serialMs(size_t feeds, size_t blackholed, unsigned short live, unsigned short dead) {
+    std::vector<int> fds;
+    auto start = Clock::now();
+    for (size_t i = 0; i < feeds - blackholed; ++i) fds.push_back(connectSerially({live}));
+    double ms = msSince(start);
+
+    // Sample a few blackholed feeds and extrapolate; each one costs the full timeout
+    size_t sample = std::min<size_t>(blackholed, 3);
+    if (sample > 0) {
+        start = Clock::now();
+        for (size_t i = 0; i < sample; ++i) fds.push_back(connectSerially({dead, live}));
+        ms += msSince(start) / static_cast<double>(sample) * static_cast<double>(blackholed);
+    }
+    for (int fd : fds) ::close(fd);
+    return ms;
+}
+
+struct ManagerResult {
+    double ms;
+    uint64_t attempts;
+};
+
+ManagerResult managerMs(size_t feeds, size_t blackholed, unsigned short live, unsigned short dead) {
+    ConnectionManager::Options options;
+    options.connect.attemptDelayMs = kAttemptDelayMs;
+    options.connect.attemptTimeoutMs = kAttemptTimeoutMs;
+    ConnectionManager manager(options);
+    std::string livePort = std::to_string(live), deadPort = std::to_string(dead);
+    for (size_t i = 0; i < feeds; ++i) {
+        if (i < blackholed) {
+            manager.add({{"127.0.0.1", deadPort}, {"127.0.0.1", livePort}});
+        } else {
+            manager.add("127.0.0.1", livePort);
+        }
+    }
+
+    auto start = Clock::now();
+    while (manager.getConnectedCount() < feeds && msSince(start) < 30000) {
+        manager.poll(10);
+    }
+    return {msSince(start), manager.getStats().connectAttempts};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t feeds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500;
+    size_t blackholedPercent = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+
+    AcceptingListener listener;
+    Blackhole blackhole;
+    std::cout << feeds << " feeds, attempt delay " << kAttemptDelayMs << " ms, attempt timeout "
+              << kAttemptTimeoutMs << " ms\n\n";
+
+    for (size_t percent : {size_t(0), blackholedPercent}) {
+        size_t blackholed = feeds * percent / 100;
+        double serial = serialMs(feeds, blackholed, listener.port(), blackhole.port());
+        listener.dropAll();
+        ManagerResult raced = managerMs(feeds, blackholed, listener.port(), blackhole.port());
+        listener.dropAll();
+        std::cout << percent << "% blackholed first: serial blocking " << serial << " ms"
+                  << (blackholed > 0 ? " (extrapolated)" : "") << ", ConnectionManager " << raced.ms
+                  << " ms (" << raced.attempts << " connects)\n";
+    }
+
+    // Reconnect storm: every feed loses its connection at the same moment
+    ConnectionManager manager;
+    std::string port = std::to_string(listener.port());
+    for (size_t i = 0; i < feeds; ++i) manager.add("127.0.0.1", port);
+    while (manager.getConnectedCount() < feeds) manager.poll(10);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Let the listener accept them all
+    listener.dropAll();
+
+    auto dropped = Clock::now();
+    std::vector<std::byte> buffer(256);
+    while (manager.getStats().connects < 2 * feeds && msSince(dropped) < 30000) {
+        for (size_t id = 0; id < feeds; ++id) {
+            if (manager.isConnected(id)) manager.getComms(id).readInto(buffer, 0);
+        }
+        manager.poll(1);
+    }
+    double allBack = msSince(dropped);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    std::vector<Clock::time_point> accepts = listener.takeAcceptTimes();
+    std::sort(accepts.begin(), accepts.end());
+    if (!accepts.empty()) {
+        auto at = [&](double fraction) {
+            size_t index = std::min(accepts.size() - 1, static_cast<size_t>(fraction * accepts.size()));
+            return std::chrono::duration<double, std::milli>(accepts[index] - dropped).count();
+        };
+        std::cout << "\nReconnect after dropping all " << feeds << " feeds: all back in " << allBack
+                  << " ms; reconnects arrived from " << at(0.0) << " to " << at(1.0) << " ms (median "
+                  << at(0.5) << " ms) with " << ConnectionManager::Options().initialBackoffMs
+                  << " ms jittered backoff\n";
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file bench_FramingCodecs.cpp
+ * @brief Encode and decode throughput of each framing codec, and the cost of type erasure.
+ * @details Usage: bench_FramingCodecs [megabytes]
+ * Codecs: random payloads of 64 B and 4 KB are framed into one buffer in memory, then
+ * decoded from it frame by frame, as BasicComms does from its receive buffer.
+ * Random bytes are the worst case for the escaping codecs (SLIP escapes 2 of 256 byte
+ * values, COBS breaks a block at every zero).
+ * TimeoutCodec is left out: it only frames by silence on the line, so it has nothing to decode.
+ * Comms: CRLF messages are streamed over loopback TCP and received through
+ * BasicComms<CrlfCodec> and through the type-erased Comms.
+ */
+
+#include "Comms.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+template <class Codec>
+void appendFrame(const Codec& codec, std::string_view payload, std::string& out) {
+    if constexpr (GatherCodec<Codec>) {
+        char header[Codec::kMaxHeader + 1];
+        char trailer[Codec::kMaxTrailer + 1];
+        out.append(header, codec.header(payload, header));
+        out.append(payload);
+        out.append(trailer, codec.trailer(payload, trailer));
+    } else {
+        codec.encode(payload, out);
+    }
+}
+
+template <class Codec>
+void benchCodec(const char* label, const std::vector<std::string>& payloads, size_t megabytes) {
+    size_t payloadBytes = payloads.size() * payloads[0].size();
+    size_t rounds = std::max<size_t>(1, megabytes * 1024 * 1024 / payloadBytes);
+    Codec codec;
+    std::string wire;
+
+    auto start = Clock::now();
+    for (size_t round = 0; round < rounds; ++round) {
+        wire.clear();
+        for (const std::string& payload : payloads) appendFrame(codec, payload, wire);
+    }
+    double encodeSeconds = secondsSince(start);
+
+    std::string message;
+    size_t decoded = 0;
+    start = Clock::now();
+    for (size_t round = 0; round < rounds; ++round) {
+        size_t offset = 0;
+        while (size_t consumed = codec.decode(std::span<const char>(wire.data() + offset, wire.size() - offset), message)) {
+            offset += consumed;
+            decoded += message.size();
+        }
+    }
+    double decodeSeconds = secondsSince(start);
+    if (decoded != rounds * payloadBytes) {
+        std::cout << "    " << label << "decoded " << decoded << " of " << rounds * payloadBytes << " bytes\n";
+        return;
+    }
+
+    double megabytesMoved = static_cast<double>(rounds * payloadBytes) / 1e6;
+    std::cout << "    " << label << "encode " << megabytesMoved / encodeSeconds << " MB/s, decode "
+              << megabytesMoved / decodeSeconds << " MB/s, overhead "
+              << static_cast<double>(wire.size()) / static_cast<double>(payloadBytes) * 100.0 - 100.0 << "%\n";
+}
+
+// Payloads for line-oriented codecs must not contain their delimiter
+std::vector<std::string> randomPayloads(size_t size, size_t count, bool text) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> printable(0x20, 0x7E);
+    std::vector<std::string> payloads(count, std::string(size, '\0'));
+    for (std::string& payload : payloads) {
+        for (char& c : payload) c = static_cast<char>(text ? printable(rng) : byte(rng));
+    }
+    return payloads;
+}
+
+class LoopbackListener {
+public:
+    LoopbackListener() {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(_fd, 4);
+        socklen_t len = sizeof(addr);
+        getsockname(_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        _port = ntohs(addr.sin_port);
+    }
+    ~LoopbackListener() { ::close(_fd); }
+    int port() const { return _port; }
+    int accept() { return ::accept(_fd, nullptr, nullptr); }
+
+private:
+    int _fd;
+    unsigned short _port;
+};
+
+// Streams count CRLF lines to client and times receiving them all
+template <class Client>
+double receiveRate(Client& client, size_t size, size_t count) {
+    LoopbackListener listener;
+    std::thread writer([&] {
+        int peer = listener.accept();
+        std::string batch;
+        for (size_t i = 0; i < 64; ++i) batch += std::string(size, 'x') + "\r\n";
+        for (size_t sent = 0; sent < count; sent += 64) ::send(peer, batch.data(), batch.size(), MSG_NOSIGNAL);
+        ::shutdown(peer, SHUT_WR);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        ::close(peer);
+    });
+    client.connectToServer("127.0.0.1", listener.port());
+
+    auto start = Clock::now();
+    size_t received = 0;
+    while (received < count && client.receiveMessage().size() == size) ++received;
+    double seconds = secondsSince(start);
+    writer.join();
+    return static_cast<double>(received) / seconds;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+
+    for (size_t size : {size_t(64), size_t(4096)}) {
+        size_t count = 1024 * 1024 / size; // 1 MB of payload per round
+        std::vector<std::string> binary = randomPayloads(size, count, false);
+        std::vector<std::string> text = randomPayloads(size, count, true);
+
+        std::cout << size << "-byte payloads, " << megabytes << " MB:\n";
+        benchCodec<LengthPrefixCodec>("LengthPrefix:  ", binary, megabytes);
+        benchCodec<VarintLengthCodec>("VarintLength:  ", binary, megabytes);
+        benchCodec<CrlfCodec>("CRLF (text):   ", text, megabytes);
+        benchCodec<NulTerminatedCodec>("NUL (text):    ", text, megabytes);
+        benchCodec<SlipCodec>("SLIP:          ", binary, megabytes);
+        benchCodec<CobsCodec>("COBS:          ", binary, megabytes);
+        benchCodec<RawCodec>("None:          ", binary, megabytes);
+    }
+
+    std::cout << "Receiving CRLF over loopback:\n";
+    for (size_t size : {size_t(64), size_t(4096)}) {
+        size_t count = (megabytes / 4 * 1024 * 1024 / (size + 2) + 63) / 64 * 64;
+        BasicComms<CrlfCodec> direct;
+        Comms erased(SocketBackend::BSD, FramingStrategy::CRLF);
+        double directRate = receiveRate(direct, size, count);
+        double erasedRate = receiveRate(erased, size, count);
+        std::cout << "    " << size << " B: BasicComms<CrlfCodec> " << directRate / 1e3 << " k msg/s, Comms "
+                  << erasedRate / 1e3 << " k msg/s\n";
+    }
+    return 0;
+}
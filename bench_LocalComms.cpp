@@ -0,0 +1,124 @@
+/**
+ * @file bench_LocalComms.cpp
+ * @brief Compares AF_UNIX stream/datagram sockets and pipes against loopback TCP,
+ * and splice() against read()+write() for recording a feed.
+ * @details Usage: bench_LocalComms [megabytes] [writeSize]
+ * A writer thread streams writeSize-byte chunks; the reader thread's CPU time is
+ * taken from getrusage(RUSAGE_THREAD).
+ */
+
+#include "LocalComms.hpp"
+#include "NetworkComms.hpp"
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+
+double threadCpuSeconds() {
+    rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+std::thread startWriter(int fd, size_t total, size_t writeSize) {
+    return std::thread([=]() {
+        std::string chunk(writeSize, 'N');
+        size_t sent = 0;
+        while (sent < total) {
+            ssize_t n = ::write(fd, chunk.data(), chunk.size());
+            if (n <= 0) break;
+            sent += static_cast<size_t>(n);
+        }
+        ::close(fd);
+    });
+}
+
+// Runs read(buffer) until it reports the source closed and prints throughput and reader CPU
+void report(const char* name, size_t total, const std::function<size_t()>& readOnce, const std::function<bool()>& isOpen) {
+    auto start = std::chrono::steady_clock::now();
+    double cpuStart = threadCpuSeconds();
+    size_t received = 0;
+    while (isOpen() && received < total) received += readOnce();
+    double cpu = threadCpuSeconds() - cpuStart;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << received / seconds / (1024 * 1024) << " MB/s, reader CPU "
+              << cpu * 1e9 / received << " ns/byte" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t total = (argc > 1 ? std::stoul(argv[1]) : 512) * 1024 * 1024;
+    const size_t writeSize = argc > 2 ? std::stoul(argv[2]) : 4096;
+    std::vector<std::byte> buffer(64 * 1024);
+
+    // --- Loopback TCP through NetworkComms ---
+    {
+        int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(listenFd, 1);
+        socklen_t len = sizeof(addr);
+        getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+        NetworkComms comms;
+        comms.connect("127.0.0.1", std::to_string(ntohs(addr.sin_port)));
+        int peer = accept(listenFd, nullptr, nullptr);
+        std::thread writer = startWriter(peer, total, writeSize);
+        report("loopback TCP (NetworkComms)", total,
+            [&]() { return comms.readInto(buffer, 100); }, [&]() { return comms.isOpen(); });
+        writer.join();
+        ::close(listenFd);
+    }
+
+    // --- AF_UNIX stream and datagram, pipe ---
+    struct Case { const char* name; int domainType; LocalComms::Type type; };
+    for (Case c : {Case{"AF_UNIX stream   ", SOCK_STREAM, LocalComms::Type::Stream},
+                   Case{"AF_UNIX datagram ", SOCK_DGRAM, LocalComms::Type::Datagram},
+                   Case{"pipe             ", -1, LocalComms::Type::Fifo}}) {
+        int fds[2];
+        if (c.domainType == -1) {
+            pipe(fds);
+        } else {
+            socketpair(AF_UNIX, c.domainType, 0, fds);
+        }
+        LocalComms comms;
+        comms.attach(fds[0], c.type);
+        std::thread writer = startWriter(fds[1], total, writeSize);
+        // A datagram socketpair reports no EOF, so stop on byte count instead
+        report(c.name, total, [&]() { return comms.readInto(buffer, 100); }, [&]() { return comms.isOpen(); });
+        writer.join();
+    }
+
+    // --- Recording: read()+write() vs spliceTo() into /dev/null ---
+    int devNull = ::open("/dev/null", O_WRONLY);
+    for (bool useSplice : {false, true}) {
+        int fds[2];
+        socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+        LocalComms comms;
+        comms.attach(fds[0], LocalComms::Type::Stream);
+        std::thread writer = startWriter(fds[1], total, writeSize);
+        report(useSplice ? "record via spliceTo    " : "record via read+write  ", total,
+            [&]() {
+                if (useSplice) return comms.spliceTo(devNull, buffer.size(), 100);
+                size_t n = comms.readInto(buffer, 100);
+                return static_cast<size_t>(n > 0 ? ::write(devNull, buffer.data(), n) : 0);
+            },
+            [&]() { return comms.isOpen(); });
+        writer.join();
+    }
+    ::close(devNull);
+    return 0;
+}
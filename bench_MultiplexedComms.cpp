@@ -0,0 +1,220 @@
+/**
+ * @file bench_MultiplexedComms.cpp
+ * @brief Alarm latency behind bulk data on one connection: Comms against MultiplexedComms.
+ * @details Usage: bench_MultiplexedComms [seconds] [linkMBps]
+ * One thread sends 1 MB bulk messages as fast as it can while another sends a 64-byte
+ * alarm every 5 ms on the same connection. The receiving side drains the socket at
+ * linkMBps (default 20) to stand in for a slow link, and timestamps each alarm when its
+ * last byte arrives.
+ *  - Comms:              LengthPrefix; the two threads take turns under a mutex, so an
+ *                        alarm waits for the bulk message being sent.
+ *  - MultiplexedComms:   alarms on a priority stream, 16 KB fragments, with the kernel's
+ *                        unsent backlog left at its default and limited to 16 KB.
+ */
+
+#include "Comms.hpp"
+#include "MultiplexedComms.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint16_t kAlarmStream = 0;
+constexpr uint16_t kBulkStream = 1;
+
+class LoopbackListener {
+public:
+    LoopbackListener() {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(_fd, 4);
+        socklen_t len = sizeof(addr);
+        getsockname(_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        _port = ntohs(addr.sin_port);
+    }
+    ~LoopbackListener() { ::close(_fd); }
+    int port() const { return _port; }
+    int accept() { return ::accept(_fd, nullptr, nullptr); }
+
+private:
+    int _fd;
+    unsigned short _port;
+};
+
+std::string makeAlarm() {
+    int64_t now = Clock::now().time_since_epoch().count();
+    std::string alarm(64, 'A');
+    std::memcpy(alarm.data() + 1, &now, sizeof(now));
+    return alarm;
+}
+
+double alarmAgeMicros(const char* alarm) {
+    int64_t sent;
+    std::memcpy(&sent, alarm + 1, sizeof(sent));
+    return std::chrono::duration<double, std::micro>(Clock::now() - Clock::time_point(Clock::duration(sent))).count();
+}
+
+struct Result {
+    std::vector<double> alarmMicros;
+    size_t bulkBytes = 0;
+};
+
+// Reads the peer side at linkBytesPerSecond; parse() consumes complete frames from the front
+// of the data and returns how many bytes it used
+void drain(int fd, double linkBytesPerSecond, const std::function<size_t(const std::string&)>& parse) {
+    std::string data;
+    char buffer[16384];
+    size_t total = 0;
+    auto start = Clock::now();
+    ssize_t received;
+    while ((received = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        data.append(buffer, static_cast<size_t>(received));
+        data.erase(0, parse(data));
+        total += static_cast<size_t>(received);
+        auto due = start + std::chrono::duration_cast<Clock::duration>(
+                               std::chrono::duration<double>(static_cast<double>(total) / linkBytesPerSecond));
+        std::this_thread::sleep_until(due);
+    }
+}
+
+void report(const char* label, Result& result, double seconds) {
+    std::vector<double>& micros = result.alarmMicros;
+    std::sort(micros.begin(), micros.end());
+    std::cout << "    " << label;
+    if (micros.empty()) {
+        std::cout << "no alarms arrived\n";
+        return;
+    }
+    std::cout << "alarm latency p50 " << micros[micros.size() / 2] / 1000 << " ms, p99 "
+              << micros[micros.size() * 99 / 100] / 1000 << " ms, max " << micros.back() / 1000 << " ms ("
+              << micros.size() << " alarms); bulk " << static_cast<double>(result.bulkBytes) / seconds / 1e6
+              << " MB/s\n";
+}
+
+// Runs the bulk and alarm senders for the given time; send(stream, message) must be thread-safe
+void runSenders(double seconds, const std::function<void(uint16_t, const std::string&)>& send) {
+    std::atomic<bool> stop {false};
+    std::string bulk(1024 * 1024, 'b');
+    std::thread bulkSender([&] {
+        while (!stop) send(kBulkStream, bulk);
+    });
+    std::thread alarmSender([&] {
+        auto next = Clock::now();
+        while (!stop) {
+            send(kAlarmStream, makeAlarm());
+            next += std::chrono::milliseconds(5);
+            std::this_thread::sleep_until(next);
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    alarmSender.join();
+    bulkSender.join();
+}
+
+Result runComms(double seconds, double linkBytesPerSecond) {
+    LoopbackListener listener;
+    Result result;
+    std::thread receiver([&] {
+        int peer = listener.accept();
+        drain(peer, linkBytesPerSecond, [&](const std::string& data) {
+            size_t used = 0;
+            while (data.size() - used >= 4) {
+                const unsigned char* h = reinterpret_cast<const unsigned char*>(data.data() + used);
+                size_t length = (size_t(h[0]) << 24) | (size_t(h[1]) << 16) | (size_t(h[2]) << 8) | h[3];
+                if (data.size() - used - 4 < length) break;
+                if (data[used + 4] == 'A') {
+                    result.alarmMicros.push_back(alarmAgeMicros(data.data() + used + 4));
+                } else {
+                    result.bulkBytes += length;
+                }
+                used += 4 + length;
+            }
+            return used;
+        });
+        ::close(peer);
+    });
+    {
+        Comms comms(SocketBackend::BSD, FramingStrategy::LengthPrefix);
+        comms.connectToServer("127.0.0.1", listener.port());
+        std::mutex mutex;
+        runSenders(seconds, [&](uint16_t, const std::string& message) {
+            std::lock_guard<std::mutex> lock(mutex);
+            comms.sendMessage(message);
+        });
+    }
+    receiver.join();
+    return result;
+}
+
+Result runMultiplexed(double seconds, double linkBytesPerSecond, int unsentLimitBytes) {
+    LoopbackListener listener;
+    Result result;
+    std::thread receiver([&] {
+        int peer = listener.accept();
+        std::string bulkPartial;
+        drain(peer, linkBytesPerSecond, [&](const std::string& data) {
+            size_t used = 0;
+            while (data.size() - used >= MultiplexedComms::kHeaderSize) {
+                const unsigned char* h = reinterpret_cast<const unsigned char*>(data.data() + used);
+                uint16_t stream = static_cast<uint16_t>((h[0] << 8) | h[1]);
+                size_t length = (size_t(h[3]) << 8) | h[4];
+                if (data.size() - used - MultiplexedComms::kHeaderSize < length) break;
+                if (stream == kAlarmStream) {
+                    result.alarmMicros.push_back(alarmAgeMicros(data.data() + used + MultiplexedComms::kHeaderSize));
+                } else {
+                    result.bulkBytes += length;
+                }
+                used += MultiplexedComms::kHeaderSize + length;
+            }
+            return used;
+        });
+        ::close(peer);
+    });
+    {
+        MultiplexedComms::Options options;
+        options.unsentLimitBytes = unsentLimitBytes;
+        MultiplexedComms comms(options);
+        comms.setStreamPriority(kAlarmStream, 10);
+        comms.connectToServer("127.0.0.1", listener.port());
+        runSenders(seconds, [&](uint16_t stream, const std::string& message) { comms.sendMessage(stream, message); });
+    }
+    receiver.join();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? std::strtod(argv[1], nullptr) : 3;
+    double linkMBps = argc > 2 ? std::strtod(argv[2], nullptr) : 20;
+    double link = linkMBps * 1e6;
+
+    std::cout << "1 MB bulk messages and a 64-byte alarm every 5 ms over one connection drained at " << linkMBps
+              << " MB/s:\n";
+    Result comms = runComms(seconds, link);
+    report("Comms, shared mutex:            ", comms, seconds);
+    Result multiplexed = runMultiplexed(seconds, link, 0);
+    report("MultiplexedComms, kernel unsent: ", multiplexed, seconds);
+    Result limited = runMultiplexed(seconds, link, 16 * 1024);
+    report("MultiplexedComms, unsent 16 KB:  ", limited, seconds);
+    return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file bench_NMEAReader.cpp
+ * @brief Reproducible NMEAReader / NMEAParser throughput benchmark.
+ * @details Usage: bench_NMEAReader [sentences] [logFile]
+ * Sentences are served from MemoryComms at several chunk sizes (modelling serial
+ * fragments up to full TCP segments), then from a memory-mapped log via MmapFileComms.
+ * No sockets or serial ports are involved, so results are stable between runs.
+ */
+
+#include "MemoryComms.hpp"
+#include "MmapFileComms.hpp"
+#include "NMEAParser.hpp"
+#include "NMEAReader.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+std::string makeLog(size_t sentences) {
+    const std::string gga = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+    const std::string rmc = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+    std::string log;
+    log.reserve(sentences * rmc.size());
+    for (size_t i = 0; i < sentences; ++i) {
+        log += (i % 2 == 0) ? gga : rmc;
+    }
+    return log;
+}
+
+void runReader(const char* name, IComms& comms, size_t bytes) {
+    NMEAReader reader(comms, 0);
+    size_t parsed = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (comms.isOpen()) {
+        if (reader.readAndParseSentence()) ++parsed;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << parsed / seconds / 1e6 << " M sentences/s, "
+              << bytes / seconds / (1024.0 * 1024.0) << " MB/s (" << parsed << " parsed)" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t sentences = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::string log = makeLog(sentences);
+
+    for (size_t chunk : {1, 16, 128, 1460, 0}) {
+        MemoryComms comms(log, chunk);
+        std::string name = "MemoryComms chunk=" + (chunk == 0 ? std::string("unlimited") : std::to_string(chunk));
+        name.resize(28, ' ');
+        runReader(name.c_str(), comms, log.size());
+    }
+
+    std::string path = argc > 2 ? argv[2] : "bench_NMEAReader.nmea";
+    if (argc <= 2) {
+        std::ofstream(path, std::ios::binary) << log;
+    }
+    MmapFileComms file;
+    if (file.open(path)) {
+        runReader("MmapFileComms               ", file, file.view().size());
+    }
+    if (argc <= 2) {
+        std::remove(path.c_str());
+    }
+
+    // Parser alone, for separating framing cost from parse cost
+    const std::string sentence = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47";
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < sentences; ++i) {
+        NMEAParser::parse(sentence);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "NMEAParser::parse only       : " << sentences / seconds / 1e6 << " M sentences/s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,232 @@
+/**
+ * @file bench_NetworkComms.cpp
+ * @brief Loopback throughput and allocation benchmark for NetworkComms read paths.
+ * @details Usage: bench_NetworkComms [megabytes]
+ * A writer thread streams data over loopback TCP; the reader drains it through
+ * each IComms read API in turn. A second pass paces the writer at 10 MB/s in
+ * 1400-byte segments and reports syscalls/KB and reader CPU for sentence-sized
+ * readBytes calls, against the former one-byte select()+recv() loop.
+ * A last pass floods loopback multicast with sentence-sized datagrams and compares
+ * recvmmsg batches against one datagram per syscall.
+ */
+
+#include "NetworkComms.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+// Count every heap allocation in the process
+static std::atomic<size_t> g_allocations {0};
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct Result {
+    double seconds;
+    size_t bytes;
+    size_t allocations;
+    double cpuSeconds;
+};
+
+double threadCpuSeconds() {
+    rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// Streams `total` bytes to one client and measures how fast `drain` consumes them.
+// With bytesPerSecond > 0 the writer sends 1400-byte segments at that rate instead.
+Result runLoopback(size_t total, const std::function<size_t(NetworkComms&)>& drain, size_t bytesPerSecond = 0) {
+    int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    listen(listenFd, 1);
+    socklen_t len = sizeof(addr);
+    getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+
+    NetworkComms comms;
+    comms.connect("127.0.0.1", std::to_string(ntohs(addr.sin_port)));
+    int peer = accept(listenFd, nullptr, nullptr);
+
+    std::thread writer([&]() {
+        std::vector<char> chunk(bytesPerSecond > 0 ? 1400 : 64 * 1024, 'N');
+        int one = 1;
+        setsockopt(peer, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        auto start = std::chrono::steady_clock::now();
+        size_t sent = 0;
+        while (sent < total) {
+            ssize_t n = send(peer, chunk.data(), std::min(chunk.size(), total - sent), 0);
+            if (n <= 0) break;
+            sent += static_cast<size_t>(n);
+            if (bytesPerSecond > 0) {
+                std::this_thread::sleep_until(start + std::chrono::microseconds(sent * 1000000 / bytesPerSecond));
+            }
+        }
+        ::close(peer);
+    });
+
+    size_t allocationsBefore = g_allocations.load();
+    double cpuBefore = threadCpuSeconds();
+    auto start = std::chrono::steady_clock::now();
+    size_t received = 0;
+    while (received < total && comms.isOpen()) {
+        received += drain(comms);
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t allocations = g_allocations.load() - allocationsBefore;
+    double cpuSeconds = threadCpuSeconds() - cpuBefore;
+
+    writer.join();
+    ::close(listenFd);
+    return {elapsed, received, allocations, cpuSeconds};
+}
+
+// The pre-buffering read path: select() then one recv() per byte
+size_t legacyReadBytes(int fd, size_t numBytes, unsigned int timeoutMs, uint64_t& syscalls) {
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(fd, &readSet);
+    timeval tv {static_cast<time_t>(timeoutMs / 1000), static_cast<suseconds_t>((timeoutMs % 1000) * 1000)};
+    ++syscalls;
+    if (select(fd + 1, &readSet, nullptr, nullptr, &tv) <= 0) return 0;
+    std::string received;
+    received.reserve(numBytes);
+    char byte;
+    while (received.size() < numBytes) {
+        ++syscalls;
+        if (recv(fd, &byte, 1, 0) != 1) break;
+        received += byte;
+    }
+    return received.size();
+}
+
+void reportPaced(const char* name, const Result& r, uint64_t syscalls) {
+    double kb = r.bytes / 1024.0;
+    std::cout << name << ": " << syscalls / kb << " syscalls/KB, reader CPU "
+              << 100.0 * r.cpuSeconds / r.seconds << "% of one core" << std::endl;
+}
+
+void report(const char* name, const Result& r) {
+    double kb = r.bytes / 1024.0;
+    std::cout << name << ": " << (r.bytes / (1024.0 * 1024.0)) / r.seconds << " MB/s, "
+              << r.allocations / kb << " allocations/KB" << std::endl;
+}
+
+// Floods loopback multicast from a writer thread and reports the datagram rate seen by the reader
+void runMulticastFlood(unsigned int batchSize, uint32_t total) {
+    const std::string group = "239.255.0.63";
+    const unsigned short port = 45063;
+    NetworkComms comms;
+    NetworkComms::UdpReceiveOptions options;
+    options.multicastGroup = group;
+    options.interfaceAddress = "127.0.0.1";
+    options.receiveBufferBytes = 4 * 1024 * 1024;
+    options.batchSize = batchSize;
+    if (!comms.bindUdp(std::to_string(port), options)) return;
+
+    // Two writers: a single sender thread is slower than a batching reader
+    std::atomic<int> running {2};
+    auto writerBody = [&]() {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        in_addr loopback;
+        inet_pton(AF_INET, "127.0.0.1", &loopback);
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &loopback, sizeof(loopback));
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        inet_pton(AF_INET, group.c_str(), &addr.sin_addr);
+        std::string sentence = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+        for (uint32_t i = 0; i < total / 2; ++i) {
+            sendto(fd, sentence.data(), sentence.size(), 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        }
+        ::close(fd);
+        --running;
+    };
+    std::thread writers[] = {std::thread(writerBody), std::thread(writerBody)};
+
+    double cpuBefore = threadCpuSeconds();
+    auto start = std::chrono::steady_clock::now();
+    auto last = start;
+    while (true) {
+        std::span<const NetworkComms::Datagram> datagrams = comms.readDatagrams(100);
+        if (datagrams.empty()) {
+            if (running == 0) break;
+            continue;
+        }
+        last = std::chrono::steady_clock::now();
+    }
+    for (std::thread& writer : writers) writer.join();
+    double seconds = std::chrono::duration<double>(last - start).count();
+    const NetworkComms::Stats& stats = comms.getStats();
+    std::cout << "multicast flood, batch " << batchSize << ": " << stats.datagrams / seconds / 1000 << "k datagrams/s received, "
+              << 100.0 * (total - stats.datagrams) / total << "% lost, "
+              << static_cast<double>(stats.datagrams) / stats.recvCalls << " datagrams/syscall, reader CPU "
+              << 1e9 * (threadCpuSeconds() - cpuBefore) / stats.datagrams << " ns/datagram" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 64;
+    const size_t total = megabytes * 1024 * 1024;
+
+    report("readBytes(4096)      ", runLoopback(total, [](NetworkComms& comms) {
+        return comms.readBytes(4096, 500).size();
+    }));
+
+    std::vector<std::byte> buffer(4096);
+    report("readInto(4 KB span)  ", runLoopback(total, [&](NetworkComms& comms) {
+        return comms.readInto(buffer, 500);
+    }));
+
+    std::vector<std::byte> ring(8192);
+    report("readIntoScatter(2x4K)", runLoopback(total, [&](NetworkComms& comms) {
+        std::span<std::byte> halves[] = {std::span(ring).subspan(6144), std::span(ring).first(6144)};
+        return comms.readIntoScatter(halves, 500);
+    }));
+
+    // 10 MB/s feed read sentence by sentence (82 bytes, the NMEA maximum)
+    const size_t rate = 10 * 1024 * 1024;
+    const size_t pacedTotal = 3 * rate;
+    uint64_t legacySyscalls = 0;
+    Result legacy = runLoopback(pacedTotal, [&](NetworkComms& comms) {
+        return legacyReadBytes(comms.getPollDescriptor(), 82, 500, legacySyscalls);
+    }, rate);
+    reportPaced("10 MB/s, before (1-byte recv)", legacy, legacySyscalls);
+
+    uint64_t bufferedSyscalls = 0;
+    Result buffered = runLoopback(pacedTotal, [&](NetworkComms& comms) {
+        uint64_t before = comms.getStats().pollCalls + comms.getStats().recvCalls;
+        size_t n = comms.readBytes(82, 500).size();
+        bufferedSyscalls += comms.getStats().pollCalls + comms.getStats().recvCalls - before;
+        return n;
+    }, rate);
+    reportPaced("10 MB/s, after (buffered)    ", buffered, bufferedSyscalls);
+
+    for (unsigned int batchSize : {1u, 64u}) {
+        runMulticastFlood(batchSize, 1000000);
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file bench_ReceiveLatency.cpp
+ * @brief Wire-to-handler latency histogram from kernel receive timestamps, on loopback.
+ * @details Usage: bench_ReceiveLatency [sentences] [handlerMicros]
+ * A writer streams GGA sentences over loopback TCP at 5000/s; the reader parses them with
+ * NMEAReader and a handler that busy-waits handlerMicros per message, so queueing shows
+ * up in the tail. A second pass floods the socket to compare reader CPU per sentence with
+ * timestamps off and on.
+ */
+
+#include "NMEAReader.hpp"
+#include "NetworkComms.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+
+const std::string kSentence = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+
+double threadCpuSeconds() {
+    rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// Connects a NetworkComms to a loopback listener and returns the server-side socket
+int connectLoopback(NetworkComms& comms) {
+    int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    listen(listenFd, 1);
+    socklen_t len = sizeof(addr);
+    getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+    comms.connect("127.0.0.1", std::to_string(ntohs(addr.sin_port)));
+    int peer = accept(listenFd, nullptr, nullptr);
+    ::close(listenFd);
+    int one = 1;
+    setsockopt(peer, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return peer;
+}
+
+std::thread startWriter(int peer, size_t sentences, size_t perSecond) {
+    return std::thread([=]() {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < sentences; ++i) {
+            send(peer, kSentence.data(), kSentence.size(), 0);
+            if (perSecond > 0) std::this_thread::sleep_until(start + std::chrono::microseconds(i * 1000000 / perSecond));
+        }
+        ::close(peer);
+    });
+}
+
+void busyWait(std::chrono::microseconds duration) {
+    auto until = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < until) {}
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t sentences = argc > 1 ? std::stoul(argv[1]) : 20000;
+    const std::chrono::microseconds handlerTime(argc > 2 ? std::stoul(argv[2]) : 100);
+
+    // --- Latency histogram ---
+    {
+        NetworkComms comms;
+        comms.setReceiveTimestamps(true);
+        int peer = connectLoopback(comms);
+        NMEAReader reader(comms, 200);
+        std::thread writer = startWriter(peer, sentences, 5000);
+
+        std::vector<double> latencyUs;
+        while (comms.isOpen()) {
+            auto message = reader.readAndParseSentence();
+            if (!message.has_value()) continue;
+            busyWait(handlerTime); // The "handler"
+            if ((*message)->receiveTime) {
+                auto latency = std::chrono::system_clock::now() - *(*message)->receiveTime;
+                latencyUs.push_back(std::chrono::duration<double, std::micro>(latency).count());
+            }
+        }
+        writer.join();
+
+        std::sort(latencyUs.begin(), latencyUs.end());
+        if (latencyUs.empty()) {
+            std::cout << "No timestamps received" << std::endl;
+            return 1;
+        }
+        auto pct = [&](double p) { return latencyUs[std::min(latencyUs.size() - 1, static_cast<size_t>(p * latencyUs.size()))]; };
+        std::cout << "wire-to-handler-done latency over " << latencyUs.size() << " sentences (handler "
+                  << handlerTime.count() << " us): p50=" << pct(0.5) << " p90=" << pct(0.9) << " p99=" << pct(0.99)
+                  << " max=" << latencyUs.back() << " us" << std::endl;
+    }
+
+    // --- Cost of timestamps: reader CPU per sentence with the socket flooded ---
+    for (bool timestamps : {false, true}) {
+        NetworkComms comms;
+        comms.setReceiveTimestamps(timestamps);
+        int peer = connectLoopback(comms);
+        NMEAReader reader(comms, 200);
+        std::thread writer = startWriter(peer, sentences * 10, 0);
+        double cpuBefore = threadCpuSeconds();
+        size_t parsed = 0;
+        while (comms.isOpen()) {
+            if (reader.readAndParseSentence().has_value()) ++parsed;
+        }
+        double cpu = threadCpuSeconds() - cpuBefore;
+        writer.join();
+        std::cout << "timestamps " << (timestamps ? "on " : "off") << ": " << cpu * 1e9 / parsed
+                  << " ns reader CPU per sentence" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file bench_RequestClient.cpp
+ * @brief Requests per second against a local echo server as the pipeline depth rises.
+ * @details Usage: bench_RequestClient [requests] [payloadBytes]
+ * The echo server is a CommsServer<LengthPrefixCodec> on its own thread that returns each
+ * frame unchanged, which is a correct reply for both clients.
+ *  - Comms:          send, then receiveMessage(): one request per round trip.
+ *  - RequestClient:  depth requests kept in flight; each reply's callback sends the next.
+ *                    With coalescing, the requests sent for one read share a send call.
+ */
+
+#include "Comms.hpp"
+#include "CommsServer.hpp"
+#include "RequestClient.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class EchoServer {
+public:
+    EchoServer() : server(options) {
+        CommsReactor::Handlers handlers;
+        handlers.onMessage = [this](CommsReactor::ConnectionId id, std::string& body) { server.send(id, body); };
+        server.setHandlers(handlers);
+        server.listen("0", "127.0.0.1");
+        thread = std::thread([this] {
+            while (!stop) server.poll(10);
+        });
+    }
+    ~EchoServer() {
+        stop = true;
+        thread.join();
+    }
+    int port() { return server.getPort(); }
+
+private:
+    CommsReactor::Options options;
+    CommsServer<LengthPrefixCodec> server;
+    std::atomic<bool> stop {false};
+    std::thread thread;
+};
+
+double runComms(int port, size_t requests, const std::string& payload) {
+    Comms comms(SocketBackend::BSD, FramingStrategy::LengthPrefix);
+    comms.connectToServer("127.0.0.1", port);
+    auto start = Clock::now();
+    for (size_t i = 0; i < requests; ++i) {
+        comms.sendMessage(payload);
+        comms.receiveMessage();
+    }
+    return static_cast<double>(requests) / std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double runPipelined(int port, size_t requests, size_t depth, bool coalesce, const std::string& payload) {
+    RequestClient client;
+    if (coalesce) {
+        client.setCoalescing(depth, std::chrono::microseconds(200));
+    }
+    client.connectToServer("127.0.0.1", port);
+
+    std::atomic<size_t> sent {0};
+    std::atomic<size_t> completed {0};
+    std::promise<void> done;
+    std::function<void()> sendNext;
+    RequestClient::Callback onReply = [&](RequestClient::Status status, std::string&) {
+        if (status != RequestClient::Status::Ok) {
+            std::cerr << "request failed\n";
+            std::exit(1);
+        }
+        if (++completed == requests) {
+            done.set_value();
+        } else {
+            sendNext();
+        }
+    };
+    sendNext = [&] {
+        if (sent++ < requests) {
+            client.send(payload, onReply, std::chrono::seconds(10));
+        }
+    };
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < depth; ++i) {
+        sendNext();
+    }
+    client.flush();
+    done.get_future().wait();
+    return static_cast<double>(requests) / std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t requests = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    size_t payloadBytes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 64;
+    std::string payload(payloadBytes, 'q');
+    EchoServer server;
+
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << requests << " requests of " << payloadBytes << " bytes to a local echo server:\n";
+    std::cout << "    Comms, send then receive:   " << runComms(server.port(), requests, payload) << " requests/s\n";
+    for (size_t depth : {1, 2, 4, 8, 16, 32, 64, 256}) {
+        double plain = runPipelined(server.port(), requests, depth, false, payload);
+        double coalesced = runPipelined(server.port(), requests, depth, true, payload);
+        std::cout << "    RequestClient, depth " << depth << ":" << std::string(depth < 10 ? 3 : depth < 100 ? 2 : 1, ' ')
+                  << plain << " requests/s, coalesced " << coalesced << " requests/s\n";
+    }
+    return 0;
+}
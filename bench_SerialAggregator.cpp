@@ -0,0 +1,223 @@
+/**
+ * @file bench_SerialAggregator.cpp
+ * @brief CPU and latency of reading many serial ports, over pty loopbacks.
+ * @details Usage: bench_SerialAggregator [seconds] [ports] [baud]
+ * A writer thread feeds each port (default 32 at 38400 baud, 10 bits per byte) with
+ * ~80-byte sentences in 16-byte pieces, as a UART FIFO hands them over, with the ports'
+ * pieces staggered as independent devices would send them. Each sentence carries its send
+ * time, so the reader measures the delay from its first byte being written to its delivery.
+ *  - thread per port:   one Serial_Comms and one thread per port, each in read(CRLF).
+ *  - SerialAggregator:  all ports on one epoll instance, read from one thread.
+ *  - ... batched:       the same, with a 5 ms sleep after each poll() so each wakeup
+ *                       collects more ports and bytes, trading latency for CPU.
+ * CPU is that of the whole process less the writer thread.
+ */
+
+#include "SerialAggregator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double cpuSeconds(clockid_t clock) {
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+long long nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+struct Result {
+    std::vector<double> latencyMicros;
+    double cpuSeconds = 0;
+    uint64_t wakeups = 0;
+};
+
+class Ptys {
+public:
+    explicit Ptys(size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            int master = posix_openpt(O_RDWR | O_NOCTTY);
+            grantpt(master);
+            unlockpt(master);
+            masters.push_back(master);
+            names.push_back(ptsname(master));
+        }
+    }
+    ~Ptys() {
+        for (int master : masters) {
+            ::close(master);
+        }
+    }
+    std::vector<int> masters;
+    std::vector<std::string> names;
+};
+
+// Writes sentences carrying their send time to every master, 16 bytes at a time
+void writeSentences(const std::vector<int>& masters, double seconds, double bytesPerSecond, std::atomic<bool>& done,
+                    double& writerCpu) {
+    constexpr size_t kFifoBytes = 16;
+    const double pieceSeconds = kFifoBytes / bytesPerSecond;
+    struct Feed {
+        std::string sentence;
+        size_t offset = 0;
+    };
+    std::vector<Feed> feeds(masters.size());
+    auto start = Clock::now();
+    for (size_t piece = 0; piece * pieceSeconds < seconds; ++piece) {
+        for (size_t port = 0; port < masters.size(); ++port) {
+            double due = (static_cast<double>(piece) + static_cast<double>(port) / static_cast<double>(masters.size())) *
+                         pieceSeconds;
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(due)));
+            Feed& feed = feeds[port];
+            if (feed.offset == feed.sentence.size()) {
+                char text[128];
+                std::snprintf(text, sizeof(text), "$GPGGA,%019lld,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n",
+                              nowNanos());
+                feed.sentence = text;
+                feed.offset = 0;
+            }
+            size_t length = std::min(kFifoBytes, feed.sentence.size() - feed.offset);
+            if (::write(masters[port], feed.sentence.data() + feed.offset, length) != static_cast<ssize_t>(length)) {
+                std::cerr << "pty write failed\n";
+                std::exit(1);
+            }
+            feed.offset += length;
+        }
+    }
+    writerCpu = cpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+    done = true;
+}
+
+void recordLatency(std::vector<double>& micros, std::string_view line) {
+    if (line.size() < 26 || line.compare(0, 7, "$GPGGA,") != 0) {
+        return;
+    }
+    long long sent = std::atoll(std::string(line.substr(7, 19)).c_str());
+    micros.push_back(static_cast<double>(nowNanos() - sent) / 1000.0);
+}
+
+Result runThreadPerPort(double seconds, size_t ports, double bytesPerSecond) {
+    Ptys ptys(ports);
+    std::vector<std::unique_ptr<Serial_Comms>> serials;
+    for (const std::string& name : ptys.names) {
+        serials.push_back(std::make_unique<Serial_Comms>());
+        if (!serials.back()->open(name) ||
+            !serials.back()->configure(Serial_Comms::BaudRate::BR_38400, Serial_Comms::DataBits::DB_8,
+                                       Serial_Comms::Parity::None, Serial_Comms::StopBits::SB_1,
+                                       Serial_Comms::FlowControl::None)) {
+            std::exit(1);
+        }
+    }
+
+    Result result;
+    std::mutex resultMutex;
+    std::atomic<bool> done {false};
+    double writerCpu = 0;
+    double cpuStart = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID);
+    std::vector<std::thread> readers;
+    for (auto& serial : serials) {
+        readers.emplace_back([&, port = serial.get()] {
+            while (!done) {
+                std::string line = port->read(Serial_Comms::TerminationMethod::CRLF, 100);
+                std::lock_guard<std::mutex> lock(resultMutex);
+                recordLatency(result.latencyMicros, line);
+            }
+        });
+    }
+    std::thread writer(writeSentences, std::cref(ptys.masters), seconds, bytesPerSecond, std::ref(done),
+                       std::ref(writerCpu));
+    writer.join();
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    result.cpuSeconds = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID) - cpuStart - writerCpu;
+    return result;
+}
+
+Result runAggregator(double seconds, size_t ports, double bytesPerSecond, unsigned int batchMs) {
+    Ptys ptys(ports);
+    SerialAggregator aggregator;
+    Result result;
+    SerialAggregator::Handlers handlers;
+    handlers.onSentence = [&](const SerialAggregator::Sentence& sentence) {
+        recordLatency(result.latencyMicros, sentence.text);
+    };
+    aggregator.setHandlers(handlers);
+    for (const std::string& name : ptys.names) {
+        SerialAggregator::PortConfig config;
+        config.device = name;
+        config.baudRate = Serial_Comms::BaudRate::BR_38400;
+        if (!aggregator.add(config)) {
+            std::exit(1);
+        }
+    }
+
+    std::atomic<bool> done {false};
+    double writerCpu = 0;
+    double cpuStart = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID);
+    std::thread writer(writeSentences, std::cref(ptys.masters), seconds, bytesPerSecond, std::ref(done),
+                       std::ref(writerCpu));
+    while (!done) {
+        aggregator.poll(100);
+        if (batchMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(batchMs));
+        }
+    }
+    writer.join();
+    result.cpuSeconds = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID) - cpuStart - writerCpu;
+    result.wakeups = aggregator.getStats().wakeups;
+    return result;
+}
+
+void report(const char* label, Result& result, double seconds) {
+    std::vector<double>& micros = result.latencyMicros;
+    std::sort(micros.begin(), micros.end());
+    std::cout << "    " << label;
+    if (micros.empty()) {
+        std::cout << "no sentences\n";
+        return;
+    }
+    std::cout << "CPU " << 100.0 * result.cpuSeconds / seconds << "% of a core, latency p50 " << micros[micros.size() / 2]
+              << " us, p99 " << micros[micros.size() * 99 / 100] << " us (" << micros.size() << " sentences";
+    if (result.wakeups > 0) {
+        std::cout << ", " << static_cast<double>(result.wakeups) / seconds << " wakeups/s";
+    }
+    std::cout << ")\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? std::strtod(argv[1], nullptr) : 3;
+    size_t ports = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 32;
+    double baud = argc > 3 ? std::strtod(argv[3], nullptr) : 38400;
+    double bytesPerSecond = baud / 10;
+
+    std::cout << ports << " ports at " << baud << " baud (" << bytesPerSecond * static_cast<double>(ports) / 1000
+              << " kB/s in total) for " << seconds << " s:\n";
+    Result threads = runThreadPerPort(seconds, ports, bytesPerSecond);
+    report("thread per port:   ", threads, seconds);
+    Result aggregated = runAggregator(seconds, ports, bytesPerSecond, 0);
+    report("SerialAggregator:  ", aggregated, seconds);
+    Result batched = runAggregator(seconds, ports, bytesPerSecond, 5);
+    report("... batched 5 ms:  ", batched, seconds);
+    return 0;
+}
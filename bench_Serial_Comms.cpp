@@ -0,0 +1,221 @@
+/**
+ * @file bench_Serial_Comms.cpp
+ * @brief CPU per port and byte-to-return latency of serial line reads, over a pty loopback.
+ * @details Usage: bench_Serial_Comms [seconds] [baud]
+ * A writer thread feeds NMEA-sized sentences into the pty master at the byte rate of the
+ * given baud (default 921600, 10 bits per byte), in 16-byte pieces as a UART FIFO hands
+ * them over. Each sentence carries its send time, so the reader measures the delay from
+ * its first byte being written to read() returning it.
+ *  - per-byte:        the previous read path, reproduced here: termios timeouts set per call,
+ *                     then one read() syscall per byte.
+ *  - Serial_Comms:    poll() deadlines and bulk reads, with the CRLF search over buffered
+ *                     bytes, for both read profiles, and served from the background reader.
+ * CPU is that of the whole process less the writer thread, so it includes the reader thread.
+ *
+ * A second run stalls the consumer for 1 s in every 2 s. The writer does not block, as a
+ * UART cannot, so bytes the pty has no room for are lost; with the background reader the
+ * ring absorbs the stall.
+ */
+
+#include "Serial_Comms.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double cpuSeconds(clockid_t clock) {
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+struct Result {
+    std::vector<double> latencyMicros;
+    double cpuSeconds = 0;
+    uint64_t syscalls = 0;
+    uint64_t sentBytes = 0;
+    uint64_t lostBytes = 0; // Refused by the full pty
+};
+
+// Writes ~80-byte sentences carrying their send time, 16 bytes at a time paced at bytesPerSecond.
+// The master is non-blocking: pieces the pty cannot take are lost, as from an overrun UART.
+void writeSentences(int master, double seconds, double bytesPerSecond, std::atomic<bool>& done, Result& result,
+                    double& writerCpu) {
+    constexpr size_t kFifoBytes = 16;
+    auto start = Clock::now();
+    size_t sent = 0;
+    char sentence[128];
+    while (Clock::now() - start < std::chrono::duration<double>(seconds)) {
+        long long now = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+        size_t length = static_cast<size_t>(std::snprintf(
+            sentence, sizeof(sentence), "$GPGGA,%019lld,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n", now));
+        for (size_t offset = 0; offset < length; offset += kFifoBytes) {
+            size_t piece = std::min(kFifoBytes, length - offset);
+            ssize_t written = ::write(master, sentence + offset, piece);
+            result.lostBytes += written < 0 ? piece : piece - static_cast<size_t>(written);
+            sent += piece;
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(
+                                                      static_cast<double>(sent) / bytesPerSecond)));
+        }
+    }
+    result.sentBytes = sent;
+    writerCpu = cpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+    done = true;
+}
+
+void recordLatency(Result& result, const std::string& line) {
+    if (line.size() < 26 || line.compare(0, 7, "$GPGGA,") != 0) {
+        return;
+    }
+    long long sent = std::atoll(line.c_str() + 7);
+    long long now = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    result.latencyMicros.push_back(static_cast<double>(now - sent) / 1000.0);
+}
+
+// The read path as it was: termios timeouts around every call, one read() per byte
+std::string perByteReadLine(int fd, unsigned int timeoutMs, uint64_t& syscalls) {
+    termios original;
+    tcgetattr(fd, &original);
+    termios tty = original;
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = std::max(1u, timeoutMs / 100);
+    tcsetattr(fd, TCSANOW, &tty);
+    syscalls += 2;
+
+    std::string line;
+    auto start = Clock::now();
+    char byte;
+    while (Clock::now() - start <= std::chrono::milliseconds(timeoutMs)) {
+        ++syscalls;
+        ssize_t n = ::read(fd, &byte, 1);
+        if (n <= 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        line += byte;
+        if (line.size() >= 2 && line[line.size() - 2] == '\r' && byte == '\n') {
+            break;
+        }
+    }
+    tcsetattr(fd, TCSANOW, &original);
+    ++syscalls;
+    return line;
+}
+
+struct Mode {
+    bool perByte = false;
+    Serial_Comms::ReadProfile profile = Serial_Comms::ReadProfile::LowLatency;
+    bool reader = false;
+    bool stalls = false; // Consumer sleeps 1 s in every 2 s
+};
+
+Result run(double seconds, double bytesPerSecond, Mode mode) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    grantpt(master);
+    unlockpt(master);
+    Serial_Comms serial;
+    serial.setReadProfile(mode.profile);
+    if (!serial.open(ptsname(master)) ||
+        !serial.configure(Serial_Comms::BaudRate::BR_921600, Serial_Comms::DataBits::DB_8, Serial_Comms::Parity::None,
+                          Serial_Comms::StopBits::SB_1, Serial_Comms::FlowControl::None)) {
+        std::cerr << "Cannot open a pty\n";
+        std::exit(1);
+    }
+    int fd = serial.getPollDescriptor();
+    if (mode.reader) {
+        serial.startReader();
+    }
+
+    Result result;
+    std::atomic<bool> done {false};
+    double writerCpu = 0;
+    double cpuStart = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID);
+    auto start = Clock::now();
+    auto nextStall = start + std::chrono::milliseconds(500);
+    std::thread writer(writeSentences, master, seconds, bytesPerSecond, std::ref(done), std::ref(result),
+                       std::ref(writerCpu));
+    while (!done) {
+        if (mode.stalls && Clock::now() >= nextStall) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            nextStall += std::chrono::seconds(2);
+        }
+        std::string line = mode.perByte ? perByteReadLine(fd, 100, result.syscalls)
+                                        : serial.read(Serial_Comms::TerminationMethod::CRLF, 100);
+        recordLatency(result, line);
+    }
+    writer.join();
+    // Whatever the reader thread still holds was received
+    while (!mode.perByte && serial.getBufferedBytes() > 0) {
+        recordLatency(result, serial.read(Serial_Comms::TerminationMethod::CRLF, 0));
+    }
+    result.cpuSeconds = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID) - cpuStart - writerCpu;
+    if (!mode.perByte) {
+        result.syscalls = serial.getStats().pollCalls + serial.getStats().readCalls;
+    }
+    serial.close();
+    ::close(master);
+    return result;
+}
+
+void report(const char* label, Result& result, double seconds) {
+    std::vector<double>& micros = result.latencyMicros;
+    std::sort(micros.begin(), micros.end());
+    std::cout << "    " << label;
+    if (micros.empty()) {
+        std::cout << "no sentences\n";
+        return;
+    }
+    std::cout << "CPU " << 100.0 * result.cpuSeconds / seconds << "% of a core, "
+              << static_cast<double>(result.syscalls) / static_cast<double>(micros.size()) << " syscalls/sentence, latency p50 "
+              << micros[micros.size() / 2] << " us, p99 " << micros[micros.size() * 99 / 100] << " us ("
+              << micros.size() << " sentences)\n";
+}
+
+void reportLoss(const char* label, const Result& result) {
+    std::cout << "    " << label << result.latencyMicros.size() << " sentences, " << result.lostBytes << " of "
+              << result.sentBytes << " bytes lost, latency p99 "
+              << (result.latencyMicros.empty() ? 0.0 : result.latencyMicros[result.latencyMicros.size() * 99 / 100] / 1000)
+              << " ms\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? std::strtod(argv[1], nullptr) : 3;
+    double baud = argc > 2 ? std::strtod(argv[2], nullptr) : 921600;
+    double bytesPerSecond = baud / 10;
+
+    std::cout << "~80-byte sentences over a pty at " << baud << " baud (" << bytesPerSecond / 1000
+              << " kB/s) for " << seconds << " s:\n";
+    Result perByte = run(seconds, bytesPerSecond, {.perByte = true});
+    report("per-byte read():  ", perByte, seconds);
+    Result lowLatency = run(seconds, bytesPerSecond, {});
+    report("LowLatency:       ", lowLatency, seconds);
+    Result highThroughput = run(seconds, bytesPerSecond, {.profile = Serial_Comms::ReadProfile::HighThroughput});
+    report("HighThroughput:   ", highThroughput, seconds);
+    Result reader = run(seconds, bytesPerSecond, {.reader = true});
+    report("reader thread:    ", reader, seconds);
+
+    std::cout << "Consumer stalled for 1 s in every 2 s:\n";
+    Result stalled = run(seconds, bytesPerSecond, {.stalls = true});
+    std::sort(stalled.latencyMicros.begin(), stalled.latencyMicros.end());
+    reportLoss("caller reads:     ", stalled);
+    Result stalledReader = run(seconds, bytesPerSecond, {.reader = true, .stalls = true});
+    std::sort(stalledReader.latencyMicros.begin(), stalledReader.latencyMicros.end());
+    reportLoss("reader thread:    ", stalledReader);
+    return 0;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file bench_SharedMemoryComms.cpp
+ * @brief Shared-memory ring vs loopback NetworkComms: throughput and one-way latency.
+ * @details Usage: bench_SharedMemoryComms [megabytes] [messageSize] [readers]
+ * Writer and readers run as threads here, but use exactly the same shm/futex
+ * path as separate processes would.
+ */
+
+#include "NetworkComms.hpp"
+#include "SharedMemoryComms.hpp"
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+long long nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+void printLatency(const char* name, std::vector<double>& us) {
+    std::sort(us.begin(), us.end());
+    std::cout << name << " latency (us): p50=" << us[us.size() / 2] << " p99=" << us[us.size() * 99 / 100] << std::endl;
+}
+
+// Ping: writer stamps the send time into the message, the reader computes one-way delay
+template <typename Send, typename Receive>
+std::vector<double> measureLatency(size_t samples, Send send, Receive receive) {
+    std::vector<double> us;
+    for (size_t i = 0; i < samples; ++i) {
+        long long sent = nowNs();
+        send(std::string(reinterpret_cast<char*>(&sent), sizeof(sent)));
+        std::string got;
+        while (got.size() < sizeof(sent)) got += receive(sizeof(sent) - got.size());
+        long long stamp;
+        memcpy(&stamp, got.data(), sizeof(stamp));
+        us.push_back((nowNs() - stamp) / 1000.0);
+    }
+    return us;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t total = (argc > 1 ? std::stoul(argv[1]) : 256) * 1024 * 1024;
+    const size_t messageSize = argc > 2 ? std::stoul(argv[2]) : 256;
+    const size_t readerCount = argc > 3 ? std::stoul(argv[3]) : 4;
+    const std::string message(messageSize, 'N');
+    const std::string name = "/nmea_bench_" + std::to_string(getpid());
+
+    // --- Shared memory: one writer, several independent readers ---
+    {
+        SharedMemoryWriter writer;
+        writer.create(name, 4 << 20);
+        std::vector<std::unique_ptr<SharedMemoryComms>> readers;
+        for (size_t i = 0; i < readerCount; ++i) {
+            readers.push_back(std::make_unique<SharedMemoryComms>());
+            readers.back()->open(name);
+        }
+
+        std::vector<std::thread> threads;
+        for (auto& reader : readers) {
+            threads.emplace_back([&, r = reader.get()]() {
+                std::vector<std::byte> buffer(64 * 1024);
+                size_t received = 0;
+                while (r->isOpen()) received += r->readInto(buffer, 100);
+                (void)received;
+            });
+        }
+
+        auto start = Clock::now();
+        for (size_t sent = 0; sent < total; sent += messageSize) writer.write(message);
+        writer.close();
+        for (auto& t : threads) t.join();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        uint64_t lost = 0;
+        for (auto& reader : readers) lost += reader->getOverrunBytes();
+        std::cout << "shm ring, " << readerCount << " readers: " << total / seconds / (1024 * 1024)
+                  << " MB/s per reader, overrun bytes total=" << lost << std::endl;
+    }
+
+    {
+        SharedMemoryWriter ping;
+        ping.create(name + "_ping", 1 << 16);
+        SharedMemoryComms reader;
+        reader.open(name + "_ping");
+        auto us = measureLatency(20000,
+            [&](const std::string& m) { ping.write(m); },
+            [&](size_t n) { return reader.readBytes(n, 100); });
+        printLatency("shm ring             ", us);
+    }
+
+    // --- Loopback TCP through NetworkComms ---
+    int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    listen(listenFd, 1);
+    socklen_t len = sizeof(addr);
+    getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+
+    NetworkComms comms;
+    comms.connect("127.0.0.1", std::to_string(ntohs(addr.sin_port)));
+    int peer = accept(listenFd, nullptr, nullptr);
+    int one = 1;
+    setsockopt(peer, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    auto us = measureLatency(20000,
+        [&](const std::string& m) { send(peer, m.data(), m.size(), 0); },
+        [&](size_t n) { return comms.readBytes(n, 100); });
+    printLatency("loopback NetworkComms", us);
+
+    std::thread writer([&]() {
+        for (size_t sent = 0; sent < total; sent += messageSize) send(peer, message.data(), message.size(), 0);
+        ::close(peer);
+    });
+    std::vector<std::byte> buffer(64 * 1024);
+    size_t received = 0;
+    auto start = Clock::now();
+    while (comms.isOpen()) received += comms.readInto(buffer, 100);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    writer.join();
+    ::close(listenFd);
+    std::cout << "loopback NetworkComms, 1 reader: " << received / seconds / (1024 * 1024) << " MB/s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file bench_SocketProfile.cpp
+ * @brief Effect of NetworkComms socket profiles on loopback ping-pong latency and streaming.
+ * @details Usage: bench_SocketProfile [roundTrips] [megabytes]
+ * Ping-pong: the client sends an NMEA sentence as two writes (body, then checksum and
+ * CRLF, as a formatter emitting fields would) and waits for a one-line reply from a
+ * peer with default socket settings. Streaming: the client writes sentence-sized
+ * messages as fast as it can; the receiver counts bytes and recv() calls (one per
+ * delivered segment burst).
+ */
+
+#include "NetworkComms.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const std::string kBody = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,";
+const std::string kTail = "*47\r\n";
+
+class Listener {
+public:
+    Listener() {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(_fd, 4);
+        socklen_t len = sizeof(addr);
+        getsockname(_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        _port = ntohs(addr.sin_port);
+    }
+    ~Listener() { ::close(_fd); }
+    std::string port() const { return std::to_string(_port); }
+    int accept() { return ::accept(_fd, nullptr, nullptr); }
+
+private:
+    int _fd;
+    unsigned short _port;
+};
+
+const char* name(NetworkComms::SocketProfile profile) {
+    switch (profile) {
+    case NetworkComms::SocketProfile::LowLatency: return "LowLatency    ";
+    case NetworkComms::SocketProfile::HighThroughput: return "HighThroughput";
+    default: return "Default       ";
+    }
+}
+
+void pingPong(NetworkComms::SocketProfile profile, size_t roundTrips) {
+    Listener listener;
+    NetworkComms comms;
+    comms.setSocketProfile(profile);
+    comms.connect("127.0.0.1", listener.port());
+    int peer = listener.accept();
+
+    // Peer: answer every complete line with a short acknowledgement line
+    std::thread responder([peer] {
+        char buffer[4096];
+        std::string pending;
+        while (true) {
+            ssize_t n = ::recv(peer, buffer, sizeof(buffer), 0);
+            if (n <= 0) break;
+            pending.append(buffer, static_cast<size_t>(n));
+            size_t end;
+            while ((end = pending.find('\n')) != std::string::npos) {
+                pending.erase(0, end + 1);
+                ::send(peer, "$ACK*00\r\n", 9, MSG_NOSIGNAL);
+            }
+        }
+    });
+
+    std::vector<double> micros;
+    micros.reserve(roundTrips);
+    std::byte reply[64];
+    for (size_t i = 0; i < roundTrips; ++i) {
+        auto start = Clock::now();
+        comms.write(kBody, 1000);
+        comms.write(kTail, 1000);
+        comms.flush();
+        size_t received = 0;
+        while (received < 9) {
+            size_t n = comms.readInto(std::span<std::byte>(reply + received, sizeof(reply) - received), 1000);
+            if (n == 0) break;
+            received += n;
+        }
+        micros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    comms.close();
+    responder.join();
+    ::close(peer);
+
+    std::sort(micros.begin(), micros.end());
+    std::cout << "  " << name(profile) << "  median " << micros[micros.size() / 2] << " us, p99 "
+              << micros[micros.size() * 99 / 100] << " us\n";
+}
+
+void stream(NetworkComms::SocketProfile profile, size_t megabytes) {
+    Listener listener;
+    NetworkComms comms;
+    comms.setSocketProfile(profile);
+    comms.connect("127.0.0.1", listener.port());
+    int peer = listener.accept();
+
+    std::string sentence = kBody + kTail;
+    size_t messages = megabytes * 1024 * 1024 / sentence.size();
+    size_t expected = messages * sentence.size();
+
+    std::atomic<size_t> recvCalls {0};
+    std::thread receiver([&] {
+        std::vector<char> buffer(256 * 1024);
+        size_t total = 0;
+        while (total < expected) {
+            ssize_t n = ::recv(peer, buffer.data(), buffer.size(), 0);
+            if (n <= 0) break;
+            total += static_cast<size_t>(n);
+            ++recvCalls;
+        }
+    });
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < messages; ++i) {
+        comms.write(sentence, 1000);
+    }
+    comms.flush();
+    receiver.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    ::close(peer);
+
+    std::cout << "  " << name(profile) << "  " << static_cast<double>(expected) / seconds / 1e6 << " MB/s, "
+              << static_cast<double>(expected) / static_cast<double>(recvCalls) << " bytes per receiver recv()\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t roundTrips = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+    size_t megabytes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 50;
+    const NetworkComms::SocketProfile profiles[] = {NetworkComms::SocketProfile::Default,
+                                                    NetworkComms::SocketProfile::LowLatency,
+                                                    NetworkComms::SocketProfile::HighThroughput};
+
+    std::cout << "Ping-pong, sentence written in two parts, " << roundTrips << " round trips:\n";
+    for (auto profile : profiles) pingPong(profile, roundTrips);
+
+    std::cout << "\nStreaming " << megabytes << " MB of " << (kBody + kTail).size() << "-byte sentences:\n";
+    for (auto profile : profiles) stream(profile, megabytes);
+    return 0;
+}
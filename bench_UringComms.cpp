@@ -0,0 +1,178 @@
+/**
+ * @file bench_UringComms.cpp
+ * @brief Compares the io_uring backend against epoll- and poll()-driven NetworkComms reads.
+ * @details Usage: bench_UringComms [megabytes] [writeSize]
+ * A writer thread streams writeSize-byte chunks over loopback TCP. The reader thread's
+ * CPU time is taken from getrusage(RUSAGE_THREAD). Syscalls are counted exactly: poll()
+ * and recv() calls from NetworkComms::getStats(), plus epoll_wait calls for the epoll
+ * reader, and io_uring_enter calls for io_uring. readInto calls served from the
+ * NetworkComms receive buffer issue no syscall and are not counted.
+ */
+
+#include "NetworkComms.hpp"
+#include "UringComms.hpp"
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+
+double threadCpuSeconds() {
+    rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+struct Loopback {
+    int listenFd;
+    int clientFd;
+    int serverFd;
+    unsigned short port;
+};
+
+Loopback makeListener() {
+    Loopback lb {};
+    lb.listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(lb.listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    listen(lb.listenFd, 1);
+    socklen_t len = sizeof(addr);
+    getsockname(lb.listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+    lb.port = ntohs(addr.sin_port);
+    return lb;
+}
+
+std::thread startWriter(int fd, size_t total, size_t writeSize) {
+    return std::thread([=]() {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        std::string chunk(writeSize, 'N');
+        size_t sent = 0;
+        while (sent < total) {
+            ssize_t n = send(fd, chunk.data(), std::min(writeSize, total - sent), 0);
+            if (n <= 0) break;
+            sent += static_cast<size_t>(n);
+        }
+        ::close(fd);
+    });
+}
+
+void report(const char* name, size_t bytes, double seconds, double cpu, double syscalls) {
+    double kb = bytes / 1024.0;
+    std::cout << name << ": " << bytes / (1024.0 * 1024.0) / seconds << " MB/s, "
+              << cpu * 1e6 / kb << " us CPU/KB, " << syscalls / kb << " syscalls/KB" << std::endl;
+}
+
+// Streams total bytes into a connected NetworkComms and reports it under name. The
+// reader issues one read per wake-up and returns how many extra syscalls it made.
+void benchNetworkComms(const char* name, size_t total, size_t writeSize,
+                       const std::function<uint64_t(NetworkComms&, size_t&)>& reader) {
+    Loopback lb = makeListener();
+    NetworkComms comms;
+    comms.connect("127.0.0.1", std::to_string(lb.port));
+    int peer = accept(lb.listenFd, nullptr, nullptr);
+    std::thread writer = startWriter(peer, total, writeSize);
+
+    NetworkComms::Stats before = comms.getStats();
+    size_t received = 0;
+    double cpuStart = threadCpuSeconds();
+    auto start = std::chrono::steady_clock::now();
+    uint64_t extraSyscalls = reader(comms, received);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double cpu = threadCpuSeconds() - cpuStart;
+
+    const NetworkComms::Stats& after = comms.getStats();
+    uint64_t polls = after.pollCalls - before.pollCalls;
+    uint64_t recvs = after.recvCalls - before.recvCalls;
+    report(name, received, elapsed, cpu, static_cast<double>(polls + recvs + extraSyscalls));
+    std::cout << "  poll=" << polls << " recv=" << recvs;
+    if (extraSyscalls > 0) std::cout << " epoll_wait=" << extraSyscalls;
+    std::cout << std::endl;
+    writer.join();
+    ::close(lb.listenFd);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t total = (argc > 1 ? std::stoul(argv[1]) : 64) * 1024 * 1024;
+    const size_t writeSize = argc > 2 ? std::stoul(argv[2]) : 256;
+    std::vector<std::byte> buffer(16 * 1024);
+
+    if (!UringComms::isSupported()) {
+        std::cout << "io_uring not supported on this kernel; only the NetworkComms paths are available." << std::endl;
+        return 0;
+    }
+
+    benchNetworkComms("poll+recv (NetworkComms)   ", total, writeSize,
+                      [&](NetworkComms& comms, size_t& received) -> uint64_t {
+        while (received < total && comms.isOpen()) {
+            received += comms.readInto(buffer, 500);
+        }
+        return 0;
+    });
+
+    benchNetworkComms("epoll+NetworkComms         ", total, writeSize,
+                      [&](NetworkComms& comms, size_t& received) -> uint64_t {
+        int epollFd = epoll_create1(EPOLL_CLOEXEC);
+        epoll_event ev {};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = comms.getPollDescriptor();
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, ev.data.fd, &ev);
+
+        uint64_t waits = 0;
+        epoll_event ready;
+        while (received < total && comms.isOpen()) {
+            // Drain buffered bytes before sleeping; they never make the socket readable
+            if (comms.getBufferedBytes() == 0) {
+                ++waits;
+                if (epoll_wait(epollFd, &ready, 1, 500) <= 0) continue;
+            }
+            received += comms.readInto(buffer, 0);
+        }
+        ::close(epollFd);
+        return waits;
+    });
+
+    {
+        Loopback lb = makeListener();
+        int client = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(lb.port);
+        connect(client, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        int peer = accept(lb.listenFd, nullptr, nullptr);
+
+        UringComms comms(256, 4096);
+        comms.attach(client, true);
+        std::thread writer = startWriter(peer, total, writeSize);
+
+        size_t received = 0;
+        double cpuStart = threadCpuSeconds();
+        auto start = std::chrono::steady_clock::now();
+        while (received < total && comms.isOpen()) {
+            received += comms.readInto(buffer, 500);
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report("io_uring multishot         ", received, elapsed, threadCpuSeconds() - cpuStart,
+               static_cast<double>(comms.getStats().enterCalls));
+        std::cout << "  completions=" << comms.getStats().completions << " rearms=" << comms.getStats().rearms
+                  << " enterCalls=" << comms.getStats().enterCalls << std::endl;
+        writer.join();
+        ::close(lb.listenFd);
+    }
+    return 0;
+}
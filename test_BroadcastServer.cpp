@@ -0,0 +1,161 @@
+#include "BroadcastServer.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+int connectClient(unsigned short port, int receiveBuffer = 0) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (receiveBuffer > 0) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    return fd;
+}
+
+void acceptAll(BroadcastServer& server, size_t expected) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (server.getClientCount() < expected && std::chrono::steady_clock::now() < deadline) server.poll(10);
+}
+
+// Reads until `length` bytes arrived, the peer closed, or 2 s passed (polling the server meanwhile)
+std::string receive(BroadcastServer& server, int fd, size_t length) {
+    std::string data;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (data.size() < length && std::chrono::steady_clock::now() < deadline) {
+        server.poll(0);
+        pollfd pfd {fd, POLLIN, 0};
+        if (::poll(&pfd, 1, 5) <= 0) continue;
+        char buffer[65536];
+        ssize_t n = recv(fd, buffer, std::min(sizeof(buffer), length - data.size()), 0);
+        if (n <= 0) break;
+        data.append(buffer, static_cast<size_t>(n));
+    }
+    return data;
+}
+
+const std::string GGA = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47";
+
+TEST(BroadcastServerTests, EveryClientReceivesTheSameStream) {
+    BroadcastServer server;
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+    std::vector<int> clients;
+    for (int i = 0; i < 3; ++i) clients.push_back(connectClient(server.getPort()));
+    acceptAll(server, 3);
+    ASSERT_EQ(server.getClientCount(), 3u);
+
+    std::string expected;
+    for (int i = 0; i < 100; ++i) {
+        server.publishSentence(GGA);
+        expected += GGA + "\r\n";
+    }
+    for (int fd : clients) {
+        EXPECT_EQ(receive(server, fd, expected.size()), expected);
+        ::close(fd);
+    }
+    EXPECT_EQ(server.getStats().bytesSent, 3 * expected.size());
+}
+
+TEST(BroadcastServerTests, LateClientStartsAtLiveEdge) {
+    BroadcastServer server;
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+    int early = connectClient(server.getPort());
+    acceptAll(server, 1);
+    server.publish("history\r\n");
+    EXPECT_EQ(receive(server, early, 9), "history\r\n");
+
+    int late = connectClient(server.getPort());
+    acceptAll(server, 2);
+    server.publish("live\r\n");
+    EXPECT_EQ(receive(server, late, 6), "live\r\n");
+    EXPECT_EQ(receive(server, early, 6), "live\r\n");
+    ::close(early);
+    ::close(late);
+}
+
+TEST(BroadcastServerTests, ChunksAreReleasedOnceEveryClientHasPassed) {
+    BroadcastServer::Options options;
+    options.chunkSize = 1024;
+    BroadcastServer server(options);
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+    int fd = connectClient(server.getPort());
+    acceptAll(server, 1);
+
+    std::string block(1000, 'x');
+    for (int i = 0; i < 10; ++i) server.publish(block);
+    EXPECT_EQ(server.getStats().liveChunks, 10u); // The client still needs all of them
+    EXPECT_EQ(receive(server, fd, 10000).size(), 10000u);
+    EXPECT_EQ(server.getStats().liveChunks, 1u);  // Only the tail is left
+    ::close(fd);
+}
+
+TEST(BroadcastServerTests, SlowClientIsEvictedWithoutStallingOthers) {
+    BroadcastServer::Options options;
+    options.maxQueuedBytes = 256 * 1024;
+    options.slowClientPolicy = BroadcastServer::SlowClientPolicy::Evict;
+    BroadcastServer server(options);
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+    int slow = connectClient(server.getPort(), 4096); // Never reads
+    int fast = connectClient(server.getPort());
+    acceptAll(server, 2);
+
+    std::string block(8192, 'y');
+    size_t received = 0;
+    for (int i = 0; i < 512 && server.getStats().evicted == 0; ++i) {
+        server.publish(block);
+        received += receive(server, fast, block.size()).size();
+    }
+    EXPECT_EQ(server.getStats().evicted, 1u);
+    EXPECT_EQ(server.getClientCount(), 1u);
+    EXPECT_GT(received, options.maxQueuedBytes);
+    ::close(slow);
+    ::close(fast);
+}
+
+TEST(BroadcastServerTests, SlowClientSkipsAheadAndResumesOnChunkBoundary) {
+    BroadcastServer::Options options;
+    options.chunkSize = 16 * 1024;
+    options.maxQueuedBytes = 256 * 1024;
+    BroadcastServer server(options);
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+    int slow = connectClient(server.getPort(), 4096);
+    acceptAll(server, 1);
+
+    std::string block(8192, 'z');
+    for (int i = 0; i < 512 && server.getStats().skipAheads == 0; ++i) {
+        server.publish(block);
+        server.poll(0);
+    }
+    EXPECT_EQ(server.getStats().skipAheads, 1u);
+    EXPECT_GT(server.getStats().skippedBytes, 0u);
+    EXPECT_EQ(server.getClientCount(), 1u);
+
+    // Once it drains its socket it receives new data again
+    std::string drained;
+    char buffer[65536];
+    ssize_t n;
+    while ((n = recv(slow, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) drained.append(buffer, n);
+    server.publish("$MARK*00\r\n");
+    std::string tail;
+    for (int i = 0; i < 200 && tail.find("$MARK") == std::string::npos; ++i) tail += receive(server, slow, 65536);
+    EXPECT_NE(tail.find("$MARK*00\r\n"), std::string::npos);
+    ::close(slow);
+}
+
+TEST(BroadcastServerTests, ClosedClientsAreRemoved) {
+    BroadcastServer server;
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+    int fd = connectClient(server.getPort());
+    acceptAll(server, 1);
+    ::close(fd);
+    for (int i = 0; i < 50 && server.getClientCount() > 0; ++i) server.poll(10);
+    EXPECT_EQ(server.getClientCount(), 0u);
+    EXPECT_EQ(server.getStats().disconnected, 1u);
+}
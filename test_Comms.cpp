@@ -0,0 +1,399 @@
+#include "Comms.hpp"
+#include "TestSupport.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+
+std::string lengthPrefixed(const std::string& message) {
+    uint32_t len = htonl(static_cast<uint32_t>(message.size()));
+    return std::string(reinterpret_cast<char*>(&len), sizeof(len)) + message;
+}
+
+// Reads exactly n bytes from the peer side, or what arrived before timeoutMs ran out
+std::string receiveExactly(int fd, size_t n, int timeoutMs = 500) {
+    std::string data;
+    char buffer[65536];
+    while (data.size() < n) {
+        pollfd pfd {fd, POLLIN, 0};
+        if (::poll(&pfd, 1, timeoutMs) != 1) break;
+        ssize_t received = ::recv(fd, buffer, std::min(sizeof(buffer), n - data.size()), 0);
+        if (received <= 0) break;
+        data.append(buffer, static_cast<size_t>(received));
+    }
+    return data;
+}
+
+bool peerHasData(int fd, int timeoutMs) {
+    pollfd pfd {fd, POLLIN, 0};
+    return ::poll(&pfd, 1, timeoutMs) == 1;
+}
+
+void shortPause() { std::this_thread::sleep_for(std::chrono::milliseconds(10)); }
+
+} // namespace
+
+TEST(CommsTests, CrlfMessagesFromOneSegmentCostOneRecv) {
+    LoopbackListener listener;
+    Comms comms(SocketBackend::BSD, FramingStrategy::CRLF);
+    comms.connectToServer("127.0.0.1", listener.port());
+    int peer = listener.accept();
+
+    sendAll(peer, "$GPGGA,1*00\r\n$GPRMC,2*00\r\n$GPVTG,3*00\r\n");
+    EXPECT_EQ(comms.receiveMessage(), "$GPGGA,1*00");
+    EXPECT_EQ(comms.receiveMessage(), "$GPRMC,2*00");
+    EXPECT_EQ(comms.receiveMessage(), "$GPVTG,3*00");
+    EXPECT_EQ(comms.getStats().recvCalls, 1u);
+    EXPECT_EQ(comms.getBufferedBytes(), 0u);
+    ::close(peer);
+}
+
+TEST(CommsTests, CrlfSplitAcrossSegments) {
+    LoopbackListener listener;
+    Comms comms(SocketBackend::BSD, FramingStrategy::CRLF);
+    comms.connectToServer("127.0.0.1", listener.port());
+    int peer = listener.accept();
+
+    // Terminator split between segments, lone CR and LF inside the payload
+    std::thread writer([peer] {
+        sendAll(peer, "HEL");
+        shortPause();
+        sendAll(peer, "L\nO\r");
+        shortPause();
+        sendAll(peer, "\nA\rB\r\nTAIL");
+        shortPause();
+        ::close(peer);
+    });
+    EXPECT_EQ(comms.receiveMessage(), "HELL\nO");
+    EXPECT_EQ(comms.receiveMessage(), "A\rB");
+    EXPECT_EQ(comms.receiveMessage(), "TAIL"); // Unterminated tail is returned at close
+    writer.join();
+}
+
+TEST(CommsTests, LengthPrefixCarriesLeftoverBytesToNextCall) {
+    LoopbackListener listener;
+    Comms comms(SocketBackend::BSD, FramingStrategy::LengthPrefix);
+    comms.connectToServer("127.0.0.1", listener.port());
+    int peer = listener.accept();
+
+    std::string third = lengthPrefixed("third");
+    sendAll(peer, lengthPrefixed("first") + lengthPrefixed("") + third.substr(0, 6));
+    EXPECT_EQ(comms.receiveMessage(), "first");
+    EXPECT_EQ(comms.receiveMessage(), "");
+    EXPECT_EQ(comms.getBufferedBytes(), 6u);
+
+    sendAll(peer, third.substr(6));
+    EXPECT_EQ(comms.receiveMessage(), "third");
+    EXPECT_EQ(comms.getStats().recvCalls, 2u);
+    ::close(peer);
+}
+
+TEST(CommsTests, ReceiveBufferGrowsForLargeFrames) {
+    LoopbackListener listener;
+    Comms comms(SocketBackend::BSD, FramingStrategy::LengthPrefix, 16);
+    comms.connectToServer("127.0.0.1", listener.port());
+    int peer = listener.accept();
+
+    std::string big(5000, 'x');
+    sendAll(peer, lengthPrefixed("small") + lengthPrefixed(big) + lengthPrefixed("after"));
+    EXPECT_EQ(comms.receiveMessage(), "small");
+    EXPECT_EQ(comms.receiveMessage(), big);
+    EXPECT_EQ(comms.receiveMessage(), "after");
+    ::close(peer);
+}
+
+TEST(CommsTests, LengthPrefixThrowsWhenPeerClosesMidFrame) {
+    LoopbackListener listener;
+    Comms comms(SocketBackend::BSD, FramingStrategy::LengthPrefix);
+    comms.connectToServer("127.0.0.1", listener.port());
+    int peer = listener.accept();
+
+    sendAll(peer, lengthPrefixed("truncated").substr(0, 8));
+    ::close(peer);
+    EXPECT_THROW(comms.receiveMessage(), std::runtime_error);
+}
+
+TEST(CommsTests, TimeoutAndNoneReturnEverythingBuffered) {
+    LoopbackListener listener;
+    Comms timed(SocketBackend::BSD, FramingStrategy::Timeout);
+    timed.connectToServer("127.0.0.1", listener.port());
+    int timedPeer = listener.accept();
+
+    // Gaps shorter than the 30 ms silence window join into one message
+    std::thread writer([timedPeer] {
+        sendAll(timedPeer, "ab");
+        shortPause();
+        sendAll(timedPeer, "cd");
+    });
+    EXPECT_EQ(timed.receiveMessage(), "abcd");
+    writer.join();
+    ::close(timedPeer);
+
+    Comms raw(SocketBackend::BSD, FramingStrategy::None);
+    raw.connectToServer("127.0.0.1", listener.port());
+    int rawPeer = listener.accept();
+    sendAll(rawPeer, std::string(3000, 'r'));
+    std::string received;
+    while (received.size() < 3000) {
+        received += raw.receiveMessage();
+    }
+    EXPECT_EQ(received, std::string(3000, 'r'));
+    ::close(rawPeer);
+    EXPECT_THROW(raw.receiveMessage(), std::runtime_error);
+}
+
+TEST(CommsTests, TimeoutFramingWaitsOnDescriptorsAboveFdSetSize) {
+    rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    if (limit.rlim_max < FD_SETSIZE + 64) {
+        GTEST_SKIP() << "descriptor limit too low";
+    }
+    rlimit raised = limit;
+    raised.rlim_cur = FD_SETSIZE + 64;
+    setrlimit(RLIMIT_NOFILE, &raised);
+
+    // Occupy the low descriptors so the client socket lands above FD_SETSIZE
+    std::vector<int> filler;
+    int fd;
+    while ((fd = ::open("/dev/null", O_RDONLY)) >= 0 && fd < FD_SETSIZE) filler.push_back(fd);
+    if (fd >= 0) ::close(fd);
+
+    {
+        LoopbackListener listener;
+        Comms timed(SocketBackend::BSD, FramingStrategy::Timeout);
+        timed.connectToServer("127.0.0.1", listener.port());
+        int peer = listener.accept();
+        sendAll(peer, "hi");
+        EXPECT_EQ(timed.receiveMessage(), "hi");
+        ::close(peer);
+    }
+
+    for (int f : filler) ::close(f);
+    setrlimit(RLIMIT_NOFILE, &limit);
+}
+
+TEST(CommsTests, ReconnectingClosesThePreviousSocket) {
+    auto openDescriptors = [] {
+        return std::distance(std::filesystem::directory_iterator("/proc/self/fd"), {});
+    };
+    LoopbackListener listener;
+    Comms comms(SocketBackend::BSD, FramingStrategy::CRLF);
+    comms.connectToServer("127.0.0.1", listener.port());
+    int first = listener.accept();
+    auto connected = openDescriptors();
+
+    comms.connectToServer("127.0.0.1", listener.port());
+    int second = listener.accept();
+    ::close(first);
+    EXPECT_EQ(openDescriptors(), connected);
+
+    sendAll(second, "ok\r\n");
+    EXPECT_EQ(comms.receiveMessage(), "ok");
+    ::close(second);
+}
+
+TEST(CommsTests, SendMessageGathersFramingAndPayloadInOneCall) {
+    LoopbackListener listener;
+    Comms prefixed(SocketBackend::BSD, FramingStrategy::LengthPrefix);
+    prefixed.connectToServer("127.0.0.1", listener.port());
+    int prefixedPeer = listener.accept();
+    Comms lines(SocketBackend::BSD, FramingStrategy::CRLF);
+    lines.connectToServer("127.0.0.1", listener.port());
+    int linesPeer = listener.accept();
+
+    prefixed.sendMessage("payload");
+    prefixed.sendMessage("");
+    lines.sendMessage("$GPGGA,1*00");
+    EXPECT_EQ(receiveExactly(prefixedPeer, 15), lengthPrefixed("payload") + lengthPrefixed(""));
+    EXPECT_EQ(receiveExactly(linesPeer, 13), "$GPGGA,1*00\r\n");
+    EXPECT_EQ(prefixed.getStats().sendCalls, 2u);
+    EXPECT_EQ(lines.getStats().sendCalls, 1u);
+    ::close(prefixedPeer);
+    ::close(linesPeer);
+}
+
+TEST(CommsTests, SendMessagesBatchesFramesIntoFewSyscalls) {
+    LoopbackListener listener;
+    Comms comms(SocketBackend::BSD, FramingStrategy::LengthPrefix);
+    comms.connectToServer("127.0.0.1", listener.port());
+    int peer = listener.accept();
+
+    std::vector<std::string> messages;
+    std::string expected;
+    for (int i = 0; i < 100; ++i) {
+        messages.push_back("msg" + std::to_string(i));
+        expected += lengthPrefixed(messages.back());
+    }
+    comms.sendMessages(messages);
+    EXPECT_EQ(receiveExactly(peer, expected.size()), expected);
+    EXPECT_EQ(comms.getStats().sendCalls, 1u);
+
+    // Two buffers per message: 600 messages need two calls of at most kMaxSendVectors
+    std::vector<std::string> many(600, "x");
+    comms.sendMessages(many);
+    EXPECT_EQ(receiveExactly(peer, 600 * 5).size(), 3000u);
+    EXPECT_EQ(comms.getStats().sendCalls, 3u);
+    EXPECT_EQ(comms.getStats().messagesSent, 700u);
+    ::close(peer);
+}
+
+TEST(CommsTests, CoalescingFlushesOnCountAndBeforeReceive) {
+    LoopbackListener listener;
+    Comms comms(SocketBackend::BSD, FramingStrategy::CRLF);
+    comms.connectToServer("127.0.0.1", listener.port());
+    int peer = listener.accept();
+    comms.setCoalescing(4, std::chrono::seconds(10));
+
+    for (int i = 0; i < 3; ++i) comms.sendMessage("AB");
+    EXPECT_FALSE(peerHasData(peer, 20));
+    EXPECT_EQ(comms.getQueuedMessages(), 3u);
+    comms.sendMessage("CD");
+    EXPECT_EQ(receiveExactly(peer, 16), "AB\r\nAB\r\nAB\r\nCD\r\n");
+    EXPECT_EQ(comms.getStats().sendCalls, 1u);
+
+    // A request still in the queue is flushed before waiting for its reply
+    comms.sendMessage("REQ");
+    std::thread responder([peer] {
+        if (receiveExactly(peer, 5) == "REQ\r\n") sendAll(peer, "RSP\r\n");
+    });
+    EXPECT_EQ(comms.receiveMessage(), "RSP");
+    responder.join();
+    ::close(peer);
+}
+
+TEST(CommsTests, CoalescingFlushesAfterDelay) {
+    LoopbackListener listener;
+    Comms comms(SocketBackend::BSD, FramingStrategy::CRLF);
+    comms.connectToServer("127.0.0.1", listener.port());
+    int peer = listener.accept();
+    comms.setCoalescing(100, std::chrono::milliseconds(5));
+
+    comms.sendMessage("one");
+    comms.flushIfDue(); // Too early
+    EXPECT_EQ(comms.getQueuedMessages(), 1u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    comms.flushIfDue();
+    EXPECT_EQ(comms.getQueuedMessages(), 0u);
+    EXPECT_EQ(receiveExactly(peer, 5), "one\r\n");
+
+    // A send that finds the queue overdue flushes it along with the new message
+    comms.sendMessage("two");
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    comms.sendMessage("three");
+    EXPECT_EQ(receiveExactly(peer, 12), "two\r\nthree\r\n");
+    ::close(peer);
+}
+
+TEST(CommsTests, BasicCommsWithEncodingCodecs) {
+    LoopbackListener listener;
+    BasicComms<CobsCodec> cobs;
+    cobs.connectToServer("127.0.0.1", listener.port());
+    int cobsPeer = listener.accept();
+    BasicComms<SlipCodec> slip;
+    slip.connectToServer("127.0.0.1", listener.port());
+    int slipPeer = listener.accept();
+
+    std::string binary("a\0b\xC0\xDB", 5);
+    cobs.sendMessage(binary);
+    slip.sendMessage(binary);
+    std::string cobsFrame = receiveExactly(cobsPeer, 7);
+    std::string slipFrame = receiveExactly(slipPeer, 9);
+    EXPECT_EQ(cobsFrame, std::string("\x02" "a\x04" "b\xC0\xDB\0", 7));
+
+    // Echo both frames back twice in one segment
+    sendAll(cobsPeer, cobsFrame + cobsFrame);
+    sendAll(slipPeer, slipFrame + slipFrame);
+    EXPECT_EQ(cobs.receiveMessage(), binary);
+    EXPECT_EQ(cobs.receiveMessage(), binary);
+    EXPECT_EQ(slip.receiveMessage(), binary);
+    EXPECT_EQ(slip.receiveMessage(), binary);
+    EXPECT_EQ(cobs.getStats().recvCalls, 1u);
+
+    std::vector<std::string> batch = {"x", std::string(1, '\0'), "yz"};
+    cobs.sendMessages(batch);
+    EXPECT_EQ(receiveExactly(cobsPeer, 10), std::string("\x02x\0\x01\x01\0\x03yz\0", 10));
+    EXPECT_EQ(cobs.getStats().sendCalls, 2u);
+    ::close(cobsPeer);
+    ::close(slipPeer);
+}
+
+TEST(CommsTests, TypeErasedCommsAcceptsAnyCodec) {
+    LoopbackListener listener;
+    Comms comms(SocketBackend::BSD, VarintLengthCodec());
+    comms.connectToServer("127.0.0.1", listener.port());
+    int peer = listener.accept();
+
+    std::string big(200, 'v');
+    comms.sendMessage(big);
+    std::string frame = receiveExactly(peer, 202);
+    EXPECT_EQ(frame.substr(0, 2), "\xC8\x01");
+
+    comms.setCoalescing(2, std::chrono::seconds(10));
+    comms.sendMessage("a");
+    EXPECT_EQ(comms.getQueuedMessages(), 1u);
+    comms.sendMessage("bc");
+    EXPECT_EQ(receiveExactly(peer, 5), "\x01" "a\x02" "bc");
+
+    sendAll(peer, frame);
+    EXPECT_EQ(comms.receiveMessage(), big);
+    ::close(peer);
+    EXPECT_THROW(comms.receiveMessage(), std::runtime_error);
+}
+
+TEST(CommsTests, OversizedLengthPrefixThrowsBeforeBuffering) {
+    LoopbackListener listener;
+    Comms comms(SocketBackend::BSD, FramingStrategy::LengthPrefix, 64, 1024);
+    comms.connectToServer("127.0.0.1", listener.port());
+    int peer = listener.accept();
+
+    // Only the header arrives; the codec must not wait for four gigabytes
+    sendAll(peer, std::string("\xFF\xFF\xFF\xF0", 4));
+    EXPECT_THROW(comms.receiveMessage(), FrameTooLargeError);
+    ::close(peer);
+}
+
+TEST(CommsTests, ReceivePooledReusesBuffers) {
+    LoopbackListener listener;
+    Comms comms(SocketBackend::BSD, FramingStrategy::LengthPrefix);
+    comms.connectToServer("127.0.0.1", listener.port());
+    int peer = listener.accept();
+
+    std::string stream;
+    for (int i = 0; i < 100; ++i) stream += lengthPrefixed("message " + std::to_string(i));
+    sendAll(peer, stream);
+    for (int i = 0; i < 100; ++i) {
+        PooledMessage message = comms.receivePooled();
+        EXPECT_EQ(message.view(), "message " + std::to_string(i));
+    }
+    EXPECT_EQ(comms.getMessagePool().getStats().acquired, 100u);
+    EXPECT_EQ(comms.getMessagePool().getStats().allocated, 1u);
+
+    // A handle keeps the pool alive past its Comms
+    PooledMessage kept;
+    {
+        Comms shortLived(SocketBackend::BSD, FramingStrategy::CRLF);
+        LoopbackListener other;
+        shortLived.connectToServer("127.0.0.1", other.port());
+        int otherPeer = other.accept();
+        sendAll(otherPeer, "kept\r\n");
+        kept = shortLived.receivePooled();
+        ::close(otherPeer);
+    }
+    EXPECT_EQ(kept.view(), "kept");
+    kept.release();
+    ::close(peer);
+}
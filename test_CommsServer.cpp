@@ -0,0 +1,211 @@
+#include "CommsServer.hpp"
+#include "TestSupport.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+
+using ConnectionId = CommsReactor::ConnectionId;
+
+int connectTo(unsigned short port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+std::string receiveExactly(int fd, size_t n, int timeoutMs = 1000) {
+    std::string data;
+    char buffer[4096];
+    while (data.size() < n) {
+        pollfd pfd {fd, POLLIN, 0};
+        if (::poll(&pfd, 1, timeoutMs) != 1) break;
+        ssize_t received = ::recv(fd, buffer, std::min(sizeof(buffer), n - data.size()), 0);
+        if (received <= 0) break;
+        data.append(buffer, static_cast<size_t>(received));
+    }
+    return data;
+}
+
+// Polls the reactor until done() or two seconds pass
+bool pollUntil(CommsReactor& reactor, const std::function<bool()>& done) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        reactor.poll(5);
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(CommsServerTests, EchoesFramesPerConnection) {
+    CommsServer<CrlfCodec> server;
+    CommsReactor::Handlers handlers;
+    handlers.onMessage = [&](ConnectionId id, std::string& line) { server.send(id, "echo " + line); };
+    server.setHandlers(handlers);
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+
+    std::vector<int> clients;
+    for (int i = 0; i < 20; ++i) clients.push_back(connectTo(server.getPort()));
+    ASSERT_TRUE(pollUntil(server, [&] { return server.getConnectionCount() == 20; }));
+
+    // Each client's line arrives split in two, interleaved with the others
+    for (size_t i = 0; i < clients.size(); ++i) sendAll(clients[i], "line" + std::to_string(i) + "-");
+    server.poll(10);
+    for (size_t i = 0; i < clients.size(); ++i) sendAll(clients[i], "end\r\n");
+    ASSERT_TRUE(pollUntil(server, [&] { return server.getStats().messagesReceived == 20; }));
+    server.flush();
+
+    for (size_t i = 0; i < clients.size(); ++i) {
+        std::string expected = "echo line" + std::to_string(i) + "-end\r\n";
+        EXPECT_EQ(receiveExactly(clients[i], expected.size()), expected);
+        ::close(clients[i]);
+    }
+    EXPECT_TRUE(pollUntil(server, [&] { return server.getConnectionCount() == 0; }));
+    EXPECT_EQ(server.getStats().closed, 20u);
+}
+
+TEST(CommsServerTests, ChattyPeerCannotStarveOthers) {
+    CommsReactor::Options options;
+    options.maxFramesPerTurn = 8;
+    CommsServer<CrlfCodec> server(options);
+    std::vector<std::string> order;
+    CommsReactor::Handlers handlers;
+    handlers.onMessage = [&](ConnectionId, std::string& line) { order.push_back(line); };
+    server.setHandlers(handlers);
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+
+    int chatty = connectTo(server.getPort());
+    int quiet = connectTo(server.getPort());
+    ASSERT_TRUE(pollUntil(server, [&] { return server.getConnectionCount() == 2; }));
+
+    std::string burst;
+    for (int i = 0; i < 2000; ++i) burst += "c\r\n";
+    sendAll(chatty, burst);
+    sendAll(quiet, "quiet\r\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    ASSERT_TRUE(pollUntil(server, [&] { return order.size() == 2001; }));
+    size_t quietPosition = std::find(order.begin(), order.end(), "quiet") - order.begin();
+    EXPECT_LE(quietPosition, 16u); // Within the chatty peer's first two turns
+    EXPECT_GT(server.getStats().deferredTurns, 0u);
+    ::close(chatty);
+    ::close(quiet);
+}
+
+TEST(CommsServerTests, ClientPoolTalksToServer) {
+    CommsServer<LengthPrefixCodec> server;
+    CommsReactor::Handlers serverHandlers;
+    serverHandlers.onMessage = [&](ConnectionId id, std::string& request) { server.send(id, request + "!"); };
+    server.setHandlers(serverHandlers);
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+
+    CommsClientPool<LengthPrefixCodec> pool;
+    std::map<ConnectionId, std::string> replies;
+    size_t opened = 0;
+    CommsReactor::Handlers poolHandlers;
+    poolHandlers.onMessage = [&](ConnectionId id, std::string& reply) { replies[id] = std::move(reply); };
+    poolHandlers.onOpen = [&](ConnectionId) { ++opened; };
+    pool.setHandlers(poolHandlers);
+
+    std::vector<ConnectionId> ids;
+    for (int i = 0; i < 100; ++i) {
+        ids.push_back(pool.connect("127.0.0.1", std::to_string(server.getPort())));
+        pool.send(ids.back(), "req" + std::to_string(i)); // Queued until the connect completes
+    }
+    ASSERT_TRUE(pollUntil(pool, [&] {
+        server.poll(0);
+        return replies.size() == ids.size();
+    }));
+    for (size_t i = 0; i < ids.size(); ++i) EXPECT_EQ(replies[ids[i]], "req" + std::to_string(i) + "!");
+    EXPECT_EQ(opened, 100u);
+    EXPECT_EQ(pool.getStats().connected, 100u);
+}
+
+TEST(CommsServerTests, FailedConnectReportsClose) {
+    unsigned short unusedPort;
+    {
+        CommsServer<CrlfCodec> probe;
+        ASSERT_TRUE(probe.listen("0", "127.0.0.1"));
+        unusedPort = probe.getPort();
+    }
+    CommsClientPool<CrlfCodec> pool;
+    std::vector<CommsReactor::CloseReason> reasons;
+    CommsReactor::Handlers handlers;
+    handlers.onClose = [&](ConnectionId, CommsReactor::CloseReason reason) { reasons.push_back(reason); };
+    pool.setHandlers(handlers);
+    ConnectionId id = pool.connect("127.0.0.1", std::to_string(unusedPort));
+    EXPECT_TRUE(pool.isOpen(id));
+    ASSERT_TRUE(pollUntil(pool, [&] { return !reasons.empty(); }));
+    EXPECT_EQ(reasons[0], CommsReactor::CloseReason::ConnectFailed);
+    EXPECT_FALSE(pool.isOpen(id));
+}
+
+TEST(CommsServerTests, TimeoutFramingUsesIdleDeadline) {
+    CommsServer<TimeoutCodec> server;
+    std::vector<std::string> messages;
+    CommsReactor::Handlers handlers;
+    handlers.onMessage = [&](ConnectionId, std::string& data) { messages.push_back(data); };
+    server.setHandlers(handlers);
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+    int client = connectTo(server.getPort());
+
+    sendAll(client, "ab");
+    for (int i = 0; i < 3; ++i) server.poll(5);
+    sendAll(client, "cd");
+    ASSERT_TRUE(pollUntil(server, [&] { return !messages.empty(); }));
+    EXPECT_EQ(messages[0], "abcd");
+    ::close(client);
+}
+
+TEST(CommsServerTests, PerConnectionHandlersAndCloseReasons) {
+    CommsReactor::Options options;
+    options.maxQueuedBytes = 1000;
+    CommsServer<VarintLengthCodec> server(options);
+    std::map<ConnectionId, CommsReactor::CloseReason> closed;
+    std::vector<ConnectionId> opened;
+    std::string special;
+    CommsReactor::Handlers handlers;
+    handlers.onOpen = [&](ConnectionId id) { opened.push_back(id); };
+    handlers.onClose = [&](ConnectionId id, CommsReactor::CloseReason reason) { closed[id] = reason; };
+    server.setHandlers(handlers);
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+
+    int invalid = connectTo(server.getPort());
+    int flooded = connectTo(server.getPort());
+    ASSERT_TRUE(pollUntil(server, [&] { return opened.size() == 2; }));
+    CommsReactor::Handlers flooding;
+    flooding.onMessage = [&](ConnectionId id, std::string& data) {
+        special = data;
+        server.send(id, std::string(2000, 'x')); // Over maxQueuedBytes
+    };
+    flooding.onClose = handlers.onClose;
+    server.setHandlers(opened[1], flooding);
+
+    sendAll(invalid, std::string(6, '\x80'));
+    sendAll(flooded, std::string("\x02hi", 3));
+    ASSERT_TRUE(pollUntil(server, [&] { return closed.size() == 2; }));
+    EXPECT_EQ(special, "hi");
+    EXPECT_EQ(closed[opened[0]], CommsReactor::CloseReason::InvalidFrame);
+    EXPECT_EQ(closed[opened[1]], CommsReactor::CloseReason::Backlog);
+    ::close(invalid);
+    ::close(flooded);
+}
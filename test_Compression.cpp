@@ -0,0 +1,213 @@
+#include "Compression.hpp"
+#include "Comms.hpp"
+#include "CommsServer.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using ConnectionId = CommsReactor::ConnectionId;
+
+// NMEA sentences with changing time and position, as a receiver emits them
+std::vector<std::string> makeSentences(size_t count) {
+    std::vector<std::string> sentences;
+    std::mt19937 random(7);
+    for (size_t i = 0; i < count; ++i) {
+        std::string time = std::to_string(120000 + i);
+        std::string lat = "4807." + std::to_string(100 + random() % 900);
+        std::string lon = "01131." + std::to_string(100 + random() % 900);
+        if (i % 2 == 0) {
+            sentences.push_back("$GPGGA," + time + "," + lat + ",N," + lon + ",E,1,08,0.9,545.4,M,46.9,M,,*47");
+        } else {
+            sentences.push_back("$GPRMC," + time + ",A," + lat + ",N," + lon + ",E,022.4,084.4,230394,003.1,W*6A");
+        }
+    }
+    return sentences;
+}
+
+std::string roundTrip(const std::string& input, const CompressionDictionary* dictionary = nullptr) {
+    std::string block;
+    LzBlock::compress(input, block, dictionary);
+    EXPECT_LE(block.size(), LzBlock::maxCompressedSize(input.size()));
+    std::string output;
+    LzBlock::decompress(std::span<const char>(block.data(), block.size()), input.size(), output, dictionary);
+    return output;
+}
+
+template <class Codec>
+std::vector<std::string> decodeAll(Codec& codec, const std::string& wire) {
+    // Fed one byte more at a time, as if every byte arrived in its own segment
+    std::vector<std::string> messages;
+    std::string message;
+    size_t start = 0;
+    for (size_t end = start; end <= wire.size(); ++end) {
+        while (size_t frameBytes = codec.decode(std::span<const char>(wire.data() + start, end - start), message)) {
+            messages.push_back(message);
+            while (codec.takePending(message)) messages.push_back(message);
+            start += frameBytes;
+        }
+    }
+    return messages;
+}
+
+} // namespace
+
+TEST(CompressionTests, LzBlockRoundTrips) {
+    std::mt19937 random(1);
+    std::string noise(5000, '\0');
+    for (char& c : noise) c = static_cast<char>(random());
+    std::string runs = std::string(1000, 'a') + "xyz" + std::string(300, 'b');
+    std::string text;
+    for (int i = 0; i < 200; ++i) text += "$GPGGA,1235" + std::to_string(i) + ",4807.038,N,01131.000,E*47\r\n";
+
+    for (const std::string& input : {std::string(), std::string("short"), std::string(13, 'q'), noise, runs, text}) {
+        EXPECT_EQ(roundTrip(input), input);
+    }
+    std::string block;
+    EXPECT_LT(LzBlock::compress(text, block), text.size() / 4);
+    block.clear();
+    EXPECT_LT(LzBlock::compress(runs, block), 30u);
+}
+
+TEST(CompressionTests, DictionaryShrinksSingleSentences) {
+    std::vector<std::string> sentences = makeSentences(2000);
+    CompressionDictionary dictionary =
+        CompressionDictionary::train(std::span<const std::string>(sentences.data(), 1000), 4096);
+    EXPECT_LE(dictionary.getContent().size(), 4096u);
+    EXPECT_FALSE(dictionary.getContent().empty());
+
+    size_t plain = 0;
+    size_t withDictionary = 0;
+    for (size_t i = 1000; i < sentences.size(); ++i) {
+        std::string block;
+        plain += LzBlock::compress(sentences[i], block);
+        block.clear();
+        withDictionary += LzBlock::compress(sentences[i], block, &dictionary);
+        EXPECT_EQ(roundTrip(sentences[i], &dictionary), sentences[i]);
+    }
+    EXPECT_LT(withDictionary * 2, plain);
+
+    // Without the dictionary its references cannot be resolved
+    std::string block;
+    LzBlock::compress(sentences[1500], block, &dictionary);
+    std::string output;
+    EXPECT_THROW(LzBlock::decompress(std::span<const char>(block.data(), block.size()), sentences[1500].size(), output),
+                 std::runtime_error);
+}
+
+TEST(CompressionTests, CorruptBlocksThrow) {
+    std::string output;
+    auto decompress = [&](const std::string& block, size_t rawSize) {
+        LzBlock::decompress(std::span<const char>(block.data(), block.size()), rawSize, output);
+    };
+    EXPECT_THROW(decompress(std::string("\x40" "ab", 3), 4), std::runtime_error);           // Literals run past the end
+    EXPECT_THROW(decompress(std::string("\x10" "a\x00\x00\x00", 5), 5), std::runtime_error); // Offset 0
+    EXPECT_THROW(decompress(std::string("\x10" "a\x05\x00\x00", 5), 5), std::runtime_error); // Before the output
+    EXPECT_THROW(decompress(std::string("\x30" "abc", 4), 5), std::runtime_error);           // Short of rawSize
+    EXPECT_THROW(decompress(std::string(), 0), std::runtime_error);
+    decompress(std::string("\x10" "a\x01\x00\x00", 5), 5);                                   // Overlapping match
+    EXPECT_EQ(output, "aaaaa");
+}
+
+TEST(CompressionTests, CodecBatchesAndFallsBackToStored) {
+    std::vector<std::string> sentences = makeSentences(100);
+    auto dictionary = std::make_shared<const CompressionDictionary>(CompressionDictionary::train(sentences));
+    CompressingCodec<> sender(dictionary);
+    CompressingCodec<> receiver(dictionary);
+
+    std::string wire;
+    sender.encode(sentences[0], wire);
+    sender.encodeBatch(sentences, wire);
+    std::string noise(200, '\0');
+    std::mt19937 random(3);
+    for (char& c : noise) c = static_cast<char>(random());
+    sender.encode(noise, wire);
+    sender.encode("", wire);
+
+    std::vector<std::string> expected = {sentences[0]};
+    expected.insert(expected.end(), sentences.begin(), sentences.end());
+    expected.push_back(noise);
+    expected.push_back("");
+    EXPECT_EQ(decodeAll(receiver, wire), expected);
+
+    const FrameCompressor::Stats& stats = sender.getCompressor().getStats();
+    EXPECT_EQ(stats.framesPacked, 4u);
+    EXPECT_EQ(stats.framesCompressed, 2u); // Not the noise, nor the empty message
+    EXPECT_LT(stats.bodyBytes * 3, stats.contentBytes);
+
+    // A frame compressed with a dictionary the receiver lacks is rejected
+    CompressingCodec<> withoutDictionary;
+    std::string message;
+    std::string frame;
+    sender.encode(sentences[1], frame);
+    EXPECT_THROW(withoutDictionary.decode(std::span<const char>(frame.data(), frame.size()), message),
+                 std::runtime_error);
+}
+
+TEST(CompressionTests, CodecLimitsDecompressedSize) {
+    FrameCompressor::Options options;
+    options.maxContentSize = 1000;
+    CompressingCodec<VarintLengthCodec> codec(nullptr, options);
+    std::string wire;
+    codec.encode(std::string(1001, 'z'), wire);
+    EXPECT_LT(wire.size(), 30u);
+    std::string message;
+    EXPECT_THROW(codec.decode(std::span<const char>(wire.data(), wire.size()), message), FrameTooLargeError);
+}
+
+TEST(CompressionTests, CommsBatchReachesServerAsSeparateMessages) {
+    std::vector<std::string> sentences = makeSentences(500);
+    auto dictionary = std::make_shared<const CompressionDictionary>(CompressionDictionary::train(sentences));
+
+    CommsReactor::Options options;
+    CommsServer<CompressingCodec<>> server(options, CompressingCodec<>(dictionary));
+    std::vector<std::string> received;
+    CommsReactor::Handlers handlers;
+    handlers.onMessage = [&](ConnectionId id, std::string& message) {
+        received.push_back(message);
+        if (received.size() == sentences.size()) server.send(id, "done");
+    };
+    server.setHandlers(handlers);
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+
+    Comms comms(SocketBackend::BSD, CompressingCodec<>(dictionary));
+    comms.connectToServer("127.0.0.1", server.getPort());
+    comms.sendMessages(sentences);
+    EXPECT_EQ(comms.getStats().sendCalls, 1u);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (received.size() < sentences.size() && std::chrono::steady_clock::now() < deadline) server.poll(5);
+    server.flush();
+    EXPECT_EQ(received, sentences);
+    EXPECT_EQ(server.getStats().messagesReceived, sentences.size());
+    EXPECT_EQ(comms.receiveMessage(), "done");
+}
+
+TEST(CompressionTests, RejectedFrameIsSkippedByComms) {
+    std::vector<std::string> sentences = makeSentences(500);
+    auto dictionary = std::make_shared<const CompressionDictionary>(CompressionDictionary::train(sentences));
+
+    CommsReactor::Options options;
+    CommsServer<CompressingCodec<>> server(options, CompressingCodec<>(dictionary));
+    CommsReactor::Handlers handlers;
+    handlers.onOpen = [&](ConnectionId id) {
+        server.send(id, sentences[1]); // Compressed with a dictionary the client lacks
+        server.send(id, "ok");         // Too short to compress: stored
+    };
+    server.setHandlers(handlers);
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+
+    Comms comms(SocketBackend::BSD, CompressingCodec<>());
+    comms.connectToServer("127.0.0.1", server.getPort());
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (server.getConnectionCount() == 0 && std::chrono::steady_clock::now() < deadline) server.poll(5);
+    server.flush();
+
+    EXPECT_THROW(comms.receiveMessage(), std::runtime_error);
+    EXPECT_EQ(comms.receiveMessage(), "ok"); // The connection survives the bad frame
+}
@@ -0,0 +1,258 @@
+#include "ConnectionManager.hpp"
+#include "TcpConnector.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+long long elapsedMs(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+}
+
+int listenOnLoopback(int backlog, unsigned short& port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    listen(fd, backlog);
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+
+// Loopback listener that accepts connections into its backlog
+class Listener {
+public:
+    explicit Listener(int backlog = 512) { _fd = listenOnLoopback(backlog, _port); }
+    ~Listener() { ::close(_fd); }
+    std::string port() const { return std::to_string(_port); }
+    int accept() { return ::accept(_fd, nullptr, nullptr); }
+
+private:
+    int _fd;
+    unsigned short _port;
+};
+
+// Listener whose accept queue is full: the kernel drops further SYNs, so connects to it
+// hang exactly like connects to an unreachable host
+class Blackhole {
+public:
+    Blackhole() {
+        _fd = listenOnLoopback(0, _port);
+        _filler = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(_port);
+        ::connect(_filler, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        pollfd pfd {_filler, POLLOUT, 0};
+        ::poll(&pfd, 1, 1000);
+    }
+    ~Blackhole() {
+        ::close(_filler);
+        ::close(_fd);
+    }
+    std::string port() const { return std::to_string(_port); }
+
+private:
+    int _fd;
+    int _filler;
+    unsigned short _port;
+};
+
+// A port nothing listens on: connects are refused at once
+std::string refusedPort() {
+    unsigned short port;
+    int fd = listenOnLoopback(1, port);
+    ::close(fd);
+    return std::to_string(port);
+}
+
+std::vector<TcpConnector::Address> addresses(const std::vector<std::string>& ports) {
+    std::vector<TcpConnector::Address> result;
+    for (const std::string& port : ports) {
+        std::vector<TcpConnector::Address> resolved = TcpConnector::resolve("127.0.0.1", port);
+        result.insert(result.end(), resolved.begin(), resolved.end());
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(TcpConnectorTests, RacesPastBlackholedAddress) {
+    Blackhole blackhole;
+    Listener listener;
+    NetworkComms::ConnectOptions options;
+    options.attemptDelayMs = 50;
+    options.attemptTimeoutMs = 5000;
+
+    TcpConnector connector(options);
+    auto start = Clock::now();
+    ASSERT_TRUE(connector.start(addresses({blackhole.port(), listener.port()})));
+    while (connector.wait(1000) == TcpConnector::State::Connecting) {
+    }
+
+    ASSERT_EQ(connector.getState(), TcpConnector::State::Connected);
+    EXPECT_EQ(connector.getAttemptCount(), 2u);
+    EXPECT_LT(elapsedMs(start), 1000); // Not the blackhole's 5 s deadline, let alone the SYN timeout
+    int fd = connector.takeSocket();
+    ASSERT_GE(fd, 0);
+    EXPECT_EQ(connector.takeSocket(), -1);
+    ::close(fd);
+}
+
+TEST(TcpConnectorTests, RefusedAddressStartsNextAttemptAtOnce) {
+    Listener listener;
+    NetworkComms::ConnectOptions options;
+    options.attemptDelayMs = 5000; // Only a failure may start the second attempt early
+
+    TcpConnector connector(options);
+    auto start = Clock::now();
+    connector.start(addresses({refusedPort(), listener.port()}));
+    while (connector.wait(1000) == TcpConnector::State::Connecting) {
+    }
+
+    EXPECT_EQ(connector.getState(), TcpConnector::State::Connected);
+    EXPECT_LT(elapsedMs(start), 1000);
+}
+
+TEST(TcpConnectorTests, AttemptsExpireAtTheirDeadline) {
+    Blackhole blackhole;
+    NetworkComms::ConnectOptions options;
+    options.attemptTimeoutMs = 100;
+
+    TcpConnector connector(options);
+    auto start = Clock::now();
+    connector.start(addresses({blackhole.port()}));
+    while (connector.wait(1000) == TcpConnector::State::Connecting) {
+    }
+
+    EXPECT_EQ(connector.getState(), TcpConnector::State::Failed);
+    EXPECT_EQ(connector.getLastError(), ETIMEDOUT);
+    EXPECT_GE(elapsedMs(start), 100);
+    EXPECT_LT(elapsedMs(start), 1000);
+}
+
+TEST(TcpConnectorTests, NetworkCommsConnectUsesRacedSocket) {
+    Listener listener;
+    NetworkComms comms;
+    NetworkComms::ConnectOptions options;
+    options.attemptTimeoutMs = 500;
+    ASSERT_TRUE(comms.connect("127.0.0.1", listener.port(), options));
+
+    int server = listener.accept();
+    const char sentence[] = "$GPGGA,1*00\r\n";
+    ASSERT_EQ(::send(server, sentence, sizeof(sentence) - 1, 0), static_cast<ssize_t>(sizeof(sentence) - 1));
+    EXPECT_EQ(comms.readBytes(sizeof(sentence) - 1, 1000), std::string(sentence));
+    ::close(server);
+
+    NetworkComms unreachable;
+    EXPECT_FALSE(unreachable.connect("127.0.0.1", refusedPort(), options));
+    EXPECT_FALSE(unreachable.isOpen());
+}
+
+TEST(ConnectionManagerTests, BringsUpManyFeedsConcurrently) {
+    Listener listener;
+    Blackhole blackhole;
+    ConnectionManager::Options options;
+    options.connect.attemptDelayMs = 50;
+    ConnectionManager manager(options);
+    const size_t feedCount = 200;
+    for (size_t i = 0; i < feedCount; ++i) {
+        // Every other feed lists the unreachable endpoint first
+        if (i % 2 == 0) {
+            manager.add("127.0.0.1", listener.port());
+        } else {
+            manager.add({{"127.0.0.1", blackhole.port()}, {"127.0.0.1", listener.port()}});
+        }
+    }
+
+    auto start = Clock::now();
+    while (manager.getConnectedCount() < feedCount && elapsedMs(start) < 5000) {
+        manager.poll(10);
+    }
+
+    EXPECT_EQ(manager.getConnectedCount(), feedCount);
+    EXPECT_LT(elapsedMs(start), 2000);
+    EXPECT_EQ(manager.getStats().connects, feedCount);
+    EXPECT_EQ(manager.getStats().failures, 0u);
+    for (size_t id = 0; id < feedCount; ++id) {
+        EXPECT_TRUE(manager.getComms(id).isOpen());
+    }
+}
+
+TEST(ConnectionManagerTests, ReconnectsAfterPeerClose) {
+    Listener listener;
+    ConnectionManager::Options options;
+    options.initialBackoffMs = 20;
+    ConnectionManager manager(options);
+    auto feed = manager.add("127.0.0.1", listener.port());
+
+    auto start = Clock::now();
+    while (!manager.isConnected(feed) && elapsedMs(start) < 2000) {
+        manager.poll(10);
+    }
+    ASSERT_TRUE(manager.isConnected(feed));
+
+    // The reader notices the close; the manager then backs off and reconnects
+    ::close(listener.accept());
+    std::byte buffer[64];
+    while (manager.getComms(feed).isOpen() && elapsedMs(start) < 2000) {
+        manager.getComms(feed).readInto(buffer, 10);
+    }
+    manager.poll(0);
+    EXPECT_EQ(manager.getState(feed), ConnectionManager::FeedState::Waiting);
+
+    while (!manager.isConnected(feed) && elapsedMs(start) < 4000) {
+        manager.poll(10);
+    }
+    EXPECT_TRUE(manager.isConnected(feed));
+    EXPECT_EQ(manager.getStats().disconnects, 1u);
+    EXPECT_EQ(manager.getStats().connects, 2u);
+}
+
+TEST(ConnectionManagerTests, FailingFeedsBackOffWithJitter) {
+    ConnectionManager::Options options;
+    options.initialBackoffMs = 10;
+    options.maxBackoffMs = 80;
+    options.seed = 42;
+    ConnectionManager manager(options);
+    const size_t feedCount = 20;
+    std::string port = refusedPort();
+    for (size_t i = 0; i < feedCount; ++i) {
+        manager.add("127.0.0.1", port);
+    }
+
+    auto start = Clock::now();
+    while (elapsedMs(start) < 400) {
+        manager.poll(5);
+    }
+
+    // Backoff 10, 20, 40, 80, 80, ... ms (each jittered down by up to half): 400 ms allows
+    // at most ~13 attempts per feed, far below one per poll
+    const ConnectionManager::Stats& stats = manager.getStats();
+    EXPECT_EQ(stats.connects, 0u);
+    EXPECT_EQ(stats.failures, stats.connectAttempts);
+    EXPECT_GE(stats.connectAttempts, feedCount * 4);
+    EXPECT_LE(stats.connectAttempts, feedCount * 14);
+
+    // Jitter spreads the retries: the feeds do not all sit at the same failure count
+    unsigned int lowest = manager.getFailureCount(0), highest = lowest;
+    for (size_t id = 1; id < feedCount; ++id) {
+        lowest = std::min(lowest, manager.getFailureCount(id));
+        highest = std::max(highest, manager.getFailureCount(id));
+    }
+    EXPECT_LT(lowest, highest);
+}
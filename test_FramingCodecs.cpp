@@ -0,0 +1,140 @@
+#include "FramingCodecs.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <class Codec>
+std::string encodeFrame(const Codec& codec, std::string_view payload) {
+    std::string frame;
+    if constexpr (GatherCodec<Codec>) {
+        char header[Codec::kMaxHeader + 1];
+        char trailer[Codec::kMaxTrailer + 1];
+        frame.append(header, codec.header(payload, header));
+        frame.append(payload);
+        frame.append(trailer, codec.trailer(payload, trailer));
+    } else {
+        codec.encode(payload, frame);
+    }
+    return frame;
+}
+
+// Encodes every payload into one stream, then decodes it fed one byte at a time
+template <class Codec>
+std::vector<std::string> roundTrip(const std::vector<std::string>& payloads) {
+    Codec codec;
+    std::string wire;
+    for (const std::string& payload : payloads) wire += encodeFrame(codec, payload);
+
+    std::vector<std::string> decoded;
+    size_t start = 0;
+    for (size_t end = 1; end <= wire.size(); ++end) {
+        std::string message;
+        size_t consumed = codec.decode(std::span<const char>(wire.data() + start, end - start), message);
+        if (consumed > 0) {
+            decoded.push_back(message);
+            start += consumed;
+        }
+    }
+    EXPECT_EQ(start, wire.size());
+    return decoded;
+}
+
+std::string bytes(std::initializer_list<int> values) {
+    std::string out;
+    for (int value : values) out += static_cast<char>(value);
+    return out;
+}
+
+} // namespace
+
+static_assert(FramingCodec<CrlfCodec> && GatherCodec<CrlfCodec>);
+static_assert(FramingCodec<LengthPrefixCodec> && FramingCodec<TimeoutCodec> && FramingCodec<RawCodec>);
+static_assert(FramingCodec<SlipCodec> && EncodingCodec<SlipCodec> && !GatherCodec<SlipCodec>);
+static_assert(FramingCodec<CobsCodec> && FramingCodec<VarintLengthCodec> && FramingCodec<NulTerminatedCodec>);
+
+TEST(FramingCodecsTests, GatherCodecsRoundTripByteByByte) {
+    std::vector<std::string> payloads = {"$GPGGA,1*00", "", std::string(300, 'v'), "a\rb\nc"};
+    EXPECT_EQ(roundTrip<LengthPrefixCodec>(payloads), payloads);
+    EXPECT_EQ(roundTrip<VarintLengthCodec>(payloads), payloads);
+    EXPECT_EQ(roundTrip<CrlfCodec>(payloads), payloads);
+    EXPECT_EQ(roundTrip<NulTerminatedCodec>(payloads), payloads);
+}
+
+TEST(FramingCodecsTests, VarintHeaderLength) {
+    VarintLengthCodec codec;
+    char header[VarintLengthCodec::kMaxHeader];
+    EXPECT_EQ(codec.header(std::string(127, 'x'), header), 1u);
+    EXPECT_EQ(codec.header(std::string(128, 'x'), header), 2u);
+    EXPECT_EQ(header[0], static_cast<char>(0x80));
+    EXPECT_EQ(header[1], 0x01);
+    EXPECT_EQ(codec.header(std::string(20000, 'x'), header), 3u);
+
+    std::string message;
+    std::string overlong = bytes({0x80, 0x80, 0x80, 0x80, 0x80, 0x01});
+    EXPECT_THROW(codec.decode(std::span<const char>(overlong.data(), overlong.size()), message),
+                 std::runtime_error);
+}
+
+TEST(FramingCodecsTests, SlipEscapesEndAndEsc) {
+    SlipCodec codec;
+    std::string payload = bytes({'a', 0xC0, 'b', 0xDB, 0xDC});
+    EXPECT_EQ(encodeFrame(codec, payload), bytes({0xC0, 'a', 0xDB, 0xDC, 'b', 0xDB, 0xDD, 0xDC, 0xC0}));
+
+    std::vector<std::string> payloads = {payload, bytes({0xC0, 0xC0}), "plain"};
+    EXPECT_EQ(roundTrip<SlipCodec>(payloads), payloads);
+}
+
+TEST(FramingCodecsTests, CobsStuffsZerosAndLongRuns) {
+    CobsCodec codec;
+    EXPECT_EQ(encodeFrame(codec, ""), bytes({0x01, 0x00}));
+    EXPECT_EQ(encodeFrame(codec, bytes({0x00})), bytes({0x01, 0x01, 0x00}));
+    EXPECT_EQ(encodeFrame(codec, bytes({0x11, 0x00, 0x22})), bytes({0x02, 0x11, 0x02, 0x22, 0x00}));
+
+    // 254 non-zero bytes fill a block exactly; the next byte starts a new one
+    std::string run254(254, 'x');
+    std::string encoded = encodeFrame(codec, run254);
+    EXPECT_EQ(encoded.size(), 254u + 3u);
+    EXPECT_EQ(encoded[0], static_cast<char>(0xFF));
+
+    std::string mixed;
+    for (int i = 0; i < 1000; ++i) mixed += static_cast<char>(i % 7 == 0 ? 0 : i);
+    std::vector<std::string> payloads = {"", run254, std::string(255, 'y'), mixed, bytes({0, 0, 0})};
+    EXPECT_EQ(roundTrip<CobsCodec>(payloads), payloads);
+
+    std::string message;
+    std::string corrupt = bytes({0x05, 'a', 0x00});
+    EXPECT_THROW(codec.decode(std::span<const char>(corrupt.data(), corrupt.size()), message), std::runtime_error);
+}
+
+TEST(FramingCodecsTests, FinishReportsTruncatedFrames) {
+    std::string partial = "abc";
+    std::span<const char> input(partial.data(), partial.size());
+    EXPECT_EQ(CrlfCodec().finish(input), "abc");
+    EXPECT_EQ(TimeoutCodec().finish(input), "abc");
+    EXPECT_THROW(LengthPrefixCodec().finish(input), std::runtime_error);
+    EXPECT_THROW(RawCodec().finish({}), std::runtime_error);
+    EXPECT_THROW(CobsCodec().finish(input), std::runtime_error);
+}
+
+TEST(FramingCodecsTests, LengthCodecsRejectFramesOverMaximum) {
+    std::string message;
+    std::string lengthHeader = bytes({0xFF, 0xFF, 0xFF, 0xF0});
+    try {
+        LengthPrefixCodec(1024).decode(std::span<const char>(lengthHeader.data(), lengthHeader.size()), message);
+        FAIL() << "Expected FrameTooLargeError";
+    } catch (const FrameTooLargeError& error) {
+        EXPECT_EQ(error.frameSize, 0xFFFFFFF0u);
+        EXPECT_EQ(error.maxFrameSize, 1024u);
+    }
+
+    std::string varintHeader = bytes({0x81, 0x08}); // 1025
+    EXPECT_THROW(VarintLengthCodec(1024).decode(std::span<const char>(varintHeader.data(), varintHeader.size()), message),
+                 FrameTooLargeError);
+
+    // At the limit frames still decode
+    std::string exact = bytes({0x00, 0x00, 0x04, 0x00}) + std::string(1024, 'x');
+    EXPECT_EQ(LengthPrefixCodec(1024).decode(std::span<const char>(exact.data(), exact.size()), message), exact.size());
+    EXPECT_EQ(message.size(), 1024u);
+}
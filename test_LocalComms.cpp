@@ -0,0 +1,180 @@
+#include "LocalComms.hpp"
+#include "NMEAReader.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+std::string tempPath(const char* tag) {
+    return "/tmp/nmea_local_" + std::string(tag) + "_" + std::to_string(getpid());
+}
+
+std::string readFile(const std::string& path) {
+    std::string content;
+    FILE* file = fopen(path.c_str(), "rb");
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) content.append(buffer, n);
+    fclose(file);
+    return content;
+}
+
+TEST(LocalCommsTests, StreamSocketFeedsNMEAReader) {
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    LocalComms comms;
+    ASSERT_TRUE(comms.attach(fds[0], LocalComms::Type::Stream));
+    NMEAReader reader(comms, 100);
+
+    std::string sentence = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+    ASSERT_EQ(::write(fds[1], sentence.data(), sentence.size()), static_cast<ssize_t>(sentence.size()));
+    auto message = reader.readAndParseSentence();
+    ASSERT_TRUE(message.has_value());
+    EXPECT_EQ((*message)->getType(), NMEAMessage::MessageType::RMC);
+
+    ::close(fds[1]);
+    EXPECT_EQ(comms.readBytes(16, 100), "");
+    EXPECT_FALSE(comms.isOpen());
+}
+
+TEST(LocalCommsTests, ConnectsToListeningSocketPath) {
+    std::string path = tempPath("listen");
+    ::unlink(path.c_str());
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+    ASSERT_EQ(bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(listen(listener, 1), 0);
+
+    LocalComms comms;
+    ASSERT_TRUE(comms.connect(path));
+    int peer = accept(listener, nullptr, nullptr);
+    ASSERT_EQ(::write(peer, "hello", 5), 5);
+    EXPECT_EQ(comms.readBytes(16, 100), "hello");
+    EXPECT_EQ(comms.readBytes(16, 20), ""); // Timeout keeps the connection
+    EXPECT_TRUE(comms.isOpen());
+
+    ::close(peer);
+    ::close(listener);
+    ::unlink(path.c_str());
+}
+
+TEST(LocalCommsTests, DatagramReadsPreserveBoundaries) {
+    std::string path = tempPath("dgram");
+    LocalComms comms;
+    ASSERT_TRUE(comms.bindDatagram(path));
+
+    int sender = socket(AF_UNIX, SOCK_DGRAM, 0);
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+    auto sendTo = [&](const std::string& data) {
+        return sendto(sender, data.data(), data.size(), 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    };
+    ASSERT_EQ(sendTo("first"), 5);
+    ASSERT_EQ(sendTo("second"), 6);
+    ASSERT_EQ(sendTo("much too long"), 13);
+
+    EXPECT_EQ(comms.readBytes(64, 100), "first");
+    EXPECT_EQ(comms.readBytes(64, 100), "second");
+    EXPECT_EQ(comms.readBytes(4, 100), "much");
+    EXPECT_EQ(comms.getTruncatedDatagrams(), 1u);
+
+    ::close(sender);
+    comms.close();
+    EXPECT_NE(access(path.c_str(), F_OK), 0); // Bound path removed on close
+}
+
+TEST(LocalCommsTests, FifoWaitsForWriterAndClosesWhenItLeaves) {
+    std::string path = tempPath("fifo");
+    ::unlink(path.c_str());
+    LocalComms comms;
+    ASSERT_TRUE(comms.openFifo(path));
+    EXPECT_EQ(comms.readBytes(16, 20), ""); // No writer yet
+    EXPECT_TRUE(comms.isOpen());
+
+    int writer = ::open(path.c_str(), O_WRONLY);
+    ASSERT_GE(writer, 0);
+    ASSERT_EQ(::write(writer, "$GP", 3), 3);
+    EXPECT_EQ(comms.readBytes(16, 100), "$GP");
+    ::close(writer);
+    EXPECT_EQ(comms.readBytes(16, 100), "");
+    EXPECT_FALSE(comms.isOpen());
+    ::unlink(path.c_str());
+}
+
+TEST(LocalCommsTests, SpliceToRecordsStreamAndFifo) {
+    std::string recording = tempPath("recording");
+    int out = ::open(recording.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    ASSERT_GE(out, 0);
+
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    LocalComms stream;
+    ASSERT_TRUE(stream.attach(fds[0], LocalComms::Type::Stream));
+    std::string payload(10000, 's');
+    ASSERT_EQ(::write(fds[1], payload.data(), payload.size()), static_cast<ssize_t>(payload.size()));
+    size_t moved = 0;
+    while (moved < payload.size()) {
+        size_t n = stream.spliceTo(out, 1 << 20, 100);
+        ASSERT_GT(n, 0u);
+        moved += n;
+    }
+    ::close(fds[1]);
+
+    int pipeFds[2];
+    ASSERT_EQ(pipe(pipeFds), 0);
+    LocalComms fifo;
+    ASSERT_TRUE(fifo.attach(pipeFds[0], LocalComms::Type::Fifo));
+    ASSERT_EQ(::write(pipeFds[1], "fifo", 4), 4);
+    EXPECT_EQ(fifo.spliceTo(out, 1 << 20, 100), 4u);
+    ::close(pipeFds[1]);
+    EXPECT_EQ(fifo.spliceTo(out, 1 << 20, 100), 0u);
+    EXPECT_FALSE(fifo.isOpen());
+
+    ::close(out);
+    EXPECT_EQ(readFile(recording), payload + "fifo");
+    ::unlink(recording.c_str());
+}
+
+TEST(LocalCommsTests, SpliceToKeepsUnwrittenDatagramBytes) {
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_DGRAM, 0, fds), 0);
+    LocalComms comms;
+    ASSERT_TRUE(comms.attach(fds[0], LocalComms::Type::Datagram));
+    int out[2];
+    ASSERT_EQ(pipe2(out, O_NONBLOCK), 0);
+    auto drain = [&]() {
+        std::string content;
+        char buffer[4096];
+        ssize_t n;
+        while ((n = ::read(out[0], buffer, sizeof(buffer))) > 0) content.append(buffer, static_cast<size_t>(n));
+        return content;
+    };
+
+    // maxBytes is honoured; the rest of the datagram comes with the next call
+    ASSERT_EQ(::send(fds[1], "$GPGGA", 6, 0), 6);
+    EXPECT_EQ(comms.spliceTo(out[1], 4, 100), 4u);
+    EXPECT_EQ(comms.spliceTo(out[1], 4, 100), 2u);
+    EXPECT_EQ(drain(), "$GPGGA");
+
+    // A full outFd (EAGAIN) keeps the datagram instead of dropping it
+    std::string filler(4096, 'f');
+    size_t buffered = 0;
+    ssize_t n;
+    while ((n = ::write(out[1], filler.data(), filler.size())) > 0) buffered += static_cast<size_t>(n);
+    while ((n = ::write(out[1], filler.data(), 1)) > 0) buffered += static_cast<size_t>(n);
+    ASSERT_EQ(::send(fds[1], "$GPRMC", 6, 0), 6);
+    EXPECT_EQ(comms.spliceTo(out[1], 64, 100), 0u);
+    EXPECT_EQ(drain().size(), buffered);
+    EXPECT_EQ(comms.spliceTo(out[1], 64, 100), 6u);
+    EXPECT_EQ(drain(), "$GPRMC");
+
+    ::close(fds[1]);
+    ::close(out[0]);
+    ::close(out[1]);
+}
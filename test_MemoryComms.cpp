@@ -0,0 +1,84 @@
+#include "MemoryComms.hpp"
+#include "MmapFileComms.hpp"
+#include "NMEAReader.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+const std::string SENTENCES =
+    "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"
+    "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+
+std::string drain(IComms& comms, size_t readSize) {
+    std::string result;
+    while (comms.isOpen()) {
+        result += comms.readBytes(readSize, 0);
+    }
+    return result;
+}
+
+TEST(MemoryCommsTests, ServesDataInConfiguredChunks) {
+    MemoryComms comms("0123456789", 4);
+    EXPECT_EQ(comms.readBytes(100, 0), "0123");
+    EXPECT_EQ(comms.readBytes(2, 0), "45");
+    EXPECT_EQ(comms.readBytes(100, 0), "6789");
+    EXPECT_TRUE(comms.isOpen());
+    EXPECT_EQ(comms.readBytes(100, 0), "");
+    EXPECT_FALSE(comms.isOpen()); // End of data behaves like a closed peer
+
+    comms.rewind();
+    EXPECT_EQ(drain(comms, 3), "0123456789");
+}
+
+TEST(MemoryCommsTests, SimulatedTimeoutsAreDeterministic) {
+    MemoryComms comms("abcdef", 2);
+    comms.setSimulatedTimeouts(2);
+    EXPECT_EQ(comms.readBytes(10, 50), "ab");
+    EXPECT_EQ(comms.readBytes(10, 50), ""); // 2nd read times out
+    EXPECT_TRUE(comms.isOpen());
+    EXPECT_EQ(comms.readBytes(10, 50), "cd");
+    EXPECT_EQ(comms.getReadCount(), 3u);
+}
+
+TEST(MemoryCommsTests, LoopReplaysForever) {
+    MemoryComms comms("xyz");
+    comms.setLoop(true);
+    EXPECT_EQ(comms.readBytes(3, 0), "xyz");
+    EXPECT_EQ(comms.readBytes(3, 0), "xyz");
+    EXPECT_TRUE(comms.isOpen());
+}
+
+TEST(MemoryCommsTests, NMEAReaderHandlesOneByteChunks) {
+    MemoryComms comms(SENTENCES, 1);
+    NMEAReader reader(comms, 0);
+    std::vector<NMEAMessage::MessageType> types;
+    while (comms.isOpen()) {
+        auto message = reader.readAndParseSentence();
+        if (message) types.push_back((*message)->getType());
+    }
+    EXPECT_EQ(types, (std::vector<NMEAMessage::MessageType>{NMEAMessage::MessageType::GGA, NMEAMessage::MessageType::RMC}));
+}
+
+TEST(MmapFileCommsTests, ServesFileContentsWithoutReading) {
+    std::string path = ::testing::TempDir() + "mmap_file_comms_test.nmea";
+    std::ofstream(path, std::ios::binary) << SENTENCES;
+
+    MmapFileComms comms(16);
+    EXPECT_FALSE(comms.isOpen());
+    ASSERT_TRUE(comms.open(path));
+    EXPECT_EQ(comms.view().size(), SENTENCES.size());
+    EXPECT_EQ(comms.readBytes(100, 0).size(), 16u);
+
+    comms.rewind();
+    EXPECT_EQ(drain(comms, 64), SENTENCES);
+    comms.close();
+    EXPECT_FALSE(comms.isOpen());
+    std::remove(path.c_str());
+}
+
+TEST(MmapFileCommsTests, MissingFileFailsToOpen) {
+    MmapFileComms comms;
+    EXPECT_FALSE(comms.open("/nonexistent/path/to.nmea"));
+    EXPECT_FALSE(comms.isOpen());
+}
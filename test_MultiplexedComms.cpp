@@ -0,0 +1,167 @@
+#include "MultiplexedComms.hpp"
+#include "TestSupport.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+
+struct Fragment {
+    uint16_t stream;
+    bool last;
+    std::string data;
+};
+
+std::string fragment(uint16_t stream, bool last, const std::string& data) {
+    std::string out = {static_cast<char>(stream >> 8), static_cast<char>(stream), static_cast<char>(last ? 1 : 0),
+                       static_cast<char>(data.size() >> 8), static_cast<char>(data.size())};
+    return out + data;
+}
+
+// Reads fragments from the peer side until the connection closes
+std::vector<Fragment> readFragments(int fd) {
+    std::string data;
+    char buffer[65536];
+    ssize_t received;
+    while ((received = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        data.append(buffer, static_cast<size_t>(received));
+    }
+    std::vector<Fragment> fragments;
+    size_t i = 0;
+    while (i + MultiplexedComms::kHeaderSize <= data.size()) {
+        const unsigned char* h = reinterpret_cast<const unsigned char*>(data.data() + i);
+        size_t length = (size_t(h[3]) << 8) | h[4];
+        fragments.push_back({static_cast<uint16_t>((h[0] << 8) | h[1]), (h[2] & 1) != 0,
+                             data.substr(i + MultiplexedComms::kHeaderSize, length)});
+        i += MultiplexedComms::kHeaderSize + length;
+    }
+    return fragments;
+}
+
+// Joins fragments into messages per stream
+std::map<uint16_t, std::vector<std::string>> reassemble(const std::vector<Fragment>& fragments) {
+    std::map<uint16_t, std::vector<std::string>> messages;
+    std::map<uint16_t, std::string> partial;
+    for (const Fragment& f : fragments) {
+        partial[f.stream] += f.data;
+        if (f.last) {
+            messages[f.stream].push_back(partial[f.stream]);
+            partial[f.stream].clear();
+        }
+    }
+    return messages;
+}
+
+} // namespace
+
+TEST(MultiplexedCommsTests, ReassemblesInterleavedStreams) {
+    LoopbackListener listener;
+    MultiplexedComms comms;
+    comms.connectToServer("127.0.0.1", listener.port());
+    int peer = listener.accept();
+
+    sendAll(peer, fragment(1, false, "bulk-") + fragment(2, true, "alarm") + fragment(1, false, "part-") +
+                      fragment(3, true, "") + fragment(1, true, "end"));
+    MultiplexedComms::StreamMessage first = comms.receiveMessage();
+    EXPECT_EQ(first.stream, 2);
+    EXPECT_EQ(first.message, "alarm");
+    MultiplexedComms::StreamMessage second = comms.receiveMessage();
+    EXPECT_EQ(second.stream, 3);
+    EXPECT_EQ(second.message, "");
+    MultiplexedComms::StreamMessage third = comms.receiveMessage();
+    EXPECT_EQ(third.stream, 1);
+    EXPECT_EQ(third.message, "bulk-part-end");
+
+    sendAll(peer, fragment(4, false, "cut"));
+    ::close(peer);
+    EXPECT_THROW(comms.receiveMessage(), std::runtime_error);
+}
+
+TEST(MultiplexedCommsTests, HighPriorityOvertakesBulkMessage) {
+    LoopbackListener listener;
+    MultiplexedComms::Options options;
+    options.maxFragmentSize = 4096;
+    auto comms = std::make_unique<MultiplexedComms>(options);
+    comms->setStreamPriority(0, 10);
+    comms->connectToServer("127.0.0.1", listener.port());
+    int peer = listener.accept();
+
+    // The peer does not read yet, so the bulk sender blocks part way through
+    std::string bulk(4 * 1024 * 1024, 'b');
+    std::thread bulkSender([&] { comms->sendMessage(1, bulk); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::thread alarmSender([&] { comms->sendMessage(0, "ALARM"); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::vector<Fragment> fragments;
+    std::thread reader([&] { fragments = readFragments(peer); });
+    alarmSender.join();
+    bulkSender.join();
+    comms.reset(); // Closes the connection so the reader sees the end
+    reader.join();
+    ::close(peer);
+
+    auto alarm = std::find_if(fragments.begin(), fragments.end(), [](const Fragment& f) { return f.stream == 0; });
+    ASSERT_NE(alarm, fragments.end());
+    EXPECT_EQ(alarm->data, "ALARM");
+    EXPECT_TRUE(alarm->last);
+    EXPECT_NE(fragments.back().stream, 0); // Bulk fragments followed the alarm
+    EXPECT_EQ(reassemble(fragments)[1], std::vector<std::string> {bulk});
+}
+
+TEST(MultiplexedCommsTests, ConcurrentSendersKeepEachStreamInOrder) {
+    LoopbackListener listener;
+    MultiplexedComms::Options options;
+    options.maxFragmentSize = 1000;
+    auto comms = std::make_unique<MultiplexedComms>(options);
+    comms->connectToServer("127.0.0.1", listener.port());
+    int peer = listener.accept();
+    std::vector<Fragment> fragments;
+    std::thread reader([&] { fragments = readFragments(peer); });
+
+    std::vector<std::thread> senders;
+    for (int t = 0; t < 4; ++t) {
+        senders.emplace_back([&, t] {
+            for (int i = 0; i < 20; ++i) {
+                // Two threads per stream; each message is one repeated character
+                comms->sendMessage(static_cast<uint16_t>(t % 2), std::string(3000 + i, static_cast<char>('a' + t)));
+            }
+        });
+    }
+    for (std::thread& sender : senders) sender.join();
+    EXPECT_EQ(comms->getStats().messagesSent, 80u);
+    comms.reset();
+    reader.join();
+    ::close(peer);
+
+    auto messages = reassemble(fragments);
+    ASSERT_EQ(messages[0].size() + messages[1].size(), 80u);
+    for (auto& [stream, list] : messages) {
+        for (const std::string& message : list) {
+            EXPECT_EQ(message.find_first_not_of(message[0]), std::string::npos) << "Interleaved on stream " << stream;
+        }
+    }
+}
+
+TEST(MultiplexedCommsTests, OversizedMessageThrows) {
+    LoopbackListener listener;
+    MultiplexedComms::Options options;
+    options.maxMessageSize = 100;
+    MultiplexedComms comms(options);
+    comms.connectToServer("127.0.0.1", listener.port());
+    int peer = listener.accept();
+
+    sendAll(peer, fragment(5, false, std::string(60, 'x')) + fragment(5, false, std::string(60, 'x')));
+    EXPECT_THROW(comms.receiveMessage(), FrameTooLargeError);
+    ::close(peer);
+}
@@ -0,0 +1,216 @@
+#include "NMEAReader.hpp"
+#include "AsyncNMEAReader.hpp"
+#include "EventLoop.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <fcntl.h>
+
+// IComms over the read end of a pipe, so tests need no network or serial hardware
+class PipeComms : public IComms {
+public:
+    PipeComms() {
+        int fds[2];
+        if (pipe(fds) != 0) throw std::runtime_error("pipe failed");
+        readFd = fds[0];
+        writeFd = fds[1];
+        fcntl(readFd, F_SETFL, fcntl(readFd, F_GETFL, 0) | O_NONBLOCK);
+    }
+    ~PipeComms() override {
+        if (readFd >= 0) ::close(readFd);
+        closeWriter();
+    }
+
+    void write(const std::string& data) {
+        ASSERT_EQ(::write(writeFd, data.data(), data.size()), static_cast<ssize_t>(data.size()));
+    }
+    void closeWriter() {
+        if (writeFd >= 0) ::close(writeFd);
+        writeFd = -1;
+    }
+
+    size_t readInto(std::span<std::byte> buffer, unsigned int /*timeoutMs*/) override {
+        ssize_t n = ::read(readFd, buffer.data(), buffer.size());
+        if (n == 0) _eof = true;
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+    bool isOpen() const override { return !_eof; }
+    int getPollDescriptor() const override { return readFd; }
+    std::optional<ReceiveTime> getLastReceiveTime() const override { return receiveTime; }
+
+    int readFd = -1;
+    int writeFd = -1;
+    std::optional<ReceiveTime> receiveTime; // Reported for every read when set
+
+private:
+    bool _eof = false;
+};
+
+const std::string GGA = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47";
+const std::string RMC = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A";
+
+TEST(NMEAReaderTests, ParsesSentenceSplitAcrossReads) {
+    PipeComms comms;
+    NMEAReader reader(comms, 0);
+
+    comms.write("noise" + GGA.substr(0, 20));
+    EXPECT_FALSE(reader.readAndParseSentence().has_value());
+
+    comms.write(GGA.substr(20) + "\r\n");
+    auto message = reader.readAndParseSentence();
+    ASSERT_TRUE(message.has_value());
+    EXPECT_EQ((*message)->getType(), NMEAMessage::MessageType::GGA);
+    EXPECT_EQ((*message)->rawSentence, GGA);
+}
+
+TEST(NMEAReaderTests, SkipsInvalidSentenceInSameBuffer) {
+    PipeComms comms;
+    NMEAReader reader(comms, 0);
+
+    reader.appendData("$GPXXX,bad\r\n" + RMC + "\r\n");
+    auto message = reader.parseBufferedSentence();
+    ASSERT_TRUE(message.has_value());
+    EXPECT_EQ((*message)->getType(), NMEAMessage::MessageType::RMC);
+    EXPECT_FALSE(reader.parseBufferedSentence().has_value());
+}
+
+TEST(NMEAReaderTests, MessageCarriesArrivalTimeOfItsLastByte) {
+    PipeComms comms;
+    NMEAReader reader(comms, 0);
+    IComms::ReceiveTime first(std::chrono::seconds(100));
+    IComms::ReceiveTime second(std::chrono::seconds(200));
+
+    comms.receiveTime = first;
+    comms.write(GGA + "\r\n" + RMC.substr(0, 30));
+    auto gga = reader.readAndParseSentence();
+    ASSERT_TRUE(gga.has_value());
+    EXPECT_EQ((*gga)->receiveTime, first);
+
+    comms.receiveTime = second;
+    comms.write(RMC.substr(30) + "\r\n");
+    auto rmc = reader.readAndParseSentence();
+    ASSERT_TRUE(rmc.has_value());
+    EXPECT_EQ((*rmc)->receiveTime, second);
+
+    comms.receiveTime.reset(); // Medium without timestamps
+    comms.write(GGA + "\r\n");
+    auto untimed = reader.readAndParseSentence();
+    ASSERT_TRUE(untimed.has_value());
+    EXPECT_FALSE((*untimed)->receiveTime.has_value());
+}
+
+TEST(AsyncNMEAReaderTests, NextResumesWhenDataArrives) {
+    EventLoop loop;
+    PipeComms comms;
+    AsyncNMEAReader reader(comms, loop);
+    std::vector<NMEAMessage::MessageType> received;
+
+    loop.spawn([&]() -> Task<void> {
+        auto message = co_await reader.next();
+        if (message) received.push_back((*message)->getType());
+        loop.stop();
+    }());
+
+    EXPECT_EQ(loop.pendingWaiters(), 1u); // Suspended, not blocking
+    comms.write(GGA + "\r\n");
+    loop.run();
+
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0], NMEAMessage::MessageType::GGA);
+}
+
+TEST(AsyncNMEAReaderTests, GeneratorYieldsUntilSourceCloses) {
+    EventLoop loop;
+    PipeComms comms;
+    AsyncNMEAReader reader(comms, loop);
+    std::vector<std::string> received;
+    bool finished = false;
+
+    loop.spawn([&]() -> Task<void> {
+        auto messages = reader.messages();
+        while (auto message = co_await messages.next()) {
+            received.push_back((*message)->rawSentence);
+        }
+        finished = true;
+    }());
+
+    comms.write(GGA + "\r\n" + RMC + "\r\n" + GGA.substr(0, 10));
+    comms.closeWriter();
+    loop.run();
+
+    EXPECT_TRUE(finished);
+    EXPECT_EQ(received, (std::vector<std::string>{GGA, RMC}));
+}
+
+TEST(AsyncNMEAReaderTests, IdleTimeoutReturnsNullopt) {
+    EventLoop loop;
+    PipeComms comms;
+    AsyncNMEAReader reader(comms, loop, 20);
+    bool timedOut = false;
+
+    loop.spawn([&]() -> Task<void> {
+        auto message = co_await reader.next();
+        timedOut = !message.has_value();
+    }());
+    loop.run(); // Returns once the only waiter has timed out
+
+    EXPECT_TRUE(timedOut);
+}
+
+TEST(AsyncNMEAReaderTests, DestroyedReaderDoesNotResumeItsWaiter) {
+    EventLoop loop;
+    PipeComms comms;
+    bool resumed = false;
+    auto reader = std::make_unique<AsyncNMEAReader>(comms, loop);
+
+    loop.spawn([&]() -> Task<void> {
+        co_await reader->next();
+        resumed = true;
+    }());
+    EXPECT_EQ(loop.pendingWaiters(), 1u);
+
+    reader.reset(); // The suspended frame still refers to the reader
+    comms.write(GGA + "\r\n");
+    loop.run(); // Nothing is left waiting, so this returns at once
+
+    EXPECT_FALSE(resumed);
+    EXPECT_EQ(loop.pendingWaiters(), 0u);
+}
+
+TEST(EventLoopTests, StopBeforeRunIsNotLost) {
+    EventLoop loop;
+    PipeComms comms;
+    loop.spawn([&]() -> Task<void> {
+        co_await loop.readable(comms.readFd); // Never becomes readable
+    }());
+
+    std::thread([&] { loop.stop(); }).join(); // Issued before run() starts
+    loop.run(); // Returns at once instead of waiting forever
+    EXPECT_EQ(loop.pendingWaiters(), 1u);
+
+    comms.write(GGA + "\r\n");
+    loop.run(); // The stop was consumed; this run serves the waiter
+    EXPECT_EQ(loop.pendingWaiters(), 0u);
+}
+
+TEST(ICommsTests, ReadBytesWrapsReadInto) {
+    PipeComms comms;
+    comms.write("abcdef");
+    EXPECT_EQ(comms.readBytes(4, 0), "abcd");
+    EXPECT_EQ(comms.readBytes(4, 0), "ef");
+    EXPECT_EQ(comms.readBytes(4, 0), "");
+}
+
+TEST(ICommsTests, ScatterFillsBuffersInOrder) {
+    PipeComms comms;
+    comms.write("0123456789");
+    std::byte head[4], tail[8];
+    std::span<std::byte> buffers[] = {head, tail};
+
+    ASSERT_EQ(comms.readIntoScatter(buffers, 0), 10u);
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(head), 4), "0123");
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(tail), 6), "456789");
+}
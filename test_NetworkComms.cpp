@@ -0,0 +1,413 @@
+#include "NetworkComms.hpp"
+#include "TestSupport.hpp"
+#include "NMEAReader.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+
+TEST(NetworkCommsTests, ReadIntoReceivesInBulk) {
+    LoopbackListener listener;
+    NetworkComms comms;
+    ASSERT_TRUE(comms.connect("127.0.0.1", listener.service()));
+    int peer = listener.accept();
+
+    std::string payload(3000, 'x');
+    ASSERT_EQ(::send(peer, payload.data(), payload.size(), 0), static_cast<ssize_t>(payload.size()));
+
+    std::byte buffer[8192];
+    size_t total = 0;
+    while (total < payload.size()) {
+        size_t n = comms.readInto(std::span<std::byte>(buffer + total, sizeof(buffer) - total), 500);
+        ASSERT_GT(n, 0u);
+        total += n;
+    }
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(buffer), total), payload);
+    ::close(peer);
+}
+
+TEST(NetworkCommsTests, ReadIntoScatterWrapsAcrossBuffers) {
+    LoopbackListener listener;
+    NetworkComms comms;
+    ASSERT_TRUE(comms.connect("127.0.0.1", listener.service()));
+    int peer = listener.accept();
+
+    ASSERT_EQ(::send(peer, "ABCDEFGH", 8, 0), 8);
+    std::byte first[3], second[16];
+    std::span<std::byte> buffers[] = {first, second};
+
+    EXPECT_EQ(comms.readIntoScatter(buffers, 500), 8u);
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(first), 3), "ABC");
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(second), 5), "DEFGH");
+    ::close(peer);
+}
+
+TEST(NetworkCommsTests, ReadBytesTimesOutAndDetectsPeerClose) {
+    LoopbackListener listener;
+    NetworkComms comms;
+    ASSERT_TRUE(comms.connect("127.0.0.1", listener.service()));
+    int peer = listener.accept();
+
+    EXPECT_EQ(comms.readBytes(16, 20), "");
+    EXPECT_TRUE(comms.isOpen());
+
+    ::close(peer);
+    EXPECT_EQ(comms.readBytes(16, 500), "");
+    EXPECT_FALSE(comms.isOpen());
+}
+
+TEST(NetworkCommsTests, SmallReadsAreServedFromReceiveBuffer) {
+    LoopbackListener listener;
+    NetworkComms comms;
+    ASSERT_TRUE(comms.connect("127.0.0.1", listener.service()));
+    int peer = listener.accept();
+
+    std::string sentence = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+    std::string segment;
+    for (int i = 0; i < 16; ++i) segment += sentence;
+    ASSERT_EQ(::send(peer, segment.data(), segment.size(), 0), static_cast<ssize_t>(segment.size()));
+
+    std::string received;
+    while (received.size() < segment.size()) {
+        std::string chunk = comms.readBytes(sentence.size(), 500);
+        ASSERT_FALSE(chunk.empty());
+        received += chunk;
+    }
+    EXPECT_EQ(received, segment);
+    EXPECT_EQ(comms.getStats().recvCalls, 1u);
+    EXPECT_EQ(comms.getStats().pollCalls, 1u);
+    ::close(peer);
+}
+
+TEST(NetworkCommsTests, BufferedDataOutlivesPeerClose) {
+    LoopbackListener listener;
+    NetworkComms comms;
+    ASSERT_TRUE(comms.connect("127.0.0.1", listener.service()));
+    int peer = listener.accept();
+    ASSERT_EQ(::send(peer, "ABCDEF", 6, 0), 6);
+    ::close(peer);
+
+    EXPECT_EQ(comms.readBytes(2, 500), "AB");
+    EXPECT_EQ(comms.getBufferedBytes(), 4u);
+    EXPECT_EQ(comms.readBytes(2, 500), "CD");
+    EXPECT_EQ(comms.readBytes(2, 500), "EF");
+    EXPECT_EQ(comms.readBytes(2, 500), ""); // Observes the close
+    EXPECT_FALSE(comms.isOpen());
+}
+
+TEST(NetworkCommsTests, WaitsOnDescriptorsAboveFdSetSize) {
+    rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    if (limit.rlim_max < FD_SETSIZE + 64) {
+        GTEST_SKIP() << "descriptor limit too low";
+    }
+    rlimit raised = limit;
+    raised.rlim_cur = FD_SETSIZE + 64;
+    setrlimit(RLIMIT_NOFILE, &raised);
+
+    // Occupy the low descriptors so the client socket lands above FD_SETSIZE
+    std::vector<int> filler;
+    int fd;
+    while ((fd = ::open("/dev/null", O_RDONLY)) >= 0 && fd < FD_SETSIZE) filler.push_back(fd);
+    if (fd >= 0) ::close(fd);
+
+    LoopbackListener listener;
+    NetworkComms comms;
+    ASSERT_TRUE(comms.connect("127.0.0.1", listener.service()));
+    EXPECT_GE(comms.getPollDescriptor(), FD_SETSIZE);
+    int peer = listener.accept();
+    ASSERT_EQ(::send(peer, "hi", 2, 0), 2);
+    EXPECT_EQ(comms.readBytes(16, 500), "hi");
+
+    ::close(peer);
+    comms.close();
+    for (int f : filler) ::close(f);
+    setrlimit(RLIMIT_NOFILE, &limit);
+}
+
+// Sends UDP datagrams to 127.0.0.1 or, with a group, to loopback multicast
+class UdpSender {
+public:
+    explicit UdpSender(const std::string& port, const char* group = nullptr) {
+        _fd = socket(AF_INET, SOCK_DGRAM, 0);
+        _addr.sin_family = AF_INET;
+        _addr.sin_port = htons(static_cast<unsigned short>(std::stoi(port)));
+        inet_pton(AF_INET, group ? group : "127.0.0.1", &_addr.sin_addr);
+        if (group) {
+            in_addr loopback;
+            inet_pton(AF_INET, "127.0.0.1", &loopback);
+            setsockopt(_fd, IPPROTO_IP, IP_MULTICAST_IF, &loopback, sizeof(loopback));
+            unsigned char loop = 1;
+            setsockopt(_fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+        }
+    }
+    ~UdpSender() { ::close(_fd); }
+
+    ssize_t send(const std::string& data) {
+        return sendto(_fd, data.data(), data.size(), 0, reinterpret_cast<sockaddr*>(&_addr), sizeof(_addr));
+    }
+
+private:
+    int _fd;
+    sockaddr_in _addr {};
+};
+
+// Picks a free UDP port by binding an ephemeral one and releasing it
+std::string freeUdpPort() {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    ::close(fd);
+    return std::to_string(ntohs(addr.sin_port));
+}
+
+std::string payloadText(const NetworkComms::Datagram& datagram) {
+    return std::string(reinterpret_cast<const char*>(datagram.payload.data()), datagram.payload.size());
+}
+
+TEST(NetworkCommsTests, UdpReadDatagramsKeepsBoundariesAndSenders) {
+    std::string port = freeUdpPort();
+    NetworkComms comms;
+    NetworkComms::UdpReceiveOptions options;
+    options.bindAddress = "127.0.0.1";
+    options.maxDatagramSize = 16;
+    ASSERT_TRUE(comms.bindUdp(port, options));
+
+    UdpSender sender(port);
+    sender.send("first");
+    sender.send("second");
+    sender.send("this one is far too long");
+
+    std::vector<std::string> received;
+    while (received.size() < 3) {
+        auto datagrams = comms.readDatagrams(500);
+        ASSERT_FALSE(datagrams.empty());
+        for (const auto& datagram : datagrams) {
+            received.push_back(payloadText(datagram));
+            EXPECT_EQ(datagram.source.ss_family, AF_INET);
+        }
+    }
+    EXPECT_EQ(received[0], "first");
+    EXPECT_EQ(received[1], "second");
+    EXPECT_EQ(received[2], "this one is far ");
+    EXPECT_EQ(comms.getStats().truncatedDatagrams, 1u);
+    EXPECT_TRUE(comms.readDatagrams(20).empty());
+}
+
+TEST(NetworkCommsTests, UdpMulticastFeedsNMEAStreamThroughReadBytes) {
+    std::string port = freeUdpPort();
+    NetworkComms comms;
+    NetworkComms::UdpReceiveOptions options;
+    options.multicastGroup = "239.255.0.61";
+    options.interfaceAddress = "127.0.0.1";
+    options.receiveBufferBytes = 256 * 1024;
+    ASSERT_TRUE(comms.bindUdp(port, options));
+    EXPECT_GE(comms.getSocketReceiveBufferSize(), 256 * 1024);
+
+    UdpSender sender(port, "239.255.0.61");
+    ASSERT_EQ(sender.send("$GPGGA,1*00\r\n"), 13);
+    ASSERT_EQ(sender.send("$GPRMC,2*00\r\n"), 13);
+
+    std::string stream;
+    while (stream.size() < 26) {
+        std::string chunk = comms.readBytes(5, 500);
+        ASSERT_FALSE(chunk.empty());
+        stream += chunk;
+    }
+    EXPECT_EQ(stream, "$GPGGA,1*00\r\n$GPRMC,2*00\r\n");
+    EXPECT_EQ(comms.readBytes(5, 20), "");
+    EXPECT_TRUE(comms.isOpen());
+}
+
+TEST(NetworkCommsTests, UdpMulticastKeepsUpAtHighDatagramRates) {
+    std::string port = freeUdpPort();
+    NetworkComms comms;
+    NetworkComms::UdpReceiveOptions options;
+    options.multicastGroup = "239.255.0.62";
+    options.interfaceAddress = "127.0.0.1";
+    options.receiveBufferBytes = 4 * 1024 * 1024;
+    ASSERT_TRUE(comms.bindUdp(port, options));
+
+    // Paced at up to 300k datagrams/s: bursts of 300 every millisecond
+    constexpr uint32_t kTotal = 150000;
+    std::thread producer([&]() {
+        UdpSender sender(port, "239.255.0.62");
+        std::string sentence = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < kTotal; ++i) {
+            memcpy(sentence.data() + 1, &i, sizeof(i)); // Sequence number in place of the talker ID
+            sender.send(sentence);
+            if (i % 300 == 299) std::this_thread::sleep_until(start + std::chrono::milliseconds(i / 300 + 1));
+        }
+    });
+
+    uint32_t received = 0;
+    int64_t last = -1;
+    bool ordered = true;
+    while (true) {
+        auto datagrams = comms.readDatagrams(200);
+        if (datagrams.empty()) break;
+        for (const auto& datagram : datagrams) {
+            uint32_t sequence;
+            memcpy(&sequence, datagram.payload.data() + 1, sizeof(sequence));
+            ordered = ordered && static_cast<int64_t>(sequence) > last;
+            last = sequence;
+            ++received;
+        }
+    }
+    producer.join();
+
+    EXPECT_TRUE(ordered);
+    EXPECT_GE(received, kTotal * 99 / 100);
+    // Batching: far fewer syscalls than datagrams whenever the reader falls behind
+    EXPECT_LT(comms.getStats().recvCalls, comms.getStats().datagrams);
+}
+
+TEST(NetworkCommsTests, ReceiveTimestampsReachParsedMessages) {
+    LoopbackListener listener;
+    NetworkComms comms;
+    ASSERT_TRUE(comms.setReceiveTimestamps(true));
+    ASSERT_TRUE(comms.connect("127.0.0.1", listener.service()));
+    int peer = listener.accept();
+    NMEAReader reader(comms, 500);
+    std::string sentence = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+
+    // Warm up: the kernel starts stamping shortly after the option is set, and segments
+    // received before then carry no time at all
+    std::optional<std::shared_ptr<NMEAMessage>> message;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(::send(peer, sentence.data(), sentence.size(), 0), static_cast<ssize_t>(sentence.size()));
+        message = reader.readAndParseSentence();
+        ASSERT_TRUE(message.has_value());
+        if ((*message)->receiveTime.has_value()) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    auto before = std::chrono::system_clock::now();
+    ASSERT_EQ(::send(peer, sentence.data(), sentence.size(), 0), static_cast<ssize_t>(sentence.size()));
+    message = reader.readAndParseSentence();
+    auto after = std::chrono::system_clock::now();
+
+    ASSERT_TRUE(message.has_value());
+    ASSERT_TRUE((*message)->receiveTime.has_value());
+    EXPECT_GE(*(*message)->receiveTime, before);
+    EXPECT_LE(*(*message)->receiveTime, after);
+
+    // Disabled: the plain recv() path, no times
+    ASSERT_TRUE(comms.setReceiveTimestamps(false));
+    ASSERT_EQ(::send(peer, sentence.data(), sentence.size(), 0), static_cast<ssize_t>(sentence.size()));
+    message = reader.readAndParseSentence();
+    ASSERT_TRUE(message.has_value());
+    EXPECT_FALSE((*message)->receiveTime.has_value());
+    ::close(peer);
+}
+
+TEST(NetworkCommsTests, UdpDatagramsCarryReceiveTimestamps) {
+    std::string port = freeUdpPort();
+    NetworkComms comms;
+    NetworkComms::UdpReceiveOptions options;
+    options.bindAddress = "127.0.0.1";
+    ASSERT_TRUE(comms.bindUdp(port, options));
+    ASSERT_TRUE(comms.setReceiveTimestamps(true));
+
+    auto before = std::chrono::system_clock::now();
+    UdpSender sender(port);
+    sender.send("$GPGGA,1*00\r\n");
+    auto datagrams = comms.readDatagrams(500);
+    ASSERT_EQ(datagrams.size(), 1u);
+    ASSERT_TRUE(datagrams[0].receiveTime.has_value());
+    EXPECT_GE(*datagrams[0].receiveTime, before);
+    EXPECT_LE(*datagrams[0].receiveTime, std::chrono::system_clock::now());
+}
+
+int intOption(int fd, int level, int name) {
+    int value = 0;
+    socklen_t length = sizeof(value);
+    getsockopt(fd, level, name, &value, &length);
+    return value;
+}
+
+TEST(NetworkCommsTests, SocketProfilesAreAppliedAtConnect) {
+    LoopbackListener listener;
+    NetworkComms comms;
+    ASSERT_TRUE(comms.connect("127.0.0.1", listener.service()));
+    int defaultReceiveBuffer = comms.getSocketReceiveBufferSize();
+    EXPECT_EQ(intOption(comms.getPollDescriptor(), IPPROTO_TCP, TCP_NODELAY), 0);
+
+    // Applied to the open socket immediately...
+    ASSERT_TRUE(comms.setSocketProfile(NetworkComms::SocketProfile::LowLatency));
+    EXPECT_NE(intOption(comms.getPollDescriptor(), IPPROTO_TCP, TCP_NODELAY), 0);
+    EXPECT_LE(comms.getSocketReceiveBufferSize(), 2 * NetworkComms::SocketProfileOptions().lowLatencyBufferBytes);
+
+    // ...and again to every socket opened later
+    ASSERT_TRUE(comms.setSocketProfile(NetworkComms::SocketProfile::HighThroughput));
+    comms.close();
+    ASSERT_TRUE(comms.connect("127.0.0.1", listener.service()));
+    EXPECT_NE(intOption(comms.getPollDescriptor(), IPPROTO_TCP, TCP_CORK), 0);
+    EXPECT_GT(comms.getSocketReceiveBufferSize(), defaultReceiveBuffer);
+}
+
+TEST(NetworkCommsTests, ExplicitUdpReceiveBufferOutranksTheProfile) {
+    std::string port = freeUdpPort();
+    NetworkComms comms;
+    ASSERT_TRUE(comms.setSocketProfile(NetworkComms::SocketProfile::LowLatency));
+    NetworkComms::UdpReceiveOptions options;
+    options.bindAddress = "127.0.0.1";
+    options.receiveBufferBytes = 256 * 1024;
+    ASSERT_TRUE(comms.bindUdp(port, options));
+    EXPECT_GE(comms.getSocketReceiveBufferSize(), 256 * 1024);
+
+    // Still kept when the profile changes on the open socket
+    ASSERT_TRUE(comms.setSocketProfile(NetworkComms::SocketProfile::LowLatency));
+    EXPECT_GE(comms.getSocketReceiveBufferSize(), 256 * 1024);
+}
+
+TEST(NetworkCommsTests, CorkedWritesWaitForFlush) {
+    LoopbackListener listener;
+    NetworkComms comms;
+    ASSERT_TRUE(comms.setSocketProfile(NetworkComms::SocketProfile::HighThroughput));
+    ASSERT_TRUE(comms.connect("127.0.0.1", listener.service()));
+    int peer = listener.accept();
+
+    std::string sentence = "$GPGGA,1*00\r\n";
+    ASSERT_EQ(comms.write(sentence, 500), sentence.size());
+    pollfd pfd {peer, POLLIN, 0};
+    EXPECT_EQ(::poll(&pfd, 1, 50), 0); // Held back: less than a segment, cork ceiling is 200 ms
+
+    ASSERT_TRUE(comms.flush());
+    ASSERT_EQ(::poll(&pfd, 1, 50), 1);
+    char buffer[64];
+    EXPECT_EQ(::recv(peer, buffer, sizeof(buffer), 0), static_cast<ssize_t>(sentence.size()));
+    EXPECT_EQ(comms.getStats().sendCalls, 1u);
+    ::close(peer);
+}
+
+TEST(NetworkCommsTests, WriteReportsPeerFailureWithoutSignal) {
+    LoopbackListener listener;
+    NetworkComms comms;
+    ASSERT_TRUE(comms.connect("127.0.0.1", listener.service()));
+    ::close(listener.accept());
+
+    // The first send draws a reset, later ones fail with EPIPE instead of raising SIGPIPE
+    std::string sentence = "$GPGGA,1*00\r\n";
+    for (int i = 0; i < 10 && comms.isOpen(); ++i) {
+        comms.write(sentence, 100);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_FALSE(comms.isOpen());
+}
@@ -0,0 +1,153 @@
+#include "RequestClient.hpp"
+#include "CommsServer.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using ConnectionId = CommsReactor::ConnectionId;
+using Clock = std::chrono::steady_clock;
+
+// Polls the server until done() or two seconds have passed
+template <class Done>
+void pollUntil(CommsServer<LengthPrefixCodec>& server, Done done) {
+    auto deadline = Clock::now() + std::chrono::seconds(2);
+    while (!done() && Clock::now() < deadline) server.poll(5);
+    server.flush();
+}
+
+} // namespace
+
+TEST(RequestClientTests, RepliesResolveOutOfOrder) {
+    CommsReactor::Options options;
+    CommsServer<LengthPrefixCodec> server(options);
+    std::vector<std::string> requests;
+    ConnectionId client = 0;
+    CommsReactor::Handlers handlers;
+    handlers.onMessage = [&](ConnectionId id, std::string& body) {
+        client = id;
+        requests.push_back(body);
+    };
+    server.setHandlers(handlers);
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+
+    RequestClient requester;
+    requester.connectToServer("127.0.0.1", server.getPort());
+    std::vector<std::future<std::string>> replies;
+    for (const char* query : {"GET speed", "GET heading", "GET depth"}) {
+        replies.push_back(requester.request(query, std::chrono::seconds(2)));
+    }
+    pollUntil(server, [&] { return requests.size() == 3; });
+    ASSERT_EQ(requests.size(), 3u);
+    EXPECT_EQ(RequestClient::payload(requests[1]), "GET heading");
+
+    // Answered last first
+    for (size_t order = 0; order < requests.size(); ++order) {
+        const std::string& body = requests[requests.size() - 1 - order];
+        std::string answer = std::string(RequestClient::payload(body).substr(4)) + "=" + std::to_string(order);
+        server.send(client, RequestClient::replyBody(RequestClient::correlationId(body), answer));
+    }
+    server.flush();
+
+    EXPECT_EQ(replies[0].get(), "speed=2");
+    EXPECT_EQ(replies[1].get(), "heading=1");
+    EXPECT_EQ(replies[2].get(), "depth=0");
+    EXPECT_EQ(requester.getPendingCount(), 0u);
+    EXPECT_EQ(requester.getStats().replies, 3u);
+}
+
+TEST(RequestClientTests, RequestTimesOutAndLateReplyIsDropped) {
+    CommsReactor::Options options;
+    CommsServer<LengthPrefixCodec> server(options);
+    std::vector<std::string> requests;
+    ConnectionId client = 0;
+    CommsReactor::Handlers handlers;
+    handlers.onMessage = [&](ConnectionId id, std::string& body) {
+        client = id;
+        requests.push_back(body);
+    };
+    server.setHandlers(handlers);
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+
+    RequestClient requester;
+    requester.connectToServer("127.0.0.1", server.getPort());
+    auto start = Clock::now();
+    std::future<std::string> reply = requester.request("slow", std::chrono::milliseconds(50));
+    std::promise<RequestClient::Status> status;
+    requester.send(
+        "slow too", [&](RequestClient::Status result, std::string&) { status.set_value(result); },
+        std::chrono::milliseconds(50));
+
+    EXPECT_THROW(reply.get(), RequestTimeoutError);
+    EXPECT_GE(Clock::now() - start, std::chrono::milliseconds(50));
+    EXPECT_EQ(status.get_future().get(), RequestClient::Status::TimedOut);
+    EXPECT_EQ(requester.getStats().timeouts, 2u);
+
+    pollUntil(server, [&] { return requests.size() == 2; });
+    ASSERT_EQ(requests.size(), 2u);
+    server.send(client, RequestClient::replyBody(RequestClient::correlationId(requests[0]), "too late"));
+    server.flush();
+    auto deadline = Clock::now() + std::chrono::seconds(2);
+    while (requester.getStats().lateReplies == 0 && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(requester.getStats().lateReplies, 1u);
+    EXPECT_EQ(requester.getStats().replies, 0u);
+}
+
+TEST(RequestClientTests, ConnectionLossFailsPendingRequests) {
+    CommsReactor::Options options;
+    CommsServer<LengthPrefixCodec> server(options);
+    size_t received = 0;
+    CommsReactor::Handlers handlers;
+    handlers.onMessage = [&](ConnectionId, std::string&) { ++received; };
+    server.setHandlers(handlers);
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+
+    RequestClient requester;
+    requester.connectToServer("127.0.0.1", server.getPort());
+    std::future<std::string> first = requester.request("a", std::chrono::seconds(5));
+    std::future<std::string> second = requester.request("b", std::chrono::seconds(5));
+    pollUntil(server, [&] { return received == 2; });
+    server.closeAll();
+
+    EXPECT_THROW(first.get(), std::runtime_error);
+    EXPECT_THROW(second.get(), std::runtime_error);
+    EXPECT_EQ(requester.getPendingCount(), 0u);
+    EXPECT_THROW(requester.request("c", std::chrono::seconds(5)), std::runtime_error);
+}
+
+TEST(RequestClientTests, PipelinedRequestsShareSendCalls) {
+    CommsReactor::Options options;
+    CommsServer<LengthPrefixCodec> server(options);
+    CommsReactor::Handlers handlers;
+    handlers.onMessage = [&](ConnectionId id, std::string& body) { server.send(id, body); };
+    server.setHandlers(handlers);
+    ASSERT_TRUE(server.listen("0", "127.0.0.1"));
+
+    RequestClient requester;
+    requester.setCoalescing(64, std::chrono::milliseconds(1));
+    requester.connectToServer("127.0.0.1", server.getPort());
+    constexpr int kRequests = 1000;
+    std::atomic<int> matched {0};
+    for (int i = 0; i < kRequests; ++i) {
+        std::string query = "query " + std::to_string(i);
+        requester.send(
+            query,
+            [&matched, query](RequestClient::Status status, std::string& reply) {
+                if (status == RequestClient::Status::Ok && reply == query) ++matched;
+            },
+            std::chrono::seconds(5));
+    }
+    // The last partial batch goes out on the receiver thread once due
+    pollUntil(server, [&] { return matched == kRequests; });
+
+    EXPECT_EQ(matched, kRequests);
+    EXPECT_EQ(requester.getStats().requests, static_cast<uint64_t>(kRequests));
+    EXPECT_LT(requester.getSendCalls(), static_cast<uint64_t>(kRequests / 4));
+}
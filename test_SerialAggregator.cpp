@@ -0,0 +1,175 @@
+#include "SerialAggregator.hpp"
+#include "TestSupport.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+struct Received {
+    SerialAggregator::PortId port;
+    std::string text;
+    SerialAggregator::Clock::time_point arrival;
+};
+
+class SerialAggregatorTest : public ::testing::Test {
+protected:
+    SerialAggregator aggregator;
+    std::vector<std::unique_ptr<PtyPair>> ptys;
+    std::vector<Received> received;
+
+    void SetUp() override {
+        SerialAggregator::Handlers handlers;
+        handlers.onSentence = [this](const SerialAggregator::Sentence& sentence) {
+            received.push_back({sentence.port, std::string(sentence.text), sentence.arrival});
+        };
+        aggregator.setHandlers(handlers);
+    }
+
+    SerialAggregator::PortId addPort(SerialAggregator::PortConfig config = {}) {
+        ptys.push_back(std::make_unique<PtyPair>());
+        config.device = ptys.back()->slaveName();
+        std::optional<SerialAggregator::PortId> id = aggregator.add(config);
+        EXPECT_TRUE(id.has_value());
+        return id.value_or(0);
+    }
+
+    // Polls until count sentences have arrived or a second has passed
+    void pollFor(size_t count) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (received.size() < count && std::chrono::steady_clock::now() < deadline) {
+            aggregator.poll(50);
+        }
+    }
+};
+
+TEST_F(SerialAggregatorTest, FramesSentencesPerPort) {
+    SerialAggregator::PortId gnss = addPort();
+    SerialAggregator::PortId ais = addPort();
+    SerialAggregator::PortConfig lineFeed;
+    lineFeed.termination = Serial_Comms::TerminationMethod::LF;
+    SerialAggregator::PortId sounder = addPort(lineFeed);
+    EXPECT_EQ(aggregator.getPortCount(), 3u);
+
+    auto start = SerialAggregator::Clock::now();
+    ptys[gnss]->write("$GPGGA,1*00\r\n$GPRMC,1");
+    ptys[ais]->write("!AIVDM,1,1,,A,13aEOK?P00PD2wVMdLDRhgvL289?,0*26\r");
+    ptys[sounder]->write("$SDDPT,12.3,0.5*55\n");
+    pollFor(2);
+    // The CRLF straddling two reads, and the rest of a sentence, come later
+    ptys[ais]->write("\n");
+    ptys[gnss]->write("*00\r\n");
+    pollFor(4);
+
+    std::map<SerialAggregator::PortId, std::vector<std::string>> byPort;
+    for (const Received& sentence : received) {
+        byPort[sentence.port].push_back(sentence.text);
+        EXPECT_GE(sentence.arrival, start);
+        EXPECT_LE(sentence.arrival, SerialAggregator::Clock::now());
+    }
+    EXPECT_EQ(byPort[gnss], (std::vector<std::string>{"$GPGGA,1*00\r\n", "$GPRMC,1*00\r\n"}));
+    EXPECT_EQ(byPort[ais], (std::vector<std::string>{"!AIVDM,1,1,,A,13aEOK?P00PD2wVMdLDRhgvL289?,0*26\r\n"}));
+    EXPECT_EQ(byPort[sounder], (std::vector<std::string>{"$SDDPT,12.3,0.5*55\n"}));
+    EXPECT_EQ(aggregator.getStats().sentences, 4u);
+}
+
+TEST_F(SerialAggregatorTest, OneWakeupServesEveryReadyPort) {
+    for (int i = 0; i < 8; ++i) {
+        addPort();
+    }
+    for (auto& pty : ptys) {
+        pty->write("$HEHDT,274.07,T*03\r\n");
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    EXPECT_EQ(aggregator.poll(100), 8u);
+    EXPECT_EQ(aggregator.getStats().wakeups, 1u);
+    EXPECT_EQ(aggregator.getStats().reads, 8u);
+    for (SerialAggregator::PortId id = 0; id < 8; ++id) {
+        EXPECT_EQ(received[id].arrival, received[0].arrival);
+    }
+    EXPECT_EQ(aggregator.poll(0), 0u);
+}
+
+TEST_F(SerialAggregatorTest, DiscardsOverlongInput) {
+    SerialAggregator::PortConfig config;
+    config.maxSentenceLength = 82;
+    SerialAggregator::PortId port = addPort(config);
+    ptys[port]->write(std::string(100, '~')); // Noise from a wrong baud rate
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (aggregator.getStats().discardedBytes == 0 && std::chrono::steady_clock::now() < deadline) {
+        aggregator.poll(50);
+    }
+    EXPECT_TRUE(received.empty());
+    EXPECT_EQ(aggregator.getStats().discardedBytes, 100u);
+
+    ptys[port]->write("$GPGLL,4916.45,N*31\r\n");
+    pollFor(1);
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0].text, "$GPGLL,4916.45,N*31\r\n");
+}
+
+TEST_F(SerialAggregatorTest, ReportsHangupAndKeepsOtherPorts) {
+    SerialAggregator::PortId lost = addPort();
+    SerialAggregator::PortId kept = addPort();
+    std::vector<SerialAggregator::PortId> closed;
+    SerialAggregator::Handlers handlers;
+    handlers.onSentence = [this](const SerialAggregator::Sentence& sentence) {
+        received.push_back({sentence.port, std::string(sentence.text), sentence.arrival});
+    };
+    handlers.onClose = [&](SerialAggregator::PortId id) { closed.push_back(id); };
+    aggregator.setHandlers(handlers);
+
+    ptys[lost]->closeMaster();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (closed.empty() && std::chrono::steady_clock::now() < deadline) {
+        aggregator.poll(50);
+    }
+    EXPECT_EQ(closed, std::vector<SerialAggregator::PortId>{lost});
+    EXPECT_FALSE(aggregator.isOpen(lost));
+    EXPECT_EQ(aggregator.getOpenCount(), 1u);
+
+    // The closed port no longer wakes the loop
+    EXPECT_EQ(aggregator.poll(20), 0u);
+    EXPECT_EQ(aggregator.getStats().wakeups, 1u);
+
+    ptys[kept]->write("$GPZDA,1*00\r\n");
+    pollFor(1);
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0].port, kept);
+}
+
+TEST_F(SerialAggregatorTest, HandlerMayAddPorts) {
+    SerialAggregator::PortId first = addPort();
+    SerialAggregator::Handlers handlers;
+    handlers.onSentence = [this](const SerialAggregator::Sentence& sentence) {
+        received.push_back({sentence.port, std::string(sentence.text), sentence.arrival});
+        if (received.size() == 1) {
+            for (int i = 0; i < 16; ++i) addPort(); // While the first port's input is being framed
+        }
+    };
+    aggregator.setHandlers(handlers);
+
+    ptys[first]->write("$GPGGA,1*00\r\n$GPRMC,1*00\r\n");
+    pollFor(2);
+    ASSERT_EQ(received.size(), 2u);
+    EXPECT_EQ(received[1].text, "$GPRMC,1*00\r\n");
+    EXPECT_EQ(aggregator.getPortCount(), 17u);
+
+    ptys.back()->write("$HEHDT,274.07,T*03\r\n");
+    pollFor(3);
+    ASSERT_EQ(received.size(), 3u);
+    EXPECT_EQ(received[2].port, 16u);
+}
+
+TEST_F(SerialAggregatorTest, RejectsPortThatCannotOpen) {
+    SerialAggregator::PortConfig config;
+    config.device = "/dev/does-not-exist";
+    EXPECT_FALSE(aggregator.add(config).has_value());
+    EXPECT_EQ(aggregator.getPortCount(), 0u);
+}
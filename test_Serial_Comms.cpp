@@ -0,0 +1,290 @@
+#include "Serial_Comms.hpp"
+#include "TestSupport.hpp"
+#include <gtest/gtest.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+// Opens the pty slave in raw 8N1, as for a GNSS receiver
+static void openRaw(Serial_Comms& serial, const PtyPair& pty) {
+    ASSERT_TRUE(serial.open(pty.slaveName()));
+    ASSERT_TRUE(serial.configure(Serial_Comms::BaudRate::BR_115200, Serial_Comms::DataBits::DB_8,
+                                 Serial_Comms::Parity::None, Serial_Comms::StopBits::SB_1,
+                                 Serial_Comms::FlowControl::None));
+}
+
+TEST(SerialCommsTests, ReadsSentencesFromOneBulkRead) {
+    PtyPair pty;
+    Serial_Comms serial;
+    openRaw(serial, pty);
+
+    pty.write("$GPGGA,123519,4807.038,N*47\r\n$GPRMC,123520,A*6A\r\n$GPVTG");
+    EXPECT_EQ(serial.read(Serial_Comms::TerminationMethod::CRLF, 500), "$GPGGA,123519,4807.038,N*47\r\n");
+    uint64_t readsAfterFirst = serial.getStats().readCalls;
+    EXPECT_LE(readsAfterFirst, 2u);
+
+    // The rest came with the first read
+    EXPECT_EQ(serial.read(Serial_Comms::TerminationMethod::CRLF, 500), "$GPRMC,123520,A*6A\r\n");
+    EXPECT_EQ(serial.getStats().readCalls, readsAfterFirst);
+    EXPECT_EQ(serial.getBufferedBytes(), 6u);
+}
+
+TEST(SerialCommsTests, FindsCrlfSplitBetweenReads) {
+    PtyPair pty;
+    Serial_Comms serial;
+    openRaw(serial, pty);
+
+    std::thread writer([&] {
+        pty.write("$GPGSA,A,3\r");
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        pty.write("\n$GP");
+    });
+    EXPECT_EQ(serial.read(Serial_Comms::TerminationMethod::CRLF, 1000), "$GPGSA,A,3\r\n");
+    writer.join();
+    EXPECT_EQ(serial.read(Serial_Comms::TerminationMethod::None, 0, 3), "$GP");
+}
+
+TEST(SerialCommsTests, ReadTimesOutWithPartialData) {
+    PtyPair pty;
+    Serial_Comms serial;
+    openRaw(serial, pty);
+
+    pty.write("$GPGLL,49");
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(serial.read(Serial_Comms::TerminationMethod::LF, 50), "$GPGLL,49");
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(50));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(500));
+    // Waiting blocks in poll() instead of spinning on reads
+    EXPECT_LE(serial.getStats().readCalls, 2u);
+
+    pty.write("abcdef\n");
+    EXPECT_EQ(serial.read(Serial_Comms::TerminationMethod::LF, 500, 4), "abcd");
+    EXPECT_EQ(serial.read(Serial_Comms::TerminationMethod::LF, 500), "ef\n");
+}
+
+TEST(SerialCommsTests, ReadIntoReturnsWhatHasArrived) {
+    PtyPair pty;
+    Serial_Comms serial;
+    openRaw(serial, pty);
+
+    pty.write("0123456789");
+    std::byte buffer[64];
+    // Returns the ten bytes at once rather than waiting for 64
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(serial.readInto(std::span<std::byte>(buffer, 4), 1000), 4u);
+    EXPECT_EQ(serial.readInto(std::span<std::byte>(buffer, sizeof(buffer)), 1000), 6u);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(buffer), 6), "456789");
+    EXPECT_EQ(serial.readInto(std::span<std::byte>(buffer, sizeof(buffer)), 20), 0u);
+}
+
+TEST(SerialCommsTests, ReadsLeaveTermiosAlone) {
+    PtyPair pty;
+    Serial_Comms serial;
+    openRaw(serial, pty);
+
+    pty.write("$GPZDA,201530.00,04,07,2002,00,00*60\r\n");
+    EXPECT_EQ(serial.read(Serial_Comms::TerminationMethod::CRLF, 500), "$GPZDA,201530.00,04,07,2002,00,00*60\r\n");
+    EXPECT_EQ(serial.read(Serial_Comms::TerminationMethod::CRLF, 20), "");
+    // One poll() and one read() for the sentence, one poll() for the timeout
+    EXPECT_EQ(serial.getStats().pollCalls + serial.getStats().readCalls, 3u);
+
+    termios tty;
+    ASSERT_EQ(tcgetattr(serial.getPollDescriptor(), &tty), 0);
+    EXPECT_EQ(tty.c_cc[VMIN], 0);
+    EXPECT_EQ(tty.c_cc[VTIME], 0);
+}
+
+TEST(SerialCommsTests, HighThroughputProfileCollectsBurstInOneRead) {
+    PtyPair pty;
+    Serial_Comms serial;
+    ASSERT_TRUE(serial.setReadProfile(Serial_Comms::ReadProfile::HighThroughput)); // Applied by configure()
+    openRaw(serial, pty);
+    termios tty;
+    ASSERT_EQ(tcgetattr(serial.getPollDescriptor(), &tty), 0);
+    EXPECT_EQ(tty.c_cc[VMIN], 64);
+    EXPECT_EQ(tty.c_cc[VTIME], 1);
+
+    std::thread writer([&] {
+        for (int i = 0; i < 10; ++i) {
+            pty.write("$GPGSV,3,1,11,03*7A\r\n");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    });
+    std::byte buffer[1024];
+    size_t received = serial.readInto(std::span<std::byte>(buffer, sizeof(buffer)), 1000);
+    writer.join();
+    // Waits for VMIN bytes instead of returning the first sentence alone
+    EXPECT_GE(received, 64u);
+    EXPECT_EQ(serial.getStats().readCalls, 1u);
+
+    ASSERT_TRUE(serial.setReadProfile(Serial_Comms::ReadProfile::LowLatency));
+    ASSERT_EQ(tcgetattr(serial.getPollDescriptor(), &tty), 0);
+    EXPECT_EQ(tty.c_cc[VMIN], 0);
+}
+
+TEST(SerialCommsTests, SetsNonStandardBaudRate) {
+    PtyPair pty;
+    Serial_Comms serial;
+    openRaw(serial, pty);
+    EXPECT_EQ(serial.getBaudRate(), 115200u);
+
+    // 1.5 Mbaud has a Bxxx constant; 1 Mbaud and 250 kbaud go through termios2/BOTHER
+    for (unsigned int baud : {1500000u, 1000000u, 250000u}) {
+        ASSERT_TRUE(serial.setBaudRate(baud)) << baud;
+        EXPECT_EQ(serial.getBaudRate(), baud);
+    }
+    pty.write("$GPHDT,274.07,T*03\r\n");
+    EXPECT_EQ(serial.read(Serial_Comms::TerminationMethod::CRLF, 500), "$GPHDT,274.07,T*03\r\n");
+    EXPECT_FALSE(serial.setBaudRate(0));
+}
+
+TEST(SerialCommsTests, LowLatencyFailsGracefullyWithoutUartDriver) {
+    PtyPair pty;
+    Serial_Comms serial;
+    EXPECT_FALSE(serial.setLowLatency(true)); // Not open
+    openRaw(serial, pty);
+
+    // A pty has no serial_struct; the port keeps working as configured
+    EXPECT_FALSE(serial.setLowLatency(true));
+    EXPECT_EQ(serial.getBaudRate(), 115200u);
+    pty.write("$GPGGA,1\r\n");
+    EXPECT_EQ(serial.read(Serial_Comms::TerminationMethod::CRLF, 500), "$GPGGA,1\r\n");
+}
+
+// ~80-byte numbered sentence, as a GNSS receiver emits
+static std::string sentence(int i) {
+    char text[96];
+    std::snprintf(text, sizeof(text), "$GPGGA,%06d,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n", i);
+    return text;
+}
+
+TEST(SerialCommsTests, ReaderThreadLosesNothingWhileConsumerStalls) {
+    PtyPair pty;
+    Serial_Comms serial;
+    openRaw(serial, pty);
+    ASSERT_TRUE(serial.startReader());
+    EXPECT_TRUE(serial.isReaderRunning());
+    EXPECT_FALSE(serial.startReader());
+
+    // 3000 sentences (~240 kB, several times what the pty buffers hold) over 1 s while the
+    // consumer is stalled for 2 s
+    constexpr int kSentences = 3000;
+    size_t refused = 0;
+    std::thread writer([&] {
+        for (int i = 0; i < kSentences; ++i) {
+            refused += pty.writeOrDrop(sentence(i));
+            if (i % 30 == 29) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    writer.join();
+    EXPECT_EQ(refused, 0u);
+
+    for (int i = 0; i < kSentences; ++i) {
+        ASSERT_EQ(serial.read(Serial_Comms::TerminationMethod::CRLF, 500), sentence(i));
+    }
+    EXPECT_EQ(serial.getBufferedBytes(), 0u);
+    Serial_Comms::ReaderStats stats = serial.getReaderStats();
+    EXPECT_EQ(stats.overrunBytes, 0u);
+    EXPECT_EQ(stats.bytes, kSentences * sentence(0).size());
+    EXPECT_GT(stats.highWaterBytes, 200000u);
+}
+
+TEST(SerialCommsTests, ReaderCountsRingOverrun) {
+    PtyPair pty;
+    Serial_Comms serial;
+    openRaw(serial, pty);
+    ASSERT_TRUE(serial.startReader(4096));
+
+    std::string data(20000, 'x');
+    for (size_t offset = 0; offset < data.size(); offset += 1000) {
+        pty.write(data.substr(offset, 1000));
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (serial.getReaderStats().bytes < data.size() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    std::byte buffer[8192];
+    size_t received = 0;
+    while (size_t n = serial.readInto(std::span<std::byte>(buffer, sizeof(buffer)), 20)) {
+        received += n;
+    }
+    // The ring kept its first 4096 bytes; the rest was dropped and counted
+    Serial_Comms::ReaderStats stats = serial.getReaderStats();
+    EXPECT_EQ(received, 4096u);
+    EXPECT_EQ(stats.overrunBytes, data.size() - 4096);
+    EXPECT_EQ(stats.highWaterBytes, 4096u);
+}
+
+TEST(SerialCommsTests, ReaderStampsEachChunkWithItsArrival) {
+    PtyPair pty;
+    Serial_Comms serial;
+    openRaw(serial, pty);
+    EXPECT_FALSE(serial.getLastReceiveTime().has_value());
+    ASSERT_TRUE(serial.startReader());
+    EXPECT_NE(serial.getPollDescriptor(), -1);
+
+    auto before = std::chrono::steady_clock::now();
+    pty.write("$GPHDT,1*00\r\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    pty.write("$GPHDT,2*00\r\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+
+    // The poll descriptor is readable and both chunks are waiting; each read returns one
+    pollfd pfd = {serial.getPollDescriptor(), POLLIN, 0};
+    EXPECT_EQ(poll(&pfd, 1, 0), 1);
+    EXPECT_EQ(serial.getBufferedBytes(), 26u);
+    std::byte buffer[64];
+    ASSERT_EQ(serial.readInto(std::span<std::byte>(buffer, sizeof(buffer)), 0), 13u);
+    auto first = serial.getLastArrivalTime();
+    ASSERT_EQ(serial.readInto(std::span<std::byte>(buffer, sizeof(buffer)), 0), 13u);
+    auto second = serial.getLastArrivalTime();
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(buffer), 13), "$GPHDT,2*00\r\n");
+    ASSERT_TRUE(first && second);
+
+    // Times of arrival, not of the reads that came later
+    EXPECT_GE(*first, before);
+    EXPECT_LT(*first - before, std::chrono::milliseconds(40));
+    EXPECT_GE(*second - *first, std::chrono::milliseconds(50));
+    EXPECT_GE(std::chrono::steady_clock::now() - *second, std::chrono::milliseconds(50));
+    ASSERT_TRUE(serial.getLastReceiveTime().has_value());
+    EXPECT_LT(*serial.getLastReceiveTime(), std::chrono::system_clock::now() - std::chrono::milliseconds(40));
+
+    // Caught up: the descriptor waits for the next chunk
+    EXPECT_EQ(poll(&pfd, 1, 0), 0);
+    // Reads never touched the port themselves
+    EXPECT_EQ(serial.getStats().readCalls, 0u);
+}
+
+TEST(SerialCommsTests, StoppedReaderHandsOverRemainingBytes) {
+    PtyPair pty;
+    Serial_Comms serial;
+    openRaw(serial, pty);
+    ASSERT_TRUE(serial.startReader());
+
+    pty.write("$GPVTG,1*00\r\n$GPV");
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (serial.getBufferedBytes() < 17 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    serial.stopReader();
+    EXPECT_FALSE(serial.isReaderRunning());
+
+    pty.write("TG,2*00\r\n");
+    EXPECT_EQ(serial.read(Serial_Comms::TerminationMethod::CRLF, 500), "$GPVTG,1*00\r\n");
+    EXPECT_EQ(serial.read(Serial_Comms::TerminationMethod::CRLF, 500), "$GPVTG,2*00\r\n");
+    EXPECT_GT(serial.getStats().readCalls, 0u); // The second sentence came straight from the port
+}
@@ -0,0 +1,95 @@
+#include "SharedMemoryComms.hpp"
+#include "NMEAReader.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+std::string ringName(const char* test) {
+    return "/nmea_test_" + std::string(test) + "_" + std::to_string(getpid());
+}
+
+TEST(SharedMemoryCommsTests, ReadersHaveIndependentCursors) {
+    SharedMemoryWriter writer;
+    ASSERT_TRUE(writer.create(ringName("cursors"), 4096));
+    SharedMemoryComms first, second;
+    ASSERT_TRUE(first.open(ringName("cursors")));
+    ASSERT_TRUE(second.open(ringName("cursors")));
+
+    ASSERT_TRUE(writer.write("hello "));
+    EXPECT_EQ(first.readBytes(3, 0), "hel");
+    ASSERT_TRUE(writer.write("world"));
+    EXPECT_EQ(first.readBytes(100, 0), "lo world");
+    EXPECT_EQ(second.readBytes(100, 0), "hello world");
+    EXPECT_EQ(second.readBytes(100, 0), "");
+}
+
+TEST(SharedMemoryCommsTests, LateReaderStartsAtLiveData) {
+    SharedMemoryWriter writer;
+    ASSERT_TRUE(writer.create(ringName("late"), 4096));
+    ASSERT_TRUE(writer.write("old"));
+    SharedMemoryComms reader;
+    ASSERT_TRUE(reader.open(ringName("late")));
+    ASSERT_TRUE(writer.write("new"));
+    EXPECT_EQ(reader.readBytes(100, 0), "new");
+}
+
+TEST(SharedMemoryCommsTests, SleepingReaderIsWokenByWriter) {
+    SharedMemoryWriter writer;
+    ASSERT_TRUE(writer.create(ringName("wake"), 4096));
+    SharedMemoryComms reader;
+    ASSERT_TRUE(reader.open(ringName("wake")));
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(reader.readBytes(16, 30), ""); // Times out with nothing written
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(25));
+
+    std::thread producer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        writer.write("$GPGGA,1*00\r\n");
+    });
+    EXPECT_EQ(reader.readBytes(64, 2000), "$GPGGA,1*00\r\n");
+    producer.join();
+}
+
+TEST(SharedMemoryCommsTests, LappedReaderSkipsAheadAndCountsLoss) {
+    SharedMemoryWriter writer;
+    ASSERT_TRUE(writer.create(ringName("lapped"), 4096));
+    SharedMemoryComms reader;
+    ASSERT_TRUE(reader.open(ringName("lapped")));
+
+    for (char c : std::string("abcdef")) {
+        ASSERT_TRUE(writer.write(std::string(1024, c)));
+    }
+    std::string received;
+    while (true) {
+        std::string chunk = reader.readBytes(8192, 0);
+        if (chunk.empty()) break;
+        received += chunk;
+    }
+    EXPECT_EQ(reader.getOverrunBytes(), 2048u);
+    EXPECT_EQ(received, std::string(1024, 'c') + std::string(1024, 'd') + std::string(1024, 'e') + std::string(1024, 'f'));
+}
+
+TEST(SharedMemoryCommsTests, WriterCloseEndsStreamAfterPendingData) {
+    SharedMemoryWriter writer;
+    ASSERT_TRUE(writer.create(ringName("close"), 4096));
+    SharedMemoryComms reader;
+    ASSERT_TRUE(reader.open(ringName("close")));
+    NMEAReader nmea(reader, 10);
+
+    writer.write("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n");
+    writer.close();
+    EXPECT_TRUE(reader.isOpen());
+    auto message = nmea.readAndParseSentence();
+    ASSERT_TRUE(message.has_value());
+    EXPECT_EQ((*message)->getType(), NMEAMessage::MessageType::RMC);
+    EXPECT_FALSE(reader.isOpen());
+}
+
+TEST(SharedMemoryCommsTests, OpenFailsForMissingRing) {
+    SharedMemoryComms reader;
+    EXPECT_FALSE(reader.open(ringName("missing")));
+    EXPECT_FALSE(reader.isOpen());
+}
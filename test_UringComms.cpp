@@ -0,0 +1,81 @@
+#include "UringComms.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define SKIP_WITHOUT_IO_URING() \
+    if (!UringComms::isSupported()) GTEST_SKIP() << "io_uring not available on this kernel"
+
+std::string readAll(UringComms& comms, size_t expected, unsigned int timeoutMs = 500) {
+    std::string result;
+    char buffer[256];
+    while (result.size() < expected) {
+        size_t n = comms.readInto(std::as_writable_bytes(std::span<char>(buffer)), timeoutMs);
+        if (n == 0) break;
+        result.append(buffer, n);
+    }
+    return result;
+}
+
+TEST(UringCommsTests, MultishotRecvOnSocket) {
+    SKIP_WITHOUT_IO_URING();
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    UringComms comms(8, 64);
+    ASSERT_TRUE(comms.attach(fds[0], true));
+
+    std::string payload;
+    for (int i = 0; i < 50; ++i) payload += "$GPGGA,sentence," + std::to_string(i) + "*00\r\n";
+    ASSERT_EQ(::write(fds[1], payload.data(), payload.size()), static_cast<ssize_t>(payload.size()));
+
+    EXPECT_EQ(readAll(comms, payload.size()), payload); // Larger than all provided buffers together
+    ::close(fds[1]);
+    EXPECT_EQ(readAll(comms, 1), "");
+    EXPECT_FALSE(comms.isOpen());
+}
+
+TEST(UringCommsTests, QueuedCompletionsNeedNoSyscall) {
+    SKIP_WITHOUT_IO_URING();
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    UringComms comms(16, 16);
+    ASSERT_TRUE(comms.attach(fds[0], true));
+
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(::write(fds[1], "0123456789ABCDEF", 16), 16);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // Let completions land
+
+    uint64_t before = comms.getStats().enterCalls;
+    EXPECT_EQ(readAll(comms, 64).size(), 64u);
+    EXPECT_EQ(comms.getStats().enterCalls, before);
+    ::close(fds[1]);
+}
+
+TEST(UringCommsTests, ReadsFromPseudoTerminal) {
+    SKIP_WITHOUT_IO_URING();
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_GE(master, 0);
+    ASSERT_EQ(grantpt(master), 0);
+    ASSERT_EQ(unlockpt(master), 0);
+    int slave = ::open(ptsname(master), O_RDWR | O_NOCTTY);
+    ASSERT_GE(slave, 0);
+    termios tty;
+    tcgetattr(slave, &tty);
+    cfmakeraw(&tty);
+    tcsetattr(slave, TCSANOW, &tty);
+
+    UringComms comms;
+    ASSERT_TRUE(comms.attach(slave, true));
+    EXPECT_EQ(readAll(comms, 1, 20), ""); // Times out with nothing written
+
+    ASSERT_EQ(::write(master, "$GPRMC,1*00\r\n", 13), 13);
+    EXPECT_EQ(readAll(comms, 13), "$GPRMC,1*00\r\n");
+    ::close(master);
+}